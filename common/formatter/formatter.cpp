@@ -6,6 +6,7 @@
 #include "common/formatter/rules/rule_config.h"
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
 #include "common/util/ast_util.h"
 #include "common/util/string_util.h"
 
@@ -266,9 +267,13 @@ bool can_node_be_inlined(const FormatterTreeNode& curr_node, int cursor_pos) {
   return line_width <= indent::line_width_target;  // TODO - comments
 }
 
-std::vector<std::string> apply_formatting(const FormatterTreeNode& curr_node,
-                                          std::vector<std::string> /*output*/ = {},
-                                          int cursor_pos = 0) {
+// formatted_refs optionally holds the already formatted lines of each list in curr_node.refs, an
+// empty entry means the ref still has to be formatted.
+std::vector<std::string> apply_formatting(
+    const FormatterTreeNode& curr_node,
+    std::vector<std::string> /*output*/ = {},
+    int cursor_pos = 0,
+    const std::vector<std::vector<std::string>>* formatted_refs = nullptr) {
   using namespace formatter_rules;
   if (!curr_node.token && curr_node.refs.empty()) {
     // special case to handle an empty list
@@ -317,7 +322,15 @@ std::vector<std::string> apply_formatting(const FormatterTreeNode& curr_node,
     } else {
       // If it's not a token, we have to recursively build up the form
       // TODO - add the cursor_pos here
-      const auto& lines = apply_formatting(ref, {}, cursor_pos);
+      std::vector<std::string> new_lines;
+      const std::vector<std::string>* formatted = nullptr;
+      if (formatted_refs && !formatted_refs->at(i).empty()) {
+        formatted = &formatted_refs->at(i);
+      } else {
+        new_lines = apply_formatting(ref, {}, cursor_pos);
+        formatted = &new_lines;
+      }
+      const auto& lines = *formatted;
       for (int i = 0; i < (int)lines.size(); i++) {
         const auto& line = lines.at(i);
         form_lines.push_back(fmt::format(
@@ -464,15 +477,20 @@ std::string join_formatted_lines(const std::vector<std::string>& lines,
   return fmt::format("{}", fmt::join(lines, line_ending));
 }
 
-std::optional<std::string> formatter::format_code(const std::string& source) {
+namespace {
+
+/*!
+ * Steps 1 and 2 of formatting (see format_code), producing the tree that is ready to be printed.
+ */
+std::optional<FormatterTree> build_formatter_tree(const std::string& source) {
   // Create a parser.
-  std::shared_ptr<TSParser> parser(ts_parser_new(), TreeSitterParserDeleter());
+  std::shared_ptr<TSParser> parser(ts_parser_new(), formatter::TreeSitterParserDeleter());
   ts_parser_set_language(parser.get(), tree_sitter_opengoal());
 
   // Build a syntax tree based on source code stored in a string.
   std::shared_ptr<TSTree> tree(
       ts_parser_parse_string(parser.get(), NULL, source.c_str(), source.length()),
-      TreeSitterTreeDeleter());
+      formatter::TreeSitterTreeDeleter());
 
   // Get the root node of the syntax tree.
   TSNode root_node = ts_tree_root_node(tree.get());
@@ -484,19 +502,62 @@ std::optional<std::string> formatter::format_code(const std::string& source) {
     return std::nullopt;
   }
 
+  // 1. Simplify the AST down to something that is easier to work on from a formatting perspective
+  // this also gathers basic metadata that can be done at this stage, like if the token is a
+  // comment or if the form is on the top-level
+  auto formatting_tree = FormatterTree(source, root_node);
+  // 2. Recursively iterate through this simplified FormatterTree and figure out what rules
+  // need to be applied to produce an optimal result
+  apply_formatting_config(formatting_tree.root);
+  return formatting_tree;
+}
+
+// below this, it's not worth starting threads.
+constexpr int MIN_FORMS_PER_THREAD = 8;
+
+/*!
+ * Format each top level list on its own, in parallel if num_threads > 1. Tokens (comments, and
+ * top level symbols) are left empty, these are handled when the file is joined together.
+ */
+std::vector<std::vector<std::string>> format_top_level_lists(const FormatterTreeNode& root,
+                                                             int num_threads) {
+  const int num_refs = root.refs.size();
+  std::vector<std::vector<std::string>> result(num_refs);
+  auto format_one = [&](int i) {
+    const auto& ref = root.refs.at(i);
+    if (!ref.token) {
+      result.at(i) = apply_formatting(ref);
+    }
+  };
+
+  num_threads = std::min(num_threads, num_refs / MIN_FORMS_PER_THREAD);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_refs; i++) {
+      format_one(i);
+    }
+    return result;
+  }
+
+  // forms vary a lot in size, so workers take the next form instead of a fixed range.
+  JobSystem::global().parallel_for(
+      "format-form", num_refs, [&](size_t i) { format_one(i); }, num_threads);
+  return result;
+}
+}  // namespace
+
+std::optional<std::string> formatter::format_code(const std::string& source, int num_threads) {
   try {
-    // There are three phases of formatting
-    // 1. Simplify the AST down to something that is easier to work on from a formatting perspective
-    // this also gathers basic metadata that can be done at this stage, like if the token is a
-    // comment or if the form is on the top-level
-    auto formatting_tree = FormatterTree(source, root_node);
-    // 2. Recursively iterate through this simplified FormatterTree and figure out what rules
-    // need to be applied to produce an optimal result
-    apply_formatting_config(formatting_tree.root);
+    // There are three phases of formatting, the first two build the tree
+    auto formatting_tree = build_formatter_tree(source);
+    if (!formatting_tree) {
+      return std::nullopt;
+    }
     // 3. Use this updated FormatterTree to print out the final source-code, while doing so
     // we may deviate from the optimal result to produce something even more optimal by inlining
     // forms that can fit within the line width.
-    const auto formatted_lines = apply_formatting(formatting_tree.root);
+    // The top level forms don't depend on each other, so they are done first, possibly in parallel
+    const auto formatted_forms = format_top_level_lists(formatting_tree->root, num_threads);
+    const auto formatted_lines = apply_formatting(formatting_tree->root, {}, 0, &formatted_forms);
     // 4. Now we joint he lines together, it's easier when formatting to leave all lines independent
     // so adding indentation is easier
     const auto formatted_source =
@@ -508,3 +569,34 @@ std::optional<std::string> formatter::format_code(const std::string& source) {
 
   return std::nullopt;
 }
+
+std::optional<std::vector<std::string>> formatter::format_top_level_forms(
+    const std::string& source,
+    int num_threads) {
+  try {
+    auto formatting_tree = build_formatter_tree(source);
+    if (!formatting_tree) {
+      return std::nullopt;
+    }
+    const auto& root = formatting_tree->root;
+    const auto formatted_forms = format_top_level_lists(root, num_threads);
+    const auto line_ending = file_util::get_majority_file_line_endings(source);
+    std::vector<std::string> result;
+    for (size_t i = 0; i < root.refs.size(); i++) {
+      const auto& ref = root.refs[i];
+      if (ref.token) {
+        result.push_back(ref.metadata.node_type == "block_comment"
+                             ? join_formatted_lines(
+                                   formatter_rules::comments::format_block_comment(ref.token_str()),
+                                   line_ending)
+                             : ref.token_str());
+      } else {
+        result.push_back(join_formatted_lines(formatted_forms[i], line_ending));
+      }
+    }
+    return result;
+  } catch (std::exception& e) {
+    lg::error("Unable to format code - {}", e.what());
+  }
+  return std::nullopt;
+}
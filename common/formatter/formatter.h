@@ -2,6 +2,7 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "tree_sitter/api.h"
 
@@ -15,5 +16,12 @@ struct TreeSitterTreeDeleter {
   void operator()(TSTree* ptr) const { ts_tree_delete(ptr); }
 };
 
-std::optional<std::string> format_code(const std::string& source);
+// num_threads > 1 formats the top level forms of large files in parallel.
+std::optional<std::string> format_code(const std::string& source, int num_threads = 1);
+
+// Format each top level form (or comment) of the source on its own, returning them in the order
+// they appear. Joining these is not the same as format_code, which also decides the blank lines
+// between them.
+std::optional<std::vector<std::string>> format_top_level_forms(const std::string& source,
+                                                               int num_threads = 1);
 }  // namespace formatter
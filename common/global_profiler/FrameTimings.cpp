@@ -0,0 +1,165 @@
+#include "FrameTimings.h"
+
+#include <algorithm>
+
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/string_util.h"
+
+#include "fmt/core.h"
+#include "third-party/json.hpp"
+
+int FrameTimings::channel(const std::string& name, float hitch_ms) {
+  std::lock_guard<std::mutex> lock(m_channels_mutex);
+  const int count = m_channel_count;
+  for (int i = 0; i < count; i++) {
+    if (m_channels[i]->name == name) {
+      return i;
+    }
+  }
+  ASSERT_MSG(count < MAX_CHANNELS, "too many frame timing channels");
+  auto ch = std::make_unique<Channel>();
+  ch->name = name;
+  ch->hitch_ms = hitch_ms;
+  m_channels[count] = std::move(ch);
+  // channels are never removed, so recording only needs the count to be up to date.
+  m_channel_count = count + 1;
+  return count;
+}
+
+namespace {
+template <typename T, typename F>
+void atomic_update(std::atomic<T>& value, F&& f) {
+  T old = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(old, f(old), std::memory_order_relaxed)) {
+  }
+}
+
+/*!
+ * Nearest-rank percentile: the smallest sample that at least percent% of the samples are <= to.
+ */
+float percentile(const std::vector<float>& sorted_samples, int percent) {
+  if (sorted_samples.empty()) {
+    return 0;
+  }
+  const size_t rank = (percent * sorted_samples.size() + 99) / 100;
+  return sorted_samples[rank ? rank - 1 : 0];
+}
+}  // namespace
+
+void FrameTimings::record(int channel, float ms) {
+  ASSERT(channel >= 0 && channel < m_channel_count);
+  auto& ch = *m_channels[channel];
+  const u64 idx = ch.count.fetch_add(1, std::memory_order_relaxed);
+  ch.history[idx % HISTORY_SIZE].store(ms, std::memory_order_relaxed);
+  atomic_update(ch.total, [&](double total) { return total + ms; });
+  atomic_update(ch.max, [&](float max) { return std::max(max, ms); });
+  if (ms > ch.hitch_ms) {
+    ch.hitches.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/*!
+ * Get the stats of a channel. If history_out is set, also get its history, oldest first.
+ */
+FrameTimings::ChannelStats FrameTimings::channel_stats(Channel& ch,
+                                                       std::vector<float>* history_out) {
+  ChannelStats result;
+  result.name = ch.name;
+  result.count = ch.count.load(std::memory_order_relaxed);
+  result.mean = result.count ? ch.total.load(std::memory_order_relaxed) / result.count : 0;
+  result.max = ch.max.load(std::memory_order_relaxed);
+  result.hitches = ch.hitches.load(std::memory_order_relaxed);
+  result.hitch_ms = ch.hitch_ms;
+
+  std::vector<float> samples;
+  const u64 first = result.count > (u64)HISTORY_SIZE ? result.count - HISTORY_SIZE : 0;
+  samples.reserve(result.count - first);
+  for (u64 i = first; i < result.count; i++) {
+    samples.push_back(ch.history[i % HISTORY_SIZE].load(std::memory_order_relaxed));
+  }
+  if (history_out) {
+    *history_out = samples;
+  }
+  std::sort(samples.begin(), samples.end());
+  result.p50 = percentile(samples, 50);
+  result.p95 = percentile(samples, 95);
+  result.p99 = percentile(samples, 99);
+  return result;
+}
+
+std::vector<FrameTimings::ChannelStats> FrameTimings::stats() {
+  std::vector<ChannelStats> result;
+  const int count = m_channel_count;
+  for (int i = 0; i < count; i++) {
+    result.push_back(channel_stats(*m_channels[i], nullptr));
+  }
+  return result;
+}
+
+void FrameTimings::reset() {
+  const int count = m_channel_count;
+  for (int i = 0; i < count; i++) {
+    auto& ch = *m_channels[i];
+    ch.count = 0;
+    ch.total = 0;
+    ch.max = 0;
+    ch.hitches = 0;
+  }
+}
+
+bool FrameTimings::dump(const fs::path& path) {
+  const int count = m_channel_count;
+  std::string text;
+  if (path.extension() == ".csv") {
+    text = "channel,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches,hitch_ms\n";
+    for (int i = 0; i < count; i++) {
+      auto s = channel_stats(*m_channels[i], nullptr);
+      text += fmt::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{},{:.3f}\n", s.name, s.count,
+                          s.mean, s.p50, s.p95, s.p99, s.max, s.hitches, s.hitch_ms);
+    }
+    // write_text_file adds the last newline.
+    text.pop_back();
+  } else {
+    nlohmann::json json;
+    auto& channels = json["channels"];
+    for (int i = 0; i < count; i++) {
+      std::vector<float> history;
+      auto s = channel_stats(*m_channels[i], &history);
+      auto& ch = channels[s.name];
+      ch["count"] = s.count;
+      ch["mean_ms"] = s.mean;
+      ch["p50_ms"] = s.p50;
+      ch["p95_ms"] = s.p95;
+      ch["p99_ms"] = s.p99;
+      ch["max_ms"] = s.max;
+      ch["hitches"] = s.hitches;
+      ch["hitch_ms"] = s.hitch_ms;
+      ch["history_ms"] = history;
+    }
+    text = json.dump();
+  }
+
+  try {
+    file_util::create_dir_if_needed_for_file(path);
+    file_util::write_text_file(path, text);
+  } catch (const std::exception& e) {
+    lg::error("Failed to write frame timings to {}: {}", path.string(), e.what());
+    return false;
+  }
+  lg::info("Wrote frame timings for {} channels to {}", count, path.string());
+  return true;
+}
+
+void FrameTimings::dump_to_profile_data() {
+  const auto base = file_util::get_jak_project_dir() / "profile_data" /
+                    fmt::format("frame-timings-{}", str_util::current_local_timestamp_no_colons());
+  dump(base.string() + ".csv");
+  dump(base.string() + ".json");
+}
+
+FrameTimings& frame_timings() {
+  // constructed on first use, since channels are created during static initialization.
+  static FrameTimings timings;
+  return timings;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/util/FileUtil.h"
+
+/*!
+ * Rolling history of how long things take each frame, for statistics instead of a timeline like
+ * GlobalProfiler. Each channel is a named stream of samples in milliseconds, recorded from any
+ * thread. Channels keep the last HISTORY_SIZE samples, which are used for the percentiles, and a
+ * count, mean, max and number of hitches (samples over the channel's hitch threshold) since the
+ * last reset.
+ *
+ * Recording doesn't lock, so it's safe on realtime threads like the audio callback. A sample
+ * recorded while the stats are read may be missing from some of them.
+ */
+class FrameTimings {
+ public:
+  static constexpr int MAX_CHANNELS = 1024;
+  static constexpr int HISTORY_SIZE = 60 * 60;
+  // two frames at 60 fps.
+  static constexpr float DEFAULT_HITCH_MS = 1000.f / 30.f;
+
+  struct ChannelStats {
+    std::string name;
+    u64 count = 0;
+    float mean = 0;
+    float max = 0;
+    u64 hitches = 0;
+    float hitch_ms = 0;
+    // over the history.
+    float p50 = 0;
+    float p95 = 0;
+    float p99 = 0;
+  };
+
+  // returns the id of the channel with this name, creating it if needed.
+  int channel(const std::string& name, float hitch_ms = DEFAULT_HITCH_MS);
+  void record(int channel, float ms);
+  void record(const std::string& name, float ms) { record(channel(name), ms); }
+
+  std::vector<ChannelStats> stats();
+  void reset();
+
+  // write the stats (and, for JSON, the history) to a .csv or .json file.
+  bool dump(const fs::path& path);
+  // write both to profile_data, with a timestamp in the name.
+  void dump_to_profile_data();
+
+ private:
+  struct Channel {
+    std::string name;
+    float hitch_ms;
+    // sample i goes in history[i % HISTORY_SIZE].
+    std::array<std::atomic<float>, HISTORY_SIZE> history;
+    std::atomic<u64> count = 0;
+    std::atomic<double> total = 0;
+    std::atomic<float> max = 0;
+    std::atomic<u64> hitches = 0;
+  };
+
+  ChannelStats channel_stats(Channel& channel, std::vector<float>* history_out);
+
+  std::mutex m_channels_mutex;
+  std::array<std::unique_ptr<Channel>, MAX_CHANNELS> m_channels;
+  std::atomic<int> m_channel_count = 0;
+};
+
+FrameTimings& frame_timings();
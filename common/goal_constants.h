@@ -98,6 +98,26 @@ constexpr int EE_MAIN_MEM_LOW_PROTECT = 512 * 1024;
 constexpr int EE_MAIN_MEM_SIZE = 128 * (1 << 20);  // 128 MB, same as PS2 TOOL
 constexpr u64 EE_MAIN_MEM_MAP = 0x2123000000;      // intentionally > 32-bit to catch pointer bugs
 
+// Functions compiled with profiling write enter/exit events into a ring buffer in GOAL memory. The
+// runtime describes the buffer with a FunctionTraceInfo at this fixed address, so the probes
+// don't need any linking. See game/kernel/common/ktrace.h
+constexpr u32 FUNCTION_TRACE_INFO_ADDR = 0x13AD40;
+
+struct FunctionTraceInfo {
+  u32 buffer;  // GOAL address of the FunctionTraceEntry array
+  u32 mask;    // number of entries - 1, must be a power of two
+  u32 next;    // number of events written, not masked
+  u32 pad;
+};
+
+struct FunctionTraceEntry {
+  u64 tsc;   // rdtsc when the event happened
+  u32 name;  // GOAL address of a string with the function name
+  u32 kind;  // FunctionTraceEvent
+};
+
+enum class FunctionTraceEvent : u32 { ENTER = 0, EXIT = 1 };
+
 // when true, attempt to map the EE memory in the low 2 GB of RAM
 // this allows us to use EE pointers as real pointers.  However, this might not always work,
 // so this should be used only for debugging.
@@ -30,6 +30,13 @@ struct DgoHeader {
   char name[60];
 };
 
+/*!
+ * PC-only: set in DgoHeader::object_count when each object is compressed with zstd. After each
+ * ObjectHeader (which has the decompressed size) is a u32 with the compressed size, then a zstd
+ * frame, padded to 16 bytes like a normal object.
+ */
+constexpr u32 DGO_ZSTD_FLAG = 0x80000000;
+
 /*!
  * Data at the front of each OBJ.
  */
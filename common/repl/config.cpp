@@ -14,6 +14,7 @@ void to_json(json& j, const Config& obj) {
       {"keybinds", obj.keybinds},
       {"perGameHistory", obj.per_game_history},
       {"permissiveRedefinitions", obj.permissive_redefinitions},
+      {"compressDgos", obj.compress_dgos},
   };
 }
 
@@ -64,6 +65,9 @@ void from_json(const json& j, Config& obj) {
   if (j.contains("permissiveRedefinitions")) {
     j.at("permissiveRedefinitions").get_to(obj.permissive_redefinitions);
   }
+  if (j.contains("compressDgos")) {
+    j.at("compressDgos").get_to(obj.compress_dgos);
+  }
   // if there is game specific configuration, override any values we just set
   if (j.contains(version_to_game_name(obj.game_version))) {
     from_json(j.at(version_to_game_name(obj.game_version)), obj);
@@ -49,6 +49,8 @@ struct Config {
       {KeyBind::Modifier::CTRL, "N", "Full build of the game", "(mi)"}};
   bool per_game_history = true;
   bool permissive_redefinitions = false;
+  // build DGOs with zstd compressed objects (only the PC port can load these)
+  bool compress_dgos = false;
   std::string iso_path;
 
   int get_nrepl_port() {
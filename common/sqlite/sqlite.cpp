@@ -1,7 +1,29 @@
 #include "sqlite.h"
 
+#include <cctype>
+
 #include "common/log/log.h"
 
+namespace {
+// the cache is cleared when it's full, in case something is generating lots of unique queries.
+constexpr size_t MAX_CACHED_STATEMENTS = 256;
+
+bool is_blank(const char* start, const char* end) {
+  for (const char* c = start; c < end; c++) {
+    if (!isspace((unsigned char)*c)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+sqlite::SQLiteDatabase::~SQLiteDatabase() {
+  // statements have to be finalized before the database closes.
+  commit_writes();
+  m_statements.clear();
+}
+
 bool sqlite::SQLiteDatabase::open_db(const std::string& path) {
   if (is_open()) {
     return true;
@@ -53,3 +75,128 @@ sqlite::GenericResponse sqlite::SQLiteDatabase::run_query(const std::string& sql
   }
   return resp;
 }
+
+/*!
+ * Run the statements in sql, and return the result of the last one, or of the first one that fails.
+ * If sql is a single statement, it's prepared once and reused the next time the same text is run.
+ */
+sqlite::QueryResult sqlite::SQLiteDatabase::run_statement(const std::string& sql) {
+  QueryResult result;
+  if (!is_open()) {
+    result.error = "database is not open";
+    return result;
+  }
+  auto* db = m_db.value().get();
+
+  if (m_batch_start && std::chrono::steady_clock::now() - *m_batch_start > *m_max_batch_time) {
+    commit_writes();
+  }
+
+  auto it = m_statements.find(sql);
+  if (it != m_statements.end()) {
+    run_prepared(it->second.get(), &result);
+    return result;
+  }
+
+  result.error = "no statement";
+  const char* next = sql.c_str();
+  const char* end = next + sql.size();
+  while (next < end) {
+    sqlite3_stmt* stmt = nullptr;
+    const char* tail = nullptr;
+    if (sqlite3_prepare_v2(db, next, end - next, &stmt, &tail) != SQLITE_OK) {
+      result = QueryResult();
+      result.error = sqlite3_errmsg(db);
+      lg::error("SQL error: {}", result.error);
+      return result;
+    }
+    if (!stmt) {
+      // only whitespace or comments left.
+      break;
+    }
+
+    result = QueryResult();
+    run_prepared(stmt, &result);
+    if (next == sql.c_str() && is_blank(tail, end)) {
+      if (m_statements.size() >= MAX_CACHED_STATEMENTS) {
+        m_statements.clear();
+      }
+      m_statements[sql].reset(stmt);
+    } else {
+      sqlite3_finalize(stmt);
+    }
+
+    if (result.status == QueryResult::Status::ERROR) {
+      break;
+    }
+    next = tail;
+  }
+  return result;
+}
+
+void sqlite::SQLiteDatabase::run_prepared(sqlite3_stmt* stmt, QueryResult* result) {
+  auto* db = m_db.value().get();
+  if (m_max_batch_time && !m_batch_start && !sqlite3_stmt_readonly(stmt) &&
+      sqlite3_get_autocommit(db)) {
+    if (sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr) == SQLITE_OK) {
+      m_batch_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  result->num_columns = sqlite3_column_count(stmt);
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    for (int i = 0; i < result->num_columns; i++) {
+      QueryResult::Cell cell;
+      cell.type = sqlite3_column_type(stmt, i);
+      if (cell.type == SQLITE_INTEGER) {
+        cell.integer = sqlite3_column_int64(stmt, i);
+      } else if (cell.type == SQLITE_FLOAT) {
+        cell.real = sqlite3_column_double(stmt, i);
+      }
+      // after reading the typed value: getting the text converts the value in place.
+      const auto* text = (const char*)sqlite3_column_text(stmt, i);
+      cell.text_offset = result->text.size();
+      result->text.append(text ? text : "NULL");
+      result->text.push_back('\0');
+      result->cells.push_back(cell);
+    }
+  }
+
+  if (rc == SQLITE_DONE) {
+    result->status =
+        result->num_columns ? QueryResult::Status::SELECT : QueryResult::Status::MODIFY;
+  } else {
+    result->status = QueryResult::Status::ERROR;
+    result->error = sqlite3_errmsg(db);
+    result->cells.clear();
+    result->text.clear();
+    lg::error("SQL error: {}", result->error);
+  }
+  sqlite3_reset(stmt);
+}
+
+/*!
+ * Group writes into transactions, instead of each statement committing on its own. This is much
+ * faster when there are many small writes, but they're only on disk once commit_writes is called,
+ * or a statement is run more than max_batch_time after the first write. Pass nullopt to stop.
+ */
+void sqlite::SQLiteDatabase::set_batch_writes(
+    std::optional<std::chrono::milliseconds> max_batch_time) {
+  if (!max_batch_time) {
+    commit_writes();
+  }
+  m_max_batch_time = max_batch_time;
+}
+
+void sqlite::SQLiteDatabase::commit_writes() {
+  if (!m_batch_start) {
+    return;
+  }
+  m_batch_start.reset();
+  char* err_msg = nullptr;
+  if (sqlite3_exec(m_db.value().get(), "COMMIT", nullptr, nullptr, &err_msg) != SQLITE_OK) {
+    lg::error("SQL error committing writes: {}", err_msg);
+    sqlite3_free(err_msg);
+  }
+}
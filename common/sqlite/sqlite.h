@@ -1,8 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "third-party/sqlite3/sqlite3.h"
@@ -18,19 +21,61 @@ struct SQLite3DatabaseDeleter {
   }
 };
 
+struct SQLite3StatementDeleter {
+  void operator()(sqlite3_stmt* stmt) const { sqlite3_finalize(stmt); }
+};
+
 struct GenericResponse {
   std::vector<std::vector<std::string>> rows;
 };
 
+/*!
+ * The result of a single statement. Cells are stored row by row, with their sqlite type. The text
+ * of every cell (what sqlite3_column_text gives) is kept back to back in one buffer.
+ */
+struct QueryResult {
+  enum class Status { ERROR, SELECT, MODIFY };
+  struct Cell {
+    int type = SQLITE_NULL;
+    int64_t integer = 0;
+    double real = 0;
+    uint32_t text_offset = 0;
+  };
+
+  Status status = Status::ERROR;
+  std::string error;
+  int num_columns = 0;
+  std::vector<Cell> cells;
+  std::string text;
+
+  size_t num_rows() const { return num_columns ? cells.size() / num_columns : 0; }
+  const char* cell_text(size_t i) const { return text.data() + cells.at(i).text_offset; }
+};
+
 class SQLiteDatabase {
  public:
   SQLiteDatabase() = default;
+  ~SQLiteDatabase();
   bool is_open() const { return m_db.has_value(); }
   bool open_db(const std::string& path);
   GenericResponse run_query(const std::string& sql);
+  QueryResult run_statement(const std::string& sql);
+
+  void set_batch_writes(std::optional<std::chrono::milliseconds> max_batch_time);
+  void commit_writes();
+  bool has_pending_writes() const { return m_batch_start.has_value(); }
 
  private:
+  void run_prepared(sqlite3_stmt* stmt, QueryResult* result);
+
   std::optional<std::shared_ptr<sqlite3>> m_db;
+  // prepared statements, by their text. Only queries with a single statement are cached.
+  std::unordered_map<std::string, std::unique_ptr<sqlite3_stmt, SQLite3StatementDeleter>>
+      m_statements;
+
+  // if set, writes are grouped into transactions, which are committed after this long.
+  std::optional<std::chrono::milliseconds> m_max_batch_time;
+  std::optional<std::chrono::steady_clock::time_point> m_batch_start;
 };
 
 }  // namespace sqlite
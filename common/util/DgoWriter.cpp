@@ -8,12 +8,27 @@
 #include "BinaryWriter.h"
 #include "FileUtil.h"
 
+#include "common/link_types.h"
 #include "common/log/log.h"
+#include "common/util/compress.h"
 
-void build_dgo(const DgoDescription& description, const std::string& output_prefix) {
+namespace {
+// decompression speed doesn't depend on the level, so we can afford a slower one here.
+constexpr int DGO_ZSTD_LEVEL = 9;
+}  // namespace
+
+/*!
+ * Build a DGO. If compress is set, each object is compressed with zstd (see DGO_ZSTD_FLAG). Only
+ * the PC port can load these: the overlord always uses its fast DGO loader for them, and jak2's
+ * kernel decompresses the CGOs it reads directly at boot.
+ */
+void build_dgo(const DgoDescription& description,
+               const std::string& output_prefix,
+               bool compress) {
   BinaryWriter writer;
   // dgo header
-  writer.add<uint32_t>(description.entries.size());
+  const u32 object_count = description.entries.size();
+  writer.add<uint32_t>(compress ? (object_count | DGO_ZSTD_FLAG) : object_count);
   writer.add_cstr_len(description.dgo_name.c_str(), 60);
 
   for (auto& obj : description.entries) {
@@ -30,7 +45,14 @@ void build_dgo(const DgoDescription& description, const std::string& output_pref
     // name
     writer.add_str_len(obj.name_in_dgo, 60);
     // data
-    writer.add_data(obj_data.data(), obj_data.size());
+    if (compress) {
+      auto compressed =
+          compression::compress_zstd_no_header(obj_data.data(), obj_data.size(), DGO_ZSTD_LEVEL);
+      writer.add<uint32_t>(compressed.size());
+      writer.add_data(compressed.data(), compressed.size());
+    } else {
+      writer.add_data(obj_data.data(), obj_data.size());
+    }
     // pad
     while (writer.get_size() & 0xf) {
       writer.add<uint8_t>(0);
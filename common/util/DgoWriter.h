@@ -17,4 +17,6 @@ struct DgoDescription {
   std::vector<DgoEntry> entries;
 };
 
-void build_dgo(const DgoDescription& description, const std::string& output_prefix);
+void build_dgo(const DgoDescription& description,
+               const std::string& output_prefix,
+               bool compress = false);
@@ -10,12 +10,16 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include "BinaryWriter.h"
 
 #include "common/common_types.h"
+#include "common/link_types.h"
 #include "common/util/BinaryReader.h"
+#include "common/util/compress.h"
+#include "common/util/iso_vfs.h"
 #include "common/util/string_util.h"
 #include "common/util/unicode_util.h"
 
@@ -356,12 +360,53 @@ std::vector<uint8_t> read_binary_file(const std::string& filename) {
   return read_binary_file(fs::path(filename));
 }
 
+namespace {
+struct IsoMount {
+  fs::path mount_point;
+  std::shared_ptr<const IsoVfs> iso;
+};
+std::mutex g_iso_mounts_mutex;
+std::vector<IsoMount> g_iso_mounts;
+}  // namespace
+
+void mount_iso(const fs::path& mount_point, std::shared_ptr<const IsoVfs> iso) {
+  std::lock_guard<std::mutex> lock(g_iso_mounts_mutex);
+  lg::info("Mounted {} ({} files) at {}", iso->image_path().string(), iso->entries().size(),
+           mount_point.string());
+  g_iso_mounts.push_back({fs::absolute(mount_point).lexically_normal(), std::move(iso)});
+}
+
+/*!
+ * If path is inside a mounted ISO and the ISO has the file, get its data. The data stays valid
+ * for the rest of the program, mounts are never removed.
+ */
+std::optional<std::span<const u8>> find_in_mounted_iso(const fs::path& path) {
+  std::lock_guard<std::mutex> lock(g_iso_mounts_mutex);
+  if (g_iso_mounts.empty()) {
+    return std::nullopt;
+  }
+  auto normal_path = fs::absolute(path).lexically_normal();
+  for (const auto& mount : g_iso_mounts) {
+    auto relative = normal_path.lexically_relative(mount.mount_point);
+    if (relative.empty() || *relative.begin() == "..") {
+      continue;
+    }
+    if (const auto* entry = mount.iso->find(relative.generic_string())) {
+      return mount.iso->data(*entry);
+    }
+  }
+  return std::nullopt;
+}
+
 std::vector<uint8_t> read_binary_file(const fs::path& path) {
   // make sure file exists and isn't a directory
 
   auto status = fs::status(path);
 
   if (!fs::exists(status)) {
+    if (auto mounted = find_in_mounted_iso(path)) {
+      return std::vector<uint8_t>(mounted->begin(), mounted->end());
+    }
     throw std::runtime_error(
         fmt::format("File {} cannot be opened: does not exist.", path.string()));
   }
@@ -689,6 +734,50 @@ std::vector<u8> decompress_dgo(const std::vector<u8>& data_in) {
   return decompressed_data;
 }
 
+/*!
+ * Is this a DGO with zstd compressed objects, from build_dgo? These are different from the original
+ * game's compressed DGOs, which are compressed as a whole.
+ */
+bool dgo_is_zstd_compressed(const std::vector<u8>& data) {
+  u32 object_count = 0;
+  if (data.size() >= sizeof(DgoHeader)) {
+    memcpy(&object_count, data.data(), sizeof(u32));
+  }
+  return object_count & DGO_ZSTD_FLAG;
+}
+
+/*!
+ * Decompress a DGO with zstd compressed objects to a normal DGO.
+ */
+std::vector<u8> decompress_zstd_dgo(const std::vector<u8>& data_in) {
+  BinaryReader reader(data_in);
+  auto header = reader.read<DgoHeader>();
+  ASSERT(header.object_count & DGO_ZSTD_FLAG);
+  header.object_count &= ~DGO_ZSTD_FLAG;
+  std::vector<u8> result(sizeof(DgoHeader));
+  memcpy(result.data(), &header, sizeof(DgoHeader));
+
+  for (u32 i = 0; i < header.object_count; i++) {
+    while (reader.get_seek() & 0xf) {
+      reader.ffwd(1);
+    }
+    auto obj_header = reader.read<ObjectHeader>();
+    u32 compressed_size = reader.read<u32>();
+    ASSERT(reader.bytes_left() >= compressed_size);
+
+    size_t obj_start = result.size();
+    result.resize(obj_start + sizeof(ObjectHeader) + obj_header.size);
+    memcpy(result.data() + obj_start, &obj_header, sizeof(ObjectHeader));
+    compression::decompress_zstd_no_header(reader.here(), compressed_size,
+                                           result.data() + obj_start + sizeof(ObjectHeader),
+                                           obj_header.size);
+    reader.ffwd(compressed_size);
+    result.resize((result.size() + 0xf) & ~0xf);
+  }
+
+  return result;
+}
+
 FILE* open_file(const fs::path& path, const std::string& mode) {
 #ifdef _WIN32
   return _wfopen(path.wstring().c_str(), std::wstring(mode.begin(), mode.end()).c_str());
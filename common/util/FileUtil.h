@@ -16,8 +16,10 @@
 #undef FALSE
 #endif
 
+#include <memory>
 #include <optional>
 #include <regex>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -26,6 +28,8 @@
 
 namespace fs = ghc::filesystem;
 
+class IsoVfs;
+
 namespace file_util {
 fs::path get_user_home_dir();
 fs::path get_user_config_dir();
@@ -54,6 +58,9 @@ void write_text_file(const std::string& file_name, const std::string& text);
 void write_text_file(const fs::path& file_name, const std::string& text);
 std::vector<uint8_t> read_binary_file(const std::string& filename);
 std::vector<uint8_t> read_binary_file(const fs::path& filename);
+/// Files under mount_point that don't exist on disk are read out of the ISO instead
+void mount_iso(const fs::path& mount_point, std::shared_ptr<const IsoVfs> iso);
+std::optional<std::span<const u8>> find_in_mounted_iso(const fs::path& path);
 std::string read_text_file(const std::string& path);
 std::string read_text_file(const fs::path& path);
 bool is_printable_char(char c);
@@ -68,6 +75,8 @@ void ISONameFromAnimationName(char* dst, const char* src);
 void assert_file_exists(const char* path, const char* error_message);
 bool dgo_header_is_compressed(const std::vector<u8>& data);
 std::vector<u8> decompress_dgo(const std::vector<u8>& data_in);
+bool dgo_is_zstd_compressed(const std::vector<u8>& data);
+std::vector<u8> decompress_zstd_dgo(const std::vector<u8>& data_in);
 FILE* open_file(const fs::path& path, const std::string& mode);
 std::vector<fs::path> find_files_in_dir(const fs::path& dir, const std::regex& pattern);
 std::vector<fs::path> find_files_recursively(const fs::path& base_dir, const std::regex& pattern);
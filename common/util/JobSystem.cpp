@@ -0,0 +1,208 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "common/global_profiler/GlobalProfiler.h"
+#include "common/util/Assert.h"
+
+namespace {
+// set on worker threads, so the tasks they start go on their own queue.
+thread_local JobSystem* t_worker_jobs = nullptr;
+thread_local int t_worker_idx = -1;
+}  // namespace
+
+TaskGroup::TaskGroup(const char* name, JobSystem* jobs)
+    : m_jobs(jobs ? *jobs : JobSystem::global()), m_name(name) {}
+
+TaskGroup::~TaskGroup() {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+  m_pending++;
+  m_jobs.push({std::move(task), this});
+}
+
+/*!
+ * Run queued tasks until all tasks in this group are done, then rethrow the first exception from
+ * one of them, if any.
+ */
+void TaskGroup::wait() {
+  while (m_pending > 0) {
+    if (!m_jobs.try_run_one()) {
+      // our remaining tasks are running on other threads. Check for new work occasionally, in
+      // case they start more tasks.
+      std::unique_lock<std::mutex> lock(m_lock);
+      m_done.wait_for(lock, std::chrono::milliseconds(1), [&]() { return m_pending == 0; });
+    }
+  }
+
+  // the last task holds the lock until it's done with the group.
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::swap(error, m_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void TaskGroup::finish_task(std::exception_ptr error) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if (error && !m_error) {
+    m_error = error;
+  }
+  if (--m_pending == 0) {
+    m_done.notify_all();
+  }
+}
+
+JobSystem::JobSystem(int num_workers) {
+  if (num_workers <= 0) {
+    num_workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < num_workers; i++) {
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (int i = 0; i < num_workers; i++) {
+    m_workers.emplace_back([this, i]() { worker_loop(i); });
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(m_sleep_lock);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+/*!
+ * The shared pool, with one worker per hardware thread.
+ */
+JobSystem& JobSystem::global() {
+  static JobSystem jobs;
+  return jobs;
+}
+
+void JobSystem::push(Task&& task) {
+  size_t queue_idx = t_worker_jobs == this ? t_worker_idx : m_next_queue++ % m_queues.size();
+  {
+    std::lock_guard<std::mutex> lock(m_queues[queue_idx]->lock);
+    m_queues[queue_idx]->tasks.push_back(std::move(task));
+  }
+  m_num_queued++;
+  {
+    std::lock_guard<std::mutex> lock(m_sleep_lock);
+  }
+  m_wake.notify_one();
+}
+
+/*!
+ * Run one queued task: the newest one from our own queue if we're a worker, otherwise the oldest
+ * one from another queue. Returns false if there was nothing to run.
+ */
+bool JobSystem::try_run_one() {
+  const int self = t_worker_jobs == this ? t_worker_idx : -1;
+  const int num_queues = m_queues.size();
+  Task task;
+  bool found = false;
+
+  if (self >= 0) {
+    auto& queue = *m_queues[self];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      found = true;
+    }
+  }
+
+  for (int i = 1; i <= num_queues && !found; i++) {
+    auto& queue = *m_queues[(std::max(self, 0) + i) % num_queues];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      found = true;
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+  m_num_queued--;
+
+  const bool profile = task.group->m_name && prof().is_enabled();
+  if (profile) {
+    prof().begin_event(task.group->m_name);
+  }
+  std::exception_ptr error;
+  try {
+    task.func();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (profile) {
+    prof().end_event();
+  }
+  task.group->finish_task(error);
+  return true;
+}
+
+void JobSystem::worker_loop(int worker_idx) {
+  t_worker_jobs = this;
+  t_worker_idx = worker_idx;
+  while (true) {
+    if (try_run_one()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(m_sleep_lock);
+    m_wake.wait(lock, [&]() { return m_stopping || m_num_queued > 0; });
+    if (m_stopping && m_num_queued == 0) {
+      return;
+    }
+  }
+}
+
+/*!
+ * Run func(i) for i in [0, count). Indices are handed out in small chunks as threads become free,
+ * so it's fine if some take much longer than others. At most max_parallel run at once (0 for no
+ * limit). The calling thread helps, and the first exception is rethrown.
+ */
+void JobSystem::parallel_for(const char* name,
+                             size_t count,
+                             const std::function<void(size_t)>& func,
+                             int max_parallel) {
+  size_t num_tasks = max_parallel > 0 ? max_parallel : num_workers();
+  num_tasks = std::min(num_tasks, count);
+  if (num_tasks <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      func(i);
+    }
+    return;
+  }
+
+  const size_t chunk_size = std::max<size_t>(1, count / (num_tasks * 8));
+  std::atomic<size_t> next = 0;
+  TaskGroup group(name, this);
+  for (size_t t = 0; t < num_tasks; t++) {
+    group.run([&]() {
+      for (size_t start = next.fetch_add(chunk_size); start < count;
+           start = next.fetch_add(chunk_size)) {
+        for (size_t i = start; i < std::min(start + chunk_size, count); i++) {
+          func(i);
+        }
+      }
+    });
+  }
+  group.wait();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+/*!
+ * @file JobSystem.h
+ * A pool of persistent worker threads for running many small tasks.
+ *
+ * Each worker has its own queue. Workers run their newest task first, and steal the oldest task
+ * from another worker when they run out, so uneven work spreads out across all the threads.
+ * Waiting on a TaskGroup runs queued tasks instead of blocking, so tasks can start and wait on
+ * their own groups.
+ *
+ * When the GlobalProfiler is enabled, each task is recorded as an event with its group's name.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+/*!
+ * A set of tasks that can be waited on together. If a task throws, the remaining tasks still run,
+ * and the first exception is rethrown by wait.
+ *
+ * The group must outlive its tasks: the destructor waits for them, but won't rethrow.
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(const char* name = nullptr, JobSystem* jobs = nullptr);
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  ~TaskGroup();
+
+  void run(std::function<void()> task);
+  void wait();
+
+ private:
+  friend class JobSystem;
+  void finish_task(std::exception_ptr error);
+
+  JobSystem& m_jobs;
+  const char* m_name = nullptr;
+  std::atomic<int> m_pending = 0;
+  std::mutex m_lock;
+  std::condition_variable m_done;
+  std::exception_ptr m_error;
+};
+
+class JobSystem {
+ public:
+  // 0 workers means one per hardware thread.
+  explicit JobSystem(int num_workers = 0);
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  ~JobSystem();
+
+  static JobSystem& global();
+  int num_workers() const { return m_workers.size(); }
+
+  void parallel_for(const char* name,
+                    size_t count,
+                    const std::function<void(size_t)>& func,
+                    int max_parallel = 0);
+
+ private:
+  friend class TaskGroup;
+  struct Task {
+    std::function<void()> func;
+    TaskGroup* group = nullptr;
+  };
+
+  struct WorkerQueue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  void push(Task&& task);
+  bool try_run_one();
+  void worker_loop(int worker_idx);
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::atomic<int> m_num_queued = 0;
+  std::atomic<size_t> m_next_queue = 0;
+  std::mutex m_sleep_lock;
+  std::condition_variable m_wake;
+  bool m_stopping = false;
+};
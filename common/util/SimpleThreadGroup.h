@@ -15,6 +15,10 @@
  *   can cause confusing issues where resources used by threads are destroyed before the threads
  *   are joined, if you aren't careful about the order you declare variables.
  * - the function is copied (once)
+ *
+ * Work is split into equal ranges up front. For many tasks of uneven size, use the JobSystem
+ * instead. This is still the right tool for a few threads that block for a long time, like the
+ * consumers of a queue.
  */
 class SimpleThreadGroup {
  public:
@@ -47,11 +47,11 @@ std::vector<u8> decompress_zstd(const void* data, size_t size) {
   return result;
 }
 
-std::vector<u8> compress_zstd_no_header(const void* data, size_t size) {
+std::vector<u8> compress_zstd_no_header(const void* data, size_t size, int level) {
   size_t max_compressed = ZSTD_compressBound(size);
   std::vector<u8> result(max_compressed);
 
-  size_t compressed_size = ZSTD_compress(result.data(), max_compressed, data, size, 1);
+  size_t compressed_size = ZSTD_compress(result.data(), max_compressed, data, size, level);
   if (ZSTD_isError(compressed_size)) {
     ASSERT_MSG(false, fmt::format("ZSTD error: {}", ZSTD_getErrorName(compressed_size)));
   }
@@ -59,4 +59,15 @@ std::vector<u8> compress_zstd_no_header(const void* data, size_t size) {
   result.resize(compressed_size);
   return result;
 }
+
+/*!
+ * Decompress a single zstd frame to out, which must be exactly the size of the decompressed data.
+ */
+void decompress_zstd_no_header(const void* data, size_t size, void* out, size_t out_size) {
+  auto decomp_size = ZSTD_decompress(out, out_size, data, size);
+  if (ZSTD_isError(decomp_size)) {
+    ASSERT_MSG(false, fmt::format("ZSTD error: {}", ZSTD_getErrorName(decomp_size)));
+  }
+  ASSERT(decomp_size == out_size);
+}
 }  // namespace compression
@@ -8,5 +8,6 @@ namespace compression {
 // compress and decompress data with zstd
 std::vector<u8> compress_zstd(const void* data, size_t size);
 std::vector<u8> decompress_zstd(const void* data, size_t size);
-std::vector<u8> compress_zstd_no_header(const void* data, size_t size);
+std::vector<u8> compress_zstd_no_header(const void* data, size_t size, int level = 1);
+void decompress_zstd_no_header(const void* data, size_t size, void* out, size_t out_size);
 }  // namespace compression
@@ -0,0 +1,191 @@
+#include "iso_vfs.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+
+#ifdef OS_POSIX
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif _WIN32
+#include <io.h>
+
+#include "third-party/mman/mman.h"
+#endif
+
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/string_util.h"
+
+#include "fmt/core.h"
+#include "third-party/zstd/lib/common/xxhash.h"
+
+namespace {
+constexpr u64 SECTOR_SIZE = 0x800;
+// the discs are only a few levels deep, this is just to stop a corrupted image from looping.
+constexpr int MAX_DIRECTORY_DEPTH = 16;
+
+std::string normalize_path(const std::string& path) {
+  std::string result = str_util::to_upper(path);
+  for (auto& c : result) {
+    if (c == '\\') {
+      c = '/';
+    }
+  }
+  size_t start = 0;
+  while (start < result.size() && result[start] == '/') {
+    start++;
+  }
+  return result.substr(start);
+}
+}  // namespace
+
+IsoVfs::IsoVfs(const fs::path& iso_path) : m_image_path(iso_path) {
+  m_size = fs::file_size(iso_path);
+  if (m_size < 0x11 * SECTOR_SIZE) {
+    throw std::runtime_error(
+        fmt::format("{} is too small to be an ISO ({} bytes)", iso_path.string(), m_size));
+  }
+#ifdef _WIN32
+  m_fd = _wopen(iso_path.wstring().c_str(), _O_RDONLY | _O_BINARY);
+#else
+  m_fd = open(iso_path.string().c_str(), O_RDONLY);
+#endif
+  if (m_fd < 0) {
+    throw std::runtime_error(
+        fmt::format("Failed to open {}: {}", iso_path.string(), strerror(errno)));
+  }
+  void* mem = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+  if (mem == MAP_FAILED) {
+#ifdef _WIN32
+    _close(m_fd);
+#else
+    close(m_fd);
+#endif
+    throw std::runtime_error(fmt::format("Failed to map {}", iso_path.string()));
+  }
+  m_mapping = mem;
+  m_data = (const u8*)mem;
+
+  // same walk as find_files_in_iso: the first entry of the path table is the root directory.
+  u32 path_table_sector = read_at<u32>(0x10 * SECTOR_SIZE + 0x8c);
+  u32 root_extent = read_at<u32>(path_table_sector * SECTOR_SIZE + 2);
+  u32 root_size = read_at<u32>(root_extent * SECTOR_SIZE + 10);
+  index_directory(root_extent, root_size, "", 0);
+}
+
+IsoVfs::~IsoVfs() {
+  munmap(m_mapping, m_size);
+#ifdef _WIN32
+  _close(m_fd);
+#else
+  close(m_fd);
+#endif
+}
+
+template <typename T>
+T IsoVfs::read_at(u64 offset) const {
+  if (offset + sizeof(T) > m_size) {
+    throw std::runtime_error(fmt::format("{} is corrupted: read at 0x{:x} is past the end",
+                                         m_image_path.string(), offset));
+  }
+  T result;
+  memcpy(&result, m_data + offset, sizeof(T));
+  return result;
+}
+
+void IsoVfs::index_directory(u32 sector, u32 size, const std::string& prefix, int depth) {
+  if (depth > MAX_DIRECTORY_DEPTH) {
+    throw std::runtime_error(
+        fmt::format("{} is corrupted: directories are nested too deep", m_image_path.string()));
+  }
+  const u64 base = u64(sector) * SECTOR_SIZE;
+  u32 offset = 0;
+  while (offset < size) {
+    u8 record_size = read_at<u8>(base + offset);
+    if (!record_size) {
+      // records don't cross sectors, the rest of this one is padding.
+      offset = (offset & ~(SECTOR_SIZE - 1)) + SECTOR_SIZE;
+      continue;
+    }
+    u8 kind = read_at<u8>(base + offset + 0x21);
+    // 0 and 1 are the "." and ".." entries
+    if (kind != 0 && kind != 1) {
+      u32 extent = read_at<u32>(base + offset + 2);
+      u32 data_size = read_at<u32>(base + offset + 10);
+      u32 name_len = read_at<u8>(base + offset + 32);
+      if (base + offset + 0x21 + name_len > m_size) {
+        throw std::runtime_error(fmt::format("{} is corrupted: bad name at 0x{:x}",
+                                             m_image_path.string(), base + offset));
+      }
+      std::string name((const char*)m_data + base + offset + 0x21, name_len);
+      bool is_file = name_len >= 2 && name[name_len - 2] == ';' && name[name_len - 1] == '1';
+      if (is_file) {
+        name.resize(name_len - 2);
+        if (u64(extent) * SECTOR_SIZE + data_size > m_size) {
+          throw std::runtime_error(fmt::format("{} is truncated: {}{} ends past the end",
+                                               m_image_path.string(), prefix, name));
+        }
+        auto& entry = m_entries.emplace_back();
+        entry.path = str_util::to_upper(prefix + name);
+        entry.offset = u64(extent) * SECTOR_SIZE;
+        entry.size = data_size;
+        m_by_path.emplace(entry.path, m_entries.size() - 1);
+      } else {
+        index_directory(extent, data_size, prefix + name + "/", depth + 1);
+      }
+    }
+    offset += record_size;
+  }
+}
+
+const IsoVfs::Entry* IsoVfs::find(const std::string& path) const {
+  auto it = m_by_path.find(normalize_path(path));
+  if (it == m_by_path.end()) {
+    return nullptr;
+  }
+  return &m_entries.at(it->second);
+}
+
+std::span<const u8> IsoVfs::data(const Entry& entry) const {
+  return std::span<const u8>(m_data + entry.offset, entry.size);
+}
+
+std::vector<u8> IsoVfs::read(const Entry& entry) const {
+  auto span = data(entry);
+  return std::vector<u8>(span.begin(), span.end());
+}
+
+/*!
+ * Read up to size bytes, starting at offset into the file. Returns the number of bytes read, which
+ * is short at the end of the file.
+ */
+size_t IsoVfs::read(const Entry& entry, u64 offset, void* dst, size_t size) const {
+  if (offset >= entry.size) {
+    return 0;
+  }
+  size_t len = std::min<u64>(size, entry.size - offset);
+  memcpy(dst, m_data + entry.offset + offset, len);
+  return len;
+}
+
+/*!
+ * XXH64 of the file's data, matching the hashes the extractor computes when unpacking.
+ */
+u64 IsoVfs::hash(const Entry& entry) const {
+  return XXH64(m_data + entry.offset, entry.size, 0);
+}
+
+/*!
+ * The same (hash, file count) that calculate_extraction_hash gives for an extraction of this
+ * image, so an image can be checked against the extractor's database without unpacking it.
+ */
+std::tuple<u64, int> IsoVfs::contents_hash() const {
+  u64 combined_hash = 0;
+  for (const auto& entry : m_entries) {
+    combined_hash ^= hash(entry);
+  }
+  return {XXH64(&combined_hash, sizeof(u64), 0), (int)m_entries.size()};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/*!
+ * @file iso_vfs.h
+ * Read-only access to the files of an ISO9660 disc image, without extracting it.
+ *
+ * The image is memory mapped and the directory tree is indexed once when it is opened. Reads are
+ * served straight out of the mapping, so looking up and reading a file never touches the
+ * filesystem again. This is the same layout that read_iso_file.h unpacks to iso_data/.
+ */
+
+#include <span>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/util/FileUtil.h"
+
+class IsoVfs {
+ public:
+  struct Entry {
+    std::string path;  // upper case, relative to the root of the disc, ie. "DGO/GAME.CGO"
+    u64 offset = 0;    // byte offset of the data in the image
+    u64 size = 0;
+  };
+
+  explicit IsoVfs(const fs::path& iso_path);
+  ~IsoVfs();
+  IsoVfs(const IsoVfs&) = delete;
+  IsoVfs& operator=(const IsoVfs&) = delete;
+
+  const fs::path& image_path() const { return m_image_path; }
+  const std::vector<Entry>& entries() const { return m_entries; }
+
+  // find by path relative to the root of the disc. Not case sensitive, accepts either slash.
+  const Entry* find(const std::string& path) const;
+
+  std::span<const u8> data(const Entry& entry) const;
+  std::vector<u8> read(const Entry& entry) const;
+  size_t read(const Entry& entry, u64 offset, void* dst, size_t size) const;
+
+  u64 hash(const Entry& entry) const;
+  std::tuple<u64, int> contents_hash() const;
+
+ private:
+  void index_directory(u32 sector, u32 size, const std::string& prefix, int depth);
+  template <typename T>
+  T read_at(u64 offset) const;
+
+  fs::path m_image_path;
+  void* m_mapping = nullptr;
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+  int m_fd = -1;
+
+  std::vector<Entry> m_entries;
+  std::unordered_map<std::string, size_t> m_by_path;
+};
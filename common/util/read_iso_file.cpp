@@ -1,10 +1,20 @@
 #include "read_iso_file.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 #include "common/common_types.h"
 #include "common/log/log.h"
 #include "common/util/Assert.h"
 #include "common/util/FileUtil.h"
+#include "common/util/SimpleThreadGroup.h"
 
+#include "fmt/core.h"
 #include "third-party/zstd/lib/common/xxhash.h"
 
 IsoFile::IsoFile() {
@@ -87,36 +97,83 @@ void add_from_dir(FILE* fp, u32 sector, u32 size, IsoFile::Entry* parent) {
   }
 }
 
-void unpack_entry(FILE* fp,
-                  IsoFile& iso,
-                  const IsoFile::Entry& entry,
-                  const fs::path& dest,
-                  bool print_progress) {
+/*!
+ * Create the directories for entry and list the files inside it, in the order they were listed on
+ * the disc.
+ */
+void collect_files(const IsoFile::Entry& entry,
+                   const fs::path& dest,
+                   std::vector<std::pair<const IsoFile::Entry*, fs::path>>* out) {
   fs::path path_to_entry = dest / entry.name;
   if (entry.is_dir) {
     fs::create_directory(path_to_entry);
     for (const auto& child : entry.children) {
-      unpack_entry(fp, iso, child, path_to_entry, print_progress);
+      collect_files(child, path_to_entry, out);
     }
   } else {
-    if (print_progress) {
-      lg::info("Extracting {}...", entry.name);
-    }
-    std::vector<u8> buffer(entry.size);
-    if (fseek_64(fp, entry.offset_in_file, SEEK_SET)) {
-      ASSERT_MSG(false, "Failed to fseek iso when unpacking");
-    }
-    if (fread(buffer.data(), buffer.size(), 1, fp) != 1) {
-      ASSERT_MSG(false, "Failed to fread iso when unpacking");
-    }
-    file_util::write_binary_file(path_to_entry.string(), buffer.data(), buffer.size());
-    iso.files_extracted++;
-    if (iso.shouldHash) {
-      auto hash = XXH64(buffer.data(), buffer.size(), 0);
-      iso.hashes.push_back(hash);
-    }
+    out->emplace_back(&entry, path_to_entry);
   }
 }
+
+// files are read in pieces of at most this size, and at most this much data is waiting to be
+// written at once.
+constexpr size_t EXTRACT_CHUNK_SIZE = 8 * 1024 * 1024;
+constexpr size_t EXTRACT_MAX_BYTES_IN_FLIGHT = 16 * EXTRACT_CHUNK_SIZE;
+
+struct ExtractChunk {
+  size_t file_idx = 0;
+  std::vector<u8> data;
+  bool first = false;
+  bool last = false;
+};
+
+/*!
+ * Chunks that have been read, but not written. The reader blocks once too much is waiting.
+ */
+class ExtractQueue {
+ public:
+  void push(ExtractChunk&& chunk) {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cv.wait(lk, [&] { return m_bytes == 0 || m_bytes + chunk.data.size() <= m_max_bytes; });
+    m_bytes += chunk.data.size();
+    m_chunks.push_back(std::move(chunk));
+    m_cv.notify_all();
+  }
+
+  std::optional<ExtractChunk> pop() {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cv.wait(lk, [&] { return !m_chunks.empty() || m_done; });
+    if (m_chunks.empty()) {
+      return std::nullopt;
+    }
+    auto result = std::move(m_chunks.front());
+    m_chunks.pop_front();
+    return result;
+  }
+
+  // call once the chunk from pop has been written
+  void release(size_t size) {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_bytes -= size;
+    m_cv.notify_all();
+  }
+
+  void finish() {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_done = true;
+    m_cv.notify_all();
+  }
+
+  explicit ExtractQueue(size_t max_bytes) : m_max_bytes(max_bytes) {}
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<ExtractChunk> m_chunks;
+  size_t m_bytes = 0;
+  size_t m_max_bytes = 0;
+  bool m_done = false;
+};
 }  // namespace
 
 IsoFile find_files_in_iso(FILE* fp) {
@@ -128,8 +185,99 @@ IsoFile find_files_in_iso(FILE* fp) {
   return result;
 }
 
+/*!
+ * Extract all files in layout to dest.
+ * The calling thread does large sequential reads of the ISO and workers write and hash the files.
+ * A file is always handled by the same worker, so its chunks are written and hashed in order.
+ */
 void unpack_iso_files(FILE* fp, IsoFile& layout, const fs::path& dest, bool print_progress) {
-  unpack_entry(fp, layout, layout.root, dest, print_progress);
+  std::vector<std::pair<const IsoFile::Entry*, fs::path>> files;
+  collect_files(layout.root, dest, &files);
+
+  const int num_workers = std::clamp((int)std::thread::hardware_concurrency(), 2, 8);
+  std::vector<std::unique_ptr<ExtractQueue>> queues;
+  for (int i = 0; i < num_workers; i++) {
+    queues.push_back(std::make_unique<ExtractQueue>(EXTRACT_MAX_BYTES_IN_FLIGHT / num_workers));
+  }
+  std::vector<u64> hashes(files.size());
+
+  SimpleThreadGroup workers;
+  workers.run(
+      [&](int worker_idx) {
+        auto& queue = *queues.at(worker_idx);
+        FILE* out = nullptr;
+        XXH64_state_t* hash_state = XXH64_createState();
+        while (auto chunk = queue.pop()) {
+          const auto& path = files.at(chunk->file_idx).second;
+          if (chunk->first) {
+            out = file_util::open_file(path, "wb");
+            ASSERT_MSG(out, fmt::format("Failed to open {} when unpacking", path.string()));
+            XXH64_reset(hash_state, 0);
+          }
+          if (!chunk->data.empty()) {
+            if (fwrite(chunk->data.data(), chunk->data.size(), 1, out) != 1) {
+              ASSERT_MSG(false, fmt::format("Failed to write {} when unpacking", path.string()));
+            }
+            if (layout.shouldHash) {
+              XXH64_update(hash_state, chunk->data.data(), chunk->data.size());
+            }
+          }
+          if (chunk->last) {
+            fclose(out);
+            out = nullptr;
+            hashes.at(chunk->file_idx) = XXH64_digest(hash_state);
+          }
+          queue.release(chunk->data.size());
+        }
+        XXH64_freeState(hash_state);
+      },
+      num_workers, num_workers);
+
+  // read in disc order, the files are usually laid out in a different order than the directories.
+  std::vector<size_t> read_order(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    read_order[i] = i;
+  }
+  std::stable_sort(read_order.begin(), read_order.end(), [&](size_t a, size_t b) {
+    return files[a].first->offset_in_file < files[b].first->offset_in_file;
+  });
+
+  u64 position = UINT64_MAX;
+  for (size_t file_idx : read_order) {
+    const auto& entry = *files[file_idx].first;
+    if (print_progress) {
+      lg::info("Extracting {}...", entry.name);
+    }
+    if (position != entry.offset_in_file) {
+      if (fseek_64(fp, entry.offset_in_file, SEEK_SET)) {
+        ASSERT_MSG(false, "Failed to fseek iso when unpacking");
+      }
+    }
+    size_t done = 0;
+    do {
+      ExtractChunk chunk;
+      chunk.file_idx = file_idx;
+      chunk.data.resize(std::min(EXTRACT_CHUNK_SIZE, entry.size - done));
+      if (!chunk.data.empty() && fread(chunk.data.data(), chunk.data.size(), 1, fp) != 1) {
+        ASSERT_MSG(false, "Failed to fread iso when unpacking");
+      }
+      chunk.first = done == 0;
+      done += chunk.data.size();
+      chunk.last = done == entry.size;
+      queues.at(file_idx % num_workers)->push(std::move(chunk));
+    } while (done < entry.size);
+    position = entry.offset_in_file + entry.size;
+  }
+
+  for (auto& queue : queues) {
+    queue->finish();
+  }
+  workers.join();
+
+  layout.files_extracted += files.size();
+  if (layout.shouldHash) {
+    layout.hashes.insert(layout.hashes.end(), hashes.begin(), hashes.end());
+  }
 }
 
 IsoFile unpack_iso_files(FILE* fp,
@@ -0,0 +1,484 @@
+#include "IR2Cache.h"
+
+#include <algorithm>
+
+#include "common/log/log.h"
+#include "common/util/fnv.h"
+
+#include "decompiler/ObjectFile/ObjectFileDB.h"
+#include "decompiler/config.h"
+
+#include "fmt/core.h"
+#include "fmt/format.h"
+#include "third-party/json.hpp"
+
+namespace decompiler {
+
+namespace {
+// bump this when the format of the cache files or the key changes.
+constexpr int IR2_CACHE_VERSION = 1;
+
+template <typename Map>
+std::vector<typename Map::key_type> sorted_keys(const Map& map) {
+  std::vector<typename Map::key_type> result;
+  result.reserve(map.size());
+  for (const auto& [k, v] : map) {
+    result.push_back(k);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+template <typename Set>
+std::vector<typename Set::key_type> sorted_set(const Set& set) {
+  std::vector<typename Set::key_type> result(set.begin(), set.end());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+template <typename Inner>
+void add_string_int_map(std::string& out, const std::unordered_map<int, Inner>& map) {
+  for (auto k : sorted_keys(map)) {
+    out += fmt::format("{}={},", k, map.at(k));
+  }
+}
+
+void add_typespec_names(const TypeSpec& ts, std::vector<std::string>* out) {
+  if (ts.base_type().empty()) {
+    return;
+  }
+  out->push_back(ts.base_type());
+  for (size_t i = 0; i < ts.arg_count(); i++) {
+    add_typespec_names(ts.get_arg(i), out);
+  }
+}
+
+/*!
+ * Split output text into the words that might name a type or symbol.
+ */
+std::vector<std::string> find_tokens(const std::string& text) {
+  std::unordered_set<std::string> tokens;
+  auto is_separator = [](char c) {
+    return std::isspace((unsigned char)c) || c == '(' || c == ')' || c == '\'' || c == '"' ||
+           c == '`' || c == ',' || c == ';';
+  };
+
+  size_t i = 0;
+  while (i < text.size()) {
+    while (i < text.size() && is_separator(text[i])) {
+      i++;
+    }
+    size_t start = i;
+    while (i < text.size() && !is_separator(text[i])) {
+      i++;
+    }
+    if (i > start && !std::isdigit((unsigned char)text[start])) {
+      tokens.insert(text.substr(start, i - start));
+    }
+  }
+  return sorted_set(tokens);
+}
+
+std::string hex_hash(const std::string& str) {
+  return fmt::format("{:016x}", fnv64(str));
+}
+}  // namespace
+
+IR2Cache::IR2Cache(const fs::path& cache_dir,
+                   const Config& config,
+                   const DecompilerTypeSystem& dts)
+    : m_cache_dir(cache_dir), m_dts(dts) {
+  file_util::create_dir_if_needed(m_cache_dir);
+
+  // things that can change the output of any object.
+  std::string key = fmt::format("v{} {} {} fmt{} ivn{} cfg{}\n", IR2_CACHE_VERSION,
+                                (int)config.game_version, config.all_types_file, config.format_code,
+                                config.ignore_var_name_casts, config.print_cfgs);
+
+  // a rebuilt decompiler may produce different output.
+  auto exe_path = fs::path(file_util::get_current_executable_path());
+  std::error_code ec;
+  auto exe_size = fs::file_size(exe_path, ec);
+  auto exe_time = fs::last_write_time(exe_path, ec).time_since_epoch().count();
+  key += fmt::format("exe {} {}\n", exe_size, exe_time);
+
+  for (const auto& ag : sorted_keys(dts.art_group_info)) {
+    key += ag + ":";
+    add_string_int_map(key, dts.art_group_info.at(ag));
+  }
+  key += "\n";
+  for (const auto& jg : sorted_keys(dts.jg_info)) {
+    key += jg + ":";
+    add_string_int_map(key, dts.jg_info.at(jg));
+  }
+  key += "\n";
+  for (auto id : sorted_keys(dts.textures)) {
+    const auto& tex = dts.textures.at(id);
+    key += fmt::format("{}={} {} {},", id, tex.name, tex.tpage_name, tex.idx);
+  }
+  key += "\n";
+  for (const auto& str : sorted_keys(dts.bad_format_strings)) {
+    key += fmt::format("{}={},", str, dts.bad_format_strings.at(str));
+  }
+  key += "\n";
+  for (const auto& func : sorted_keys(dts.format_ops_with_dynamic_string_by_func_name)) {
+    key += func + "=";
+    for (const auto& ops : dts.format_ops_with_dynamic_string_by_func_name.at(func)) {
+      key += fmt::format("{} ", fmt::join(ops, " "));
+    }
+    key += ",";
+  }
+  key += "\n";
+  for (const auto& x : sorted_keys(config.art_group_type_remap)) {
+    key += fmt::format("{}={},", x, config.art_group_type_remap.at(x));
+  }
+  for (const auto& x : sorted_keys(config.art_group_file_override)) {
+    for (const auto& y : sorted_keys(config.art_group_file_override.at(x))) {
+      key += fmt::format("{}:{}={},", x, y, config.art_group_file_override.at(x).at(y));
+    }
+  }
+  for (const auto& x : sorted_keys(config.joint_node_hacks)) {
+    key += fmt::format("{}={},", x, config.joint_node_hacks.at(x));
+  }
+  for (const auto& x : sorted_keys(config.process_stack_size_overrides)) {
+    key += fmt::format("{}={},", x, config.process_stack_size_overrides.at(x));
+  }
+  key += fmt::format("\n{}\n", fmt::join(sorted_set(config.hacks.types_with_bad_inspect_methods),
+                                         " "));
+  m_global_key = hex_hash(key);
+}
+
+/*!
+ * Compute the part of the cache key that doesn't depend on the output: the object itself and the
+ * config for it. Must be called after the top level pass and before the IR2 passes.
+ */
+std::string IR2Cache::compute_key(const ObjectFileData& data,
+                                  const Config& config,
+                                  const std::vector<std::string>& imports) const {
+  const auto& name = data.to_unique_name();
+  std::string key = fmt::format("{} {} {} {:016x}\n", m_global_key, name, data.data.size(),
+                                fnv64(data.data.data(), data.data.size()));
+  key += fmt::format("imports {}\n", fmt::join(imports, " "));
+
+  auto labels_it = config.label_types.find(name);
+  if (labels_it != config.label_types.end()) {
+    for (const auto& label : sorted_keys(labels_it->second)) {
+      const auto& info = labels_it->second.at(label);
+      key += fmt::format("label {} {} {} {}\n", label, info.is_value, info.type_name,
+                         info.array_size.value_or(-1));
+    }
+  }
+
+  auto anon_it = config.anon_function_types_by_obj_by_id.find(name);
+  if (anon_it != config.anon_function_types_by_obj_by_id.end()) {
+    key += "anon ";
+    add_string_int_map(key, anon_it->second);
+    key += "\n";
+  }
+
+  const auto& hacks = config.hacks;
+  for (const auto& seg_functions : data.linked_data.functions_by_seg) {
+    for (const auto& func : seg_functions) {
+      const auto& fname = func.name();
+      key += fmt::format("func {} {} {} {}\n", fname, func.type.print(), func.suspected_asm,
+                         func.warnings.get_warning_text(false));
+      key += fmt::format("flags {} {} {} {} {} {}\n",
+                         hacks.no_type_analysis_functions_by_name.count(fname),
+                         hacks.hint_inline_assembly_functions.count(fname),
+                         hacks.asm_functions_by_name.count(fname),
+                         hacks.pair_functions_by_name.count(fname),
+                         hacks.reject_cond_to_value.count(fname),
+                         hacks.mips2c_functions_by_name.count(fname));
+
+      auto reg_casts = config.register_type_casts_by_function_by_atomic_op_idx.find(fname);
+      if (reg_casts != config.register_type_casts_by_function_by_atomic_op_idx.end()) {
+        for (auto idx : sorted_keys(reg_casts->second)) {
+          for (const auto& cast : reg_casts->second.at(idx)) {
+            key += fmt::format("rc {} {} {},", cast.atomic_op_idx, cast.reg.to_string(),
+                               cast.type_name);
+          }
+        }
+        key += "\n";
+      }
+
+      auto stack_casts = config.stack_type_casts_by_function_by_stack_offset.find(fname);
+      if (stack_casts != config.stack_type_casts_by_function_by_stack_offset.end()) {
+        for (auto offset : sorted_keys(stack_casts->second)) {
+          const auto& cast = stack_casts->second.at(offset);
+          key += fmt::format("sc {} {},", cast.stack_offset, cast.type_name);
+        }
+        key += "\n";
+      }
+
+      auto arg_names = config.function_arg_names.find(fname);
+      if (arg_names != config.function_arg_names.end()) {
+        key += fmt::format("args {}\n", fmt::join(arg_names->second, " "));
+      }
+
+      auto var_overrides = config.function_var_overrides.find(fname);
+      if (var_overrides != config.function_var_overrides.end()) {
+        for (const auto& var : sorted_keys(var_overrides->second)) {
+          const auto& ovr = var_overrides->second.at(var);
+          key += fmt::format("var {} {} {},", var, ovr.name, ovr.type.value_or(""));
+        }
+        key += "\n";
+      }
+
+      auto stack_hints = config.stack_structure_hints_by_function.find(fname);
+      if (stack_hints != config.stack_structure_hints_by_function.end()) {
+        for (const auto& hint : stack_hints->second) {
+          key += fmt::format("ss {} {} {} {},", hint.element_type, (int)hint.container_type,
+                             hint.container_size, hint.stack_offset);
+        }
+        key += "\n";
+      }
+
+      auto cond_hack = hacks.cond_with_else_len_by_func_name.find(fname);
+      if (cond_hack != hacks.cond_with_else_len_by_func_name.end()) {
+        for (const auto& block : sorted_keys(cond_hack->second.max_length_by_start_block)) {
+          key += fmt::format("cwe {} {},", block,
+                             cond_hack->second.max_length_by_start_block.at(block));
+        }
+        key += "\n";
+      }
+
+      auto asm_branch = hacks.blocks_ending_in_asm_branch_by_func_name.find(fname);
+      if (asm_branch != hacks.blocks_ending_in_asm_branch_by_func_name.end()) {
+        key += fmt::format("asmb {}\n", fmt::join(sorted_set(asm_branch->second), " "));
+      }
+
+      auto jump_table = hacks.mips2c_jump_table_functions.find(fname);
+      if (jump_table != hacks.mips2c_jump_table_functions.end()) {
+        key += fmt::format("jt {}\n", fmt::join(jump_table->second, " "));
+      }
+    }
+  }
+
+  return hex_hash(key);
+}
+
+fs::path IR2Cache::entry_path(const ObjectFileData& data) const {
+  return m_cache_dir / (data.to_unique_name() + ".json");
+}
+
+std::optional<IR2Cache::Result> IR2Cache::lookup(const ObjectFileData& data,
+                                                 const std::string& key) {
+  auto path = entry_path(data);
+  if (!fs::exists(path)) {
+    m_misses++;
+    return std::nullopt;
+  }
+
+  try {
+    auto json = nlohmann::json::parse(file_util::read_text_file(path));
+    if (json.at("version").get<int>() != IR2_CACHE_VERSION ||
+        json.at("key").get<std::string>() != key) {
+      m_misses++;
+      return std::nullopt;
+    }
+
+    auto tokens = json.at("tokens").get<std::vector<std::string>>();
+    if (json.at("deps").get<u64>() != dependency_hash(tokens)) {
+      m_misses++;
+      return std::nullopt;
+    }
+
+    Result result;
+    result.ir2_asm = json.at("ir2_asm").get<std::string>();
+    result.disasm = json.at("disasm").get<std::string>();
+    m_hits++;
+    return result;
+  } catch (const std::exception& e) {
+    lg::warn("Ignoring bad IR2 cache entry {}: {}", path.string(), e.what());
+    m_misses++;
+    return std::nullopt;
+  }
+}
+
+void IR2Cache::store(const ObjectFileData& data, const std::string& key, const Result& result) {
+  auto tokens = find_tokens(result.ir2_asm);
+  auto disasm_tokens = find_tokens(result.disasm);
+  tokens.insert(tokens.end(), disasm_tokens.begin(), disasm_tokens.end());
+  std::sort(tokens.begin(), tokens.end());
+  tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+  nlohmann::json json;
+  json["version"] = IR2_CACHE_VERSION;
+  json["key"] = key;
+  json["deps"] = dependency_hash(tokens);
+  json["tokens"] = tokens;
+  json["ir2_asm"] = result.ir2_asm;
+  json["disasm"] = result.disasm;
+
+  // write to a temporary file first, so an interrupted run can't leave a partial entry.
+  auto path = entry_path(data);
+  auto temp_path = path;
+  temp_path += ".tmp";
+  file_util::write_text_file(temp_path, json.dump());
+  std::error_code ec;
+  fs::rename(temp_path, path, ec);
+  if (ec) {
+    lg::warn("Failed to write IR2 cache entry {}: {}", path.string(), ec.message());
+  }
+}
+
+/*!
+ * Hash the current meaning of all the given words. Changing a type or symbol that is mentioned
+ * (or adding a type/symbol with that name) changes this hash.
+ */
+u64 IR2Cache::dependency_hash(const std::vector<std::string>& tokens) {
+  std::vector<u64> hashes;
+  hashes.reserve(tokens.size());
+  for (const auto& token : tokens) {
+    hashes.push_back(token_hash(token));
+  }
+  return fnv64(hashes.data(), hashes.size() * sizeof(u64));
+}
+
+u64 IR2Cache::token_hash(const std::string& token) {
+  auto it = m_token_hashes.find(token);
+  if (it != m_token_hashes.end()) {
+    return it->second;
+  }
+
+  std::string desc;
+  if (m_dts.ts.partially_defined_type_exists(token)) {
+    desc += fmt::format("type {:x}\n", type_closure_hash(token));
+  }
+
+  auto sym_it = m_dts.symbol_types.find(token);
+  if (sym_it != m_dts.symbol_types.end()) {
+    desc += fmt::format("sym {}", sym_it->second.print());
+    std::vector<std::string> type_names;
+    add_typespec_names(sym_it->second, &type_names);
+    for (const auto& name : type_names) {
+      desc += fmt::format(" {:x}", type_closure_hash(name));
+    }
+    desc += "\n";
+  } else if (m_dts.symbols.count(token)) {
+    desc += "untyped-sym\n";
+  }
+
+  u64 result = desc.empty() ? 0 : fnv64(desc);
+  m_token_hashes[token] = result;
+  return result;
+}
+
+/*!
+ * Hash the definition of a type and every type it refers to.
+ */
+u64 IR2Cache::type_closure_hash(const std::string& type_name) {
+  auto it = m_type_closure_hashes.find(type_name);
+  if (it != m_type_closure_hashes.end()) {
+    return it->second;
+  }
+
+  std::unordered_set<std::string> visited = {type_name};
+  std::vector<std::string> to_visit = {type_name};
+  std::vector<std::string> refs;
+  while (!to_visit.empty()) {
+    auto name = std::move(to_visit.back());
+    to_visit.pop_back();
+    refs.clear();
+    type_references(name, &refs);
+    for (auto& ref : refs) {
+      if (visited.insert(ref).second) {
+        to_visit.push_back(ref);
+      }
+    }
+  }
+
+  auto sorted = sorted_set(visited);
+  std::vector<u64> hashes;
+  hashes.reserve(sorted.size() * 2);
+  for (const auto& name : sorted) {
+    hashes.push_back(fnv64(name));
+    hashes.push_back(type_hash(name));
+  }
+  u64 result = fnv64(hashes.data(), hashes.size() * sizeof(u64));
+  m_type_closure_hashes[type_name] = result;
+  return result;
+}
+
+/*!
+ * Hash the definition of a single type.
+ */
+u64 IR2Cache::type_hash(const std::string& type_name) {
+  auto it = m_type_hashes.find(type_name);
+  if (it != m_type_hashes.end()) {
+    return it->second;
+  }
+
+  std::string desc;
+  const auto& ts = m_dts.ts;
+  if (ts.fully_defined_type_exists(type_name)) {
+    auto* type = ts.lookup_type(type_name);
+    desc = type->print();
+    desc += type->print_method_info();
+    for (const auto& [state, state_type] : type->get_states_declared_for_type()) {
+      desc += fmt::format("state {} {}\n", state, state_type.print());
+    }
+    if (auto* enum_type = dynamic_cast<EnumType*>(type)) {
+      desc += fmt::format("enum {}\n", enum_type->is_bitfield());
+      for (const auto& entry : sorted_keys(enum_type->entries())) {
+        desc += fmt::format("{}={}\n", entry, enum_type->entries().at(entry));
+      }
+    }
+  } else if (ts.partially_defined_type_exists(type_name)) {
+    desc = fmt::format("forward {}", ts.lookup_type_allow_partial_def(type_name)->get_name());
+  }
+
+  auto method_count = ts.try_get_type_method_count(type_name);
+  if (method_count) {
+    desc += fmt::format("methods {}\n", *method_count);
+  }
+
+  u64 result = fnv64(desc);
+  m_type_hashes[type_name] = result;
+  return result;
+}
+
+/*!
+ * Get the names of the types that the definition of this type refers to.
+ */
+void IR2Cache::type_references(const std::string& type_name, std::vector<std::string>* out) const {
+  const auto& ts = m_dts.ts;
+  if (!ts.fully_defined_type_exists(type_name)) {
+    if (ts.partially_defined_type_exists(type_name)) {
+      out->push_back(ts.lookup_type_allow_partial_def(type_name)->get_name());
+    }
+    return;
+  }
+
+  auto* type = ts.lookup_type(type_name);
+  if (type->has_parent()) {
+    out->push_back(type->get_parent());
+  }
+
+  if (auto* structure = dynamic_cast<StructureType*>(type)) {
+    for (const auto& field : structure->fields()) {
+      add_typespec_names(field.type(), out);
+      if (field.decomp_as_type()) {
+        add_typespec_names(*field.decomp_as_type(), out);
+      }
+    }
+  }
+
+  if (auto* bitfield = dynamic_cast<BitFieldType*>(type)) {
+    for (const auto& field : bitfield->fields()) {
+      add_typespec_names(field.type(), out);
+    }
+  }
+
+  for (const auto& method : type->get_methods_defined_for_type()) {
+    add_typespec_names(method.type, out);
+  }
+  if (auto* new_method = type->get_new_method_defined_for_type()) {
+    add_typespec_names(new_method->type, out);
+  }
+  for (const auto& [state, state_type] : type->get_states_declared_for_type()) {
+    add_typespec_names(state_type, out);
+  }
+}
+
+}  // namespace decompiler
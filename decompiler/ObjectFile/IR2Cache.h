@@ -0,0 +1,70 @@
+#pragma once
+
+/*!
+ * @file IR2Cache.h
+ * A persistent cache of IR2 results.
+ *
+ * The IR2 passes are run per object, and the passes for one function can depend on the other
+ * functions in the object (labels, defstates, anonymous functions), so the cache stores the final
+ * output text of an object. An entry is reused when:
+ * - the object's bytes, the names/types of its functions, and the config entries for the object
+ *   and its functions are unchanged (the "key")
+ * - every type and symbol mentioned in the previous output has the same definition in the current
+ *   type system. For types this includes parents, field types and method types, recursively.
+ *
+ * This makes editing the types or casts for one file only redo the files that can see the change.
+ */
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/util/FileUtil.h"
+
+namespace decompiler {
+struct Config;
+struct ObjectFileData;
+class DecompilerTypeSystem;
+
+class IR2Cache {
+ public:
+  IR2Cache(const fs::path& cache_dir, const Config& config, const DecompilerTypeSystem& dts);
+
+  struct Result {
+    std::string ir2_asm;
+    std::string disasm;
+  };
+
+  std::string compute_key(const ObjectFileData& data,
+                          const Config& config,
+                          const std::vector<std::string>& imports) const;
+  std::optional<Result> lookup(const ObjectFileData& data, const std::string& key);
+  void store(const ObjectFileData& data, const std::string& key, const Result& result);
+
+  int hit_count() const { return m_hits; }
+  int miss_count() const { return m_misses; }
+
+ private:
+  fs::path entry_path(const ObjectFileData& data) const;
+  u64 dependency_hash(const std::vector<std::string>& tokens);
+  u64 token_hash(const std::string& token);
+  u64 type_closure_hash(const std::string& type_name);
+  u64 type_hash(const std::string& type_name);
+  void type_references(const std::string& type_name, std::vector<std::string>* out) const;
+
+  fs::path m_cache_dir;
+  const DecompilerTypeSystem& m_dts;
+  std::string m_global_key;
+
+  // the type system doesn't change during IR2, so these are only computed once per run
+  std::unordered_map<std::string, u64> m_token_hashes;
+  std::unordered_map<std::string, u64> m_type_closure_hashes;
+  std::unordered_map<std::string, u64> m_type_hashes;
+
+  int m_hits = 0;
+  int m_misses = 0;
+};
+}  // namespace decompiler
@@ -793,6 +793,20 @@ std::string LinkedObjectFile::get_goal_string(int seg, int word_idx, bool with_q
   return result;
 }
 
+/*!
+ * Free the words, labels and functions. The segments are kept (empty), so code that loops over
+ * every object still works, but will see no functions.
+ */
+void LinkedObjectFile::release_code_and_data() {
+  for (int seg = 0; seg < segments; seg++) {
+    std::vector<LinkedWord>().swap(words_by_seg.at(seg));
+    std::vector<Function>().swap(functions_by_seg.at(seg));
+    std::unordered_map<int, int>().swap(label_per_seg_by_offset.at(seg));
+  }
+  std::vector<DecompilerLabel>().swap(labels);
+  label_db.reset();
+}
+
 /*!
  * Return true if the object file contains any functions at all.
  */
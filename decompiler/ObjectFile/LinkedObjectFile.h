@@ -61,6 +61,7 @@ class LinkedObjectFile {
   std::string print_scripts();
   std::string print_disassembly(bool write_hex);
   bool has_any_functions();
+  void release_code_and_data();
   void append_word_to_string(std::string& dest, const LinkedWord& word) const;
   std::string print_function_disassembly(Function& func,
                                          int seg,
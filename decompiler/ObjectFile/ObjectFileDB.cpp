@@ -20,6 +20,7 @@
 #include "common/util/BinaryReader.h"
 #include "common/util/BitUtils.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
 #include "common/util/Timer.h"
 #include "common/util/crc32.h"
 #include "common/util/dgo_util.h"
@@ -297,6 +298,8 @@ void ObjectFileDB::get_objs_from_dgo(const fs::path& filename, const Config& con
 
   if (file_util::dgo_header_is_compressed(dgo_data)) {
     dgo_data = file_util::decompress_dgo(dgo_data);
+  } else if (file_util::dgo_is_zstd_compressed(dgo_data)) {
+    dgo_data = file_util::decompress_zstd_dgo(dgo_data);
   }
 
   BinaryReader reader(dgo_data);
@@ -759,19 +762,40 @@ std::string ObjectFileDB::process_tpages(TextureDB& tex_db,
   }
 
   std::string result;
+  std::vector<ObjectFileData*> tpages;
+  // versions of the same tpage write to the same folder, so they're done by one worker, in order.
+  std::vector<std::vector<size_t>> tpage_groups;
   for_each_obj([&](ObjectFileData& data) {
     if (data.name_in_dgo.substr(0, tpage_string.length()) == tpage_string) {
-      auto statistics =
-          process_tpage(data, tex_db, output_path, cfg.animated_textures, cfg.save_texture_pngs);
-      total += statistics.total_textures;
-      success += statistics.successful_textures;
-      total_px += statistics.num_px;
+      if (tpages.empty() || tpages.back()->name_in_dgo != data.name_in_dgo) {
+        tpage_groups.emplace_back();
+      }
+      tpage_groups.back().push_back(tpages.size());
+      tpages.push_back(&data);
     } else if (data.name_in_dgo == "dir-tpages") {
       result = process_dir_tpages(data).to_source();
       tpage_dir_count++;
     }
   });
 
+  // each tpage is converted into its own TextureDB, then they are merged in the original order so
+  // the result doesn't depend on which thread finished first.
+  std::vector<TextureDB> tpage_dbs(tpages.size());
+  std::vector<TPageResultStats> tpage_stats(tpages.size());
+  JobSystem::global().parallel_for("process-tpage", tpage_groups.size(), [&](size_t g) {
+    for (size_t i : tpage_groups[g]) {
+      tpage_stats[i] = process_tpage(*tpages[i], tpage_dbs[i], output_path, cfg.animated_textures,
+                                     cfg.save_texture_pngs);
+    }
+  });
+
+  for (size_t i = 0; i < tpages.size(); i++) {
+    tex_db.merge(std::move(tpage_dbs[i]));
+    total += tpage_stats[i].total_textures;
+    success += tpage_stats[i].successful_textures;
+    total_px += tpage_stats[i].num_px;
+  }
+
   ASSERT(tpage_dir_count <= 1);
 
   lg::info("Processed {} / {} textures ({} px) {:.2f}% in {:.2f} ms", success, total, total_px,
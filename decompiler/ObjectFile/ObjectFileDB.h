@@ -7,10 +7,12 @@
  * (there may be different object files with the same name sometimes)
  */
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "IR2Cache.h"
 #include "LinkedObjectFile.h"
 
 #include "common/common_types.h"
@@ -202,6 +204,7 @@ class ObjectFileDB {
       const Config& config,
       const std::unordered_set<std::string>& skip_functions,
       const std::unordered_map<std::string, std::unordered_set<std::string>>& skip_states);
+  void release_object(ObjectFileData& data);
   void analyze_functions_ir2(
       const fs::path& output_dir,
       const Config& config,
@@ -224,10 +227,13 @@ class ObjectFileDB {
   void ir2_rewrite_inline_asm_instructions(int seg, ObjectFileData& data);
   void ir2_insert_anonymous_functions(int seg, ObjectFileData& data);
   void ir2_symbol_definition_map(ObjectFileData& data);
-  void ir2_write_results(const fs::path& output_dir,
-                         const Config& config,
-                         const std::vector<std::string>& imports,
-                         ObjectFileData& data);
+  IR2Cache::Result ir2_write_results(const fs::path& output_dir,
+                                     const Config& config,
+                                     const std::vector<std::string>& imports,
+                                     ObjectFileData& data);
+  void ir2_write_result_files(const fs::path& output_dir,
+                              const ObjectFileData& data,
+                              const IR2Cache::Result& result);
   void ir2_do_segment_analysis_phase1(int seg, const Config& config, ObjectFileData& data);
   void ir2_do_segment_analysis_phase2(int seg, const Config& config, ObjectFileData& data);
   void ir2_setup_labels(const Config& config, ObjectFileData& data);
@@ -407,6 +413,7 @@ class ObjectFileDB {
 
  private:
   GameVersion m_version;
+  std::unique_ptr<IR2Cache> m_ir2_cache;
 };
 
 std::string print_art_elt_for_dump(const std::string& group_name, const std::string& name, int idx);
@@ -5,12 +5,15 @@
 
 #include "ObjectFileDB.h"
 
+#include <thread>
+
 #include "common/formatter/formatter.h"
 #include "common/goos/PrettyPrinter.h"
 #include "common/link_types.h"
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
 #include "common/util/Timer.h"
+#include "common/util/os.h"
 #include "common/util/string_util.h"
 
 #include "decompiler/IR2/Form.h"
@@ -42,6 +45,29 @@ void ObjectFileDB::process_object_file_data(
     const std::unordered_set<std::string>& skip_functions,
     const std::unordered_map<std::string, std::unordered_set<std::string>>& skip_states) {
   Timer file_timer;
+
+  // TODO - insert the game_name into the import line automatically
+  // instead of `goal_src/jak1/import/something.gc`
+  // just `import/something.gc`
+  //
+  // Can be relative to the root of the source directory
+  const auto& imports_it = config.import_deps_by_file.find(data.to_unique_name());
+  std::vector<std::string> imports;
+  if (imports_it != config.import_deps_by_file.end()) {
+    imports = imports_it->second;
+  }
+
+  std::optional<std::string> cache_key;
+  if (m_ir2_cache && data.linked_data.has_any_functions()) {
+    cache_key = m_ir2_cache->compute_key(data, config, imports);
+    auto cached = m_ir2_cache->lookup(data, *cache_key);
+    if (cached) {
+      ir2_write_result_files(output_dir, data, *cached);
+      lg::info("Done in {:.2f}ms (cached)", file_timer.getMs());
+      return;
+    }
+  }
+
   ir2_do_segment_analysis_phase1(TOP_LEVEL_SEGMENT, config, data);
   ir2_do_segment_analysis_phase1(DEBUG_SEGMENT, config, data);
   ir2_do_segment_analysis_phase1(MAIN_SEGMENT, config, data);
@@ -81,19 +107,11 @@ void ObjectFileDB::process_object_file_data(
 
   ir2_symbol_definition_map(data);
 
-  // TODO - insert the game_name into the import line automatically
-  // instead of `goal_src/jak1/import/something.gc`
-  // just `import/something.gc`
-  //
-  // Can be relative to the root of the source directory
-  const auto& imports_it = config.import_deps_by_file.find(data.to_unique_name());
-  std::vector<std::string> imports;
-  if (imports_it != config.import_deps_by_file.end()) {
-    imports = imports_it->second;
-  }
-
   if (!output_dir.string().empty()) {
-    ir2_write_results(output_dir, config, imports, data);
+    auto result = ir2_write_results(output_dir, config, imports, data);
+    if (cache_key) {
+      m_ir2_cache->store(data, *cache_key, result);
+    }
   } else {
     data.output_with_skips = ir2_final_out(data, imports, skip_functions);
     data.full_output = ir2_final_out(data, imports, {});
@@ -119,6 +137,17 @@ void ObjectFileDB::process_object_file_data(
   lg::info("Done in {:.2f}ms", file_timer.getMs());
 }
 
+/*!
+ * Free everything that was only needed to decompile this object. This is only safe once its
+ * output has been written: nothing can look at its code or data afterward.
+ */
+void ObjectFileDB::release_object(ObjectFileData& data) {
+  std::vector<uint8_t>().swap(data.data);
+  data.linked_data.release_code_and_data();
+  std::string().swap(data.full_output);
+  std::string().swap(data.output_with_skips);
+}
+
 /*!
  * Main IR2 analysis pass.
  * At this point, we assume that the files are loaded and we've run find_code to locate all
@@ -136,6 +165,19 @@ void ObjectFileDB::analyze_functions_ir2(
     total_file_count += f.second.size();
   }
   int file_idx = 1;
+
+  if (config.cache_ir2 && !output_dir.string().empty()) {
+    if (config.generate_all_types || config.generate_symbol_definition_map) {
+      lg::warn("IR2 cache is not used when generating all-types or the symbol definition map");
+    } else {
+      m_ir2_cache = std::make_unique<IR2Cache>(output_dir / ".ir2-cache", config, dts);
+    }
+  }
+
+  // data-only objects are kept, the texture, text and level extraction read them later.
+  const bool streaming = config.streaming_decompile && !output_dir.string().empty();
+  int released_count = 0;
+
   for_each_obj([&](ObjectFileData& data) {
     if (prefile_callback) {
       prefile_callback.value()(data.to_unique_name());
@@ -145,10 +187,25 @@ void ObjectFileDB::analyze_functions_ir2(
     if (postfile_callback) {
       postfile_callback.value()();
     }
+    if (streaming && data.linked_data.has_any_functions()) {
+      release_object(data);
+      released_count++;
+    }
   });
 
+  if (streaming) {
+    lg::info("Released {} objects after decompiling, peak memory {} MB", released_count,
+             get_peak_rss() / (1024 * 1024));
+  }
+
   lg::info("{}", stats.let.print());
 
+  if (m_ir2_cache) {
+    lg::info("IR2 cache: {} objects reused, {} decompiled", m_ir2_cache->hit_count(),
+             m_ir2_cache->miss_count());
+    m_ir2_cache.reset();
+  }
+
   if (config.generate_symbol_definition_map) {
     lg::info("Generating symbol definition map...");
     map_builder.build_map();
@@ -864,32 +921,44 @@ void ObjectFileDB::ir2_insert_anonymous_functions(int seg, ObjectFileData& data)
   });
 }
 
-void ObjectFileDB::ir2_write_results(const fs::path& output_dir,
-                                     const Config& config,
-                                     const std::vector<std::string>& imports,
-                                     ObjectFileData& obj) {
+/*!
+ * Write the _ir2.asm and _disasm.gc files for an object. Returns the text that was written.
+ */
+IR2Cache::Result ObjectFileDB::ir2_write_results(const fs::path& output_dir,
+                                                 const Config& config,
+                                                 const std::vector<std::string>& imports,
+                                                 ObjectFileData& obj) {
+  IR2Cache::Result result;
   if (obj.linked_data.has_any_functions()) {
-    auto file_text = ir2_to_file(obj, config);
-    auto file_name = output_dir / (obj.to_unique_name() + "_ir2.asm");
-    file_util::write_text_file(file_name, file_text);
+    result.ir2_asm = ir2_to_file(obj, config);
 
     auto unformatted_code = ir2_final_out(obj, imports, {});
-    auto final_name = output_dir / (obj.to_unique_name() + "_disasm.gc");
     if (config.format_code) {
-      const auto formatted_code = formatter::format_code(unformatted_code);
+      // objects are written one at a time, so let the formatter split up the large ones.
+      const auto formatted_code =
+          formatter::format_code(unformatted_code, std::thread::hardware_concurrency());
       if (!formatted_code) {
         lg::error(
             "Was unable to format the decompiled result of {}, make a github issue. Writing "
             "unformatted code",
             obj.to_unique_name());
-        file_util::write_text_file(final_name, unformatted_code);
+        result.disasm = unformatted_code;
       } else {
-        file_util::write_text_file(final_name, formatted_code.value());
+        result.disasm = formatted_code.value();
       }
     } else {
-      file_util::write_text_file(final_name, unformatted_code);
+      result.disasm = unformatted_code;
     }
+    ir2_write_result_files(output_dir, obj, result);
   }
+  return result;
+}
+
+void ObjectFileDB::ir2_write_result_files(const fs::path& output_dir,
+                                          const ObjectFileData& obj,
+                                          const IR2Cache::Result& result) {
+  file_util::write_text_file(output_dir / (obj.to_unique_name() + "_ir2.asm"), result.ir2_asm);
+  file_util::write_text_file(output_dir / (obj.to_unique_name() + "_disasm.gc"), result.disasm);
 }
 
 std::string ObjectFileDB::ir2_to_file(ObjectFileData& data, const Config& config) {
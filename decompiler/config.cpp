@@ -98,6 +98,12 @@ Config make_config_via_json(nlohmann::json& json) {
   if (json.contains("format_code")) {
     config.format_code = json.at("format_code").get<bool>();
   }
+  if (json.contains("cache_ir2")) {
+    config.cache_ir2 = json.at("cache_ir2").get<bool>();
+  }
+  if (json.contains("streaming_decompile")) {
+    config.streaming_decompile = json.at("streaming_decompile").get<bool>();
+  }
   config.write_hex_near_instructions = json.at("write_hex_near_instructions").get<bool>();
   config.write_scripts = json.at("write_scripts").get<bool>();
   config.disassemble_data = json.at("disassemble_data").get<bool>();
@@ -110,6 +110,8 @@ struct Config {
   bool disassemble_code = false;
   bool decompile_code = false;
   bool format_code = false;
+  bool cache_ir2 = false;
+  bool streaming_decompile = false;
   bool write_scripts = false;
   bool disassemble_data = false;
   bool process_tpages = false;
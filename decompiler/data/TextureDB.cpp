@@ -99,6 +99,29 @@ void TextureDB::add_index_texture(u32 tpage,
   }
 }
 
+/*!
+ * Add all the textures from another TextureDB, the same as if they had been added to this one.
+ */
+void TextureDB::merge(TextureDB&& other) {
+  for (auto& [combo_id, tex] : other.textures) {
+    std::vector<std::string> level_names;
+    for (const auto& [level_name, ids] : other.texture_ids_per_level) {
+      if (ids.count(combo_id)) {
+        level_names.push_back(level_name);
+      }
+    }
+    add_texture(tex.page, combo_id & 0xffff, tex.rgba_bytes, tex.w, tex.h, tex.name,
+                other.tpage_names.at(tex.page), level_names, tex.num_mips, tex.dest);
+    // free as we go, so there's only ever one copy of most of the textures.
+    std::vector<u32>().swap(tex.rgba_bytes);
+  }
+
+  for (auto& [combo_id, tex] : other.index_textures_by_combo_id) {
+    add_index_texture(combo_id >> 16, combo_id & 0xffff, tex.index_data, tex.color_table, tex.w,
+                      tex.h, tex.name, tex.tpage_name, tex.level_names);
+  }
+}
+
 void TextureDB::merge_textures(const fs::path& base_path) {
   for (auto& tex : textures) {
     fs::path full_path = base_path / tpage_names.at(tex.second.page) / (tex.second.name + ".png");
@@ -55,6 +55,7 @@ struct TextureDB {
                          const std::string& tpage_name,
                          const std::vector<std::string>& level_names);
 
+  void merge(TextureDB&& other);
   void merge_textures(const fs::path& base_path);
   void replace_textures(const fs::path& path);
 
@@ -5,6 +5,7 @@
 #include "common/log/log.h"
 #include "common/util/BinaryReader.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
 #include "common/util/string_util.h"
 
 #include "fmt/core.h"
@@ -234,7 +235,6 @@ AudioFileInfo process_audio_file(const fs::path& output_folder,
     ASSERT(reader.read<u8>() == 0);
   }
 
-  file_util::create_dir_if_needed(output_folder / suffix);
   auto file_name = fmt::format("{}.wav", remove_trailing_spaces(name));
   write_wave_file(left_samples, right_samples, header.sample_rate,
                   output_folder / suffix / file_name);
@@ -272,18 +272,29 @@ void process_streamed_audio(const decompiler::Config& config,
     auto suffix = fs::path(file).extension().string().substr(1);
     bool int_bank_p = suffix.compare("INT") == 0;
     langs.push_back(suffix);
+    file_util::create_dir_if_needed(output_path / suffix);
+
+    std::vector<int> entries;
     for (int i = 0; i < dir_data.entry_count(); i++) {
-      auto entry = dir_data.entries.at(i);
-      if (entry.international != int_bank_p) {
-        continue;
+      if (dir_data.entries.at(i).international == int_bank_p) {
+        entries.push_back(i);
       }
+    }
 
-      lg::info("File {}, total {:.2f} minutes", entry.name, audio_len / 60.0);
+    // each entry is decoded to its own wav file, so they can be done in any order.
+    std::vector<AudioFileInfo> infos(entries.size());
+    JobSystem::global().parallel_for("process-audio-file", entries.size(), [&](size_t j) {
+      const auto& entry = dir_data.entries.at(entries[j]);
       auto data = std::span(wad_data).subspan(entry.start_byte);
-      auto info = process_audio_file(output_path, data, entry.name, suffix, entry.stereo);
-      audio_len += info.length_seconds;
-      filename_data[i][lang_id + 1] = info.filename;
+      infos[j] = process_audio_file(output_path, data, entry.name, suffix, entry.stereo);
+    });
+
+    for (size_t j = 0; j < entries.size(); j++) {
+      audio_len += infos[j].length_seconds;
+      filename_data[entries[j]][lang_id + 1] = infos[j].filename;
     }
+    lg::info("Processed {} files from {}, total {:.2f} minutes", entries.size(), file,
+             audio_len / 60.0);
   }
 
   nlohmann::json file_list;
@@ -169,6 +169,17 @@ int run_decompilation_process(decompiler::Config config,
     db.dts.textures = config.texture_info_dump;
   }
 
+  // scripts only need the linked data. This is done before the main decompile, which may release
+  // objects in streaming mode.
+  if (config.write_scripts) {
+    db.find_and_write_scripts(out_folder);
+  }
+
+  if (config.streaming_decompile && (config.generate_all_types || config.hexdump_code)) {
+    lg::warn("streaming_decompile is ignored when generating all-types or hexdumping code");
+    config.streaming_decompile = false;
+  }
+
   // main decompile.
   if (config.decompile_code) {
     db.analyze_functions_ir2(out_folder, config, {}, {}, {});
@@ -194,11 +205,6 @@ int run_decompilation_process(decompiler::Config config,
     db.write_object_file_words(out_folder, config.hexdump_data, config.hexdump_code);
   }
 
-  // data stuff
-  if (config.write_scripts) {
-    db.find_and_write_scripts(out_folder);
-  }
-
   // ensure asset dir exists
   file_util::create_dir_if_needed(out_folder / "assets");
 
@@ -7,6 +7,7 @@
 #include "common/log/log.h"
 #include "common/util/Assert.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
 #include "common/util/json_util.h"
 #include "common/util/read_iso_file.h"
 
@@ -261,10 +262,7 @@ std::tuple<uint64_t, int> calculate_extraction_hash(const IsoFile& iso_file) {
 }
 
 std::tuple<uint64_t, int> calculate_extraction_hash(const fs::path& extracted_iso_path) {
-  // - XOR all hashes together and hash the result.  This makes the ordering of the hashes (aka
-  // files) irrelevant
-  uint64_t combined_hash = 0;
-  int filec = 0;
+  std::vector<fs::path> files;
   for (auto const& dir_entry : fs::recursive_directory_iterator(extracted_iso_path)) {
     if (dir_entry.is_regular_file()) {
       // skip the `buildinfo.json` file, we make that -- not relevant!
@@ -272,11 +270,32 @@ std::tuple<uint64_t, int> calculate_extraction_hash(const fs::path& extracted_is
         lg::warn("skipping buildinfo.json, that is a file our tools generate");
         continue;
       }
-      auto buffer = file_util::read_binary_file(dir_entry.path().string());
-      auto hash = XXH64(buffer.data(), buffer.size(), 0);
-      combined_hash ^= hash;
-      filec++;
+      files.push_back(dir_entry.path());
+    }
+  }
+
+  // hash the files in parallel, streaming them through a small buffer so big files aren't loaded
+  std::vector<uint64_t> hashes(files.size());
+  JobSystem::global().parallel_for("hash-iso-file", files.size(), [&](size_t idx) {
+    auto fp = file_util::open_file(files.at(idx), "rb");
+    ASSERT_MSG(fp, fmt::format("failed to open {} for hashing", files.at(idx).string()));
+    std::vector<u8> buffer(1024 * 1024);
+    XXH64_state_t* state = XXH64_createState();
+    XXH64_reset(state, 0);
+    size_t len;
+    while ((len = fread(buffer.data(), 1, buffer.size(), fp)) > 0) {
+      XXH64_update(state, buffer.data(), len);
     }
+    fclose(fp);
+    hashes.at(idx) = XXH64_digest(state);
+    XXH64_freeState(state);
+  });
+
+  // - XOR all hashes together and hash the result.  This makes the ordering of the hashes (aka
+  // files) irrelevant
+  uint64_t combined_hash = 0;
+  for (const auto& hash : hashes) {
+    combined_hash ^= hash;
   }
-  return {XXH64(&combined_hash, sizeof(uint64_t), 0), filec};
+  return {XXH64(&combined_hash, sizeof(uint64_t), 0), (int)files.size()};
 }
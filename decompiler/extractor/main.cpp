@@ -311,11 +311,15 @@ int main(int argc, char** argv) {
           fs::remove_all(iso_data_path);
         }
 
-        // std::filesystem doesn't have a rename for dirs...
         // NOTE - potential disaster here, don't do either if the directories are the same location
         // or don't copy if the temp location is _inside_ the destination directory
         if (!file_util::is_dir_in_dir(iso_data_path, temp_iso_extract_location)) {
-          fs::copy(temp_iso_extract_location, iso_data_path, fs::copy_options::recursive);
+          // moving is free on the same drive, only copy (a second pass over every file) if needed
+          std::error_code rename_error;
+          fs::rename(temp_iso_extract_location, iso_data_path, rename_error);
+          if (rename_error) {
+            fs::copy(temp_iso_extract_location, iso_data_path, fs::copy_options::recursive);
+          }
         }
         if (iso_data_path != temp_iso_extract_location) {
           // in case input is also output, don't just wipe everything (weird)
@@ -5,7 +5,7 @@
 
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
-#include "common/util/SimpleThreadGroup.h"
+#include "common/util/JobSystem.h"
 #include "common/util/compress.h"
 #include "common/util/string_util.h"
 
@@ -401,13 +401,10 @@ void extract_all_levels(const ObjectFileDB& db,
   auto entities_dir = file_util::get_jak_project_dir() / "decompiler_out" /
                       game_version_names[config.game_version] / "entities";
   file_util::create_dir_if_needed(entities_dir);
-  SimpleThreadGroup threads;
-  threads.run(
-      [&](int idx) {
-        extract_from_level(db, tex_db, dgo_names[idx], config, output_path, entities_dir);
-      },
-      dgo_names.size());
-  threads.join();
+  // levels vary a lot in size, so they're handed out one at a time.
+  JobSystem::global().parallel_for("extract-level", dgo_names.size(), [&](size_t idx) {
+    extract_from_level(db, tex_db, dgo_names[idx], config, output_path, entities_dir);
+  });
 }
 
 }  // namespace decompiler
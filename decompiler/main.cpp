@@ -3,8 +3,11 @@
 #include "config.h"
 #include "decompilation_process.h"
 
+#include "decompiler/extractor/extractor_util.h"
+
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
+#include "common/util/iso_vfs.h"
 #include "common/util/set_util.h"
 #include "common/util/term_util.h"
 #include "common/util/unicode_util.h"
@@ -17,6 +20,8 @@ int main(int argc, char** argv) {
   fs::path config_path;
   fs::path in_folder;
   fs::path out_folder;
+  fs::path iso_path;
+  bool verify_iso = false;
 
   std::string config_game_version = "";
   std::string config_override = "{}";
@@ -40,6 +45,12 @@ int main(int argc, char** argv) {
       ->required();
   app.add_option("--config-override", config_override,
                  "JSON provided will be merged with the specified config, use to override options");
+  app.add_option("--iso", iso_path,
+                 "Read the game files directly from this ISO image instead of extracting it to "
+                 "in-folder first. Files that are in in-folder are still used");
+  app.add_flag("--verify-iso", verify_iso,
+               "Check the --iso image against the extractor's database. This hashes the entire "
+               "image, so it's slow");
   define_common_cli_arguments(app);
   app.validate_positionals();
   CLI11_PARSE(app, argc, argv);
@@ -83,8 +94,31 @@ int main(int argc, char** argv) {
   }
 
   in_folder = in_folder / config.game_name;
-  // Verify the in_folder is correct
-  if (!exists(in_folder)) {
+  if (!iso_path.empty()) {
+    std::shared_ptr<IsoVfs> iso;
+    try {
+      iso = std::make_shared<IsoVfs>(iso_path);
+    } catch (const std::exception& e) {
+      lg::error("Aborting - failed to open ISO: {}", e.what());
+      return 1;
+    }
+    if (verify_iso) {
+      // same check the extractor does after unpacking, but without unpacking.
+      auto [contents_hash, file_count] = iso->contents_hash();
+      bool known_iso = false;
+      for (const auto& [serial, by_elf] : extractor_iso_database()) {
+        for (const auto& [elf_hash, meta] : by_elf) {
+          known_iso |= meta.contents_hash.count(contents_hash) && meta.num_files == file_count;
+        }
+      }
+      if (!known_iso) {
+        lg::warn("ISO contents hash {} ({} files) is not in the extractor database",
+                 contents_hash, file_count);
+      }
+    }
+    file_util::mount_iso(in_folder, iso);
+  } else if (!exists(in_folder)) {
+    // Verify the in_folder is correct
     lg::error("Aborting - 'in_folder' does not exist '{}'", in_folder.string());
     return 1;
   }
@@ -95,7 +129,8 @@ int main(int argc, char** argv) {
 
   // Warning message if expected ELF isn't found, user could be using bad assets / didn't extract
   // the ISO properly
-  if (!config.expected_elf_name.empty() && !fs::exists(in_folder / config.expected_elf_name)) {
+  if (!config.expected_elf_name.empty() && !fs::exists(in_folder / config.expected_elf_name) &&
+      !file_util::find_in_mounted_iso(in_folder / config.expected_elf_name)) {
     lg::error(
         "WARNING - '{}' does not contain the expected ELF file '{}'.  Was the ISO extracted "
         "properly or is there a version mismatch?",
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "common/listener_common.h"
 #include "common/versions/versions.h"
 
@@ -19,4 +21,11 @@ struct GameLaunchOptions {
   GameVersion game_version = GameVersion::Jak1;
   bool disable_display = false;
   int server_port = DECI2_PORT;
+  std::string boot_image_path;     // if set, save/restore a snapshot of memory after boot
+  std::string iso_path;            // if set, files missing from out/iso are read from this image
+  bool fast_dgo = false;           // load DGOs with whole-file reads instead of the ISO thread
+  std::string record_input_path;   // if set, record pad, mouse, timer and rand inputs to this file
+  std::string replay_input_path;   // if set, replay inputs recorded with record_input_path
+  bool exit_after_replay = false;
+  std::string frame_timings_path;  // if set, write frame timing stats to this file on exit
 };
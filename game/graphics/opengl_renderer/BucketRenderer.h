@@ -19,6 +19,7 @@ struct LevelVis {
 };
 
 class EyeRenderer;
+class StreamingBuffer;
 /*!
  * The main renderer will contain a single SharedRenderState that's passed to all bucket renderers.
  * This allows bucket renders to share textures and shaders.
@@ -60,6 +61,8 @@ struct SharedRenderState {
   math::Vector4f camera_pos;
 
   EyeRenderer* eye_renderer = nullptr;
+  // for vertex/index data that changes every frame. Owned by OpenGLRenderer.
+  StreamingBuffer* streaming_buffer = nullptr;
 
   std::string load_status_debug;
 
@@ -107,6 +110,14 @@ class BucketRenderer {
   virtual void init_shaders(ShaderLibrary&) {}
   virtual void init_textures(TexturePool&, GameVersion) {}
 
+  // Renderers that can process their DMA without OpenGL or the SharedRenderState can split render
+  // into prepare and submit. The prepares of many buckets may run at the same time on worker
+  // threads, each following its own bucket's chain until next_bucket. Then submit is called on
+  // the render thread, in bucket order, to draw what was prepared.
+  virtual bool can_prepare() const { return false; }
+  virtual void prepare(DmaFollower& /*dma*/, u32 /*next_bucket*/, GameVersion /*version*/) {}
+  virtual void submit(SharedRenderState* /*render_state*/, ScopedProfilerNode& /*prof*/) {}
+
  protected:
   std::string m_name;
   int m_my_id;
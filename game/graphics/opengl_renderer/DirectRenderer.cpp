@@ -4,6 +4,7 @@
 #include "common/log/log.h"
 #include "common/util/Assert.h"
 
+#include "game/graphics/opengl_renderer/StreamingBuffer.h"
 #include "game/graphics/pipelines/opengl.h"
 
 #include "fmt/core.h"
@@ -15,14 +16,15 @@ constexpr PerGameVersion<int> game_height(448, 416, 416);
 
 DirectRenderer::DirectRenderer(const std::string& name, int my_id, int batch_size)
     : BucketRenderer(name, my_id), m_prim_buffer(batch_size) {
-  glGenBuffers(1, &m_ogl.vertex_buffer);
+  // the vertex data is in the streaming buffer, see setup_vertex_array.
   glGenVertexArrays(1, &m_ogl.vao);
-  glBindVertexArray(m_ogl.vao);
-  glBindBuffer(GL_ARRAY_BUFFER, m_ogl.vertex_buffer);
   m_ogl.vertex_buffer_max_verts = batch_size * 3 * 2;
-  m_ogl.vertex_buffer_bytes = m_ogl.vertex_buffer_max_verts * sizeof(Vertex);
-  glBufferData(GL_ARRAY_BUFFER, m_ogl.vertex_buffer_bytes, nullptr,
-               GL_STREAM_DRAW);  // todo stream?
+}
+
+/*!
+ * Point the vertex array at the buffer bound to GL_ARRAY_BUFFER.
+ */
+void DirectRenderer::setup_vertex_array() {
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0,                             // location 0 in the shader
                         4,                             // 4 floats per vert (w unused)
@@ -76,12 +78,9 @@ DirectRenderer::DirectRenderer(const std::string& name, int my_id, int batch_siz
                         sizeof(Vertex),                   //
                         (void*)offsetof(Vertex, scissor)  // offset in array
   );
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
 }
 
 DirectRenderer::~DirectRenderer() {
-  glDeleteBuffers(1, &m_ogl.vertex_buffer);
   glDeleteVertexArrays(1, &m_ogl.vao);
 }
 
@@ -258,9 +257,14 @@ void DirectRenderer::flush_pending(SharedRenderState* render_state, ScopedProfil
   glBindVertexArray(m_ogl.vao);
   // render!
   // update buffers:
-  glBindBuffer(GL_ARRAY_BUFFER, m_ogl.vertex_buffer);
-  glBufferData(GL_ARRAY_BUFFER, m_prim_buffer.vert_count * sizeof(Vertex),
-               m_prim_buffer.vertices.data(), GL_STREAM_DRAW);
+  auto upload = render_state->streaming_buffer->upload(
+      m_prim_buffer.vertices.data(), m_prim_buffer.vert_count * sizeof(Vertex), sizeof(Vertex));
+  if (upload.generation != m_ogl.vertex_buffer_generation) {
+    glBindBuffer(GL_ARRAY_BUFFER, upload.buffer);
+    setup_vertex_array();
+    m_ogl.vertex_buffer_generation = upload.generation;
+  }
+  const int first_vert = upload.offset / sizeof(Vertex);
 
   GLint current_shader;
   GLint viewport_size[4];
@@ -289,11 +293,11 @@ void DirectRenderer::flush_pending(SharedRenderState* render_state, ScopedProfil
       glDepthMask(GL_TRUE);
       glUniform1f(m_uniforms.alpha_min, m_double_draw_aref);
       glUniform1f(m_uniforms.alpha_max, 10);
-      glDrawArrays(GL_TRIANGLES, offset, n_batch);
+      glDrawArrays(GL_TRIANGLES, first_vert + offset, n_batch);
       glDepthMask(GL_FALSE);
       glUniform1f(m_uniforms.alpha_min, -10);
       glUniform1f(m_uniforms.alpha_max, m_double_draw_aref);
-      glDrawArrays(GL_TRIANGLES, offset, n_batch);
+      glDrawArrays(GL_TRIANGLES, first_vert + offset, n_batch);
       offset += n_batch;
       draw_count += 2;
       num_tris += n_batch / 3;
@@ -302,7 +306,7 @@ void DirectRenderer::flush_pending(SharedRenderState* render_state, ScopedProfil
     m_test_state_needs_gl_update = true;
     m_prim_gl_state_needs_gl_update = true;
   } else {
-    glDrawArrays(GL_TRIANGLES, 0, m_prim_buffer.vert_count);
+    glDrawArrays(GL_TRIANGLES, first_vert, m_prim_buffer.vert_count);
     num_tris += m_prim_buffer.vert_count / 3;
     draw_count++;
   }
@@ -311,7 +315,7 @@ void DirectRenderer::flush_pending(SharedRenderState* render_state, ScopedProfil
     render_state->shaders[ShaderId::DEBUG_RED].activate();
     glDisable(GL_BLEND);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glDrawArrays(GL_TRIANGLES, 0, m_prim_buffer.vert_count);
+    glDrawArrays(GL_TRIANGLES, first_vert, m_prim_buffer.vert_count);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     m_blend_state_needs_gl_update = true;
     m_prim_gl_state_needs_gl_update = true;
@@ -203,6 +203,7 @@ class DirectRenderer : public BucketRenderer {
   int m_current_tex_state_idx = -1;
 
   int get_texture_unit_for_current_reg(SharedRenderState* render_state, ScopedProfilerNode& prof);
+  void setup_vertex_array();
 
   // state set through the prim/rgbaq register that doesn't require changing GL stuff
   struct PrimBuildState {
@@ -284,9 +285,8 @@ class DirectRenderer : public BucketRenderer {
   } m_blit_buf_state;
 
   struct {
-    GLuint vertex_buffer;
     GLuint vao;
-    u32 vertex_buffer_bytes = 0;
+    u32 vertex_buffer_generation = 0;  // of the streaming buffer vao points to
     u32 vertex_buffer_max_verts = 0;
     float color_mult = 1.0;
     float alpha_mult = 1.0;
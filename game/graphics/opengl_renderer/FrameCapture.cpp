@@ -0,0 +1,167 @@
+#include "FrameCapture.h"
+
+#include <cstring>
+
+#include "common/goal_constants.h"
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/Timer.h"
+#include "common/util/compress.h"
+#include "common/util/string_util.h"
+
+#include "fmt/core.h"
+
+namespace {
+constexpr u32 CAPTURE_MAGIC = 0x50414346;  // FCAP
+constexpr u32 CAPTURE_VERSION = 1;
+}  // namespace
+
+FrameCaptureWriter::FrameCaptureWriter(const fs::path& path,
+                                       GameVersion version,
+                                       const u8* ee_memory,
+                                       u32 offset_of_s7,
+                                       int frame_count)
+    : m_path(path), m_frames_left(frame_count) {
+  ASSERT(frame_count > 0);
+  file_util::create_dir_if_needed_for_file(path);
+  m_fp = file_util::open_file(path, "wb");
+  if (!m_fp) {
+    lg::error("Failed to open {} for frame capture: {}", path.string(), strerror(errno));
+    return;
+  }
+  lg::info("Capturing {} frames to {}", frame_count, path.string());
+  fwrite(&CAPTURE_MAGIC, sizeof(u32), 1, m_fp);
+  fwrite(&CAPTURE_VERSION, sizeof(u32), 1, m_fp);
+
+  Serializer ser;
+  ser.from_ptr(&version);
+  ser.from_ptr(&offset_of_s7);
+  // the low memory is protected, so can't be read. Nothing the renderer uses is there.
+  ser.from_raw_data(const_cast<u8*>(ee_memory + EE_MAIN_MEM_LOW_PROTECT),
+                    EE_MAIN_MEM_SIZE - EE_MAIN_MEM_LOW_PROTECT);
+  write_entry(ser);
+}
+
+FrameCaptureWriter::~FrameCaptureWriter() {
+  if (m_fp) {
+    fclose(m_fp);
+  }
+}
+
+void FrameCaptureWriter::write_entry(Serializer& ser) {
+  auto [data, size] = ser.get_save_result();
+  auto compressed = compression::compress_zstd(data, size);
+  u64 compressed_size = compressed.size();
+  if (fwrite(&compressed_size, sizeof(u64), 1, m_fp) != 1 ||
+      fwrite(compressed.data(), compressed.size(), 1, m_fp) != 1) {
+    lg::error("Failed to write frame capture to {}", m_path.string());
+    fclose(m_fp);
+    m_fp = nullptr;
+  }
+}
+
+bool FrameCaptureWriter::add_frame(FixedChunkDmaCopier& copier,
+                                   const std::vector<std::string>& levels,
+                                   const std::vector<std::string>& active_levels,
+                                   float pmode_alp) {
+  if (!m_fp) {
+    return true;
+  }
+  Timer timer;
+  Serializer ser;
+  auto levels_copy = levels;
+  auto active_levels_copy = active_levels;
+  ser.from_string_vector(&levels_copy);
+  ser.from_string_vector(&active_levels_copy);
+  ser.from_ptr(&pmode_alp);
+  copier.serialize_last_result(ser);
+  write_entry(ser);
+  lg::debug("Captured frame in {:.3f} ms", timer.getMs());
+
+  m_frames_left--;
+  if (m_frames_left == 0 && m_fp) {
+    fclose(m_fp);
+    m_fp = nullptr;
+    lg::info("Finished frame capture {}", m_path.string());
+  }
+  return !m_fp;
+}
+
+/*!
+ * Load a frame capture. Frames that were cut off by the game exiting are skipped.
+ */
+std::optional<FrameCapture> load_frame_capture(const fs::path& path) {
+  std::vector<u8> file;
+  try {
+    file = file_util::read_binary_file(path);
+  } catch (const std::exception& e) {
+    lg::error("Failed to read frame capture {}: {}", path.string(), e.what());
+    return {};
+  }
+
+  size_t offset = 0;
+  auto read_u32 = [&]() {
+    u32 result = 0;
+    if (offset + sizeof(u32) <= file.size()) {
+      memcpy(&result, file.data() + offset, sizeof(u32));
+    }
+    offset += sizeof(u32);
+    return result;
+  };
+  if (read_u32() != CAPTURE_MAGIC) {
+    lg::error("{} is not a frame capture", path.string());
+    return {};
+  }
+  const u32 version = read_u32();
+  if (version != CAPTURE_VERSION) {
+    lg::error("{} has version {}, but only version {} is supported", path.string(), version,
+              CAPTURE_VERSION);
+    return {};
+  }
+
+  FrameCapture result;
+  bool got_header = false;
+  while (offset + sizeof(u64) <= file.size()) {
+    u64 size;
+    memcpy(&size, file.data() + offset, sizeof(u64));
+    offset += sizeof(u64);
+    if (offset + size > file.size()) {
+      lg::warn("Frame capture {} is truncated", path.string());
+      break;
+    }
+    auto data = compression::decompress_zstd(file.data() + offset, size);
+    offset += size;
+    Serializer ser(data.data(), data.size());
+
+    if (!got_header) {
+      ser.from_ptr(&result.version);
+      ser.from_ptr(&result.offset_of_s7);
+      result.ee_memory.resize(EE_MAIN_MEM_SIZE);
+      ser.from_raw_data(result.ee_memory.data() + EE_MAIN_MEM_LOW_PROTECT,
+                        EE_MAIN_MEM_SIZE - EE_MAIN_MEM_LOW_PROTECT);
+      got_header = true;
+    } else {
+      auto& frame = result.frames.emplace_back();
+      ser.from_string_vector(&frame.levels);
+      ser.from_string_vector(&frame.active_levels);
+      ser.from_ptr(&frame.pmode_alp);
+      // load with the copier, so we use the same format it saves.
+      FixedChunkDmaCopier copier(EE_MAIN_MEM_SIZE);
+      copier.serialize_last_result(ser);
+      frame.dma = copier.get_last_result();
+    }
+    ASSERT(ser.get_load_finished());
+  }
+
+  if (result.frames.empty()) {
+    lg::error("Frame capture {} has no frames", path.string());
+    return {};
+  }
+  return result;
+}
+
+fs::path make_frame_capture_path(GameVersion version) {
+  return file_util::get_jak_project_dir() / "profile_data" /
+         fmt::format("frame-capture-{}-{}.fcap", game_version_names[version],
+                     str_util::current_local_timestamp_no_colons());
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+/*!
+ * @file FrameCapture.h
+ * Saving frames from the game, to replay them through the renderer with tools/render_replay.
+ *
+ * A capture starts with a copy of EE memory, then has one entry per frame with the DMA chain (as
+ * copied by the FixedChunkDmaCopier), the levels the game wanted loaded, and the PCRTC alpha.
+ * Each of these is zstd compressed and written as soon as it's captured, so captures can be long.
+ *
+ * Textures uploaded with texture_upload_now (tpages loaded by the game, outside of the DMA chain)
+ * aren't captured. Replays will only have textures from the .fr3 files and from the DMA chain.
+ */
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/dma/dma_copy.h"
+#include "common/util/FileUtil.h"
+#include "common/versions/versions.h"
+
+struct FrameCaptureFrame {
+  std::vector<std::string> levels;
+  std::vector<std::string> active_levels;
+  float pmode_alp = 1.f;
+  DmaData dma;
+};
+
+struct FrameCapture {
+  GameVersion version = GameVersion::Jak1;
+  u32 offset_of_s7 = 0;
+  // all of EE memory, at the start of the capture. The protected low memory is zeros.
+  std::vector<u8> ee_memory;
+  std::vector<FrameCaptureFrame> frames;
+};
+
+class FrameCaptureWriter {
+ public:
+  FrameCaptureWriter(const fs::path& path,
+                     GameVersion version,
+                     const u8* ee_memory,
+                     u32 offset_of_s7,
+                     int frame_count);
+  ~FrameCaptureWriter();
+  FrameCaptureWriter(const FrameCaptureWriter&) = delete;
+  FrameCaptureWriter& operator=(const FrameCaptureWriter&) = delete;
+
+  // Write the last chain run through the copier. Returns true once all frames are written.
+  bool add_frame(FixedChunkDmaCopier& copier,
+                 const std::vector<std::string>& levels,
+                 const std::vector<std::string>& active_levels,
+                 float pmode_alp);
+
+ private:
+  void write_entry(Serializer& ser);
+
+  fs::path m_path;
+  FILE* m_fp = nullptr;
+  int m_frames_left = 0;
+};
+
+std::optional<FrameCapture> load_frame_capture(const fs::path& path);
+fs::path make_frame_capture_path(GameVersion version);
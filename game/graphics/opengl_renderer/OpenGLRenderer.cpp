@@ -1,5 +1,6 @@
 #include "OpenGLRenderer.h"
 
+#include "common/global_profiler/FrameTimings.h"
 #include "common/goal_constants.h"
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
@@ -41,7 +42,12 @@
 
 namespace {
 std::string g_current_renderer;
-}
+// grows if a frame needs more.
+constexpr u32 STREAMING_BUFFER_INITIAL_SIZE = 8 * 1024 * 1024;
+// frame timing hitches, for a single bucket and for a category of them.
+constexpr float BUCKET_HITCH_MS = 2.f;
+constexpr float CATEGORY_HITCH_MS = 4.f;
+}  // namespace
 
 /*!
  * OpenGL Error callback. If we do something invalid, this will be called.
@@ -92,6 +98,9 @@ OpenGLRenderer::OpenGLRenderer(std::shared_ptr<TexturePool> texture_pool,
   lg::info("OpenGL context shading language version: {}",
            (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
 
+  m_streaming_buffer = std::make_unique<StreamingBuffer>(STREAMING_BUFFER_INITIAL_SIZE);
+  m_render_state.streaming_buffer = m_streaming_buffer.get();
+
   const tfrag3::Level* common_level = nullptr;
   {
     auto p = scoped_prof("load-common");
@@ -129,6 +138,16 @@ OpenGLRenderer::OpenGLRenderer(std::shared_ptr<TexturePool> texture_pool,
     default:
       ASSERT(false);
   }
+
+  for (auto& renderer : m_bucket_renderers) {
+    m_bucket_timing_channels.push_back(frame_timings().channel(
+        fmt::format("bucket/{}", renderer->name_and_id()), BUCKET_HITCH_MS));
+  }
+  for (int i = 0; i < (int)BucketCategory::MAX_CATEGORIES; i++) {
+    m_category_timing_channels[i] = frame_timings().channel(
+        fmt::format("category/{}", BUCKET_CATEGORY_NAMES[i]), CATEGORY_HITCH_MS);
+  }
+  m_render_timing_channel = frame_timings().channel("render");
 }
 
 void OpenGLRenderer::init_bucket_renderers_jak3() {
@@ -947,8 +966,13 @@ void OpenGLRenderer::blit_display() {
 void OpenGLRenderer::render(DmaFollower dma, const RenderOptions& settings) {
   m_profiler.clear();
   m_render_state.reset();
-  m_render_state.ee_main_memory = g_ee_main_mem;
-  m_render_state.offset_of_s7 = offset_of_s7();
+  if (settings.ee_main_memory) {
+    m_render_state.ee_main_memory = settings.ee_main_memory;
+    m_render_state.offset_of_s7 = settings.offset_of_s7;
+  } else {
+    m_render_state.ee_main_memory = g_ee_main_mem;
+    m_render_state.offset_of_s7 = offset_of_s7();
+  }
 
   {
     g_current_renderer = "frame-setup";
@@ -1051,6 +1075,10 @@ void OpenGLRenderer::render(DmaFollower dma, const RenderOptions& settings) {
   }
 
   m_profiler.finish();
+  frame_timings().record(m_render_timing_channel, m_profiler.root_time() * 1000.f);
+  for (int i = 0; i < (int)BucketCategory::MAX_CATEGORIES; i++) {
+    frame_timings().record(m_category_timing_channels[i], m_category_times[i] * 1000.f);
+  }
   //  if (m_profiler.root_time() > 0.018) {
   //    fmt::print("Slow frame: {:.2f} ms\n", m_profiler.root_time() * 1000);
   //    fmt::print("{}\n", m_profiler.to_string());
@@ -1066,6 +1094,8 @@ void OpenGLRenderer::render(DmaFollower dma, const RenderOptions& settings) {
     SmallProfilerStats stats;
     stats.draw_calls = m_profiler.root()->stats().draw_calls;
     stats.triangles = m_profiler.root()->stats().triangles;
+    stats.upload_kb = m_streaming_buffer->last_frame_stats().bytes / 1024;
+    stats.upload_stalls = m_streaming_buffer->last_frame_stats().stalls;
     for (int i = 0; i < (int)BucketCategory::MAX_CATEGORIES; i++) {
       stats.time_per_category[i] = m_category_times[i];
     }
@@ -1085,6 +1115,9 @@ void OpenGLRenderer::render(DmaFollower dma, const RenderOptions& settings) {
     m_filters_menu.draw_window();
   }
 
+  // all draws using streamed data are submitted.
+  m_streaming_buffer->end_frame();
+
   if (settings.gpu_sync) {
     g_current_renderer = "gpu-sync";
     glFinish();
@@ -1104,6 +1137,7 @@ void OpenGLRenderer::draw_renderer_selection_window() {
   ImGui::Checkbox("Sky CPU", &m_render_state.use_sky_cpu);
   ImGui::Checkbox("Occlusion Cull", &m_render_state.use_occlusion_culling);
   ImGui::Checkbox("Blackout Loads", &m_enable_fast_blackout_loads);
+  ImGui::Checkbox("Parallel Bucket Prepare", &m_parallel_bucket_prepare);
 
   if (m_texture_animator && ImGui::TreeNode("Texture Animator")) {
     m_texture_animator->draw_debug_window();
@@ -1127,6 +1161,10 @@ void OpenGLRenderer::draw_renderer_selection_window() {
       ImGui::PopID();
     }
   }
+  if (ImGui::TreeNode("Streaming Buffer")) {
+    m_streaming_buffer->draw_debug_window();
+    ImGui::TreePop();
+  }
   if (ImGui::TreeNode("Texture Pool")) {
     m_render_state.texture_pool->draw_debug_window();
     ImGui::TreePop();
@@ -1283,6 +1321,7 @@ void OpenGLRenderer::dispatch_buckets_jak1(DmaFollower dma,
   // now we should point to the first bucket!
   ASSERT(dma.current_tag_offset() == m_render_state.next_bucket);
   m_render_state.next_bucket += 16;
+  start_bucket_prepares(dma);
 
   // loop over the buckets!
   for (size_t bucket_id = 0; bucket_id < m_bucket_renderers.size(); bucket_id++) {
@@ -1290,7 +1329,7 @@ void OpenGLRenderer::dispatch_buckets_jak1(DmaFollower dma,
     auto bucket_prof = prof.make_scoped_child(renderer->name_and_id());
     g_current_renderer = renderer->name_and_id();
     // lg::info("Render: {} start", g_current_renderer);
-    renderer->render(dma, &m_render_state, bucket_prof);
+    render_bucket(bucket_id, dma, bucket_prof);
     if (sync_after_buckets) {
       auto pp = scoped_prof("finish");
       glFinish();
@@ -1302,6 +1341,8 @@ void OpenGLRenderer::dispatch_buckets_jak1(DmaFollower dma,
     m_render_state.next_bucket += 16;
     vif_interrupt_callback(bucket_id);
     m_category_times[(int)m_bucket_categories[bucket_id]] += bucket_prof.get_elapsed_time();
+    frame_timings().record(m_bucket_timing_channels[bucket_id],
+                           bucket_prof.get_elapsed_time() * 1000.f);
 
     // hack to draw the collision mesh in the middle the drawing
     if (bucket_id == 31 - 1 && Gfx::g_global_settings.collision_enable) {
@@ -1324,13 +1365,14 @@ void OpenGLRenderer::dispatch_buckets_jak2(DmaFollower dma,
   m_render_state.next_bucket = m_render_state.buckets_base + 16;
   m_render_state.bucket_for_vis_copy = (int)jak2::BucketId::BUCKET_2;
   m_render_state.num_vis_to_copy = jak2::LEVEL_MAX;
+  start_bucket_prepares(dma);
 
   for (size_t bucket_id = 0; bucket_id < m_bucket_renderers.size(); bucket_id++) {
     auto& renderer = m_bucket_renderers[bucket_id];
     auto bucket_prof = prof.make_scoped_child(renderer->name_and_id());
     g_current_renderer = renderer->name_and_id();
     // lg::info("Render: {} start", g_current_renderer);
-    renderer->render(dma, &m_render_state, bucket_prof);
+    render_bucket(bucket_id, dma, bucket_prof);
     if (sync_after_buckets) {
       auto pp = scoped_prof("finish");
       glFinish();
@@ -1342,6 +1384,8 @@ void OpenGLRenderer::dispatch_buckets_jak2(DmaFollower dma,
     m_render_state.next_bucket += 16;
     vif_interrupt_callback(bucket_id + 1);
     m_category_times[(int)m_bucket_categories[bucket_id]] += bucket_prof.get_elapsed_time();
+    frame_timings().record(m_bucket_timing_channels[bucket_id],
+                           bucket_prof.get_elapsed_time() * 1000.f);
 
     // hack to draw the collision mesh in the middle the drawing
     if (bucket_id + 1 == (int)jak2::BucketId::TEX_L0_ALPHA &&
@@ -1366,13 +1410,14 @@ void OpenGLRenderer::dispatch_buckets_jak3(DmaFollower dma,
   m_render_state.next_bucket = m_render_state.buckets_base + 16;
   m_render_state.bucket_for_vis_copy = (int)jak3::BucketId::BUCKET_2;
   m_render_state.num_vis_to_copy = jak3::LEVEL_MAX;
+  start_bucket_prepares(dma);
 
   for (size_t bucket_id = 0; bucket_id < m_bucket_renderers.size(); bucket_id++) {
     auto& renderer = m_bucket_renderers[bucket_id];
     auto bucket_prof = prof.make_scoped_child(renderer->name_and_id());
     g_current_renderer = renderer->name_and_id();
     // lg::info("Render: {} start", g_current_renderer);
-    renderer->render(dma, &m_render_state, bucket_prof);
+    render_bucket(bucket_id, dma, bucket_prof);
     if (sync_after_buckets) {
       auto pp = scoped_prof("finish");
       glFinish();
@@ -1384,6 +1429,8 @@ void OpenGLRenderer::dispatch_buckets_jak3(DmaFollower dma,
     m_render_state.next_bucket += 16;
     vif_interrupt_callback(bucket_id + 1);
     m_category_times[(int)m_bucket_categories[bucket_id]] += bucket_prof.get_elapsed_time();
+    frame_timings().record(m_bucket_timing_channels[bucket_id],
+                           bucket_prof.get_elapsed_time() * 1000.f);
 
     // hack to draw the collision mesh in the middle the drawing
     if (bucket_id + 1 == (int)jak3::BucketId::TEX_L0_ALPHA &&
@@ -1397,6 +1444,58 @@ void OpenGLRenderer::dispatch_buckets_jak3(DmaFollower dma,
   // TODO ending data.
 }
 
+/*!
+ * Start preparing the buckets whose renderers support it on the job system. Bucket i's chain
+ * starts at its tag in the bucket array and ends at the tag of bucket i + 1, so each can be
+ * followed on its own.
+ */
+void OpenGLRenderer::start_bucket_prepares(const DmaFollower& dma) {
+  m_bucket_prepares.clear();
+  m_bucket_prepares.resize(m_bucket_renderers.size());
+  if (!m_parallel_bucket_prepare) {
+    return;
+  }
+
+  for (size_t bucket_id = 0; bucket_id < m_bucket_renderers.size(); bucket_id++) {
+    auto* renderer = m_bucket_renderers[bucket_id].get();
+    if (!renderer->can_prepare()) {
+      continue;
+    }
+    const u32 start = m_render_state.buckets_base + 16 * bucket_id;
+    const void* base = dma.base();
+    const auto version = m_version;
+    auto& group = m_bucket_prepares[bucket_id];
+    group = std::make_unique<TaskGroup>("bucket-prepare");
+    group->run([=]() {
+      DmaFollower bucket_dma(base, start);
+      renderer->prepare(bucket_dma, start + 16, version);
+    });
+  }
+}
+
+/*!
+ * Render a single bucket. If it was prepared on another thread, wait for that, then draw it and
+ * skip over its DMA.
+ */
+void OpenGLRenderer::render_bucket(size_t bucket_id, DmaFollower& dma, ScopedProfilerNode& prof) {
+  auto& renderer = m_bucket_renderers[bucket_id];
+  auto& prepare = m_bucket_prepares[bucket_id];
+  if (!prepare) {
+    renderer->render(dma, &m_render_state, prof);
+    return;
+  }
+
+  {
+    auto p = prof.make_scoped_child("wait-prepare");
+    prepare->wait();
+  }
+  prepare.reset();
+  renderer->submit(&m_render_state, prof);
+  while (dma.current_tag_offset() != m_render_state.next_bucket) {
+    dma.read_and_advance();
+  }
+}
+
 /*!
  * This function finds buckets and dispatches them to the appropriate part.
  */
@@ -4,12 +4,14 @@
 #include <memory>
 
 #include "common/dma/dma_chain_read.h"
+#include "common/util/JobSystem.h"
 
 #include "game/graphics/opengl_renderer/BucketRenderer.h"
 #include "game/graphics/opengl_renderer/CollideMeshRenderer.h"
 #include "game/graphics/opengl_renderer/Fbo.h"
 #include "game/graphics/opengl_renderer/Profiler.h"
 #include "game/graphics/opengl_renderer/Shader.h"
+#include "game/graphics/opengl_renderer/StreamingBuffer.h"
 #include "game/graphics/opengl_renderer/TextureAnimator.h"
 #include "game/graphics/opengl_renderer/foreground/Generic2.h"
 #include "game/graphics/opengl_renderer/foreground/Merc2.h"
@@ -51,6 +53,10 @@ struct RenderOptions {
   // when enabled, does a `glFinish()` after each major rendering pass. This blocks until the GPU
   // is done working, making it easier to profile GPU utilization.
   bool gpu_sync = false;
+
+  // EE memory and s7 to use instead of the game's, for replaying a frame capture.
+  u8* ee_main_memory = nullptr;
+  u32 offset_of_s7 = 0;
 };
 
 /*!
@@ -70,12 +76,17 @@ class OpenGLRenderer {
   // the graphics system.
   void render(DmaFollower dma, const RenderOptions& settings);
 
+  // stats of the last frame
+  const Profiler& profiler() const { return m_profiler; }
+
  private:
   void setup_frame(const RenderOptions& settings);
   void dispatch_buckets(DmaFollower dma, ScopedProfilerNode& prof, bool sync_after_buckets);
   void dispatch_buckets_jak1(DmaFollower dma, ScopedProfilerNode& prof, bool sync_after_buckets);
   void dispatch_buckets_jak2(DmaFollower dma, ScopedProfilerNode& prof, bool sync_after_buckets);
   void dispatch_buckets_jak3(DmaFollower dma, ScopedProfilerNode& prof, bool sync_after_buckets);
+  void start_bucket_prepares(const DmaFollower& dma);
+  void render_bucket(size_t bucket_id, DmaFollower& dma, ScopedProfilerNode& prof);
 
   void do_pcrtc_effects(float alp, SharedRenderState* render_state, ScopedProfilerNode& prof);
   void blit_display();
@@ -105,6 +116,7 @@ class OpenGLRenderer {
   }
 
   SharedRenderState m_render_state;
+  std::unique_ptr<StreamingBuffer> m_streaming_buffer;
   Profiler m_profiler;
   SmallProfiler m_small_profiler;
   SubtitleEditor* m_subtitle_editor = nullptr;
@@ -115,14 +127,21 @@ class OpenGLRenderer {
   std::shared_ptr<TextureAnimator> m_texture_animator;
   std::vector<std::unique_ptr<BucketRenderer>> m_bucket_renderers;
   std::vector<BucketCategory> m_bucket_categories;
+  // for buckets being prepared on other threads, by bucket id.
+  std::vector<std::unique_ptr<TaskGroup>> m_bucket_prepares;
   class BlitDisplays* m_blit_displays = nullptr;
 
   std::array<float, (int)BucketCategory::MAX_CATEGORIES> m_category_times;
+  // FrameTimings channels
+  std::vector<int> m_bucket_timing_channels;
+  std::array<int, (int)BucketCategory::MAX_CATEGORIES> m_category_timing_channels;
+  int m_render_timing_channel = 0;
   FullScreenDraw m_blackout_renderer;
   CollideMeshRenderer m_collide_renderer;
 
   float m_last_pmode_alp = 1.;
   bool m_enable_fast_blackout_loads = true;
+  bool m_parallel_bucket_prepare = true;
   std::string m_renderer_filter = "";
 
   struct FboState {
@@ -209,6 +209,7 @@ void SmallProfiler::draw(const std::string& status, const SmallProfilerStats& st
   if (ImGui::Begin("Profiler (short)", nullptr, window_flags)) {
     ImGui::Text(" tri: %7d\n", stats.triangles);
     ImGui::Text("  DC: %4d\n", stats.draw_calls);
+    ImGui::Text("  up: %5d KB, %d stalls\n", stats.upload_kb, stats.upload_stalls);
     if (!status.empty()) {
       ImGui::Text("%s", status.c_str());
     }
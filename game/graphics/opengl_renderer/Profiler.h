@@ -40,6 +40,7 @@ class ProfilerNode {
   void add_tri(int count = 1) { m_stats.triangles += count; }
   float get_elapsed_time() const { return m_timer.getSeconds(); }
   const ProfilerStats& stats() const { return m_stats; }
+  const std::vector<ProfilerNode>& children() const { return m_children; }
 
  private:
   friend class Profiler;
@@ -84,6 +85,7 @@ class Profiler {
 
   std::string to_string();
   ProfilerNode* root() { return &m_root; }
+  const ProfilerNode& root() const { return m_root; }
 
  private:
   void draw_node(ProfilerNode& node, bool expand, int depth, float start_time);
@@ -110,6 +112,7 @@ class FramePlot {
 
 struct SmallProfilerStats {
   int triangles, draw_calls;
+  int upload_kb, upload_stalls;
   float time_per_category[(int)BucketCategory::MAX_CATEGORIES];
 };
 
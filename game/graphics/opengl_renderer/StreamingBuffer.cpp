@@ -0,0 +1,152 @@
+#include "StreamingBuffer.h"
+
+#include <cstring>
+
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/Timer.h"
+
+#include "third-party/imgui/imgui.h"
+
+namespace {
+// when growing, make room for this many frames the size of the current one.
+constexpr u32 FRAMES_PER_BUFFER = 3;
+}  // namespace
+
+StreamingBuffer::StreamingBuffer(u32 initial_size) {
+  ASSERT(initial_size > 0);
+  create_buffer(initial_size);
+}
+
+StreamingBuffer::~StreamingBuffer() {
+  for (auto& frame : m_in_flight) {
+    glDeleteSync(frame.fence);
+  }
+  glDeleteBuffers(1, &m_buffer);
+  glDeleteBuffers(m_retired_buffers.size(), m_retired_buffers.data());
+}
+
+void StreamingBuffer::create_buffer(u32 size) {
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  m_capacity = size;
+  m_generation++;
+  m_head = 0;
+  m_used = 0;
+  m_frame_bytes = 0;
+}
+
+/*!
+ * Switch to a new buffer that fits a few frames of min_frame_size bytes. Nothing in the old buffer
+ * is overwritten, so it's safe to keep drawing from it until the end of this frame.
+ */
+void StreamingBuffer::grow(u32 min_frame_size) {
+  u32 new_capacity = m_capacity * 2;
+  while (new_capacity < min_frame_size * FRAMES_PER_BUFFER) {
+    new_capacity *= 2;
+  }
+  lg::info("[StreamingBuffer] growing from {} KB to {} KB", m_capacity / 1024,
+           new_capacity / 1024);
+  for (auto& frame : m_in_flight) {
+    glDeleteSync(frame.fence);
+  }
+  m_in_flight.clear();
+  m_retired_buffers.push_back(m_buffer);
+  create_buffer(new_capacity);
+  m_frame_stats.grows++;
+}
+
+void StreamingBuffer::wait_for_oldest_frame() {
+  auto& frame = m_in_flight.front();
+  GLenum result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    Timer timer;
+    m_frame_stats.stalls++;
+    do {
+      result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    } while (result == GL_TIMEOUT_EXPIRED);
+    m_frame_stats.stall_ms += (float)timer.getMs();
+  }
+  ASSERT(result != GL_WAIT_FAILED);
+  glDeleteSync(frame.fence);
+  m_used -= frame.bytes;
+  m_in_flight.pop_front();
+}
+
+/*!
+ * Copy size bytes to the buffer, starting at a multiple of alignment (which doesn't need to be a
+ * power of two, so vertex sizes can be used to get a base vertex).
+ */
+StreamingBuffer::Allocation StreamingBuffer::upload(const void* data, u32 size, u32 alignment) {
+  ASSERT(alignment > 0);
+  if (size == 0) {
+    return {m_buffer, 0, m_generation};
+  }
+  u32 offset, consumed;
+  while (true) {
+    offset = ((m_head + alignment - 1) / alignment) * alignment;
+    if (offset + size <= m_capacity) {
+      consumed = offset + size - m_head;
+    } else {
+      // doesn't fit at the end, wrap around to the start.
+      offset = 0;
+      consumed = m_capacity - m_head + size;
+    }
+
+    if (m_used + consumed <= m_capacity) {
+      break;
+    }
+    if (m_in_flight.empty()) {
+      // this frame alone doesn't fit.
+      grow(m_frame_stats.bytes + size + alignment);
+    } else {
+      wait_for_oldest_frame();
+    }
+  }
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+  if (m_use_map) {
+    void* dst = glMapBufferRange(
+        GL_COPY_WRITE_BUFFER, offset, size,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    ASSERT(dst);
+    memcpy(dst, data, size);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  } else {
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  m_head = offset + size;
+  m_used += consumed;
+  m_frame_bytes += consumed;
+  m_frame_stats.uploads++;
+  m_frame_stats.bytes += size;
+  return {m_buffer, offset, m_generation};
+}
+
+/*!
+ * Call after all draws for the frame have been submitted.
+ */
+void StreamingBuffer::end_frame() {
+  if (m_frame_bytes) {
+    m_in_flight.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_frame_bytes});
+    m_frame_bytes = 0;
+  }
+  if (!m_retired_buffers.empty()) {
+    // GL keeps these around until the draws using them are done.
+    glDeleteBuffers(m_retired_buffers.size(), m_retired_buffers.data());
+    m_retired_buffers.clear();
+  }
+  m_last_frame_stats = m_frame_stats;
+  m_frame_stats = {};
+}
+
+void StreamingBuffer::draw_debug_window() {
+  ImGui::Checkbox("Map buffer (off: glBufferSubData)", &m_use_map);
+  ImGui::Text("Size: %d KB, %d frames in flight", m_capacity / 1024, (int)m_in_flight.size());
+  ImGui::Text("Uploads: %d, %d KB", m_last_frame_stats.uploads, m_last_frame_stats.bytes / 1024);
+  ImGui::Text("Stalls: %d (%.3f ms)", m_last_frame_stats.stalls, m_last_frame_stats.stall_ms);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "common/common_types.h"
+
+#include "game/graphics/pipelines/opengl.h"
+
+/*!
+ * A ring buffer for vertex and index data that is generated on the CPU every frame.
+ *
+ * Instead of each renderer re-specifying its own buffer with glBufferData every time it draws,
+ * renderers copy their data into the next free part of one large buffer, and draw from the offset
+ * they're given. The parts written in a frame are protected by a fence at the end of the frame, and
+ * are only overwritten once the GPU is done with them. Waiting on one of those fences is a stall,
+ * and is counted in the stats.
+ *
+ * Data is written with unsynchronized glMapBufferRange (or glBufferSubData, if mapping is turned
+ * off), since we take care of synchronization with the fences. If a single frame uploads more than
+ * the buffer can hold, a larger buffer is created. Allocations made in the old buffer stay valid
+ * until the end of the frame, so users should check the generation of each allocation to see if
+ * their vertex array needs to be set up again.
+ */
+class StreamingBuffer {
+ public:
+  struct Allocation {
+    GLuint buffer = 0;
+    u32 offset = 0;      // bytes from the start of buffer. Multiple of the requested alignment.
+    u32 generation = 0;  // different for each GL buffer this has used.
+  };
+
+  struct Stats {
+    u32 uploads = 0;
+    u32 bytes = 0;
+    u32 stalls = 0;
+    float stall_ms = 0;
+    u32 grows = 0;
+  };
+
+  StreamingBuffer(u32 initial_size);
+  ~StreamingBuffer();
+  StreamingBuffer(const StreamingBuffer&) = delete;
+  StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+  Allocation upload(const void* data, u32 size, u32 alignment);
+  void end_frame();
+
+  const Stats& last_frame_stats() const { return m_last_frame_stats; }
+  void draw_debug_window();
+
+ private:
+  struct InFlightFrame {
+    GLsync fence;
+    u32 bytes;  // bytes of the ring used by this frame, including padding.
+  };
+
+  void create_buffer(u32 size);
+  void grow(u32 min_frame_size);
+  void wait_for_oldest_frame();
+
+  GLuint m_buffer = 0;
+  u32 m_generation = 0;
+  u32 m_capacity = 0;
+  u32 m_head = 0;         // the next free byte
+  u32 m_used = 0;         // bytes between the oldest in-flight frame and m_head
+  u32 m_frame_bytes = 0;  // bytes of the ring used by this frame so far
+  std::deque<InFlightFrame> m_in_flight;
+  std::vector<GLuint> m_retired_buffers;
+
+  bool m_use_map = true;
+  Stats m_frame_stats;
+  Stats m_last_frame_stats;
+};
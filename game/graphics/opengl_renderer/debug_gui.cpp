@@ -1,5 +1,7 @@
 #include "debug_gui.h"
 
+#include <algorithm>
+
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/util/string_util.h"
 
@@ -15,6 +17,7 @@
 
 void FrameTimeRecorder::finish_frame() {
   m_frame_times[m_idx++] = m_compute_timer.getMs();
+  frame_timings().record(m_frame_cpu_channel, m_frame_times[m_idx - 1]);
   if (m_idx == SIZE) {
     m_idx = 0;
   }
@@ -23,6 +26,7 @@ void FrameTimeRecorder::finish_frame() {
 void FrameTimeRecorder::start_frame() {
   m_compute_timer.start();
   float frame_time = m_fps_timer.getSeconds();
+  frame_timings().record(m_frame_channel, frame_time * 1000.f);
   m_last_frame_time = (0.9 * m_last_frame_time) + (0.1 * frame_time);
   m_fps_timer.start();
 }
@@ -123,6 +127,12 @@ void OpenGlDebugGui::draw(const DmaStats& dma_stats) {
         ImGui::Checkbox("Quick-Screenshot on F2", &screenshot_hotkey_enabled);
         ImGui::EndMenu();
       }
+      if (ImGui::BeginMenu("Frame Capture")) {
+        ImGui::MenuItem("Capture Next Frames!", nullptr, &m_want_frame_capture);
+        ImGui::InputInt("Frames", &m_frame_capture_frames);
+        m_frame_capture_frames = std::max(m_frame_capture_frames, 1);
+        ImGui::EndMenu();
+      }
       ImGui::MenuItem("Subtitle Editor", nullptr, &m_subtitle_editor);
       ImGui::MenuItem("Debug Text Filter", nullptr, &m_filters_menu);
       ImGui::EndMenu();
@@ -213,6 +223,11 @@ void OpenGlDebugGui::draw(const DmaStats& dma_stats) {
       ImGui::EndMenu();
     }
 
+    if (ImGui::BeginMenu("Frame Timings")) {
+      draw_frame_timings_menu();
+      ImGui::EndMenu();
+    }
+
     if (!Gfx::g_debug_settings.ignore_hide_imgui) {
       std::string button_text =
           fmt::format("Click here or Press {} to hide Toolbar",
@@ -247,6 +262,28 @@ void OpenGlDebugGui::draw(const DmaStats& dma_stats) {
   }
 }
 
+void OpenGlDebugGui::draw_frame_timings_menu() {
+  ImGui::Checkbox("Show Buckets", &m_frame_timings_show_buckets);
+  ImGui::SameLine();
+  if (ImGui::Button("Reset")) {
+    frame_timings().reset();
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Dump to File")) {
+    frame_timings().dump_to_profile_data();
+  }
+  ImGui::Separator();
+  ImGui::Text("%-30s %8s %8s %8s %8s %8s", "ms", "p50", "p95", "p99", "max", "hitches");
+  for (const auto& stats : frame_timings().stats()) {
+    // buckets and categories have a prefix
+    if (!m_frame_timings_show_buckets && stats.name.find('/') != std::string::npos) {
+      continue;
+    }
+    ImGui::Text("%-30s %8.2f %8.2f %8.2f %8.2f %8d", stats.name.c_str(), stats.p50, stats.p95,
+                stats.p99, stats.max, (int)stats.hitches);
+  }
+}
+
 void OpenGlDebugGui::draw_overlord_debug_menu() {
   ImGui::Begin("Overlord");
 
@@ -6,6 +6,7 @@
  */
 
 #include "common/dma/dma.h"
+#include "common/global_profiler/FrameTimings.h"
 #include "common/util/Timer.h"
 #include "common/versions/versions.h"
 
@@ -36,6 +37,9 @@ class FrameTimeRecorder {
 
   bool m_play = true;
   bool m_single_frame = false;
+
+  int m_frame_channel = frame_timings().channel("frame");
+  int m_frame_cpu_channel = frame_timings().channel("frame-cpu");
 };
 
 class OpenGlDebugGui {
@@ -63,6 +67,15 @@ class OpenGlDebugGui {
     return false;
   }
 
+  // number of frames to capture for render_replay, or 0.
+  int get_frame_capture_request() {
+    if (m_want_frame_capture) {
+      m_want_frame_capture = false;
+      return m_frame_capture_frames;
+    }
+    return 0;
+  }
+
   bool small_profiler = false;
   bool record_events = false;
   int max_event_buffer_size = 65536;
@@ -74,14 +87,18 @@ class OpenGlDebugGui {
 
  private:
   void draw_overlord_debug_menu();
+  void draw_frame_timings_menu();
   FrameTimeRecorder m_frame_timer;
   bool m_draw_frame_time = false;
   bool m_draw_profiler = false;
   bool m_draw_debug = false;
   bool m_draw_loader = false;
   bool m_draw_overlord = false;
+  bool m_frame_timings_show_buckets = false;
   bool m_subtitle_editor = false;
   bool m_filters_menu = false;
   bool m_want_screenshot = false;
+  bool m_want_frame_capture = false;
+  int m_frame_capture_frames = 1;
   float target_fps_input = 60.f;
 };
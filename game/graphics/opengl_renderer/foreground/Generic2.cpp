@@ -8,18 +8,37 @@ Generic2::Generic2(ShaderLibrary& shaders,
                    u32 num_verts,
                    u32 num_frags,
                    u32 num_adgif,
-                   u32 num_buckets) {
+                   u32 num_buckets)
+    : Generic2(std::make_shared<OpenGLObjects>(), num_verts, num_frags, num_adgif, num_buckets) {
+  opengl_setup(shaders);
+}
+
+Generic2::Generic2(std::shared_ptr<OpenGLObjects> ogl,
+                   u32 num_verts,
+                   u32 num_frags,
+                   u32 num_adgif,
+                   u32 num_buckets)
+    : m_ogl(ogl) {
   m_verts.resize(num_verts);
   m_fragments.resize(num_frags);
   m_adgifs.resize(num_adgif);
   m_buckets.resize(num_buckets);
   m_indices.resize(num_verts * 3);
-
-  opengl_setup(shaders);
 }
 
 Generic2::~Generic2() {
-  opengl_cleanup();
+  if (m_ogl.use_count() == 1) {
+    opengl_cleanup();
+  }
+}
+
+/*!
+ * Create a Generic2 that draws with the same OpenGL objects as this one, but has its own buffers
+ * for the DMA data and draws. Many can process DMA at the same time. The buffers start small and
+ * grow to fit the biggest frame seen.
+ */
+std::shared_ptr<Generic2> Generic2::make_sibling() {
+  return std::shared_ptr<Generic2>(new Generic2(m_ogl, 4096, 128, 128, 64));
 }
 
 void Generic2::draw_debug_window() {
@@ -58,51 +77,69 @@ void Generic2::render_in_mode(DmaFollower& dma,
   {
     // our first pass is to go over the DMA chain from the game and extract the data into buffers
     auto p = prof.make_scoped_child("dma");
-    switch (mode) {
-      case Mode::NORMAL:
-      case Mode::WARP:
-        if (render_state->version == GameVersion::Jak1) {
-          process_dma_jak1(dma, render_state->next_bucket);
-        } else {
-          process_dma_jak2(dma, render_state->next_bucket);
-        }
-        break;
-      case Mode::LIGHTNING:
-        process_dma_lightning(dma, render_state->next_bucket);
-        break;
-      case Mode::PRIM:
-        process_dma_prim(dma, render_state->next_bucket);
-        break;
-      default:
-        ASSERT_NOT_REACHED();
-    }
+    process_dma_in_mode(dma, render_state->next_bucket, render_state->version, mode);
   }
 
-  m_empty = m_next_free_vert == 0;
-
   {
     // the next pass is to look at all of that data, and figure out the best order to draw it
     // using OpenGL
     auto p = prof.make_scoped_child("setup");
-    switch (mode) {
-      case Mode::NORMAL:
-        setup_draws(true, true);
-        break;
-      case Mode::LIGHTNING:
-      case Mode::PRIM:
-        setup_draws(false, true);
-        break;
-      case Mode::WARP:
-        setup_draws(true, false);
-        break;
-      default:
-        ASSERT_NOT_REACHED();
-    }
+    setup_draws_in_mode(mode);
   }
 
-  {
-    // the final pass is the actual drawing.
-    auto p = prof.make_scoped_child("drawing");
-    do_draws(render_state, p);
+  // the final pass is the actual drawing.
+  draw_prepared(render_state, prof);
+}
+
+void Generic2::prepare_in_mode(DmaFollower& dma, u32 next_bucket, GameVersion version, Mode mode) {
+  process_dma_in_mode(dma, next_bucket, version, mode);
+  setup_draws_in_mode(mode);
+}
+
+void Generic2::draw_prepared(SharedRenderState* render_state, ScopedProfilerNode& prof) {
+  auto p = prof.make_scoped_child("drawing");
+  do_draws(render_state, p);
+}
+
+void Generic2::process_dma_in_mode(DmaFollower& dma,
+                                   u32 next_bucket,
+                                   GameVersion version,
+                                   Mode mode) {
+  switch (mode) {
+    case Mode::NORMAL:
+    case Mode::WARP:
+      if (version == GameVersion::Jak1) {
+        process_dma_jak1(dma, next_bucket);
+      } else {
+        process_dma_jak2(dma, next_bucket);
+      }
+      break;
+    case Mode::LIGHTNING:
+      process_dma_lightning(dma, next_bucket);
+      break;
+    case Mode::PRIM:
+      process_dma_prim(dma, next_bucket);
+      break;
+    default:
+      ASSERT_NOT_REACHED();
   }
-}
\ No newline at end of file
+
+  m_empty = m_next_free_vert == 0;
+}
+
+void Generic2::setup_draws_in_mode(Mode mode) {
+  switch (mode) {
+    case Mode::NORMAL:
+      setup_draws(true, true);
+      break;
+    case Mode::LIGHTNING:
+    case Mode::PRIM:
+      setup_draws(false, true);
+      break;
+    case Mode::WARP:
+      setup_draws(true, false);
+      break;
+    default:
+      ASSERT_NOT_REACHED();
+  }
+}
@@ -18,6 +18,13 @@ class Generic2 {
                       ScopedProfilerNode& prof,
                       Mode mode);
 
+  // render_in_mode, split into the DMA processing and draw setup, which doesn't use OpenGL and can
+  // run on any thread, and the drawing, which must happen on the render thread.
+  void prepare_in_mode(DmaFollower& dma, u32 next_bucket, GameVersion version, Mode mode);
+  void draw_prepared(SharedRenderState* render_state, ScopedProfilerNode& prof);
+
+  std::shared_ptr<Generic2> make_sibling();
+
   void draw_debug_window();
   bool empty() { return m_empty; }
 
@@ -34,6 +41,15 @@ class Generic2 {
   static_assert(sizeof(Vertex) == 32);
 
  private:
+  struct OpenGLObjects;
+  Generic2(std::shared_ptr<OpenGLObjects> ogl,
+           u32 num_verts,
+           u32 num_frags,
+           u32 num_adgif,
+           u32 num_buckets);
+
+  void process_dma_in_mode(DmaFollower& dma, u32 next_bucket, GameVersion version, Mode mode);
+  void setup_draws_in_mode(Mode mode);
   void determine_draw_modes(bool enable_at, bool default_fog);
   void build_index_buffer();
   void link_adgifs_back_to_frags();
@@ -56,6 +72,7 @@ class Generic2 {
   bool handle_bucket_setup_dma(DmaFollower& dma, u32 next_bucket);
 
   void opengl_setup(ShaderLibrary& shaders);
+  void opengl_setup_vertex_array();
   void opengl_cleanup();
   void opengl_bind_and_setup_proj(SharedRenderState* render_state);
   void setup_opengl_for_draw_mode(const DrawMode& draw_mode,
@@ -179,33 +196,44 @@ class Generic2 {
   std::vector<u32> m_indices;
   u32 m_max_indices_seen = 0;
 
+  // these grow the buffers when they are full, which invalidates references to earlier entries.
   Fragment& next_frag() {
-    ASSERT(m_next_free_frag < m_fragments.size());
+    if (m_next_free_frag == m_fragments.size()) {
+      m_fragments.resize(m_fragments.size() * 2);
+    }
     return m_fragments[m_next_free_frag++];
   }
 
   Adgif& next_adgif() {
-    ASSERT(m_next_free_adgif < m_adgifs.size());
+    if (m_next_free_adgif == m_adgifs.size()) {
+      m_adgifs.resize(m_adgifs.size() * 2);
+    }
     return m_adgifs[m_next_free_adgif++];
   }
 
   void alloc_vtx(int count) {
     m_next_free_vert += count;
-    ASSERT(m_next_free_vert < m_verts.size());
+    if (m_next_free_vert >= m_verts.size()) {
+      m_verts.resize(std::max<size_t>(m_verts.size() * 2, m_next_free_vert + 1));
+    }
   }
 
   static constexpr int ALPHA_MODE_COUNT = 7;
   bool m_alpha_draw_enable[ALPHA_MODE_COUNT] = {true, true, true, true, true, true, true};
 
-  struct {
+  // shared with siblings.
+  struct OpenGLObjects {
     GLuint vao;
-    GLuint vertex_buffer;
-    GLuint index_buffer;
+    u32 vertex_buffer_generation = 0;  // of the streaming buffer vao points to
     GLuint alpha_reject, color_mult, fog_color, scale, mat_23, mat_32, mat_33, fog_consts,
         hvdf_offset, use_full_matrix, full_matrix;
     GLuint gfx_hack_no_tex;
     GLuint warp_sample_mode;
-  } m_ogl;
+  };
+  std::shared_ptr<OpenGLObjects> m_ogl;
+  // where do_draws uploaded this frame's vertices and indices in the streaming buffer.
+  GLint m_base_vertex = 0;
+  size_t m_index_offset = 0;
 
   bool m_empty = false;
 };
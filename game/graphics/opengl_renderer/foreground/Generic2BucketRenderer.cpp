@@ -4,7 +4,7 @@ Generic2BucketRenderer::Generic2BucketRenderer(const std::string& name,
                                                int id,
                                                std::shared_ptr<Generic2> renderer,
                                                Generic2::Mode mode)
-    : BucketRenderer(name, id), m_generic(renderer), m_mode(mode) {}
+    : BucketRenderer(name, id), m_generic(renderer->make_sibling()), m_mode(mode) {}
 
 void Generic2BucketRenderer::draw_debug_window() {
   m_generic->draw_debug_window();
@@ -28,3 +28,19 @@ void Generic2BucketRenderer::render(DmaFollower& dma,
 bool Generic2BucketRenderer::empty() const {
   return m_empty;
 }
+
+void Generic2BucketRenderer::prepare(DmaFollower& dma, u32 next_bucket, GameVersion version) {
+  // if disabled, the DMA is skipped by OpenGLRenderer.
+  m_prepared = m_enabled;
+  if (m_prepared) {
+    m_generic->prepare_in_mode(dma, next_bucket, version, m_mode);
+  }
+}
+
+void Generic2BucketRenderer::submit(SharedRenderState* render_state, ScopedProfilerNode& prof) {
+  if (!m_prepared) {
+    return;
+  }
+  m_generic->draw_prepared(render_state, prof);
+  m_empty = m_generic->empty();
+}
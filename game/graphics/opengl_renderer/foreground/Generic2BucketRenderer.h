@@ -12,9 +12,14 @@ class Generic2BucketRenderer : public BucketRenderer {
   void render(DmaFollower& dma, SharedRenderState* render_state, ScopedProfilerNode& prof) override;
   void draw_debug_window() override;
   bool empty() const override;
+  bool can_prepare() const override { return true; }
+  void prepare(DmaFollower& dma, u32 next_bucket, GameVersion version) override;
+  void submit(SharedRenderState* render_state, ScopedProfilerNode& prof) override;
 
  private:
+  // our own buffers, so other generic buckets can be prepared at the same time.
   std::shared_ptr<Generic2> m_generic;
   Generic2::Mode m_mode;
   bool m_empty = false;
+  bool m_prepared = false;
 };
@@ -230,6 +230,10 @@ void Generic2::link_adgifs_back_to_frags() {
  * TODO: also determine texture units per bucket here.
  */
 void Generic2::draws_to_buckets() {
+  // at worst, each adgif gets its own bucket.
+  if (m_buckets.size() < m_next_free_adgif) {
+    m_buckets.resize(m_next_free_adgif);
+  }
   std::unordered_map<u64, u32> draw_key_to_bucket;
   for (u32 i = 0; i < m_next_free_adgif; i++) {
     auto& ad = m_adgifs[i];
@@ -352,6 +356,11 @@ void Generic2::final_vertex_update() {
  * Build the index buffer.
  */
 void Generic2::build_index_buffer() {
+  // each adgif starts with a restart, then each vertex adds at most 3 indices.
+  const u32 max_indices = m_next_free_adgif + 3 * m_next_free_vert;
+  if (m_indices.size() < max_indices) {
+    m_indices.resize(max_indices);
+  }
   for (u32 bucket_idx = 0; bucket_idx < m_next_free_bucket; bucket_idx++) {
     auto& bucket = m_buckets[bucket_idx];
     bucket.tri_count = 0;
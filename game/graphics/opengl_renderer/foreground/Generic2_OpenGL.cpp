@@ -2,20 +2,37 @@
 
 #include "Generic2.h"
 #include "game/graphics/gfx.h"
+#include "game/graphics/opengl_renderer/StreamingBuffer.h"
 
 void Generic2::opengl_setup(ShaderLibrary& shaders) {
-  // create OpenGL objects
-  glGenBuffers(1, &m_ogl.vertex_buffer);
-  glGenBuffers(1, &m_ogl.index_buffer);
-  glGenVertexArrays(1, &m_ogl.vao);
-
-  // set up the vertex array
-  glBindVertexArray(m_ogl.vao);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ogl.index_buffer);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(u32), nullptr, GL_STREAM_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, m_ogl.vertex_buffer);
-  glBufferData(GL_ARRAY_BUFFER, m_verts.size() * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+  // create OpenGL objects. The vertices and indices are in the streaming buffer, and the vertex
+  // array is set up in do_draws.
+  glGenVertexArrays(1, &m_ogl->vao);
 
+  const auto& shader = shaders[ShaderId::GENERIC];
+  auto id = shader.id();
+
+  shader.activate();
+  m_ogl->alpha_reject = glGetUniformLocation(id, "alpha_reject");
+  m_ogl->color_mult = glGetUniformLocation(id, "color_mult");
+  m_ogl->fog_color = glGetUniformLocation(id, "fog_color");
+
+  m_ogl->scale = glGetUniformLocation(id, "scale");
+  m_ogl->mat_23 = glGetUniformLocation(id, "mat_23");
+  m_ogl->mat_32 = glGetUniformLocation(id, "mat_32");
+  m_ogl->mat_33 = glGetUniformLocation(id, "mat_33");
+  m_ogl->fog_consts = glGetUniformLocation(id, "fog_constants");
+  m_ogl->hvdf_offset = glGetUniformLocation(id, "hvdf_offset");
+  m_ogl->gfx_hack_no_tex = glGetUniformLocation(id, "gfx_hack_no_tex");
+  m_ogl->warp_sample_mode = glGetUniformLocation(id, "warp_sample_mode");
+  m_ogl->use_full_matrix = glGetUniformLocation(id, "use_full_matrix");
+  m_ogl->full_matrix = glGetUniformLocation(id, "full_matrix");
+}
+
+/*!
+ * Point the vertex array at the buffer bound to GL_ARRAY_BUFFER.
+ */
+void Generic2::opengl_setup_vertex_array() {
   // xyz
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0,                            // location 0 in the shader
@@ -54,51 +71,27 @@ void Generic2::opengl_setup(ShaderLibrary& shaders) {
                          sizeof(Vertex),                    //
                          (void*)offsetof(Vertex, tex_unit)  // offset in array
   );
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
-
-  const auto& shader = shaders[ShaderId::GENERIC];
-  auto id = shader.id();
-
-  shader.activate();
-  m_ogl.alpha_reject = glGetUniformLocation(id, "alpha_reject");
-  m_ogl.color_mult = glGetUniformLocation(id, "color_mult");
-  m_ogl.fog_color = glGetUniformLocation(id, "fog_color");
-
-  m_ogl.scale = glGetUniformLocation(id, "scale");
-  m_ogl.mat_23 = glGetUniformLocation(id, "mat_23");
-  m_ogl.mat_32 = glGetUniformLocation(id, "mat_32");
-  m_ogl.mat_33 = glGetUniformLocation(id, "mat_33");
-  m_ogl.fog_consts = glGetUniformLocation(id, "fog_constants");
-  m_ogl.hvdf_offset = glGetUniformLocation(id, "hvdf_offset");
-  m_ogl.gfx_hack_no_tex = glGetUniformLocation(id, "gfx_hack_no_tex");
-  m_ogl.warp_sample_mode = glGetUniformLocation(id, "warp_sample_mode");
-  m_ogl.use_full_matrix = glGetUniformLocation(id, "use_full_matrix");
-  m_ogl.full_matrix = glGetUniformLocation(id, "full_matrix");
 }
 
 void Generic2::opengl_cleanup() {
-  glDeleteBuffers(1, &m_ogl.vertex_buffer);
-  glDeleteBuffers(1, &m_ogl.index_buffer);
-  glDeleteVertexArrays(1, &m_ogl.vao);
+  glDeleteVertexArrays(1, &m_ogl->vao);
 }
 
 void Generic2::opengl_bind_and_setup_proj(SharedRenderState* render_state) {
   render_state->shaders[ShaderId::GENERIC].activate();
-  glUniform4f(m_ogl.fog_color, render_state->fog_color[0] / 255.f,
+  glUniform4f(m_ogl->fog_color, render_state->fog_color[0] / 255.f,
               render_state->fog_color[1] / 255.f, render_state->fog_color[2] / 255.f,
               render_state->fog_intensity / 255);
-  glUniform4f(m_ogl.scale, m_drawing_config.proj_scale[0], m_drawing_config.proj_scale[1],
+  glUniform4f(m_ogl->scale, m_drawing_config.proj_scale[0], m_drawing_config.proj_scale[1],
               m_drawing_config.proj_scale[2], 0);
-  glUniform1f(m_ogl.mat_23, m_drawing_config.proj_mat_23);
-  glUniform1f(m_ogl.mat_32, m_drawing_config.proj_mat_32);
-  glUniform1f(m_ogl.mat_33, 0);
-  glUniform3f(m_ogl.fog_consts, m_drawing_config.pfog0, m_drawing_config.fog_min,
+  glUniform1f(m_ogl->mat_23, m_drawing_config.proj_mat_23);
+  glUniform1f(m_ogl->mat_32, m_drawing_config.proj_mat_32);
+  glUniform1f(m_ogl->mat_33, 0);
+  glUniform3f(m_ogl->fog_consts, m_drawing_config.pfog0, m_drawing_config.fog_min,
               m_drawing_config.fog_max);
-  glUniform4f(m_ogl.hvdf_offset, m_drawing_config.hvdf_offset[0], m_drawing_config.hvdf_offset[1],
+  glUniform4f(m_ogl->hvdf_offset, m_drawing_config.hvdf_offset[0], m_drawing_config.hvdf_offset[1],
               m_drawing_config.hvdf_offset[2], m_drawing_config.hvdf_offset[3]);
-  glUniform1i(m_ogl.gfx_hack_no_tex, Gfx::g_global_settings.hack_no_tex);
+  glUniform1i(m_ogl->gfx_hack_no_tex, Gfx::g_global_settings.hack_no_tex);
 }
 
 void Generic2::setup_opengl_for_draw_mode(const DrawMode& draw_mode,
@@ -200,9 +193,9 @@ void Generic2::setup_opengl_for_draw_mode(const DrawMode& draw_mode,
     glDepthMask(GL_FALSE);
   }
 
-  glUniform1f(m_ogl.alpha_reject, alpha_reject);
-  glUniform1f(m_ogl.color_mult, color_mult);
-  glUniform4f(m_ogl.fog_color, render_state->fog_color[0] / 255.f,
+  glUniform1f(m_ogl->alpha_reject, alpha_reject);
+  glUniform1f(m_ogl->color_mult, color_mult);
+  glUniform4f(m_ogl->fog_color, render_state->fog_color[0] / 255.f,
               render_state->fog_color[1] / 255.f, render_state->fog_color[2] / 255.f,
               render_state->fog_intensity / 255);
 }
@@ -253,12 +246,12 @@ void Generic2::setup_opengl_tex(u16 unit,
   }
 
   if (render_state->version >= GameVersion::Jak2 && tbp_to_lookup == 1216) {
-    glUniform1ui(m_ogl.warp_sample_mode, 1);
+    glUniform1ui(m_ogl->warp_sample_mode, 1);
     // warp shader uses region clamp, which isn't supported by DrawMode.
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   } else {
-    glUniform1ui(m_ogl.warp_sample_mode, 0);
+    glUniform1ui(m_ogl->warp_sample_mode, 0);
   }
 }
 
@@ -273,8 +266,9 @@ void Generic2::do_draws_for_alpha(SharedRenderState* render_state,
       setup_opengl_for_draw_mode(first.mode, first.fix, render_state);
       setup_opengl_tex(0, first.tbp, first.mode.get_filt_enable(), first.mode.get_clamp_s_enable(),
                        first.mode.get_clamp_t_enable(), render_state);
-      glDrawElements(GL_TRIANGLE_STRIP, bucket.idx_count, GL_UNSIGNED_INT,
-                     (void*)(sizeof(u32) * bucket.idx_idx));
+      glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, bucket.idx_count, GL_UNSIGNED_INT,
+                               (void*)(m_index_offset + sizeof(u32) * bucket.idx_idx),
+                               m_base_vertex);
       prof.add_draw_call();
       prof.add_tri(bucket.tri_count);
     }
@@ -289,8 +283,9 @@ void Generic2::do_hud_draws(SharedRenderState* render_state, ScopedProfilerNode&
       setup_opengl_for_draw_mode(first.mode, first.fix, render_state);
       setup_opengl_tex(0, first.tbp, first.mode.get_filt_enable(), first.mode.get_clamp_s_enable(),
                        first.mode.get_clamp_t_enable(), render_state);
-      glDrawElements(GL_TRIANGLE_STRIP, bucket.idx_count, GL_UNSIGNED_INT,
-                     (void*)(sizeof(u32) * bucket.idx_idx));
+      glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, bucket.idx_count, GL_UNSIGNED_INT,
+                               (void*)(m_index_offset + sizeof(u32) * bucket.idx_idx),
+                               m_base_vertex);
       prof.add_draw_call();
       prof.add_tri(bucket.tri_count);
     }
@@ -298,22 +293,29 @@ void Generic2::do_hud_draws(SharedRenderState* render_state, ScopedProfilerNode&
 }
 
 void Generic2::do_draws(SharedRenderState* render_state, ScopedProfilerNode& prof) {
-  glBindVertexArray(m_ogl.vao);
-  glBindBuffer(GL_ARRAY_BUFFER, m_ogl.vertex_buffer);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ogl.index_buffer);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_next_free_idx * sizeof(u32), m_indices.data(),
-               GL_STREAM_DRAW);
-  glBufferData(GL_ARRAY_BUFFER, m_next_free_vert * sizeof(Vertex), m_verts.data(), GL_STREAM_DRAW);
+  auto* stream = render_state->streaming_buffer;
+  auto vertices = stream->upload(m_verts.data(), m_next_free_vert * sizeof(Vertex), sizeof(Vertex));
+  auto indices = stream->upload(m_indices.data(), m_next_free_idx * sizeof(u32), sizeof(u32));
+  m_base_vertex = vertices.offset / sizeof(Vertex);
+  m_index_offset = indices.offset;
+
+  glBindVertexArray(m_ogl->vao);
+  if (vertices.generation != m_ogl->vertex_buffer_generation) {
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+    opengl_setup_vertex_array();
+    m_ogl->vertex_buffer_generation = vertices.generation;
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
 
   glEnable(GL_PRIMITIVE_RESTART);
   glPrimitiveRestartIndex(UINT32_MAX);
 
   opengl_bind_and_setup_proj(render_state);
   if (m_drawing_config.uses_full_matrix) {
-    glUniform1i(m_ogl.use_full_matrix, 1);
-    glUniformMatrix4fv(m_ogl.full_matrix, 1, GL_FALSE, m_drawing_config.full_matrix[0].data());
+    glUniform1i(m_ogl->use_full_matrix, 1);
+    glUniformMatrix4fv(m_ogl->full_matrix, 1, GL_FALSE, m_drawing_config.full_matrix[0].data());
   } else {
-    glUniform1i(m_ogl.use_full_matrix, 0);
+    glUniform1i(m_ogl->use_full_matrix, 0);
   }
   constexpr DrawMode::AlphaBlend alpha_order[ALPHA_MODE_COUNT] = {
       DrawMode::AlphaBlend::SRC_0_FIX_DST,    DrawMode::AlphaBlend::SRC_SRC_SRC_SRC,
@@ -329,12 +331,12 @@ void Generic2::do_draws(SharedRenderState* render_state, ScopedProfilerNode& pro
   }
 
   if (m_drawing_config.uses_hud) {
-    glUniform4f(m_ogl.scale, m_drawing_config.hud_scale[0], m_drawing_config.hud_scale[1],
+    glUniform4f(m_ogl->scale, m_drawing_config.hud_scale[0], m_drawing_config.hud_scale[1],
                 m_drawing_config.hud_scale[2], 0);
-    glUniform1f(m_ogl.mat_23, m_drawing_config.hud_mat_23);
-    glUniform1f(m_ogl.mat_32, m_drawing_config.hud_mat_32);
-    glUniform1f(m_ogl.mat_33, m_drawing_config.hud_mat_33);
-    glUniform1i(m_ogl.gfx_hack_no_tex, false);
+    glUniform1f(m_ogl->mat_23, m_drawing_config.hud_mat_23);
+    glUniform1f(m_ogl->mat_32, m_drawing_config.hud_mat_32);
+    glUniform1f(m_ogl->mat_33, m_drawing_config.hud_mat_33);
+    glUniform1i(m_ogl->gfx_hack_no_tex, false);
 
     do_hud_draws(render_state, prof);
   }
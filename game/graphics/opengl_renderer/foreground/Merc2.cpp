@@ -10,6 +10,7 @@
 #include "common/util/fnv.h"
 
 #include "game/graphics/opengl_renderer/EyeRenderer.h"
+#include "game/graphics/opengl_renderer/StreamingBuffer.h"
 #include "game/graphics/opengl_renderer/background/background_common.h"
 
 #include "third-party/imgui/imgui.h"
@@ -62,6 +63,9 @@ Merc2::Merc2(ShaderLibrary& shaders, const std::vector<GLuint>* anim_slot_array)
   glGenVertexArrays(1, &m_vao);
   glBindVertexArray(m_vao);
 
+  // modified vertices are drawn from the streaming buffer, which is bound in do_draws.
+  glGenVertexArrays(1, &m_mod_vao);
+
   // Bone buffer to store skinning matrices for multiple draws
   glGenBuffers(1, &m_bones_buffer);
   glBindBuffer(GL_UNIFORM_BUFFER, m_bones_buffer);
@@ -108,11 +112,7 @@ Merc2::Merc2(ShaderLibrary& shaders, const std::vector<GLuint>* anim_slot_array)
 }
 
 Merc2::~Merc2() {
-  for (auto& x : m_mod_vtx_buffers) {
-    glDeleteBuffers(1, &x.vertex);
-    glDeleteVertexArrays(1, &x.vao);
-  }
-
+  glDeleteVertexArrays(1, &m_mod_vao);
   glDeleteBuffers(1, &m_bones_buffer);
   glDeleteVertexArrays(1, &m_vao);
 }
@@ -171,7 +171,7 @@ float blerc_multiplier = 1.f;
 
 void Merc2::model_mod_blerc_draws(int num_effects,
                                   const tfrag3::MercModel* model,
-                                  const LevelData* lev,
+                                  StreamingBuffer* stream,
                                   ModBuffers* mod_opengl_buffers,
                                   const float* blerc_weights,
                                   MercDebugStats* stats) {
@@ -183,10 +183,6 @@ void Merc2::model_mod_blerc_draws(int num_effects,
       continue;
     }
 
-    // grab opengl buffer
-    auto opengl_buffers = alloc_mod_vtx_buffer(lev);
-    mod_opengl_buffers[ei] = opengl_buffers;
-
     // check that we have enough room for the finished thing.
     if (effect.mod.vertices.size() > MAX_MOD_VTX) {
       fmt::print("More mod vertices than MAX_MOD_VTX. {} > {}\n", effect.mod.vertices.size(),
@@ -207,11 +203,7 @@ void Merc2::model_mod_blerc_draws(int num_effects,
     // and upload to GPU
     stats->num_uploads++;
     stats->num_upload_bytes += effect.mod.vertices.size() * sizeof(tfrag3::MercVertex);
-    {
-      glBindBuffer(GL_ARRAY_BUFFER, opengl_buffers.vertex);
-      glBufferData(GL_ARRAY_BUFFER, effect.mod.vertices.size() * sizeof(tfrag3::MercVertex),
-                   m_mod_vtx_temp.data(), GL_DYNAMIC_DRAW);
-    }
+    mod_opengl_buffers[ei] = upload_mod_vtx(stream, effect.mod.vertices.size());
   }
 }
 
@@ -222,7 +214,7 @@ void Merc2::model_mod_blerc_draws(int num_effects,
 
 void Merc2::model_mod_draws(int num_effects,
                             const tfrag3::MercModel* model,
-                            const LevelData* lev,
+                            StreamingBuffer* stream,
                             const u8* input_data,
                             const DmaTransfer& setup,
                             ModBuffers* mod_opengl_buffers,
@@ -238,10 +230,6 @@ void Merc2::model_mod_draws(int num_effects,
     }
 
     prof().begin_event("start1");
-    // grab opengl buffer
-    auto opengl_buffers = alloc_mod_vtx_buffer(lev);
-    mod_opengl_buffers[ei] = opengl_buffers;
-
     // check that we have enough room for the finished thing.
     if (effect.mod.vertices.size() > MAX_MOD_VTX) {
       fmt::print("More mod vertices than MAX_MOD_VTX. {} > {}\n", effect.mod.vertices.size(),
@@ -386,9 +374,7 @@ void Merc2::model_mod_draws(int num_effects,
     stats->num_upload_bytes += effect.mod.vertices.size() * sizeof(tfrag3::MercVertex);
     {
       auto pp = scoped_prof("update-verts-upload");
-      glBindBuffer(GL_ARRAY_BUFFER, opengl_buffers.vertex);
-      glBufferData(GL_ARRAY_BUFFER, effect.mod.vertices.size() * sizeof(tfrag3::MercVertex),
-                   m_mod_vtx_temp.data(), GL_DYNAMIC_DRAW);
+      mod_opengl_buffers[ei] = upload_mod_vtx(stream, effect.mod.vertices.size());
     }
   }
 }
@@ -574,9 +560,11 @@ void Merc2::handle_pc_model(const DmaTransfer& setup,
   // will hold opengl buffers for the updated vertices
   ModBuffers mod_opengl_buffers[kMaxEffect];
   if (model_uses_pc_blerc) {
-    model_mod_blerc_draws(num_effects, model, lev, mod_opengl_buffers, blerc_weights, stats);
+    model_mod_blerc_draws(num_effects, model, render_state->streaming_buffer, mod_opengl_buffers,
+                          blerc_weights, stats);
   } else if (model_uses_mod) {  // only if we've enabled, this path is slow.
-    model_mod_draws(num_effects, model, lev, input_data, setup, mod_opengl_buffers, stats);
+    model_mod_draws(num_effects, model, render_state->streaming_buffer, input_data, setup,
+                    mod_opengl_buffers, stats);
   }
 
   // stats
@@ -1039,19 +1027,14 @@ u32 Merc2::alloc_bones(int count, ShaderMercMat* data) {
   return first_bone_vector;
 }
 
-Merc2::ModBuffers Merc2::alloc_mod_vtx_buffer(const LevelData* lev) {
-  if (m_next_mod_vtx_buffer >= m_mod_vtx_buffers.size()) {
-    GLuint b;
-    glGenBuffers(1, &b);
-    GLuint vao;
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, b);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lev->merc_indices);
-    setup_merc_vao();
-    m_mod_vtx_buffers.push_back({vao, b});
-  }
-  return m_mod_vtx_buffers[m_next_mod_vtx_buffer++];
+/*!
+ * Upload the first vertex_count vertices of m_mod_vtx_temp. The vertices are drawn with the usual
+ * indices, offset by base_vertex.
+ */
+Merc2::ModBuffers Merc2::upload_mod_vtx(StreamingBuffer* stream, size_t vertex_count) {
+  auto alloc = stream->upload(m_mod_vtx_temp.data(), vertex_count * sizeof(tfrag3::MercVertex),
+                              sizeof(tfrag3::MercVertex));
+  return {alloc.buffer, alloc.generation, (u32)(alloc.offset / sizeof(tfrag3::MercVertex))};
 }
 
 Merc2::Draw* Merc2::try_alloc_envmap_draw(const tfrag3::MercDraw& mdraw,
@@ -1215,7 +1198,6 @@ void Merc2::flush_draw_buckets(SharedRenderState* render_state,
   m_next_free_light = 0;
   m_next_free_bone_vector = 0;
   m_next_free_level_bucket = 0;
-  m_next_mod_vtx_buffer = 0;
 }
 
 void Merc2::do_draws(const Draw* draw_array,
@@ -1234,10 +1216,17 @@ void Merc2::do_draws(const Draw* draw_array,
 
   for (u32 di = 0; di < num_draws; di++) {
     auto& draw = draw_array[di];
+    GLint base_vertex = 0;
     if (draw.flags & MOD_VTX) {
-      glBindVertexArray(draw.mod_vtx_buffer.vao);
+      glBindVertexArray(m_mod_vao);
+      if (draw.mod_vtx_buffer.generation != m_mod_vao_generation) {
+        glBindBuffer(GL_ARRAY_BUFFER, draw.mod_vtx_buffer.vertex);
+        setup_merc_vao();
+        m_mod_vao_generation = draw.mod_vtx_buffer.generation;
+      }
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lev->merc_indices);
       glBindBuffer(GL_ARRAY_BUFFER, lev->merc_vertices);
+      base_vertex = draw.mod_vtx_buffer.base_vertex;
       normal_vtx_buffer_bound = false;
     } else {
       if (!normal_vtx_buffer_bound) {
@@ -1334,15 +1323,17 @@ void Merc2::do_draws(const Draw* draw_array,
       math::Vector4f l1_dir_f(l1_dir.x(), l1_dir.y(), l1_dir.z(), 1);
       set_uniform(uniforms.light_direction[1], l1_dir_f);
       glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
-      glDrawElements(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP, draw.index_count,
-                     GL_UNSIGNED_INT, (void*)(sizeof(u32) * draw.first_index));
+      glDrawElementsBaseVertex(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP,
+                               draw.index_count, GL_UNSIGNED_INT,
+                               (void*)(sizeof(u32) * draw.first_index), base_vertex);
       // draw a
       setup_opengl_from_draw_mode(draw.mode, GL_TEXTURE0, use_mipmaps_for_filtering);
       math::Vector4f l1_dir_f_off(l1_dir.x(), l1_dir.y(), l1_dir.z(), -1);
       set_uniform(uniforms.light_direction[1], l1_dir_f_off);
       glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
-      glDrawElements(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP, draw.index_count,
-                     GL_UNSIGNED_INT, (void*)(sizeof(u32) * draw.first_index));
+      glDrawElementsBaseVertex(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP,
+                               draw.index_count, GL_UNSIGNED_INT,
+                               (void*)(sizeof(u32) * draw.first_index), base_vertex);
       glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
     } else {
@@ -1351,8 +1342,9 @@ void Merc2::do_draws(const Draw* draw_array,
       prof.add_tri(draw.num_triangles);
       glBindBufferRange(GL_UNIFORM_BUFFER, 1, m_bones_buffer,
                         sizeof(math::Vector4f) * draw.first_bone, 128 * sizeof(ShaderMercMat));
-      glDrawElements(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP, draw.index_count,
-                     GL_UNSIGNED_INT, (void*)(sizeof(u32) * draw.first_index));
+      glDrawElementsBaseVertex(draw.no_strip ? GL_TRIANGLES : GL_TRIANGLE_STRIP,
+                               draw.index_count, GL_UNSIGNED_INT,
+                               (void*)(sizeof(u32) * draw.first_index), base_vertex);
     }
   }
 
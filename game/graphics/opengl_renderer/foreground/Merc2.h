@@ -86,8 +86,11 @@ class Merc2 {
                        MercDebugStats* stats);
   u32 alloc_lights(const VuLights& lights);
 
+  // modified vertices for one effect, in the streaming buffer.
   struct ModBuffers {
-    GLuint vao, vertex;
+    GLuint vertex;
+    u32 generation;
+    u32 base_vertex;
   };
 
   static constexpr int kMaxEffect = 64;
@@ -157,8 +160,9 @@ class Merc2 {
 
   void setup_merc_vao();
 
-  std::vector<ModBuffers> m_mod_vtx_buffers;
-  u32 m_next_mod_vtx_buffer = 0;
+  // vertex array for drawing modified vertices. Set up again when the streaming buffer changes.
+  GLuint m_mod_vao;
+  u32 m_mod_vao_generation = 0;
 
   static constexpr int MAX_MOD_VTX = UINT16_MAX;
   std::vector<tfrag3::MercVertex> m_mod_vtx_temp;
@@ -170,7 +174,7 @@ class Merc2 {
   };
   std::vector<UnpackTempVtx> m_mod_vtx_unpack_temp;
 
-  ModBuffers alloc_mod_vtx_buffer(const LevelData* lev);
+  ModBuffers upload_mod_vtx(StreamingBuffer* stream, size_t vertex_count);
 
   GLuint m_bones_buffer;
 
@@ -251,14 +255,14 @@ class Merc2 {
                           MercDebugStats* stats);
   void model_mod_draws(int num_effects,
                        const tfrag3::MercModel* model,
-                       const LevelData* lev,
+                       StreamingBuffer* stream,
                        const u8* input_data,
                        const DmaTransfer& setup,
                        ModBuffers* mod_opengl_buffers,
                        MercDebugStats* stats);
   void model_mod_blerc_draws(int num_effects,
                              const tfrag3::MercModel* model,
-                             const LevelData* lev,
+                             StreamingBuffer* stream,
                              ModBuffers* mod_opengl_buffers,
                              const float* blerc_weights,
                              MercDebugStats* stats);
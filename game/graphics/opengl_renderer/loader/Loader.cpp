@@ -89,6 +89,16 @@ void Loader::set_active_levels(const std::vector<std::string>& levels) {
   m_active_levels = levels;
 }
 
+std::vector<std::string> Loader::get_want_levels() {
+  std::unique_lock<std::mutex> lk(m_loader_mutex);
+  return m_desired_levels;
+}
+
+std::vector<std::string> Loader::get_active_levels() {
+  std::unique_lock<std::mutex> lk(m_loader_mutex);
+  return m_active_levels;
+}
+
 /*!
  * Get all levels that are in memory and used very recently.
  */
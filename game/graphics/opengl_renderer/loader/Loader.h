@@ -24,6 +24,8 @@ class Loader {
   const tfrag3::Level& load_common(TexturePool& tex_pool, const std::string& name);
   void set_want_levels(const std::vector<std::string>& levels);
   void set_active_levels(const std::vector<std::string>& levels);
+  std::vector<std::string> get_want_levels();
+  std::vector<std::string> get_active_levels();
   std::vector<LevelData*> get_in_use_levels();
   void draw_debug_window();
   void debug_print_loaded_levels();
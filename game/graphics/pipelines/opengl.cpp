@@ -11,6 +11,7 @@
 #include <sstream>
 
 #include "common/dma/dma_copy.h"
+#include "common/global_profiler/FrameTimings.h"
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/goal_constants.h"
 #include "common/log/log.h"
@@ -21,10 +22,12 @@
 
 #include "game/graphics/display.h"
 #include "game/graphics/gfx.h"
+#include "game/graphics/opengl_renderer/FrameCapture.h"
 #include "game/graphics/opengl_renderer/OpenGLRenderer.h"
 #include "game/graphics/opengl_renderer/debug_gui.h"
 #include "game/graphics/screenshot.h"
 #include "game/graphics/texture/TexturePool.h"
+#include "game/kernel/common/kmachine.h"
 #include "game/runtime.h"
 #include "game/sce/libscf.h"
 #include "game/system/hid/input_manager.h"
@@ -71,6 +74,11 @@ struct GraphicsData {
   // temporary opengl renderer
   OpenGLRenderer ogl_renderer;
 
+  // frames for render_replay. The request is set by the debug menu, and the capture is taken by
+  // the game thread in gl_send_chain. Both are guarded by dma_mutex.
+  int frame_capture_request = 0;
+  std::unique_ptr<FrameCaptureWriter> frame_capture;
+
   OpenGlDebugGui debug_gui;
 
   FrameLimiter frame_limiter;
@@ -381,6 +389,9 @@ void render_game_frame(int game_width,
   {
     auto p = scoped_prof("wait-for-dma");
     std::unique_lock<std::mutex> lock(g_gfx_data->dma_mutex);
+    if (int frames = g_gfx_data->debug_gui.get_frame_capture_request()) {
+      g_gfx_data->frame_capture_request = frames;
+    }
     // there's a timeout here, so imgui can still be responsive even if we don't render anything
     got_chain = g_gfx_data->dma_cv.wait_for(lock, std::chrono::milliseconds(40),
                                             [=] { return g_gfx_data->has_data_to_render; });
@@ -647,6 +658,8 @@ u32 gl_sync_path() {
   }
   std::unique_lock<std::mutex> lock(g_gfx_data->sync_mutex);
   g_gfx_data->last_engine_time = g_gfx_data->engine_timer.getSeconds();
+  static const int timing_channel = frame_timings().channel("ee");
+  frame_timings().record(timing_channel, g_gfx_data->last_engine_time * 1000.f);
   if (!g_gfx_data->has_data_to_render) {
     return 0;
   }
@@ -683,6 +696,26 @@ void gl_send_chain(const void* data, u32 offset) {
 
     g_gfx_data->dma_copier.set_input_data(data, offset, run_dma_copy);
 
+    // frame captures are taken here, before the game continues, so the EE memory and the chain are
+    // from the same frame. Once we return, the game runs the next frame while this one renders.
+    if (g_gfx_data->frame_capture_request && !g_gfx_data->frame_capture) {
+      g_gfx_data->frame_capture = std::make_unique<FrameCaptureWriter>(
+          make_frame_capture_path(g_gfx_data->version), g_gfx_data->version, g_ee_main_mem,
+          offset_of_s7(), g_gfx_data->frame_capture_request);
+    }
+    g_gfx_data->frame_capture_request = 0;
+    if (g_gfx_data->frame_capture) {
+      auto& copier = g_gfx_data->dma_copier;
+      if constexpr (!run_dma_copy) {
+        copier.run(data, offset);
+      }
+      if (g_gfx_data->frame_capture->add_frame(copier, g_gfx_data->loader->get_want_levels(),
+                                               g_gfx_data->loader->get_active_levels(),
+                                               g_gfx_data->pmode_alp)) {
+        g_gfx_data->frame_capture.reset();
+      }
+    }
+
     g_gfx_data->has_data_to_render = true;
     g_gfx_data->dma_cv.notify_all();
   }
@@ -0,0 +1,472 @@
+/*!
+ * @file kboot_image.cpp
+ * Saving and restoring snapshots of the EE heaps after boot. See kboot_image.h.
+ */
+
+#include "kboot_image.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "common/goal_constants.h"
+#include "common/log/log.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+#include "common/versions/versions.h"
+
+#include "game/kernel/common/kboot.h"
+#include "game/mips2c/mips2c_table.h"
+#include "game/runtime.h"
+
+namespace boot_image {
+namespace {
+
+constexpr u32 BOOT_IMAGE_MAGIC = 0x49424f47;  // "GOBI"
+// increment this if the layout of the file, or what is stored in it, changes.
+constexpr u32 BOOT_IMAGE_VERSION = 1;
+
+struct BootImageHeader {
+  u32 magic;
+  u32 version;
+  u32 game_version;
+  u32 pad;
+  u64 host_anchor;         //! address of a function in the executable, to relocate host pointers
+  u64 layout_fingerprint;  //! distance between two functions, to detect a different executable
+};
+
+std::string g_boot_image_path;
+
+// EE offsets of 8-byte host pointers stored in EE memory (inside C function trampolines).
+std::vector<u32> g_host_pointers;
+// objects which ran mips2c link callbacks.
+std::vector<std::string> g_mips2c_objects;
+
+u64 host_anchor() {
+  return (u64)&init_globals;
+}
+
+u64 layout_fingerprint() {
+  return (u64)&exec_runtime - (u64)&init_globals;
+}
+
+/*!
+ * Settings which change what ends up in memory during boot. The boot image can only be used if
+ * these all match.
+ */
+std::string boot_config_key() {
+  return fmt::format("{} {} {} {} {} {} {}", build_revision(), DiskBoot, MasterDebug, DebugSegment,
+                     DebugBootLevel, DebugBootMessage, file_util::get_user_config_dir().string());
+}
+
+/*!
+ * Identify a source file by size and modification time. Checking this is much cheaper than hashing
+ * the contents, which would defeat the purpose of skipping the load.
+ */
+std::string source_file_stamp(const std::string& path) {
+  std::error_code ec;
+  auto size = fs::file_size(path, ec);
+  if (ec) {
+    return "";
+  }
+  auto mtime = fs::last_write_time(path, ec);
+  if (ec) {
+    return "";
+  }
+  return fmt::format("{} {} {}", path, size, (s64)mtime.time_since_epoch().count());
+}
+
+bool source_file_stamps(const std::vector<std::string>& source_files,
+                        std::vector<std::string>* out) {
+  for (auto& file : source_files) {
+    auto stamp = source_file_stamp(file);
+    if (stamp.empty()) {
+      lg::warn("[boot image] could not find {}", file);
+      return false;
+    }
+    out->push_back(stamp);
+  }
+  return true;
+}
+
+class Writer {
+ public:
+  explicit Writer(FILE* fp) : m_fp(fp) {}
+
+  template <typename T>
+  void add(const T& obj) {
+    add_data(&obj, sizeof(T));
+  }
+
+  void add_data(const void* data, size_t size) {
+    if (m_ok && size && fwrite(data, size, 1, m_fp) != 1) {
+      m_ok = false;
+    }
+  }
+
+  void add_str(const std::string& str) {
+    add<u32>(str.size());
+    add_data(str.data(), str.size());
+  }
+
+  bool ok() const { return m_ok; }
+
+ private:
+  FILE* m_fp = nullptr;
+  bool m_ok = true;
+};
+
+class Reader {
+ public:
+  explicit Reader(FILE* fp) : m_fp(fp) {}
+
+  template <typename T>
+  T read() {
+    T obj{};
+    read_data(&obj, sizeof(T));
+    return obj;
+  }
+
+  void read_data(void* data, size_t size) {
+    if (!m_ok || !size) {
+      return;
+    }
+    if (fread(data, size, 1, m_fp) != 1) {
+      m_ok = false;
+      memset(data, 0, size);
+    }
+  }
+
+  u32 read_count() {
+    auto count = read<u32>();
+    // nothing we store is anywhere near this, so this is a corrupt file.
+    if (count > (1 << 20)) {
+      m_ok = false;
+      return 0;
+    }
+    return count;
+  }
+
+  std::string read_str() {
+    auto size = read<u32>();
+    // nothing we store is anywhere near this, so this is a corrupt file.
+    if (size > 4096) {
+      m_ok = false;
+      return "";
+    }
+    std::string result(size, '\0');
+    read_data(result.data(), size);
+    return result;
+  }
+
+  bool ok() const { return m_ok; }
+
+ private:
+  FILE* m_fp = nullptr;
+  bool m_ok = true;
+};
+
+bool in_regions(u32 addr, u32 size, const std::vector<Region>& regions) {
+  for (auto& r : regions) {
+    if (addr >= r.start && addr + size <= r.end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+void init_globals() {
+  g_host_pointers.clear();
+  g_mips2c_objects.clear();
+}
+
+/*!
+ * Set the boot image file. An empty path disables boot images.
+ */
+void set_path(const std::string& path) {
+  g_boot_image_path = path;
+}
+
+bool enabled() {
+  return !g_boot_image_path.empty();
+}
+
+/*!
+ * Remember that there is a host pointer at this location in EE memory, so it can be relocated if
+ * the executable is loaded at a different address.
+ */
+void note_host_pointer(const void* ee_location) {
+  g_host_pointers.push_back((const u8*)ee_location - g_ee_main_mem);
+}
+
+/*!
+ * Remember that an object ran its mips2c link callbacks, so they can be run again after a restore.
+ */
+void note_mips2c_object(const char* object_name) {
+  g_mips2c_objects.push_back(object_name);
+}
+
+/*!
+ * Write the given EE memory regions and globals to the boot image file.
+ */
+bool save(const std::vector<Region>& regions,
+          const std::vector<Global>& globals,
+          const std::vector<std::string>& source_files) {
+  Timer timer;
+  std::vector<std::string> stamps;
+  if (!source_file_stamps(source_files, &stamps)) {
+    return false;
+  }
+
+  for (auto& r : regions) {
+    ASSERT(r.start >= EE_MAIN_MEM_LOW_PROTECT && r.start <= r.end && r.end <= EE_MAIN_MEM_SIZE);
+  }
+
+  // host pointers outside of the saved regions are in memory that was freed and don't matter.
+  std::vector<u32> host_pointers;
+  for (auto offset : g_host_pointers) {
+    if (in_regions(offset, sizeof(u64), regions)) {
+      host_pointers.push_back(offset);
+    }
+  }
+
+  // write to a temporary file first, so a crash or a parallel launch never sees half a boot image.
+  auto tmp_path = g_boot_image_path + ".tmp";
+  FILE* fp = file_util::open_file(tmp_path, "wb");
+  if (!fp) {
+    lg::warn("[boot image] failed to open {} for writing", tmp_path);
+    return false;
+  }
+
+  Writer w(fp);
+  BootImageHeader header;
+  header.magic = BOOT_IMAGE_MAGIC;
+  header.version = BOOT_IMAGE_VERSION;
+  header.game_version = (u32)g_game_version;
+  header.pad = 0;
+  header.host_anchor = host_anchor();
+  header.layout_fingerprint = layout_fingerprint();
+  w.add(header);
+  w.add_str(boot_config_key());
+
+  w.add<u32>(stamps.size());
+  for (auto& stamp : stamps) {
+    w.add_str(stamp);
+  }
+
+  w.add<u32>(globals.size());
+  for (auto& g : globals) {
+    w.add_str(g.name);
+    w.add<u32>(g.size);
+    w.add_data(g.data, g.size);
+  }
+
+  w.add<u32>(host_pointers.size());
+  for (auto offset : host_pointers) {
+    w.add<u32>(offset);
+  }
+
+  auto trampolines = Mips2C::gLinkedFunctionTable.trampolines();
+  w.add<u32>(trampolines.size());
+  for (auto& [name, offset] : trampolines) {
+    w.add_str(name);
+    w.add<u32>(offset);
+  }
+
+  w.add<u32>(g_mips2c_objects.size());
+  for (auto& name : g_mips2c_objects) {
+    w.add_str(name);
+  }
+
+  u64 total_size = 0;
+  w.add<u32>(regions.size());
+  for (auto& r : regions) {
+    w.add(r);
+  }
+  for (auto& r : regions) {
+    w.add_data(g_ee_main_mem + r.start, r.end - r.start);
+    total_size += r.end - r.start;
+  }
+
+  bool ok = w.ok();
+  fclose(fp);
+  if (!ok) {
+    lg::warn("[boot image] failed to write {}", tmp_path);
+    fs::remove(tmp_path);
+    return false;
+  }
+
+  std::error_code ec;
+  fs::rename(tmp_path, g_boot_image_path, ec);
+  if (ec) {
+    lg::warn("[boot image] failed to rename {}: {}", tmp_path, ec.message());
+    fs::remove(tmp_path);
+    return false;
+  }
+
+  lg::info("[boot image] saved {:.2f} MB in {} regions to {} in {:.2f} ms",
+           (double)total_size / (1 << 20), regions.size(), g_boot_image_path, timer.getMs());
+  return true;
+}
+
+/*!
+ * Load the boot image file, if it is valid for this executable, game and settings.
+ * On success, EE memory and the globals are overwritten, host pointers are relocated, and mips2c
+ * functions are linked again. On failure nothing is modified and the normal boot should be used.
+ */
+bool restore(const std::vector<Global>& globals, const std::vector<std::string>& source_files) {
+  Timer timer;
+  if (!fs::exists(g_boot_image_path)) {
+    lg::info("[boot image] {} does not exist, doing a normal boot", g_boot_image_path);
+    return false;
+  }
+
+  std::vector<std::string> stamps;
+  if (!source_file_stamps(source_files, &stamps)) {
+    return false;
+  }
+
+  FILE* fp = file_util::open_file(g_boot_image_path, "rb");
+  if (!fp) {
+    lg::warn("[boot image] failed to open {}", g_boot_image_path);
+    return false;
+  }
+
+  auto reject = [&](const std::string& reason) {
+    lg::warn("[boot image] not using {}: {}", g_boot_image_path, reason);
+    fclose(fp);
+    return false;
+  };
+
+  Reader r(fp);
+  auto header = r.read<BootImageHeader>();
+  if (!r.ok() || header.magic != BOOT_IMAGE_MAGIC) {
+    return reject("not a boot image");
+  }
+  if (header.version != BOOT_IMAGE_VERSION) {
+    return reject(fmt::format("version {}, expected {}", header.version, BOOT_IMAGE_VERSION));
+  }
+  if (header.game_version != (u32)g_game_version) {
+    return reject("created for a different game");
+  }
+  if (header.layout_fingerprint != layout_fingerprint()) {
+    return reject("created by a different executable");
+  }
+  if (r.read_str() != boot_config_key()) {
+    return reject("created with different settings");
+  }
+
+  auto stamp_count = r.read<u32>();
+  if (stamp_count != stamps.size()) {
+    return reject("created with different source files");
+  }
+  for (auto& stamp : stamps) {
+    if (r.read_str() != stamp) {
+      return reject(fmt::format("source file changed ({})", stamp));
+    }
+  }
+
+  // read everything except EE memory first, so we can still fall back to a normal boot.
+  auto global_count = r.read<u32>();
+  if (global_count != globals.size()) {
+    return reject("different kernel globals");
+  }
+  std::vector<std::vector<u8>> global_data(globals.size());
+  for (size_t i = 0; i < globals.size(); i++) {
+    if (r.read_str() != globals[i].name || r.read<u32>() != globals[i].size) {
+      return reject(fmt::format("different kernel global {}", globals[i].name));
+    }
+    global_data[i].resize(globals[i].size);
+    r.read_data(global_data[i].data(), globals[i].size);
+  }
+
+  std::vector<u32> host_pointers(r.read_count());
+  for (auto& offset : host_pointers) {
+    offset = r.read<u32>();
+  }
+
+  std::vector<std::pair<std::string, u32>> trampolines(r.read_count());
+  for (auto& [name, offset] : trampolines) {
+    name = r.read_str();
+    offset = r.read<u32>();
+  }
+
+  std::vector<std::string> mips2c_objects(r.read_count());
+  for (auto& name : mips2c_objects) {
+    name = r.read_str();
+  }
+
+  std::vector<Region> regions(r.read_count());
+  u64 total_size = 0;
+  for (auto& region : regions) {
+    region = r.read<Region>();
+    if (region.start < EE_MAIN_MEM_LOW_PROTECT || region.start > region.end ||
+        region.end > EE_MAIN_MEM_SIZE) {
+      return reject("invalid memory region");
+    }
+    total_size += region.end - region.start;
+  }
+
+  for (auto offset : host_pointers) {
+    if (!in_regions(offset, sizeof(u64), regions)) {
+      return reject("invalid host pointer");
+    }
+  }
+
+  if (!r.ok()) {
+    return reject("file is truncated");
+  }
+
+  // make sure all of the memory is there before we start overwriting things.
+  auto data_start = ftell(fp);
+  fseek(fp, 0, SEEK_END);
+  auto file_size = ftell(fp);
+  if (data_start < 0 || file_size < 0 || (u64)(file_size - data_start) != total_size) {
+    return reject("file is truncated");
+  }
+  fseek(fp, data_start, SEEK_SET);
+
+  // past this point, we can't go back to a normal boot.
+  for (auto& region : regions) {
+    r.read_data(g_ee_main_mem + region.start, region.end - region.start);
+  }
+  fclose(fp);
+  ASSERT_MSG(r.ok(), fmt::format("Failed to read boot image {}", g_boot_image_path));
+
+  for (size_t i = 0; i < globals.size(); i++) {
+    memcpy(globals[i].data, global_data[i].data(), globals[i].size);
+  }
+
+  // the executable may be loaded at a different address (ASLR), but everything in it moves by the
+  // same amount.
+  u64 slide = host_anchor() - header.host_anchor;
+  for (auto offset : host_pointers) {
+    u64 ptr;
+    memcpy(&ptr, g_ee_main_mem + offset, sizeof(u64));
+    ptr += slide;
+    memcpy(g_ee_main_mem + offset, &ptr, sizeof(u64));
+  }
+  g_host_pointers = std::move(host_pointers);
+
+  // mips2c functions keep pointers to GOAL symbols on the C++ side, so their link callbacks need to
+  // run again. The trampolines already exist in GOAL memory and are reused.
+  for (auto& [name, offset] : trampolines) {
+    Mips2C::gLinkedFunctionTable.reuse_trampoline(name, offset);
+  }
+  for (auto& name : mips2c_objects) {
+    const auto& it = Mips2C::gMips2CLinkCallbacks[g_game_version].find(name);
+    if (it != Mips2C::gMips2CLinkCallbacks[g_game_version].end()) {
+      for (auto& x : it->second) {
+        x();
+      }
+    }
+  }
+  g_mips2c_objects = std::move(mips2c_objects);
+
+  lg::info("[boot image] restored {:.2f} MB in {} regions from {} in {:.2f} ms",
+           (double)total_size / (1 << 20), regions.size(), g_boot_image_path, timer.getMs());
+  return true;
+}
+
+}  // namespace boot_image
@@ -0,0 +1,55 @@
+#pragma once
+
+/*!
+ * @file kboot_image.h
+ * Added in the PC port.
+ *
+ * A "boot image" is a snapshot of the EE heaps and the C kernel globals, taken after the kernel and
+ * engine have been loaded and linked, right before "play" is called. Later launches with the same
+ * executable, arguments and CGO files can restore it instead of loading and linking through the
+ * DGO/RPC path.
+ *
+ * Only state that the C kernel knows about is captured: EE memory, the registered globals, the
+ * host pointers inside C function trampolines and the mips2c functions. Side effects of the
+ * engine's top-level code on the IOP or the renderer are not replayed, so this is meant for
+ * automated runs where startup time matters more than a faithful boot.
+ */
+
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace boot_image {
+
+/*!
+ * A range of EE memory [start, end) to store in the boot image.
+ */
+struct Region {
+  u32 start = 0;
+  u32 end = 0;
+};
+
+/*!
+ * A C kernel global to store in the boot image. It is copied byte-for-byte, so it must not contain
+ * host pointers.
+ */
+struct Global {
+  const char* name = nullptr;
+  void* data = nullptr;
+  u32 size = 0;
+};
+
+void init_globals();
+void set_path(const std::string& path);
+bool enabled();
+
+void note_host_pointer(const void* ee_location);
+void note_mips2c_object(const char* object_name);
+
+bool save(const std::vector<Region>& regions,
+          const std::vector<Global>& globals,
+          const std::vector<std::string>& source_files);
+bool restore(const std::vector<Global>& globals, const std::vector<std::string>& source_files);
+
+}  // namespace boot_image
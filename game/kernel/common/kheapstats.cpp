@@ -0,0 +1,254 @@
+#include "kheapstats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/goal_constants.h"
+#include "common/log/log.h"
+#include "common/symbols.h"
+
+#include "game/kernel/common/Ptr.h"
+#include "game/kernel/common/kboot.h"
+#include "game/kernel/common/kprint.h"
+#include "game/kernel/common/kscheme.h"
+
+#include "fmt/core.h"
+#include "third-party/json.hpp"
+
+bool g_alloc_stats_enabled = false;
+
+namespace {
+const char* heap_names[(int)AllocHeap::NUM_HEAPS] = {
+    "global", "debug", "process-level-heap", "loading-level", "process", "scratch", "stack"};
+
+struct AllocCounter {
+  u64 count = 0;
+  u64 bytes = 0;
+  u64 failed = 0;
+};
+
+u64 counter_key(AllocHeap heap, u32 type) {
+  return ((u64)heap << 32) | type;
+}
+
+struct AllocStats {
+  const char* (*type_name)(u32 type) = nullptr;
+  // by counter_key
+  std::unordered_map<u64, AllocCounter> totals;
+  std::unordered_map<u64, AllocCounter> totals_at_last_snapshot;
+  // every sample_interval-th allocation, by counter_key and the function or process that did it
+  std::map<std::pair<u64, std::string>, AllocCounter> samples;
+  u32 sample_interval = 0;
+  u32 until_next_sample = 0;
+  u32 snapshot_frames = 0;
+  u32 frame = 0;
+  std::string file_name;
+};
+
+AllocStats g_stats;
+
+std::string row_name(u64 key) {
+  u32 type = key & UINT32_MAX;
+  return fmt::format("{} {}", heap_names[key >> 32], type ? g_stats.type_name(type) : "(untyped)");
+}
+
+/*!
+ * The innermost profiled function that hasn't returned yet, if function tracing is running (see
+ * ktrace.h). Otherwise, the name of the process, if the allocation is for a process.
+ */
+std::string allocation_owner(u32 pp) {
+  auto info = Ptr<FunctionTraceInfo>(FUNCTION_TRACE_INFO_ADDR).c();
+  if (info->mask) {
+    auto entries = Ptr<FunctionTraceEntry>(info->buffer).c();
+    const u32 count = std::min({info->next, info->mask + 1, 256u});
+    int depth = 0;
+    for (u32 i = 0; i < count; i++) {
+      const auto& entry = entries[(info->next - 1 - i) & info->mask];
+      if (entry.kind == (u32)FunctionTraceEvent::EXIT) {
+        depth++;
+      } else if (depth-- == 0) {
+        return Ptr<String>(entry.name).c()->data();
+      }
+    }
+  }
+
+  if (pp && pp != UNKNOWN_PP) {
+    // process-tree's name is the first field in all games.
+    u32 name = *Ptr<u32>(pp);
+    if ((name & 7) == BASIC_OFFSET && name < EE_MAIN_MEM_SIZE - 64) {
+      const char* data = Ptr<String>(name).c()->data();
+      return fmt::format("process {}", std::string(data, strnlen(data, 64)));
+    }
+  }
+  return "?";
+}
+
+/*!
+ * Counters sorted by bytes, largest first.
+ */
+template <typename Key>
+std::vector<std::pair<Key, AllocCounter>> sorted_by_bytes(
+    const std::vector<std::pair<Key, AllocCounter>>& rows) {
+  auto result = rows;
+  std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+    return a.second.bytes != b.second.bytes ? a.second.bytes > b.second.bytes : a.first < b.first;
+  });
+  return result;
+}
+
+void write_snapshot() {
+  std::vector<std::pair<u64, AllocCounter>> growth;
+  for (const auto& [key, total] : g_stats.totals) {
+    AllocCounter delta = total;
+    auto prev = g_stats.totals_at_last_snapshot.find(key);
+    if (prev != g_stats.totals_at_last_snapshot.end()) {
+      delta.count -= prev->second.count;
+      delta.bytes -= prev->second.bytes;
+      delta.failed -= prev->second.failed;
+    }
+    if (delta.count || delta.failed) {
+      growth.emplace_back(key, delta);
+    }
+  }
+  growth = sorted_by_bytes(growth);
+  g_stats.totals_at_last_snapshot = g_stats.totals;
+
+  if (g_stats.file_name.empty()) {
+    u64 bytes = 0, count = 0, failed = 0;
+    for (const auto& [key, delta] : growth) {
+      bytes += delta.bytes;
+      count += delta.count;
+      failed += delta.failed;
+    }
+    cprintf("alloc stats frame %d: %lld KB in %lld allocations (%lld failed)\n", g_stats.frame,
+            (long long)(bytes / 1024), (long long)count, (long long)failed);
+    for (size_t i = 0; i < std::min(growth.size(), (size_t)10); i++) {
+      const auto& [key, delta] = growth[i];
+      cprintf("  %8lld KB %6lld %s\n", (long long)(delta.bytes / 1024), (long long)delta.count,
+              row_name(key).c_str());
+    }
+    return;
+  }
+
+  nlohmann::json snapshot;
+  snapshot["frame"] = g_stats.frame;
+  auto& rows = snapshot["growth"];
+  rows = nlohmann::json::array();
+  for (const auto& [key, delta] : growth) {
+    rows.push_back({{"heap", heap_names[key >> 32]},
+                    {"type", (key & UINT32_MAX) ? g_stats.type_name(key & UINT32_MAX) : ""},
+                    {"count", delta.count},
+                    {"bytes", delta.bytes},
+                    {"failed", delta.failed}});
+  }
+  std::ofstream out(g_stats.file_name, std::ios::app);
+  out << snapshot.dump() << '\n';
+}
+}  // namespace
+
+/*!
+ * Called at startup with a function to look up the name of a type, which is different per game.
+ */
+void init_alloc_stats(const char* (*type_name)(u32 type)) {
+  g_alloc_stats_enabled = false;
+  g_stats = AllocStats();
+  g_stats.type_name = type_name;
+}
+
+void alloc_stats_record(AllocHeap heap, u32 type, s32 size, u32 pp, bool ok) {
+  const u64 key = counter_key(heap, type);
+  const u32 aligned_size = (size + 15) & ~15;
+  auto& counter = g_stats.totals[key];
+  if (ok) {
+    counter.count++;
+    counter.bytes += aligned_size;
+  } else {
+    counter.failed++;
+  }
+
+  if (g_stats.sample_interval && !g_stats.until_next_sample--) {
+    g_stats.until_next_sample = g_stats.sample_interval - 1;
+    auto& sample = g_stats.samples[{key, allocation_owner(pp)}];
+    if (ok) {
+      sample.count++;
+      sample.bytes += aligned_size;
+    } else {
+      sample.failed++;
+    }
+  }
+}
+
+/*!
+ * Called once per frame, writes a snapshot every snapshot_frames frames.
+ */
+void alloc_stats_frame() {
+  if (!g_alloc_stats_enabled) {
+    return;
+  }
+  g_stats.frame++;
+  if (g_stats.snapshot_frames && g_stats.frame % g_stats.snapshot_frames == 0) {
+    write_snapshot();
+  }
+}
+
+/*!
+ * Clear the counters and start counting allocations. If sample_interval isn't 0, every
+ * sample_interval-th allocation also records which function or process made it. If snapshot_frames
+ * isn't 0, print what grew to the listener every snapshot_frames frames, or append it as a line of
+ * JSON to file_name if it isn't #f.
+ */
+u64 pc_alloc_stats_start(u32 sample_interval, u32 snapshot_frames, u32 file_name) {
+  auto type_name = g_stats.type_name;
+  g_stats = AllocStats();
+  g_stats.type_name = type_name;
+  g_stats.sample_interval = sample_interval;
+  g_stats.snapshot_frames = snapshot_frames;
+  if (file_name != s7.offset) {
+    g_stats.file_name = Ptr<String>(file_name).c()->data();
+    // each start writes a new file.
+    std::ofstream out(g_stats.file_name, std::ios::trunc);
+    if (!out) {
+      lg::error("Unable to open allocation stats file {}", g_stats.file_name);
+      return s7.offset;
+    }
+  }
+  g_alloc_stats_enabled = true;
+  return s7.offset + true_symbol_offset(g_game_version);
+}
+
+void pc_alloc_stats_stop() {
+  g_alloc_stats_enabled = false;
+}
+
+/*!
+ * Print the totals since pc-alloc-stats-start to the listener, and the top sampled allocators.
+ */
+void pc_alloc_stats_print(u32 max_rows) {
+  std::vector<std::pair<u64, AllocCounter>> totals(g_stats.totals.begin(), g_stats.totals.end());
+  totals = sorted_by_bytes(totals);
+  cprintf("allocations by heap and type over %d frames:\n", g_stats.frame);
+  cprintf("  %8s %8s %6s\n", "KB", "count", "failed");
+  for (size_t i = 0; i < std::min(totals.size(), (size_t)max_rows); i++) {
+    const auto& [key, total] = totals[i];
+    cprintf("  %8lld %8lld %6lld %s\n", (long long)(total.bytes / 1024), (long long)total.count,
+            (long long)total.failed, row_name(key).c_str());
+  }
+
+  if (g_stats.sample_interval) {
+    std::vector<std::pair<std::pair<u64, std::string>, AllocCounter>> samples(
+        g_stats.samples.begin(), g_stats.samples.end());
+    samples = sorted_by_bytes(samples);
+    cprintf("sampled allocations (1 in %d):\n", g_stats.sample_interval);
+    for (size_t i = 0; i < std::min(samples.size(), (size_t)max_rows); i++) {
+      const auto& [key, sample] = samples[i];
+      cprintf("  %8lld %8lld %6lld %s from %s\n", (long long)(sample.bytes / 1024),
+              (long long)sample.count, (long long)sample.failed, row_name(key.first).c_str(),
+              key.second.c_str());
+    }
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*!
+ * @file kheapstats.h
+ * Optional allocation counters, by heap and GOAL type. Each game's alloc_from_heap reports here
+ * when they are enabled with pc-alloc-stats-start. Snapshots of what grew since the last one can
+ * be printed to the listener or appended to a file every few frames.
+ */
+
+#include "common/common_types.h"
+
+enum class AllocHeap : u8 {
+  GLOBAL,
+  DEBUG,
+  PROCESS_LEVEL,
+  LOADING_LEVEL,
+  PROCESS,
+  SCRATCH,
+  STACK,
+  NUM_HEAPS
+};
+
+// checked before calling alloc_stats_record, so allocation is unchanged when stats are off.
+extern bool g_alloc_stats_enabled;
+
+void init_alloc_stats(const char* (*type_name)(u32 type));
+void alloc_stats_record(AllocHeap heap, u32 type, s32 size, u32 pp, bool ok);
+void alloc_stats_frame();
+
+u64 pc_alloc_stats_start(u32 sample_interval, u32 snapshot_frames, u32 file_name);
+void pc_alloc_stats_stop();
+void pc_alloc_stats_print(u32 max_rows);
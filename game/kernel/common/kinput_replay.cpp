@@ -0,0 +1,362 @@
+/*!
+ * @file kinput_replay.cpp
+ * Recording and replaying the game's inputs. See kinput_replay.h.
+ */
+
+#include "kinput_replay.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/FileUtil.h"
+
+#include "game/kernel/common/kboot.h"
+#include "game/kernel/common/kernel_types.h"
+#include "game/runtime.h"
+
+namespace input_replay {
+namespace {
+
+constexpr u32 INPUT_REPLAY_MAGIC = 0x52494f47;  // "GOIR"
+// increment this if the layout of the file, or what is stored in it, changes.
+constexpr u32 INPUT_REPLAY_VERSION = 1;
+
+struct InputReplayHeader {
+  u32 magic;
+  u32 version;
+  u32 game_version;
+  u32 pad;
+};
+
+// after the header, the file is a list of events. Each is a tag byte and its data.
+enum class Event : u8 {
+  FRAME = 0,     // no data
+  PAD = 1,       // port, then the pad bytes
+  PAD_SAME = 2,  // port. Same pad bytes as the last read of this port
+  MOUSE = 3,     // u16 buttons, float x, float y
+  TIMER = 4,     // increase since the last timer read, as a varint
+  RAND = 5,      // u32
+};
+
+const char* event_name(Event event) {
+  switch (event) {
+    case Event::FRAME:
+      return "end of frame";
+    case Event::PAD:
+    case Event::PAD_SAME:
+      return "pad";
+    case Event::MOUSE:
+      return "mouse";
+    case Event::TIMER:
+      return "timer";
+    case Event::RAND:
+      return "rand";
+    default:
+      return "unknown";
+  }
+}
+
+// the bytes of CPadInfo filled in by scePadRead: buttons, sticks and pressures.
+constexpr size_t PAD_DATA_START = offsetof(CPadInfo, button0);
+constexpr size_t PAD_DATA_SIZE = offsetof(CPadInfo, dummy) - PAD_DATA_START;
+constexpr int MAX_PADS = 2;
+
+enum class Mode { OFF, RECORD, REPLAY };
+
+struct InputReplayState {
+  Mode mode = Mode::OFF;
+  u32 frame = 0;
+  u64 last_timer = 0;
+  u8 last_pad[MAX_PADS][PAD_DATA_SIZE] = {};
+
+  // recording. Each frame is written out when it ends.
+  FILE* out = nullptr;
+  std::vector<u8> out_frame;
+
+  // replay
+  std::vector<u8> in;
+  size_t in_offset = 0;
+};
+
+std::string g_record_path;
+std::string g_replay_path;
+bool g_exit_when_done = false;
+InputReplayState g_state;
+
+template <typename T>
+void write(const T& value) {
+  const auto* bytes = (const u8*)&value;
+  g_state.out_frame.insert(g_state.out_frame.end(), bytes, bytes + sizeof(T));
+}
+
+void write_varint(u64 value) {
+  while (value >= 0x80) {
+    g_state.out_frame.push_back((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  g_state.out_frame.push_back(value);
+}
+
+/*!
+ * Stop replaying, and go back to live inputs unless we're supposed to exit.
+ */
+void end_replay() {
+  g_state = InputReplayState();
+  if (g_exit_when_done) {
+    MasterExit = RuntimeExitStatus::EXIT;
+  }
+}
+
+/*!
+ * Read from the replay. Returns false, and ends the replay, if the recording is cut off.
+ */
+bool read_bytes(void* dst, size_t size) {
+  if (g_state.in_offset + size > g_state.in.size()) {
+    lg::error("[Input Replay] The recording is truncated in frame {}. Stopping the replay.",
+              g_state.frame);
+    end_replay();
+    return false;
+  }
+  memcpy(dst, g_state.in.data() + g_state.in_offset, size);
+  g_state.in_offset += size;
+  return true;
+}
+
+template <typename T>
+bool read(T* value) {
+  return read_bytes(value, sizeof(T));
+}
+
+bool read_varint(u64* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    u8 byte;
+    if (!read(&byte)) {
+      return false;
+    }
+    *value |= u64(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  lg::error("[Input Replay] The recording is corrupt in frame {}. Stopping the replay.",
+            g_state.frame);
+  end_replay();
+  return false;
+}
+
+/*!
+ * Check that the next event in the replay is the one the game is reading. Returns false, and ends
+ * the replay, if the recording has ended or has something else.
+ */
+bool next_event_is(Event event) {
+  if (g_state.in_offset == g_state.in.size()) {
+    lg::info("[Input Replay] Finished after {} frames", g_state.frame);
+    end_replay();
+    return false;
+  }
+  const auto recorded = (Event)g_state.in[g_state.in_offset];
+  const bool matches = recorded == event || (event == Event::PAD && recorded == Event::PAD_SAME);
+  if (!matches) {
+    lg::error("[Input Replay] Out of sync in frame {}: the game read the {}, but the recording has "
+              "the {}. Stopping the replay.",
+              g_state.frame, event_name(event), event_name(recorded));
+    end_replay();
+    return false;
+  }
+  g_state.in_offset++;
+  return true;
+}
+
+bool start_recording(const std::string& path) {
+  g_state.out = file_util::open_file(path, "wb");
+  if (!g_state.out) {
+    lg::error("[Input Replay] Unable to open {} to record inputs", path);
+    return false;
+  }
+  InputReplayHeader header = {INPUT_REPLAY_MAGIC, INPUT_REPLAY_VERSION, (u32)g_game_version, 0};
+  write(header);
+  g_state.mode = Mode::RECORD;
+  lg::info("[Input Replay] Recording inputs to {}", path);
+  return true;
+}
+
+bool start_replay(const std::string& path) {
+  if (!fs::exists(path)) {
+    lg::error("[Input Replay] Recording {} doesn't exist", path);
+    return false;
+  }
+  g_state.in = file_util::read_binary_file(path);
+  InputReplayHeader header;
+  if (g_state.in.size() < sizeof(header)) {
+    lg::error("[Input Replay] Recording {} is too short", path);
+    return false;
+  }
+  read(&header);
+  if (header.magic != INPUT_REPLAY_MAGIC || header.version != INPUT_REPLAY_VERSION ||
+      header.game_version != (u32)g_game_version) {
+    lg::error("[Input Replay] Recording {} is from another version or game", path);
+    return false;
+  }
+  g_state.mode = Mode::REPLAY;
+  lg::info("[Input Replay] Replaying inputs from {}", path);
+  return true;
+}
+
+}  // namespace
+
+void set_paths(const std::string& record_path,
+               const std::string& replay_path,
+               bool exit_when_done) {
+  ASSERT(record_path.empty() || replay_path.empty());
+  g_record_path = record_path;
+  g_replay_path = replay_path;
+  g_exit_when_done = exit_when_done;
+}
+
+void init_globals() {
+  stop();
+  if (!g_record_path.empty()) {
+    start_recording(g_record_path);
+  } else if (!g_replay_path.empty()) {
+    if (!start_replay(g_replay_path)) {
+      end_replay();
+    }
+  }
+}
+
+void stop() {
+  if (g_state.out) {
+    // the unfinished frame is kept, so replays end at the same read.
+    fwrite(g_state.out_frame.data(), g_state.out_frame.size(), 1, g_state.out);
+    fclose(g_state.out);
+  }
+  g_state = InputReplayState();
+}
+
+/*!
+ * Record or replace the pad bytes of a CPadInfo that scePadRead just filled in.
+ */
+void pad(int port, u8* pad_data) {
+  ASSERT(port >= 0 && port < MAX_PADS);
+  u8* data = pad_data + PAD_DATA_START;
+  u8* last = g_state.last_pad[port];
+  switch (g_state.mode) {
+    case Mode::RECORD:
+      if (memcmp(data, last, PAD_DATA_SIZE) == 0) {
+        write(Event::PAD_SAME);
+        write<u8>(port);
+      } else {
+        write(Event::PAD);
+        write<u8>(port);
+        g_state.out_frame.insert(g_state.out_frame.end(), data, data + PAD_DATA_SIZE);
+        memcpy(last, data, PAD_DATA_SIZE);
+      }
+      break;
+    case Mode::REPLAY:
+      if (next_event_is(Event::PAD)) {
+        const auto event = (Event)g_state.in[g_state.in_offset - 1];
+        u8 recorded_port;
+        if (!read(&recorded_port)) {
+          return;
+        }
+        if (recorded_port != port) {
+          lg::error("[Input Replay] Out of sync in frame {}: pads were read in another order",
+                    g_state.frame);
+          end_replay();
+          return;
+        }
+        if (event == Event::PAD && !read_bytes(last, PAD_DATA_SIZE)) {
+          return;
+        }
+        memcpy(data, last, PAD_DATA_SIZE);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void mouse(u16* buttons, float* x, float* y) {
+  switch (g_state.mode) {
+    case Mode::RECORD:
+      write(Event::MOUSE);
+      write(*buttons);
+      write(*x);
+      write(*y);
+      break;
+    case Mode::REPLAY:
+      if (next_event_is(Event::MOUSE)) {
+        u16 recorded_buttons;
+        float recorded_x, recorded_y;
+        if (read(&recorded_buttons) && read(&recorded_x) && read(&recorded_y)) {
+          *buttons = recorded_buttons;
+          *x = recorded_x;
+          *y = recorded_y;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+u64 timer(u64 live) {
+  switch (g_state.mode) {
+    case Mode::RECORD:
+      write(Event::TIMER);
+      write_varint(live - g_state.last_timer);
+      g_state.last_timer = live;
+      return live;
+    case Mode::REPLAY: {
+      u64 delta;
+      if (next_event_is(Event::TIMER) && read_varint(&delta)) {
+        g_state.last_timer += delta;
+        return g_state.last_timer;
+      }
+      return live;
+    }
+    default:
+      return live;
+  }
+}
+
+u32 rand(u32 live) {
+  switch (g_state.mode) {
+    case Mode::RECORD:
+      write(Event::RAND);
+      write(live);
+      return live;
+    case Mode::REPLAY: {
+      u32 recorded;
+      return next_event_is(Event::RAND) && read(&recorded) ? recorded : live;
+    }
+    default:
+      return live;
+  }
+}
+
+/*!
+ * Called when the game sends a frame to the renderer.
+ */
+void frame() {
+  switch (g_state.mode) {
+    case Mode::RECORD:
+      write(Event::FRAME);
+      fwrite(g_state.out_frame.data(), g_state.out_frame.size(), 1, g_state.out);
+      g_state.out_frame.clear();
+      break;
+    case Mode::REPLAY:
+      next_event_is(Event::FRAME);
+      break;
+    default:
+      return;
+  }
+  g_state.frame++;
+}
+
+}  // namespace input_replay
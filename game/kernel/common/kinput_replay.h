@@ -0,0 +1,36 @@
+#pragma once
+
+/*!
+ * @file kinput_replay.h
+ * Added in the PC port.
+ *
+ * Recording and replaying everything the game reads from the outside world while it runs: pads
+ * (which includes keyboard and mouse bindings), the jak 2 mouse cursor, pc-rand and the EE timer.
+ * Each read is written to the recording in the order it happens, with a marker at the end of each
+ * frame. A replay hands the same values back to the same reads, so the game runs the same frames
+ * again, with or without a display.
+ *
+ * Anything else that changes from run to run can still make the game read a different number of
+ * times, for example level loads that take a different number of frames. A replay stops at the
+ * first read that doesn't match the recording and logs the frame where that happened.
+ */
+
+#include <string>
+
+#include "common/common_types.h"
+
+namespace input_replay {
+
+// only one of the paths may be set. Recording or replaying starts when the EE starts.
+void set_paths(const std::string& record_path, const std::string& replay_path, bool exit_when_done);
+void init_globals();
+void stop();
+
+// called by each input after reading the live value, to record it or replace it.
+void pad(int port, u8* pad_data);
+void mouse(u16* buttons, float* x, float* y);
+u64 timer(u64 live);
+u32 rand(u32 live);
+void frame();
+
+}  // namespace input_replay
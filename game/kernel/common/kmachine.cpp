@@ -16,8 +16,11 @@
 #include "game/graphics/screenshot.h"
 #include "game/kernel/common/Ptr.h"
 #include "game/kernel/common/kernel_types.h"
+#include "game/kernel/common/kheapstats.h"
+#include "game/kernel/common/kinput_replay.h"
 #include "game/kernel/common/kprint.h"
 #include "game/kernel/common/kscheme.h"
+#include "game/kernel/common/ktrace.h"
 #include "game/mips2c/mips2c_table.h"
 #include "game/sce/libcdvd_ee.h"
 #include "game/sce/libpad.h"
@@ -418,7 +421,7 @@ CommonPCPortFunctionWrappers g_pc_port_funcs;
 
 u64 read_ee_timer() {
   u64 ns = ee_clock_timer.getNs();
-  return (ns * 3) / 10;
+  return input_replay::timer((ns * 3) / 10);
 }
 
 void pc_memmove(u32 dst, u32 src, u32 size) {
@@ -426,6 +429,8 @@ void pc_memmove(u32 dst, u32 src, u32 size) {
 }
 
 void send_gfx_dma_chain(u32 /*bank*/, u32 chain) {
+  alloc_stats_frame();
+  input_replay::frame();
   if (Gfx::GetCurrentRenderer()) {
     Gfx::GetCurrentRenderer()->send_chain(g_ee_main_mem, chain);
   }
@@ -975,7 +980,7 @@ void pc_prof(u32 name, ProfNode::Kind kind) {
 
 std::mt19937 extra_random_generator;
 u32 pc_rand() {
-  return (u32)extra_random_generator();
+  return input_replay::rand((u32)extra_random_generator());
 }
 
 void pc_treat_pad0_as_pad1(u32 symptr) {
@@ -1115,6 +1120,15 @@ void init_common_pc_port_functions(
 
   // profiler
   make_func_symbol_func("pc-prof", (void*)pc_prof);
+  // trace events from functions compiled with profiling, see ktrace.h
+  init_function_trace();
+  make_func_symbol_func("pc-function-trace-start", (void*)pc_function_trace_start);
+  make_func_symbol_func("pc-function-trace-stop", (void*)pc_function_trace_stop);
+  make_func_symbol_func("pc-function-trace-dump", (void*)pc_function_trace_dump);
+  // allocation counts by heap and type, see kheapstats.h
+  make_func_symbol_func("pc-alloc-stats-start", (void*)pc_alloc_stats_start);
+  make_func_symbol_func("pc-alloc-stats-stop", (void*)pc_alloc_stats_stop);
+  make_func_symbol_func("pc-alloc-stats-print", (void*)pc_alloc_stats_print);
 
   // RNG
   make_func_symbol_func("pc-rand", (void*)pc_rand);
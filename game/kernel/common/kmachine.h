@@ -23,6 +23,7 @@ extern u32 modsrc;
 extern u32 reboot_iop;  // renamed to reboot_iop to avoid conflict
 
 extern const char* init_types[];
+extern u32 vif1_interrupt_handler;
 extern u32 vblank_interrupt_handler;
 
 void kmachine_init_globals_common();
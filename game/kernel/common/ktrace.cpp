@@ -0,0 +1,152 @@
+#include "ktrace.h"
+
+#include <chrono>
+
+#include "common/goal_constants.h"
+#include "common/log/log.h"
+#include "common/symbols.h"
+#include "common/util/FileUtil.h"
+
+#include "game/kernel/common/Ptr.h"
+#include "game/kernel/common/kboot.h"
+#include "game/kernel/common/kmalloc.h"
+#include "game/kernel/common/kscheme.h"
+
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "fmt/core.h"
+
+namespace {
+// the buffer from the last start. GOAL memory can't be freed, so it is reused if big enough.
+u32 g_trace_buffer = 0;
+u32 g_trace_buffer_entries = 0;
+
+// the recording from the last start, saved by stop so it can still be dumped.
+bool g_recording_stopped = false;
+u32 g_stopped_mask = 0;
+u32 g_stopped_next = 0;
+
+// rdtsc and wall clock time when tracing started, to convert the timestamps to microseconds.
+u64 g_start_tsc = 0;
+std::chrono::steady_clock::time_point g_start_time;
+// the same when it stopped, so a stopped recording converts with the rate it was recorded at.
+u64 g_stop_tsc = 0;
+std::chrono::steady_clock::time_point g_stop_time;
+
+Ptr<FunctionTraceInfo> trace_info() {
+  return Ptr<FunctionTraceInfo>(FUNCTION_TRACE_INFO_ADDR);
+}
+
+/*!
+ * Point the probes at a single entry right after the header. Events are still written, but they
+ * just overwrite each other.
+ */
+void use_dummy_buffer() {
+  auto info = trace_info();
+  info->buffer = FUNCTION_TRACE_INFO_ADDR + sizeof(FunctionTraceInfo);
+  info->mask = 0;
+  info->next = 0;
+}
+}  // namespace
+
+void init_function_trace() {
+  static_assert(sizeof(FunctionTraceInfo) + sizeof(FunctionTraceEntry) <= 0x40,
+                "function trace info doesn't fit before LINK_CONTROL_NAME_ADDR");
+  g_trace_buffer = 0;
+  g_trace_buffer_entries = 0;
+  g_recording_stopped = false;
+  use_dummy_buffer();
+}
+
+/*!
+ * Start recording into a ring buffer that holds the most recent num_entries events (rounded up to
+ * a power of two). Returns #f if the buffer couldn't be allocated.
+ */
+u64 pc_function_trace_start(u32 num_entries) {
+  u32 entries = 1;
+  while (entries < num_entries) {
+    entries <<= 1;
+  }
+
+  if (entries > g_trace_buffer_entries) {
+    auto heap = MasterDebug ? kdebugheap : kglobalheap;
+    auto mem = kmalloc(heap, entries * sizeof(FunctionTraceEntry), KMALLOC_ALIGN_16,
+                       "function-trace");
+    if (!mem.offset) {
+      lg::error("Unable to allocate function trace buffer with {} entries", entries);
+      return s7.offset;
+    }
+    g_trace_buffer = mem.offset;
+    g_trace_buffer_entries = entries;
+  }
+
+  auto info = trace_info();
+  info->buffer = g_trace_buffer;
+  info->mask = entries - 1;
+  info->next = 0;
+  g_recording_stopped = false;
+  g_start_tsc = __rdtsc();
+  g_start_time = std::chrono::steady_clock::now();
+  return s7.offset + true_symbol_offset(g_game_version);
+}
+
+/*!
+ * Stop recording. The events recorded so far are kept until the next start, so they can still be
+ * dumped.
+ */
+void pc_function_trace_stop() {
+  auto info = trace_info();
+  if (info->buffer == g_trace_buffer && g_trace_buffer) {
+    g_recording_stopped = true;
+    g_stopped_mask = info->mask;
+    g_stopped_next = info->next;
+    g_stop_tsc = __rdtsc();
+    g_stop_time = std::chrono::steady_clock::now();
+  }
+  use_dummy_buffer();
+}
+
+/*!
+ * Write the events in the buffer as a Chrome trace (chrome://tracing, Perfetto). This works while
+ * recording, which continues, and after a stop, so it can be called repeatedly. Returns #f if
+ * there was nothing to write.
+ */
+u64 pc_function_trace_dump(u32 file_name) {
+  auto info = trace_info();
+  const bool running = info->buffer == g_trace_buffer && g_trace_buffer;
+  if (!running && !g_recording_stopped) {
+    lg::warn("Function trace has not been started");
+    return s7.offset;
+  }
+  const u32 mask = running ? info->mask : g_stopped_mask;
+  const u32 next = running ? info->next : g_stopped_next;
+
+  const u64 end_tsc = running ? __rdtsc() : g_stop_tsc;
+  const auto end_time = running ? std::chrono::steady_clock::now() : g_stop_time;
+  const double seconds = std::chrono::duration<double>(end_time - g_start_time).count();
+  const double ticks_per_us = seconds > 0 ? (end_tsc - g_start_tsc) / (seconds * 1e6) : 1;
+
+  // the buffer only keeps the newest entries, so older enter events may be missing.
+  const u32 count = std::min(next, mask + 1);
+  const u32 first = next - count;
+  auto entries = Ptr<FunctionTraceEntry>(g_trace_buffer).c();
+
+  std::string result = "{\"traceEvents\":[\n";
+  for (u32 i = 0; i < count; i++) {
+    const auto& entry = entries[(first + i) & mask];
+    const char* phase = entry.kind == (u32)FunctionTraceEvent::ENTER ? "B" : "E";
+    result += fmt::format("{}{{\"name\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":0,\"tid\":0}}",
+                          i ? ",\n" : "", Ptr<String>(entry.name).c()->data(), phase,
+                          (s64)(entry.tsc - g_start_tsc) / ticks_per_us);
+  }
+  result += "\n]}";
+
+  const std::string path = Ptr<String>(file_name).c()->data();
+  file_util::write_text_file(path, result);
+  lg::info("Wrote {} function trace events ({} dropped) to {}", count, next - count, path);
+  return s7.offset + true_symbol_offset(g_game_version);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/*!
+ * @file ktrace.h
+ * Runtime side of the compiler's function entry/exit tracing. Functions compiled with
+ * (declare (profile)), (declare-file (profile)) or the profile-functions setting append events to
+ * the buffer described by the FunctionTraceInfo at FUNCTION_TRACE_INFO_ADDR.
+ *
+ * There is one buffer for the whole game, not one per GOAL process, and events don't record which
+ * process they came from. They are all written as thread 0, so when a process suspends inside a
+ * traced function and another one runs, their enter/exit events interleave and the nesting in the
+ * trace viewer is wrong. Trace functions that don't suspend to get readable results.
+ */
+
+#include "common/common_types.h"
+
+void init_function_trace();
+u64 pc_function_trace_start(u32 num_entries);
+void pc_function_trace_stop();
+u64 pc_function_trace_dump(u32 file_name);
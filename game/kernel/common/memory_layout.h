@@ -22,6 +22,8 @@ constexpr u32 GLOBAL_HEAP_END = 0x1ffc000 + (BIG_MEMORY ? (0x1ffc000 - HEAP_STAR
 constexpr u32 GLOBAL_HEAP_INFO_ADDR = 0x13AD00;
 constexpr u32 DEBUG_HEAP_INFO_ADDR = 0x13AD10;
 constexpr u32 LINK_CONTROL_NAME_ADDR = 0x13AD80;
+// FUNCTION_TRACE_INFO_ADDR (0x13AD40) is also in this area, it's in goal_constants.h because the
+// compiler needs it too.
 
 //! Where to place the debug heap
 constexpr u32 DEBUG_HEAP_START = 0x5000000;
@@ -4,6 +4,7 @@
 #include "common/symbols.h"
 
 #include "game/kernel/common/fileio.h"
+#include "game/kernel/common/kboot_image.h"
 #include "game/kernel/common/klink.h"
 #include "game/kernel/common/kmachine.h"
 #include "game/kernel/common/kprint.h"
@@ -536,6 +537,7 @@ void link_control::jak1_finish(bool jump_from_c_to_goal) {
       for (auto& x : it->second) {
         x();
       }
+      boot_image::note_mips2c_object(m_object_name);
     }
 
     // execute top level!
@@ -3,6 +3,7 @@
 #include "game/kernel/jak1/kscheme.h"
 
 namespace jak1 {
+extern Ptr<jak1::Symbol> ListenerLinkBlock;
 extern Ptr<jak1::Symbol> ListenerFunction;
 extern Ptr<jak1::Symbol> kernel_dispatcher;
 extern Ptr<jak1::Symbol> kernel_packages;
@@ -21,6 +21,7 @@
 #include "game/graphics/sceGraphicsInterface.h"
 #include "game/kernel/common/fileio.h"
 #include "game/kernel/common/kboot.h"
+#include "game/kernel/common/kboot_image.h"
 #include "game/kernel/common/kdgo.h"
 #include "game/kernel/common/kdsnetm.h"
 #include "game/kernel/common/kernel_types.h"
@@ -530,17 +531,19 @@ void pc_set_levels(u32 l0, u32 l1) {
   Gfx::GetCurrentRenderer()->set_levels(levels);
 }
 
+namespace {
+InternFromCInfo intern_from_c_info(const char* name) {
+  const auto result = intern_from_c(name);
+  InternFromCInfo info{};
+  info.offset = result.offset;
+  return info;
+}
+}  // namespace
+
 void InitMachine_PCPort() {
   // PC Port added functions
-  init_common_pc_port_functions(
-      make_function_symbol_from_c,
-      [](const char* name) {
-        const auto result = intern_from_c(name);
-        InternFromCInfo info{};
-        info.offset = result.offset;
-        return info;
-      },
-      make_string_from_c);
+  init_common_pc_port_functions(make_function_symbol_from_c, intern_from_c_info,
+                                make_string_from_c);
 
   // Game specific functions
   // Called from the game thread at each frame to tell the PC rendering code which levels to start
@@ -629,11 +632,27 @@ void InitMachineScheme() {
         new_pair(s7.offset + FIX_SYM_GLOBAL_HEAP, *((s7 + FIX_SYM_PAIR_TYPE).cast<u32>()),
                  make_string_from_c("common"), kernel_packages->value);
 
+    if (boot_image::enabled()) {
+      SaveBootImage();
+    }
+
     lg::info("calling play");
     call_goal_function_by_name("play");
   }
 }
 
+/*!
+ * Replacement for InitMachineScheme when the kernel and engine were restored from a boot image.
+ * All the GOAL memory is already set up, but the C++ side of the PC port functions isn't.
+ */
+void InitMachineSchemeFromBootImage() {
+  g_pc_port_funcs.intern_from_c = intern_from_c_info;
+  g_pc_port_funcs.make_string_from_c = make_string_from_c;
+
+  lg::info("calling play");
+  call_goal_function_by_name("play");
+}
+
 }  // namespace jak1
 
 #if defined(__GNUC__)
@@ -22,6 +22,7 @@ int InitMachine();
 int ShutdownMachine();
 
 void InitMachineScheme();
+void InitMachineSchemeFromBootImage();
 
 struct DiscordInfo {
   u32 fuel;
@@ -3,18 +3,25 @@
 #include <cstring>
 
 #include "common/common_types.h"
+#include "common/goal_constants.h"
 #include "common/log/log.h"
 #include "common/symbols.h"
+#include "common/util/FileUtil.h"
 #include "common/util/Timer.h"
 
 #include "game/kernel/common/fileio.h"
+#include "game/kernel/common/kboot_image.h"
 #include "game/kernel/common/kdgo.h"
 #include "game/kernel/common/kdsnetm.h"
+#include "game/kernel/common/kheapstats.h"
 #include "game/kernel/common/klink.h"
+#include "game/kernel/common/klisten.h"
+#include "game/kernel/common/kmachine.h"
 #include "game/kernel/common/kmalloc.h"
 #include "game/kernel/common/kmemcard.h"
 #include "game/kernel/common/kprint.h"
 #include "game/kernel/common/kscheme.h"
+#include "game/kernel/common/memory_layout.h"
 #include "game/kernel/jak1/fileio.h"
 #include "game/kernel/jak1/kdgo.h"
 #include "game/kernel/jak1/klink.h"
@@ -29,7 +36,18 @@ namespace jak1 {
 // where to put a new symbol for the most recently searched for symbol that wasn't found
 u32 symbol_slot;
 
+/*!
+ * Type names for the allocation stats.
+ */
+const char* alloc_stats_type_name(u32 type) {
+  if (!Ptr<Type>(type)->symbol.offset) {
+    return "?";
+  }
+  return info(Ptr<Type>(type)->symbol)->str->data();
+}
+
 void kscheme_init_globals() {
+  init_alloc_stats(alloc_stats_type_name);
   symbol_slot = 0;
 }
 
@@ -55,7 +73,7 @@ u64 new_illegal(u32 allocation, u32 type) {
  * The pp argument is added.  It contains the current process.  If it is unknown, it is set to
  * UNKNOWN_PROCESS (UINT32_MAX).
  */
-u64 alloc_from_heap(u32 heapSymbol, u32 type, s32 size, u32 pp) {
+u64 alloc_from_heap_untracked(u32 heapSymbol, u32 type, s32 size, u32 pp) {
   using namespace jak1_symbols;
   ASSERT(size > 0);
 
@@ -131,6 +149,37 @@ u64 alloc_from_heap(u32 heapSymbol, u32 type, s32 size, u32 pp) {
   }
 }
 
+/*!
+ * Which heap the heap argument of alloc_from_heap refers to, for the allocation stats.
+ */
+AllocHeap alloc_stats_heap(u32 heapSymbol) {
+  using namespace jak1_symbols;
+  switch (heapSymbol - s7.offset) {
+    case FIX_SYM_GLOBAL_HEAP:
+      return AllocHeap::GLOBAL;
+    case FIX_SYM_DEBUG_HEAP:
+      return AllocHeap::DEBUG;
+    case FIX_SYM_PROCESS_LEVEL_HEAP:
+      return AllocHeap::PROCESS_LEVEL;
+    case FIX_SYM_LOADING_LEVEL:
+      return AllocHeap::LOADING_LEVEL;
+    case FIX_SYM_PROCESS_TYPE:
+      return AllocHeap::PROCESS;
+    case FIX_SYM_SCRATCH:
+      return AllocHeap::SCRATCH;
+    default:
+      return AllocHeap::STACK;
+  }
+}
+
+u64 alloc_from_heap(u32 heapSymbol, u32 type, s32 size, u32 pp) {
+  u64 mem = alloc_from_heap_untracked(heapSymbol, type, size, pp);
+  if (g_alloc_stats_enabled) {
+    alloc_stats_record(alloc_stats_heap(heapSymbol), type, size, pp, mem != 0);
+  }
+  return mem;
+}
+
 /*!
  * Allocate untyped memory.
  */
@@ -326,6 +375,10 @@ Ptr<Function> make_function_from_c_systemv(void* func, bool arg3_is_pp) {
   mem.c()[offset++] = 0xe0;
   // the asm function's ret will return to the caller of this (GOAL code) directlyz.
 
+  // the movabs immediates are host addresses
+  boot_image::note_host_pointer(mem.c() + 2);
+  boot_image::note_host_pointer(mem.c() + 13);
+
   // CacheFlush(mem, 0x34);
 
   return mem.cast<Function>();
@@ -389,6 +442,9 @@ Ptr<Function> make_function_from_c_win32(void* func, bool arg3_is_pp) {
     mem.c()[i++] = x;
   }
 
+  // the movabs immediate is a host address
+  boot_image::note_host_pointer(mem.c() + 2);
+
   // CacheFlush(mem, 0x34);
 
   return mem.cast<Function>();
@@ -451,6 +507,10 @@ Ptr<Function> make_stack_arg_function_from_c_systemv(void* func) {
   mem.c()[offset++] = 0xff;
   mem.c()[offset++] = 0xe0;
 
+  // the movabs immediates are host addresses
+  boot_image::note_host_pointer(mem.c() + 2);
+  boot_image::note_host_pointer(mem.c() + 13);
+
   // CacheFlush(mem, 0x34);
 
   return mem.cast<Function>();
@@ -495,6 +555,10 @@ Ptr<Function> make_stack_arg_function_from_c_win32(void* func) {
     mem.c()[i++] = x;
   }
 
+  // the movabs immediates are host addresses
+  boot_image::note_host_pointer(mem.c() + 2);
+  boot_image::note_host_pointer(mem.c() + 13);
+
   return mem.cast<Function>();
 }
 #endif
@@ -1442,6 +1506,54 @@ s32 test_function(s32 arg0, s32 arg1, s32 arg2, s32 arg3) {
   return arg0 + 2 * arg1 + 3 * arg2 + 4 * arg3;
 }
 
+namespace {
+/*!
+ * C kernel globals which are set while loading the kernel and the engine.
+ */
+std::vector<boot_image::Global> boot_image_globals() {
+  return {
+      {"NumSymbols", &NumSymbols, sizeof(NumSymbols)},
+      {"s7", &s7, sizeof(s7)},
+      {"SymbolTable2", &SymbolTable2, sizeof(SymbolTable2)},
+      {"LastSymbol", &LastSymbol, sizeof(LastSymbol)},
+      {"FastLink", &FastLink, sizeof(FastLink)},
+      {"EnableMethodSet", &EnableMethodSet, sizeof(EnableMethodSet)},
+      {"ListenerLinkBlock", &ListenerLinkBlock, sizeof(ListenerLinkBlock)},
+      {"ListenerFunction", &ListenerFunction, sizeof(ListenerFunction)},
+      {"kernel_dispatcher", &kernel_dispatcher, sizeof(kernel_dispatcher)},
+      {"kernel_packages", &kernel_packages, sizeof(kernel_packages)},
+      {"print_column", &print_column, sizeof(print_column)},
+      {"vif1_interrupt_handler", &vif1_interrupt_handler, sizeof(vif1_interrupt_handler)},
+      {"vblank_interrupt_handler", &vblank_interrupt_handler, sizeof(vblank_interrupt_handler)},
+  };
+}
+
+/*!
+ * The files loaded during boot. The boot image is out of date if any of these change.
+ */
+std::vector<std::string> boot_image_source_files() {
+  auto iso_dir = file_util::get_jak_project_dir() / "out" / "jak1" / "iso";
+  return {(iso_dir / "KERNEL.CGO").string(), (iso_dir / "GAME.CGO").string()};
+}
+}  // namespace
+
+/*!
+ * Store the heaps in a boot image. This should be called after the engine is loaded, right before
+ * calling "play".
+ */
+void SaveBootImage() {
+  std::vector<boot_image::Region> regions;
+  // kernel data below the heaps, including the kheapinfo structures.
+  regions.push_back({EE_MAIN_MEM_LOW_PROTECT, HEAP_START});
+  for (auto heap : {kglobalheap, kdebugheap}) {
+    if (heap.offset) {
+      regions.push_back({heap->base.offset, heap->current.offset});
+      regions.push_back({heap->top.offset, heap->top_base.offset});
+    }
+  }
+  boot_image::save(regions, boot_image_globals(), boot_image_source_files());
+}
+
 /*!
  * Initializes the GOAL Heap, GOAL Symbol Table, GOAL Funcdamental Types, loads the GOAL kernel,
  * exports Machine functions, loads the game engine, and calls "play" to initialize the engine.
@@ -1452,6 +1564,16 @@ s32 InitHeapAndSymbol() {
   Timer heap_init_timer;
   // reset all mips2c functions
   Mips2C::gLinkedFunctionTable = {};
+
+  // added: skip loading the kernel and engine if we have a boot image.
+  if (boot_image::enabled() && DiskBoot && MasterUseKernel &&
+      boot_image::restore(boot_image_globals(), boot_image_source_files())) {
+    protoBlock.deci2count = intern_from_c("*deci-count*").cast<s32>();
+    jak1::InitMachineSchemeFromBootImage();
+    make_function_symbol_from_c("test-function", (void*)test_function);
+    return 0;
+  }
+
   // allocate memory for the symbol table
   auto symbol_table =
       kmalloc(kglobalheap, jak1::SYM_TABLE_MEM_SIZE, KMALLOC_MEMSET, "symbol-table").cast<u32>();
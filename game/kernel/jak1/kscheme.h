@@ -70,6 +70,7 @@ u64 alloc_heap_object(u32 heap, u32 type, u32 size, u32 pp);
 Ptr<Function> make_function_symbol_from_c(const char* name, void* f);
 Ptr<Function> make_stack_arg_function_symbol_from_c(const char* name, void* f);
 s32 InitHeapAndSymbol();
+void SaveBootImage();
 u64 call_goal_function_by_name(const char* name);
 Ptr<Type> alloc_and_init_type(Ptr<Symbol> sym, u32 method_count);
 Ptr<Symbol> set_fixed_symbol(u32 offset, const char* name, u32 value);
@@ -1,11 +1,14 @@
 #include "kdgo.h"
 
+#include <vector>
+
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/link_types.h"
 #include "common/log/log.h"
 #include "common/util/BitUtils.h"
 #include "common/util/FileUtil.h"
 #include "common/util/Timer.h"
+#include "common/util/compress.h"
 
 #include "game/kernel/common/Ptr.h"
 #include "game/kernel/common/fileio.h"
@@ -130,6 +133,41 @@ void load_and_link_dgo(u64 name_gstr, u64 heap_info, u64 flag, u64 buffer_size)
   load_and_link_dgo_from_c(name, heap, flag, buffer_size, false);
 }
 
+namespace {
+/*!
+ * Read the next object in a DGO file to dest: its header, then its data, padded to 16 bytes. If the
+ * DGO is compressed (see DGO_ZSTD_FLAG), the object is decompressed to dest.
+ */
+void read_dgo_object(FILE* fp, u8* dest, bool zstd) {
+  if (fread(dest, sizeof(ObjectHeader), 1, fp) != 1) {
+    lg::die("failed to read object header");
+  }
+  auto* obj_header = (ObjectHeader*)dest;
+  u32 aligned_size = align16(obj_header->size);
+  auto* obj_dest = dest + sizeof(ObjectHeader);
+  if (!zstd) {
+    if (fread(obj_dest, aligned_size, 1, fp) != 1) {
+      lg::die("Failed to read object data");
+    }
+    return;
+  }
+
+  u32 compressed_size;
+  if (fread(&compressed_size, sizeof(u32), 1, fp) != 1) {
+    lg::die("failed to read compressed object size");
+  }
+  // the compressed data is padded so the next object header is 16-byte aligned in the file.
+  std::vector<u8> compressed(align16(sizeof(ObjectHeader) + sizeof(u32) + compressed_size) -
+                             sizeof(ObjectHeader) - sizeof(u32));
+  if (fread(compressed.data(), compressed.size(), 1, fp) != 1) {
+    lg::die("Failed to read compressed object data");
+  }
+  compression::decompress_zstd_no_header(compressed.data(), compressed_size, obj_dest,
+                                         obj_header->size);
+  memset(obj_dest + obj_header->size, 0, aligned_size - obj_header->size);
+}
+}  // namespace
+
 /*!
  * Faster version of load_and_link_dgo_from_c that skips the IOP and reads the file directly
  * to GOAL memory.
@@ -165,33 +203,21 @@ void load_and_link_dgo_from_c_fast(const char* name,
   if (fread(&header, sizeof(DgoHeader), 1, fp) != 1) {
     lg::die("failed to read dgo header");
   }
-  lg::info("got {} objects, name {}\n", header.object_count, header.name);
+  const bool zstd = header.object_count & DGO_ZSTD_FLAG;
+  const u32 object_count = header.object_count & ~DGO_ZSTD_FLAG;
+  lg::info("got {} objects, name {}\n", object_count, header.name);
 
   // load all but the final
-  for (int i = 0; i < (int)header.object_count - 1; i++) {
-    if (fread(buffer1.c(), sizeof(ObjectHeader), 1, fp) != 1) {
-      lg::die("failed to read object header");
-    }
+  for (int i = 0; i < (int)object_count - 1; i++) {
+    read_dgo_object(fp, buffer1.c(), zstd);
     auto* obj_header = (ObjectHeader*)buffer1.c();
-    u32 aligned_size = align16(obj_header->size);
-    auto* obj_dest = buffer1.c() + sizeof(ObjectHeader);
-    if (fread(obj_dest, aligned_size, 1, fp) != 1) {
-      lg::die("Failed to read object data");
-    }
     link_and_exec(buffer1 + sizeof(ObjectHeader), obj_header->name, obj_header->size, heap,
                   linkFlag, true);
   }
 
   auto final_object_dest = Ptr<u8>((heap->current + 0x3f).offset & 0xffffffc0);
-  if (fread(final_object_dest.c(), sizeof(ObjectHeader), 1, fp) != 1) {
-    lg::die("failed to read final object header");
-  }
+  read_dgo_object(fp, final_object_dest.c(), zstd);
   auto* obj_header = (ObjectHeader*)final_object_dest.c();
-  u32 aligned_size = align16(obj_header->size);
-  auto* obj_dest = (final_object_dest + sizeof(ObjectHeader)).c();
-  if (fread(obj_dest, aligned_size, 1, fp) != 1) {
-    lg::die("Failed to read object data");
-  }
   link_and_exec(final_object_dest + sizeof(ObjectHeader), obj_header->name, obj_header->size, heap,
                 linkFlag, true);
 
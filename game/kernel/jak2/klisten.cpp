@@ -129,6 +129,47 @@ struct SQLResult {
   Ptr<String> data[1];
 };
 
+/*!
+ * Make a sql-result on the debug heap, with the text of each cell, row by row.
+ */
+u32 make_sql_result(const sqlite::QueryResult& result) {
+  auto sym = find_symbol_from_c("sql-result");
+  if (!sym.offset) {
+    return s7.offset;
+  }
+
+  Ptr<Type> type = Ptr<Type>(sym->value());
+  const size_t num_cells = result.cells.size();
+  auto new_result_ptr = call_method_of_type_arg2(intern_from_c("debug").offset, type,
+                                                 GOAL_NEW_METHOD, type.offset, num_cells);
+  SQLResult* new_result = Ptr<SQLResult>(new_result_ptr).c();
+  for (size_t i = 0; i < num_cells; i++) {
+    lg::debug("[SQL] Result \"{}\"", result.cell_text(i));
+    new_result->data[i] = Ptr<String>(make_debug_string_from_c(result.cell_text(i)));
+  }
+  new_result->len = num_cells;
+
+  switch (result.status) {
+    case sqlite::QueryResult::Status::SELECT:
+      new_result->error = intern_from_c("select").offset;
+      break;
+    case sqlite::QueryResult::Status::MODIFY:
+      new_result->error = intern_from_c("modify").offset;
+      break;
+    default:
+      new_result->error = intern_from_c("error").offset;
+      break;
+  }
+  return new_result_ptr;
+}
+
+std::string sql_query_text(Ptr<String> string_in) {
+  std::string query_str = string_in->data();
+  str_util::replace(query_str, "LAST_INSERT_ID()", "last_insert_rowid()");
+  lg::debug("[SQL] Query '{}'", query_str);
+  return query_str;
+}
+
 int sql_query_sync(Ptr<String> string_in) {
   if (!MasterDebug) {
     // not debugging, no sql results.
@@ -144,9 +185,7 @@ int sql_query_sync(Ptr<String> string_in) {
       SendAck();
     */
 
-    std::string query_str = string_in->data();
-    str_util::replace(query_str, "LAST_INSERT_ID()", "last_insert_rowid()");
-    lg::debug("[SQL] Query '{}'", query_str);
+    std::string query_str = sql_query_text(string_in);
 
     // ensure the DB is initialized
     initialize_sql_db();
@@ -156,46 +195,13 @@ int sql_query_sync(Ptr<String> string_in) {
 
     kdebugheap->top.offset -= 0x4000;  // not sure what it's used for...
 
-    const auto& result = run_sql_query(query_str);
-    // TODO - check for errors
-
-    auto sym = find_symbol_from_c("sql-result");
-    if (sym.offset) {
-      // TODO - can their sql-result type not return multiple rows and the data is just the columns?
-      // or do they make assumptions and iterate the data like a 2d flattened array
-      //
-      // Collect string results
-      std::vector<std::string> results;
-      for (const auto& row : result.rows) {
-        for (const auto& val : row) {
-          lg::debug("[SQL] Result \"{}\"", val.data());
-          results.push_back(val.data());
-        }
-      }
+    const auto result = run_sql_query(query_str);
+    const auto new_result_ptr = make_sql_result(result);
+    kdebugheap->top.offset += 0x4000;
 
-      // Make the GOAL type to hold them
-      Ptr<Type> type = Ptr<Type>(sym->value());
-      auto new_result_ptr = call_method_of_type_arg2(intern_from_c("debug").offset, type,
-                                                     GOAL_NEW_METHOD, type.offset, results.size());
-      SQLResult* new_result = Ptr<SQLResult>(new_result_ptr).c();
-      for (int i = 0; i < (int)results.size(); i++) {
-        new_result->data[i] = Ptr<String>(make_debug_string_from_c(results.at(i).data()));
-      }
-      new_result->len = results.size();
-
-      // TODO - possible values here (when to set them?)
-      // 'error = the default, fairly obvious
-      // 'select = the result of a select
-      new_result->error = intern_from_c("select").offset;
-
-      kdebugheap->top.offset += 0x4000;
-
-      // Store the result in the convienant debugging global (stores last query resp)
-      SqlResult->value() = new_result_ptr;
-      return new_result_ptr;
-    }
-
-    return s7.offset;
+    // Store the result in the convienant debugging global (stores last query resp)
+    SqlResult->value() = new_result_ptr;
+    return new_result_ptr;
 
     /* Original code, disabled
       // didn't we just set these to false?
@@ -218,4 +224,33 @@ int sql_query_sync(Ptr<String> string_in) {
   }
 }
 
+/*!
+ * Start a query on the background worker, so big queries don't stall the game. Returns an id for
+ * pc-sql-query-result, or 0 when not debugging.
+ */
+u32 pc_sql_query_async(Ptr<String> string_in) {
+  if (!MasterDebug) {
+    return 0;
+  }
+  std::string query_str = sql_query_text(string_in);
+  initialize_sql_db();
+  return run_sql_query_async(query_str);
+}
+
+/*!
+ * The sql-result of a query from pc-sql-query-async, or #f if it isn't done. Each result can only
+ * be taken once, and results that aren't taken are dropped after a few hundred more queries.
+ */
+u32 pc_sql_query_result(u32 id) {
+  auto result = take_sql_query_result(id);
+  if (!result) {
+    return s7.offset;
+  }
+  // same reserve at the top of the debug heap as sql_query_sync.
+  kdebugheap->top.offset -= 0x4000;
+  const auto new_result_ptr = make_sql_result(*result);
+  kdebugheap->top.offset += 0x4000;
+  return new_result_ptr;
+}
+
 }  // namespace jak2
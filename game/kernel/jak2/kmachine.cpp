@@ -1,9 +1,12 @@
 #include "kmachine.h"
 
 #include <bitset>
+#include <chrono>
 #include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/log/log.h"
@@ -21,6 +24,7 @@
 #include "game/kernel/common/kdgo.h"
 #include "game/kernel/common/kdsnetm.h"
 #include "game/kernel/common/kernel_types.h"
+#include "game/kernel/common/kinput_replay.h"
 #include "game/kernel/common/klink.h"
 #include "game/kernel/common/kmachine.h"
 #include "game/kernel/common/kmalloc.h"
@@ -38,6 +42,7 @@
 #include "game/kernel/jak2/kscheme.h"
 #include "game/kernel/jak2/ksound.h"
 #include "game/overlord/jak2/iso.h"
+#include "game/runtime.h"
 #include "game/sce/deci2.h"
 #include "game/sce/libdma.h"
 #include "game/sce/libgraph.h"
@@ -492,6 +497,7 @@ u32 MouseGetData(u32 _mouse) {
   mouse->posx = (512.0 * width_per) - 256.0;
   mouse->posy = (416.0 * height_per) - 208.0;
   // fmt::print("Mouse - X:{}({}), Y:{}({})\n", xpos, mouse->posx, ypos, mouse->posy);
+  input_replay::mouse(&mouse->button0, &mouse->posx, &mouse->posy);
   return _mouse;
 }
 
@@ -633,6 +639,9 @@ u32 sceGsSyncV(u32 mode) {
   if (vblank_interrupt_handler && MasterExit == RuntimeExitStatus::RUNNING) {
     call_goal(Ptr<Function>(vblank_interrupt_handler), 0, 0, 0, s7.offset, g_ee_main_mem);
   }
+  if (sql_db.is_open()) {
+    commit_sql_writes_async();
+  }
 
   return Gfx::vsync();
 }
@@ -720,8 +729,18 @@ void InitMachineScheme() {
 }
 
 sqlite::SQLiteDatabase sql_db;
+// queries can run on the EE thread or the background worker.
+std::mutex sql_db_lock;
+
+// results of async queries that haven't been taken by the game yet. A result that is still here
+// this many queries later is never going to be taken, so it is dropped.
+constexpr u32 MAX_UNCOLLECTED_SQL_RESULTS = 256;
+std::mutex sql_results_lock;
+u32 sql_next_query_id = 1;
+std::unordered_map<u32, sqlite::QueryResult> sql_results;
 
 void initialize_sql_db() {
+  std::lock_guard<std::mutex> lock(sql_db_lock);
   // If the DB has already been initialized, no-op
   if (sql_db.is_open()) {
     return;
@@ -771,14 +790,62 @@ void initialize_sql_db() {
       // TODO - error check
     }
   }
+
+  // the editors save by running one insert or update per object, often hundreds in a frame.
+  // Committing each of those on its own is what makes saving slow, so they're grouped until the
+  // end of the frame.
+  sql_db.set_batch_writes(std::chrono::milliseconds(500));
+}
+
+sqlite::QueryResult run_sql_query(const std::string& query) {
+  std::lock_guard<std::mutex> lock(sql_db_lock);
+  return sql_db.run_statement(query);
+}
+
+/*!
+ * Run a query on the background worker. The result can be taken with the returned id once it's
+ * done, until MAX_UNCOLLECTED_SQL_RESULTS more queries have been started.
+ */
+u32 run_sql_query_async(const std::string& query) {
+  u32 id;
+  {
+    std::lock_guard<std::mutex> lock(sql_results_lock);
+    id = sql_next_query_id++;
+  }
+  g_background_worker.enqueue_function([id, query]() {
+    auto result = run_sql_query(query);
+    std::lock_guard<std::mutex> lock(sql_results_lock);
+    sql_results[id] = std::move(result);
+    std::erase_if(sql_results, [&](const auto& kv) {
+      return sql_next_query_id - kv.first > MAX_UNCOLLECTED_SQL_RESULTS;
+    });
+  });
+  return id;
+}
+
+std::optional<sqlite::QueryResult> take_sql_query_result(u32 id) {
+  std::lock_guard<std::mutex> lock(sql_results_lock);
+  auto it = sql_results.find(id);
+  if (it == sql_results.end()) {
+    return std::nullopt;
+  }
+  auto result = std::move(it->second);
+  sql_results.erase(it);
+  return result;
 }
 
-sqlite::GenericResponse run_sql_query(const std::string& query) {
-  if (!sql_db.is_open()) {
-    // TODO - error
-    return sqlite::GenericResponse();
+/*!
+ * Commit the writes from this frame on the background worker, so the EE doesn't wait for the disk.
+ */
+void commit_sql_writes_async() {
+  // if the worker is running a query, try again next frame.
+  std::unique_lock<std::mutex> lock(sql_db_lock, std::try_to_lock);
+  if (lock.owns_lock() && sql_db.has_pending_writes()) {
+    g_background_worker.enqueue_function([]() {
+      std::lock_guard<std::mutex> worker_lock(sql_db_lock);
+      sql_db.commit_writes();
+    });
   }
-  return sql_db.run_query(query);
 }
 
 }  // namespace jak2
@@ -14,7 +14,10 @@ void InitMachineScheme();
 
 extern sqlite::SQLiteDatabase sql_db;
 void initialize_sql_db();
-sqlite::GenericResponse run_sql_query(const std::string& query);
+sqlite::QueryResult run_sql_query(const std::string& query);
+u32 run_sql_query_async(const std::string& query);
+std::optional<sqlite::QueryResult> take_sql_query_result(u32 id);
+void commit_sql_writes_async();
 
 struct MouseInfo {
   //  ((active symbol :offset-assert 4)
@@ -14,6 +14,7 @@
 
 #include "game/kernel/common/fileio.h"
 #include "game/kernel/common/kdsnetm.h"
+#include "game/kernel/common/kheapstats.h"
 #include "game/kernel/common/klink.h"
 #include "game/kernel/common/kmemcard.h"
 #include "game/kernel/common/kprint.h"
@@ -34,7 +35,18 @@ Ptr<Symbol4<u32>> CollapseQuote;
 Ptr<Symbol4<u32>> SqlResult;
 Ptr<u32> KernelDebug;
 
+/*!
+ * Type names for the allocation stats.
+ */
+const char* alloc_stats_type_name(u32 type) {
+  if (!Ptr<Type>(type)->symbol.offset) {
+    return "?";
+  }
+  return symbol_name_cstr(*Ptr<Type>(type)->symbol);
+}
+
 void kscheme_init_globals() {
+  init_alloc_stats(alloc_stats_type_name);
   symbol_slot = 0;
   LevelTypeList.offset = 0;
   CollapseQuote.offset = 0;
@@ -78,7 +90,7 @@ void fixed_sym_set(u32 offset, u32 value) {
 }
 }  // namespace
 
-u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
+u64 alloc_from_heap_untracked(u32 heap_symbol, u32 type, s32 size, u32 pp) {
   using namespace jak2_symbols;
   auto heap_ptr = Ptr<Symbol4<Ptr<kheapinfo>>>(heap_symbol)->value();
 
@@ -124,6 +136,36 @@ u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
   }
 }
 
+/*!
+ * Which heap the heap argument of alloc_from_heap refers to, for the allocation stats.
+ */
+AllocHeap alloc_stats_heap(u32 heap_symbol) {
+  switch (heap_symbol - s7.offset) {
+    case FIX_SYM_GLOBAL_HEAP:
+      return AllocHeap::GLOBAL;
+    case FIX_SYM_DEBUG:
+      return AllocHeap::DEBUG;
+    case FIX_SYM_PROCESS_LEVEL_HEAP:
+      return AllocHeap::PROCESS_LEVEL;
+    case FIX_SYM_LOADING_LEVEL:
+      return AllocHeap::LOADING_LEVEL;
+    case FIX_SYM_PROCESS_TYPE:
+      return AllocHeap::PROCESS;
+    case FIX_SYM_SCRATCH:
+      return AllocHeap::SCRATCH;
+    default:
+      return AllocHeap::STACK;
+  }
+}
+
+u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
+  u64 mem = alloc_from_heap_untracked(heap_symbol, type, size, pp);
+  if (g_alloc_stats_enabled) {
+    alloc_stats_record(alloc_stats_heap(heap_symbol), type, size, pp, mem != 0);
+  }
+  return mem;
+}
+
 /*!
  * Allocate untyped memory.
  */
@@ -1710,6 +1752,8 @@ int InitHeapAndSymbol() {
   make_stack_arg_function_symbol_from_c("link-begin", (void*)link_begin);
   make_function_symbol_from_c("link-resume", (void*)link_resume);
   make_function_symbol_from_c("sql-query", (void*)sql_query_sync);
+  make_function_symbol_from_c("pc-sql-query-async", (void*)pc_sql_query_async);
+  make_function_symbol_from_c("pc-sql-query-result", (void*)pc_sql_query_result);
   make_function_symbol_from_c("mc-run", (void*)MC_run);
   make_function_symbol_from_c("mc-format", (void*)MC_format);
   make_function_symbol_from_c("mc-unformat", (void*)MC_unformat);
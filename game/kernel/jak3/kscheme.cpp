@@ -10,6 +10,7 @@
 #include "game/kernel/common/Symbol4.h"
 #include "game/kernel/common/fileio.h"
 #include "game/kernel/common/kdsnetm.h"
+#include "game/kernel/common/kheapstats.h"
 #include "game/kernel/common/klink.h"
 #include "game/kernel/common/kmalloc.h"
 #include "game/kernel/common/kmemcard.h"
@@ -41,7 +42,18 @@ Ptr<Symbol4<u32>> SqlResult;
 std::unordered_map<std::string, int> g_symbol_hash_table;
 #endif
 
+/*!
+ * Type names for the allocation stats.
+ */
+const char* alloc_stats_type_name(u32 type) {
+  if (!Ptr<Type>(type)->symbol.offset) {
+    return "?";
+  }
+  return sym_to_string(Ptr<Type>(type)->symbol)->data();
+}
+
 void kscheme_init_globals() {
+  init_alloc_stats(alloc_stats_type_name);
   LevelTypeList.offset = 0;
   SymbolString.offset = 0;
   CollapseQuote.offset = 0;
@@ -71,7 +83,7 @@ u64 new_illegal(u32 allocation, u32 type) {
   return s7.offset;
 }
 
-u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
+u64 alloc_from_heap_untracked(u32 heap_symbol, u32 type, s32 size, u32 pp) {
   auto heap_ptr = Ptr<Symbol4<Ptr<kheapinfo>>>(heap_symbol)->value();
   s32 aligned_size = ((size + 0xf) / 0x10) * 0x10;
   if ((heap_symbol == s7.offset + FIX_SYM_GLOBAL_HEAP) ||
@@ -115,6 +127,36 @@ u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
   }
 }
 
+/*!
+ * Which heap the heap argument of alloc_from_heap refers to, for the allocation stats.
+ */
+AllocHeap alloc_stats_heap(u32 heap_symbol) {
+  switch (heap_symbol - s7.offset) {
+    case FIX_SYM_GLOBAL_HEAP:
+      return AllocHeap::GLOBAL;
+    case FIX_SYM_DEBUG:
+      return AllocHeap::DEBUG;
+    case FIX_SYM_PROCESS_LEVEL_HEAP:
+      return AllocHeap::PROCESS_LEVEL;
+    case FIX_SYM_LOADING_LEVEL:
+      return AllocHeap::LOADING_LEVEL;
+    case FIX_SYM_PROCESS_TYPE:
+      return AllocHeap::PROCESS;
+    case FIX_SYM_SCRATCH:
+      return AllocHeap::SCRATCH;
+    default:
+      return AllocHeap::STACK;
+  }
+}
+
+u64 alloc_from_heap(u32 heap_symbol, u32 type, s32 size, u32 pp) {
+  u64 mem = alloc_from_heap_untracked(heap_symbol, type, size, pp);
+  if (g_alloc_stats_enabled) {
+    alloc_stats_record(alloc_stats_heap(heap_symbol), type, size, pp, mem != 0);
+  }
+  return mem;
+}
+
 /*!
  * Allocate untyped memory.
  */
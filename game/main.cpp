@@ -104,6 +104,13 @@ int main(int argc, char** argv) {
   int port_number = -1;
   fs::path project_path_override;
   fs::path user_config_dir_override;
+  std::string boot_image_path;
+  std::string iso_path;
+  bool fast_dgo = false;
+  std::string record_input_path;
+  std::string replay_input_path;
+  bool exit_after_replay = false;
+  std::string frame_timings_path;
   std::vector<std::string> game_args;
   CLI::App app{"OpenGOAL Game Runtime"};
   app.add_flag("--version", show_version, "Display the built revision");
@@ -131,6 +138,23 @@ int main(int argc, char** argv) {
                  "Specify the location of the 'data/' folder");
   app.add_option("--config-path", user_config_dir_override,
                  "Override the location where all user configuration and saves are saved");
+  app.add_option("--boot-image", boot_image_path,
+                 "Restore memory after boot from this file, or create it if it is missing or out "
+                 "of date. Skips loading the kernel and engine. Only supported in Jak 1");
+  app.add_option("--iso", iso_path,
+                 "Read game files that aren't in out/iso, like audio and movies, directly from "
+                 "this ISO image. Only supported in Jak 1");
+  app.add_flag("--fast-dgo", fast_dgo,
+               "Load DGOs by reading the whole file at once, instead of through the emulated ISO "
+               "thread");
+  app.add_option("--record-input", record_input_path,
+                 "Record every pad, mouse, timer and random number read to this file");
+  app.add_option("--replay-input", replay_input_path,
+                 "Replay inputs recorded with --record-input, so the game plays the same frames");
+  app.add_flag("--exit-after-replay", exit_after_replay,
+               "Exit when the replay ends or goes out of sync, for benchmarking");
+  app.add_option("--frame-timings", frame_timings_path,
+                 "On exit, write frame timing statistics to this .csv or .json file");
   app.footer(game_arg_documentation());
   app.add_option("Game Args", game_args,
                  "Remaining arguments (after '--') that are passed-through to the game itself");
@@ -174,6 +198,13 @@ int main(int argc, char** argv) {
   game_options.game_version = game_name_to_version(game_name);
   game_options.server_port =
       port_number == -1 ? DECI2_PORT - 1 + (int)game_options.game_version : port_number;
+  game_options.boot_image_path = boot_image_path;
+  game_options.iso_path = iso_path;
+  game_options.fast_dgo = fast_dgo;
+  game_options.record_input_path = record_input_path;
+  game_options.replay_input_path = replay_input_path;
+  game_options.exit_after_replay = exit_after_replay;
+  game_options.frame_timings_path = frame_timings_path;
 
   // Figure out if the CPU has AVX2 to enable higher performance AVX2 versions of functions.
   setup_cpu_info();
@@ -667,24 +667,29 @@ void LinkedFunctionTable::reg(const std::string& name, u64 (*exec)(void*), u32 s
 
   // this is short stub that will jump to the appropriate function.
   Ptr<u8> jump_to_asm;
-  switch (g_game_version) {
-    case GameVersion::Jak1:
-      jump_to_asm = Ptr<u8>(::jak1::alloc_heap_object(s7.offset + jak1_symbols::FIX_SYM_GLOBAL_HEAP,
-                                                      *(s7 + jak1_symbols::FIX_SYM_FUNCTION_TYPE),
-                                                      0x40, UNKNOWN_PP));
-      break;
-    case GameVersion::Jak2:
-      jump_to_asm = Ptr<u8>(::jak2::alloc_heap_object(
-          s7.offset + jak2_symbols::FIX_SYM_GLOBAL_HEAP,
-          ::jak2::u32_in_fixed_sym(jak2_symbols::FIX_SYM_FUNCTION_TYPE), 0x40, UNKNOWN_PP));
-      break;
-    case GameVersion::Jak3:
-      jump_to_asm = Ptr<u8>(::jak3::alloc_heap_object(
-          s7.offset + jak3_symbols::FIX_SYM_GLOBAL_HEAP,
-          ::jak3::u32_in_fixed_sym(jak3_symbols::FIX_SYM_FUNCTION_TYPE), 0x40, UNKNOWN_PP));
-      break;
-    default:
-      ASSERT(false);
+  const auto& reused = m_reused_trampolines.find(name);
+  if (reused != m_reused_trampolines.end()) {
+    jump_to_asm = reused->second;
+  } else {
+    switch (g_game_version) {
+      case GameVersion::Jak1:
+        jump_to_asm = Ptr<u8>(::jak1::alloc_heap_object(
+            s7.offset + jak1_symbols::FIX_SYM_GLOBAL_HEAP,
+            *(s7 + jak1_symbols::FIX_SYM_FUNCTION_TYPE), 0x40, UNKNOWN_PP));
+        break;
+      case GameVersion::Jak2:
+        jump_to_asm = Ptr<u8>(::jak2::alloc_heap_object(
+            s7.offset + jak2_symbols::FIX_SYM_GLOBAL_HEAP,
+            ::jak2::u32_in_fixed_sym(jak2_symbols::FIX_SYM_FUNCTION_TYPE), 0x40, UNKNOWN_PP));
+        break;
+      case GameVersion::Jak3:
+        jump_to_asm = Ptr<u8>(::jak3::alloc_heap_object(
+            s7.offset + jak3_symbols::FIX_SYM_GLOBAL_HEAP,
+            ::jak3::u32_in_fixed_sym(jak3_symbols::FIX_SYM_FUNCTION_TYPE), 0x40, UNKNOWN_PP));
+        break;
+      default:
+        ASSERT(false);
+    }
   }
 
   it.first->second.goal_trampoline = jump_to_asm;
@@ -739,6 +744,22 @@ void LinkedFunctionTable::reg(const std::string& name, u64 (*exec)(void*), u32 s
   }
 }
 
+std::vector<std::pair<std::string, u32>> LinkedFunctionTable::trampolines() const {
+  std::vector<std::pair<std::string, u32>> result;
+  for (auto& [name, func] : m_executes) {
+    result.emplace_back(name, func.goal_trampoline.offset);
+  }
+  return result;
+}
+
+/*!
+ * The next registration of this function will rewrite the given trampoline instead of allocating
+ * a new one.
+ */
+void LinkedFunctionTable::reuse_trampoline(const std::string& name, u32 goal_trampoline) {
+  m_reused_trampolines[name] = Ptr<u8>(goal_trampoline);
+}
+
 u32 LinkedFunctionTable::get(const std::string& name) {
   auto it = m_executes.find(name);
   if (it == m_executes.end()) {
@@ -18,12 +18,17 @@ class LinkedFunctionTable {
   void reg(const std::string& name, u64 (*exec)(void*), u32 goal_stack_size);
   u32 get(const std::string& name);
 
+  // for boot images: the trampolines are in GOAL memory and can be reused when linking again.
+  std::vector<std::pair<std::string, u32>> trampolines() const;
+  void reuse_trampoline(const std::string& name, u32 goal_trampoline);
+
  private:
   struct Func {
     u64 (*c_func)(void*);
     Ptr<u8> goal_trampoline;
   };
   std::unordered_map<std::string, Func> m_executes;
+  std::unordered_map<std::string, Ptr<u8>> m_reused_trampolines;
 };
 
 extern PerGameVersion<std::unordered_map<std::string, std::vector<void (*)()>>>
@@ -11,11 +11,15 @@
 
 #include "fake_iso.h"
 
+#include <algorithm>
 #include <cstring>
+#include <unordered_set>
 
 #include "common/log/log.h"
 #include "common/util/Assert.h"
 #include "common/util/FileUtil.h"
+#include "common/util/iso_vfs.h"
+#include "common/util/string_util.h"
 
 #include "game/common/overlord_common.h"
 #include "game/overlord/common/isocommon.h"
@@ -42,6 +46,8 @@ struct FakeIsoEntry {
 FakeIsoEntry fake_iso_entries[MAX_ISO_FILES];  //! List of all known files
 static FileRecord sFiles[MAX_ISO_FILES];       //! List of "FileRecords" for IsoFs API consumers
 u32 fake_iso_entry_count;                      //! Total count of fake iso files
+//! Disc image for files that aren't in out/iso. Kept across init_globals, like a disc in the drive.
+static std::shared_ptr<const IsoVfs> sIsoImage;
 
 void fake_iso_init_globals() {
   // init file lists
@@ -51,6 +57,15 @@ void fake_iso_init_globals() {
   fake_iso_entry_count = 0;
 }
 
+/*!
+ * Use an ISO for files that aren't in out/iso. Files are found by name in any directory of the
+ * disc and are read through the file_util mount of the image over out/iso. DGOs and CGOs always
+ * come from out/iso.
+ */
+void fake_iso_set_image(std::shared_ptr<const IsoVfs> iso) {
+  sIsoImage = std::move(iso);
+}
+
 /*!
  * Initialize the file system.
  */
@@ -69,6 +84,33 @@ int fake_iso_FS_Init() {
     }
   }
 
+  if (sIsoImage) {
+    u32 built_entry_count = fake_iso_entry_count;
+    std::unordered_set<std::string> known_names;
+    for (u32 i = 0; i < fake_iso_entry_count; i++) {
+      known_names.insert(str_util::to_upper(fake_iso_entries[i].iso_name));
+    }
+    for (const auto& iso_entry : sIsoImage->entries()) {
+      std::string file_name = fs::path(iso_entry.path).filename().string();
+      // the disc's DGOs are in the PS2 format, which we can't link. Compiled ones are in out/iso.
+      const std::string upper_name = str_util::to_upper(file_name);
+      if (str_util::ends_with(upper_name, ".DGO") || str_util::ends_with(upper_name, ".CGO")) {
+        continue;
+      }
+      if (file_name.length() >= 16 || !known_names.insert(file_name).second) {
+        continue;
+      }
+      ASSERT(fake_iso_entry_count < MAX_ISO_FILES);
+      FakeIsoEntry* e = &fake_iso_entries[fake_iso_entry_count];
+      strcpy(e->iso_name, file_name.c_str());
+      e->full_path = fmt::format("{}/out/{}/iso/{}", file_util::get_jak_project_dir().string(),
+                                 game_version_names[g_game_version], iso_entry.path);
+      fake_iso_entry_count++;
+    }
+    lg::info("[FAKEISO] {} files from {}", fake_iso_entry_count - built_entry_count,
+             sIsoImage->image_path().string());
+  }
+
   for (u32 i = 0; i < fake_iso_entry_count; i++) {
     MakeISOName(sFiles[i].name, fake_iso_entries[i].iso_name);
     // we don't figure out the size yet.
@@ -127,6 +169,11 @@ const char* get_file_path(FileRecord* fr) {
  */
 uint32_t FS_GetLength(FileRecord* fr) {
   const char* path = get_file_path(fr);
+  if (!fs::exists(path)) {
+    if (auto mounted = file_util::find_in_mounted_iso(path)) {
+      return mounted->size();
+    }
+  }
   file_util::assert_file_exists(path, "fake_iso FS_GetLength");
   FILE* fp = file_util::open_file(path, "rb");
   ASSERT(fp);
@@ -142,9 +189,9 @@ void LoadMusicTweaks() {
   MakeISOName(tweakname, "TWEAKVAL.MUS");
   auto file = FS_FindIN(tweakname);
   if (file) {
-    auto fp = file_util::open_file(get_file_path(file), "rb");
-    fread(&gMusicTweakInfo, sizeof(gMusicTweakInfo), 1, fp);
-    fclose(fp);
+    // this may only be in the mounted ISO, which read_binary_file falls back to.
+    auto data = file_util::read_binary_file(fs::path(get_file_path(file)));
+    memcpy(&gMusicTweakInfo, data.data(), std::min(data.size(), sizeof(gMusicTweakInfo)));
   } else {
     gMusicTweakInfo.TweakCount = 0;
   }
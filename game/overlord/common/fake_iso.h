@@ -11,11 +11,16 @@
  * should work.
  */
 
+#include <memory>
+
 #include "isocommon.h"
 
 #include "third-party/BS_thread_pool.hpp"
 
+class IsoVfs;
+
 void fake_iso_init_globals();
+void fake_iso_set_image(std::shared_ptr<const IsoVfs> iso);
 int fake_iso_FS_Init();
 const char* get_file_path(FileRecord* fr);
 FileRecord* FS_Find(const char* name);
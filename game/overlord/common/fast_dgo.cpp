@@ -0,0 +1,330 @@
+#include "fast_dgo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/link_types.h"
+#include "common/log/log.h"
+#include "common/util/BitUtils.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+#include "common/util/compress.h"
+
+#include "game/common/dgo_rpc_types.h"
+#include "game/overlord/common/dma.h"
+#include "game/overlord/common/fake_iso.h"
+#include "game/runtime.h"
+#include "game/sce/iop.h"
+
+namespace {
+constexpr size_t READ_CHUNK_SIZE = 1024 * 1024;
+
+struct FastDgoLoad {
+  std::string path;
+  std::string name;
+  std::vector<u8> file_data;  // empty if the file is in a mounted ISO
+  const u8* data = nullptr;
+  size_t size = 0;
+  std::atomic<size_t> bytes_ready = 0;
+  std::atomic<bool> read_failed = false;
+  std::atomic<bool> want_abort = false;
+  std::future<void> reader;
+
+  u32 buffer1 = 0;
+  u32 buffer2 = 0;
+  u32 heap_top = 0;
+
+  u32 object_count = 0;
+  bool zstd = false;         // objects are compressed, see DGO_ZSTD_FLAG
+  u32 objects_copied = 0;    // copied to EE memory
+  u32 objects_returned = 0;  // given to the EE to link
+  size_t copy_offset = 0;    // file offset of the next object to copy
+  u32 last_copy_location = 0;
+
+  Timer timer;
+  double wait_s = 0;
+  double copy_s = 0;
+};
+
+bool g_fast_dgo_enabled = false;
+std::unique_ptr<FastDgoLoad> g_load;
+
+void read_file(FastDgoLoad* load) {
+  FILE* fp = file_util::open_file(load->path, "rb");
+  if (!fp) {
+    load->read_failed = true;
+    return;
+  }
+  size_t offset = 0;
+  while (offset < load->size && !load->want_abort) {
+    size_t len = std::min(READ_CHUNK_SIZE, load->size - offset);
+    if (fread(load->file_data.data() + offset, len, 1, fp) != 1) {
+      load->read_failed = true;
+      break;
+    }
+    offset += len;
+    load->bytes_ready = offset;
+  }
+  fclose(fp);
+}
+
+/*!
+ * Block this IOP thread until the first end bytes of the file have been read. Returns false if the
+ * file is too short or can't be read. If wait is false, only check.
+ */
+bool file_ready(FastDgoLoad& load, size_t end, bool wait = true) {
+  if (end > load.size) {
+    return false;
+  }
+  if (load.bytes_ready >= end || !wait) {
+    return load.bytes_ready >= end;
+  }
+  Timer timer;
+  while (load.bytes_ready < end && !load.read_failed) {
+    iop::DelayThread(100);
+  }
+  load.wait_s += timer.getSeconds();
+  return load.bytes_ready >= end;
+}
+
+/*!
+ * Where the state machine would load object idx.
+ */
+u32 object_location(const FastDgoLoad& load, u32 idx) {
+  if (load.object_count == 1 || (idx + 1 == load.object_count && load.buffer1 != load.buffer2)) {
+    return load.heap_top;
+  }
+  return idx % 2 == 0 ? load.buffer1 : load.buffer2;
+}
+
+/*!
+ * Copy the next object, with its header, to the EE. Returns false if it isn't in the file or, when
+ * wait is false, hasn't been read yet. Compressed objects are decompressed straight to EE memory.
+ */
+bool copy_next_object(FastDgoLoad& load, bool wait) {
+  const size_t header_len = sizeof(ObjectHeader) + (load.zstd ? sizeof(u32) : 0);
+  if (!file_ready(load, load.copy_offset + header_len, wait)) {
+    return false;
+  }
+  const u8* src = load.data + load.copy_offset;
+  ObjectHeader header;
+  memcpy(&header, src, sizeof(ObjectHeader));
+  const size_t len = load.zstd ? fast_dgo_zstd_object_size(src)
+                               : sizeof(ObjectHeader) + align16(header.size);
+  if (!file_ready(load, load.copy_offset + len, wait)) {
+    return false;
+  }
+
+  Timer timer;
+  const u32 location = object_location(load, load.objects_copied);
+  if (load.zstd) {
+    fast_dgo_decompress_object(src, g_ee_main_mem + location);
+  } else {
+    DMA_SendToEE(const_cast<u8*>(src), len, (void*)(u64)location);
+    DMA_Sync();
+  }
+  load.copy_s += timer.getSeconds();
+
+  load.copy_offset += len;
+  load.objects_copied++;
+  load.last_copy_location = location;
+  return true;
+}
+
+void end_load(const char* how) {
+  g_load->want_abort = true;
+  if (g_load->reader.valid()) {
+    g_load->reader.wait();
+  }
+  lg::info(
+      "[Fast DGO] {} {}: {}/{} objects, {} KB, {:.3f} s ({:.3f} s waiting for the file, {:.3f} s "
+      "copying)",
+      g_load->name, how, g_load->objects_returned, g_load->object_count, g_load->copy_offset / 1024,
+      g_load->timer.getSeconds(), g_load->wait_s, g_load->copy_s);
+  g_load.reset();
+}
+
+int fail(const char* why) {
+  lg::error("[Fast DGO] {}: {}", g_load->path, why);
+  end_load("failed");
+  return DGO_RPC_RESULT_ERROR;
+}
+
+/*!
+ * Give the EE the next object. While it links that one, copy the one after it to the other buffer,
+ * if it's been read already. The last object waits, since it goes to the heap top.
+ */
+int return_next_object(u32* object_location) {
+  auto& load = *g_load;
+  if (load.objects_copied == load.objects_returned && !copy_next_object(load, true)) {
+    return fail(load.read_failed ? "read failed" : "file is too short");
+  }
+  load.objects_returned++;
+
+  if (load.objects_returned == load.object_count) {
+    // the state machine always reports the last object at the heap top.
+    *object_location = load.heap_top;
+    end_load("done");
+    return DGO_RPC_RESULT_DONE;
+  }
+
+  *object_location = load.last_copy_location;
+  if (load.buffer1 != load.buffer2 && load.objects_copied + 1 < load.object_count) {
+    copy_next_object(load, false);
+  }
+  return DGO_RPC_RESULT_MORE;
+}
+}  // namespace
+
+void fast_dgo_init_globals() {
+  if (g_load) {
+    end_load("reset");
+  }
+}
+
+/*!
+ * Enable for all DGO loads, instead of the ISO thread. Kept across init_globals.
+ */
+void fast_dgo_set_enabled(bool enabled) {
+  g_fast_dgo_enabled = enabled;
+}
+
+bool fast_dgo_enabled() {
+  return g_fast_dgo_enabled;
+}
+
+bool fast_dgo_active() {
+  return g_load != nullptr;
+}
+
+/*!
+ * Should this DGO be loaded with fast_dgo_begin? Compressed DGOs always are, since the ISO thread
+ * can't load them.
+ */
+bool fast_dgo_should_load(const char* file_path) {
+  if (g_fast_dgo_enabled) {
+    return true;
+  }
+  DgoHeader header;
+  if (fs::exists(file_path)) {
+    FILE* fp = file_util::open_file(file_path, "rb");
+    if (!fp) {
+      return false;
+    }
+    bool ok = fread(&header, sizeof(DgoHeader), 1, fp) == 1;
+    fclose(fp);
+    if (!ok) {
+      return false;
+    }
+  } else if (auto mounted = file_util::find_in_mounted_iso(file_path)) {
+    if (mounted->size() < sizeof(DgoHeader)) {
+      return false;
+    }
+    memcpy(&header, mounted->data(), sizeof(DgoHeader));
+  } else {
+    return false;
+  }
+  return header.object_count & DGO_ZSTD_FLAG;
+}
+
+/*!
+ * Start loading a DGO. Returns once the first object is in EE memory, with its location.
+ */
+int fast_dgo_begin(const char* file_path,
+                   u32 buffer1,
+                   u32 buffer2,
+                   u32 heap_top,
+                   u32* object_location) {
+  if (g_load) {
+    end_load("cancelled");
+  }
+
+  g_load = std::make_unique<FastDgoLoad>();
+  auto& load = *g_load;
+  load.path = file_path;
+  load.name = fs::path(file_path).filename().string();
+  load.buffer1 = buffer1;
+  load.buffer2 = buffer2;
+  load.heap_top = heap_top;
+
+  if (fs::exists(load.path)) {
+    load.size = fs::file_size(load.path);
+    load.file_data.resize(load.size);
+    load.data = load.file_data.data();
+    load.reader = thpool.submit(read_file, g_load.get());
+  } else if (auto mounted = file_util::find_in_mounted_iso(load.path)) {
+    load.data = mounted->data();
+    load.size = mounted->size();
+    load.bytes_ready = load.size;
+  } else {
+    return fail("file not found");
+  }
+
+  if (!file_ready(load, sizeof(DgoHeader))) {
+    return fail("no DGO header");
+  }
+  DgoHeader header;
+  memcpy(&header, load.data, sizeof(DgoHeader));
+  load.zstd = header.object_count & DGO_ZSTD_FLAG;
+  load.object_count = header.object_count & ~DGO_ZSTD_FLAG;
+  if (load.object_count == 0) {
+    return fail("no objects");
+  }
+  load.copy_offset = sizeof(DgoHeader);
+  lg::info("[Fast DGO] Loading {} with {} {}objects", header.name, load.object_count,
+           load.zstd ? "compressed " : "");
+
+  return return_next_object(object_location);
+}
+
+/*!
+ * The EE is done with the object before the last one it got, so its buffer can be reused. Returns
+ * once the next object is in EE memory. Jak 1 doesn't send the buffers again.
+ */
+int fast_dgo_next(u32 buffer1, u32 buffer2, u32 heap_top, u32* object_location) {
+  if (!g_load) {
+    return DGO_RPC_RESULT_ERROR;
+  }
+  g_load->heap_top = heap_top;
+  if (g_game_version != GameVersion::Jak1) {
+    g_load->buffer1 = buffer1;
+    g_load->buffer2 = buffer2;
+  }
+  return return_next_object(object_location);
+}
+
+/*!
+ * The size of a compressed object in the DGO file, including its header and padding. The object's
+ * header and compressed size must be readable.
+ */
+size_t fast_dgo_zstd_object_size(const u8* src) {
+  u32 compressed_size;
+  memcpy(&compressed_size, src + sizeof(ObjectHeader), sizeof(u32));
+  return align16(sizeof(ObjectHeader) + sizeof(u32) + compressed_size);
+}
+
+/*!
+ * Decompress an object from a compressed DGO, so dst has the header, data and padding that the
+ * object would have in an uncompressed DGO.
+ */
+void fast_dgo_decompress_object(const u8* src, u8* dst) {
+  ObjectHeader header;
+  memcpy(&header, src, sizeof(ObjectHeader));
+  u32 compressed_size;
+  memcpy(&compressed_size, src + sizeof(ObjectHeader), sizeof(u32));
+  memcpy(dst, &header, sizeof(ObjectHeader));
+  compression::decompress_zstd_no_header(src + sizeof(ObjectHeader) + sizeof(u32),
+                                         compressed_size, dst + sizeof(ObjectHeader), header.size);
+  memset(dst + sizeof(ObjectHeader) + header.size, 0, align16(header.size) - header.size);
+}
+
+void fast_dgo_cancel() {
+  if (g_load) {
+    end_load("cancelled");
+  }
+}
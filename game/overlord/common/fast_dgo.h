@@ -0,0 +1,38 @@
+#pragma once
+
+/*!
+ * @file fast_dgo.h
+ * PC-only DGO loading that doesn't go through the ISO thread. The whole file is read by a
+ * background thread as soon as the load starts (or used directly if it's in a mounted ISO), and
+ * each object is copied to the EE in one go once it's needed.
+ *
+ * Objects end up in the same place the DGO state machine would put them: alternating between the
+ * two buffers, with the next object copied while the EE links the current one, and the last object
+ * at the heap top given by the most recent "load next". Results are DGO_RPC_RESULT values.
+ *
+ * This is also the overlord's only loader for DGOs with zstd compressed objects, which are
+ * decompressed straight into EE memory. fast_dgo_should_load is true for those even if it isn't
+ * enabled.
+ */
+
+#include <cstddef>
+
+#include "common/common_types.h"
+
+void fast_dgo_init_globals();
+void fast_dgo_set_enabled(bool enabled);
+bool fast_dgo_enabled();
+bool fast_dgo_active();
+bool fast_dgo_should_load(const char* file_path);
+
+int fast_dgo_begin(const char* file_path,
+                   u32 buffer1,
+                   u32 buffer2,
+                   u32 heap_top,
+                   u32* object_location);
+int fast_dgo_next(u32 buffer1, u32 buffer2, u32 heap_top, u32* object_location);
+void fast_dgo_cancel();
+
+// for DGOs with zstd compressed objects, see DGO_ZSTD_FLAG.
+size_t fast_dgo_zstd_object_size(const u8* src);
+void fast_dgo_decompress_object(const u8* src, u8* dst);
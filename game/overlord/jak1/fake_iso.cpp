@@ -39,20 +39,25 @@ void fake_iso_init_globals() {
   fake_iso.load_sound_bank = FS_LoadSoundBank;
   fake_iso.load_music = FS_LoadMusic;
 
-  memset(sLoadStack, 0, sizeof(sLoadStack));
+  for (auto& entry : sLoadStack) {
+    entry = {};
+  }
   sReadInfo = nullptr;
 }
 
-static FILE* open_fr(FileRecord* fr, s32 thread_to_wake) {
-  const char* path = get_file_path(fr);
-  FILE* fp = file_util::open_file(path, "rb");
-  if (!fp) {
-    lg::error("[OVERLORD] fake iso could not open the file \"{}\"", path);
+static void open_fr(LoadStackEntry* lse, s32 thread_to_wake) {
+  const char* path = get_file_path(lse->fr);
+  lse->fp = file_util::open_file(path, "rb");
+  lse->iso_data = {};
+  if (!lse->fp) {
+    if (auto mounted = file_util::find_in_mounted_iso(path)) {
+      lse->iso_data = *mounted;
+    } else {
+      lg::error("[OVERLORD] fake iso could not open the file \"{}\"", path);
+    }
   }
 
   iop::iWakeupThread(thread_to_wake);
-
-  return fp;
 }
 
 /*!
@@ -74,9 +79,9 @@ LoadStackEntry* FS_Open(FileRecord* fr, int32_t offset) {
         selected->location += offset;
       }
 
-      auto future = thpool.submit(open_fr, fr, iop::GetThreadId());
+      auto future = thpool.submit(open_fr, selected, iop::GetThreadId());
       iop::SleepThread();
-      selected->fp = future.get();
+      future.get();
 
       return selected;
     }
@@ -100,9 +105,9 @@ LoadStackEntry* FS_OpenWad(FileRecord* fr, int32_t offset) {
       selected->fr = fr;
       selected->location = offset;
 
-      auto future = thpool.submit(open_fr, fr, iop::GetThreadId());
+      auto future = thpool.submit(open_fr, selected, iop::GetThreadId());
       iop::SleepThread();
-      selected->fp = future.get();
+      future.get();
 
       return selected;
     }
@@ -121,7 +126,11 @@ void FS_Close(LoadStackEntry* fd) {
 
   // close the FD
   fd->fr = nullptr;
-  fclose(fd->fp);
+  if (fd->fp) {
+    fclose(fd->fp);
+    fd->fp = nullptr;
+  }
+  fd->iso_data = {};
   if (fd == sReadInfo) {
     sReadInfo = nullptr;
   }
@@ -138,22 +147,33 @@ void fs_read(LoadStackEntry* fd, void* buffer, int32_t len, s32 thread_to_wake)
   real_size = sectors * SECTOR_SIZE;
   u32 offset_into_file = SECTOR_SIZE * fd->location;
 
-  ASSERT(fd->fp);
-  fseek(fd->fp, 0, SEEK_END);
-  uint32_t file_len = ftell(fd->fp);
-  rewind(fd->fp);
-
-  if (offset_into_file < file_len) {
-    if (offset_into_file) {
-      fseek(fd->fp, offset_into_file, SEEK_SET);
+  if (fd->iso_data.data()) {
+    // not on disk, read out of the mounted ISO.
+    uint32_t file_len = fd->iso_data.size();
+    if (offset_into_file < file_len) {
+      if (offset_into_file + real_size > file_len) {
+        real_size = (file_len - offset_into_file);
+      }
+      memcpy(buffer, fd->iso_data.data() + offset_into_file, real_size);
     }
+  } else {
+    ASSERT(fd->fp);
+    fseek(fd->fp, 0, SEEK_END);
+    uint32_t file_len = ftell(fd->fp);
+    rewind(fd->fp);
+
+    if (offset_into_file < file_len) {
+      if (offset_into_file) {
+        fseek(fd->fp, offset_into_file, SEEK_SET);
+      }
 
-    if (offset_into_file + real_size > file_len) {
-      real_size = (file_len - offset_into_file);
-    }
+      if (offset_into_file + real_size > file_len) {
+        real_size = (file_len - offset_into_file);
+      }
 
-    if (fread(buffer, real_size, 1, fd->fp) != 1) {
-      ASSERT(false);
+      if (fread(buffer, real_size, 1, fd->fp) != 1) {
+        ASSERT(false);
+      }
     }
   }
 
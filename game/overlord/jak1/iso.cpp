@@ -19,6 +19,7 @@
 #include "game/common/dgo_rpc_types.h"
 #include "game/overlord/common/dma.h"
 #include "game/overlord/common/fake_iso.h"
+#include "game/overlord/common/fast_dgo.h"
 #include "game/overlord/common/iso.h"
 #include "game/overlord/jak1/dma.h"
 #include "game/overlord/jak1/fake_iso.h"
@@ -337,6 +338,12 @@ void LoadDGO(RPC_Dgo_Cmd* cmd) {
   // it will crash.
   CancelDGO(nullptr);
 
+  if (fast_dgo_should_load(get_file_path(fr))) {
+    cmd->result = fast_dgo_begin(get_file_path(fr), cmd->buffer1, cmd->buffer2,
+                                 cmd->buffer_heap_top, &cmd->buffer1);
+    return;
+  }
+
   // set up the ISO Command
   sLoadDGO.cmd_id = LOAD_DGO_CMD_ID;
   sLoadDGO.messagebox_to_reply = dgo_mbx;
@@ -379,7 +386,9 @@ void LoadDGO(RPC_Dgo_Cmd* cmd) {
 void LoadNextDGO(RPC_Dgo_Cmd* cmd) {
   // printf("LOAD NEXT DGO -- 0x%x\n", cmd->buffer1);
 
-  if (sLoadDGO.cmd_id == 0) {
+  if (fast_dgo_active()) {
+    cmd->result = fast_dgo_next(cmd->buffer1, cmd->buffer2, cmd->buffer_heap_top, &cmd->buffer1);
+  } else if (sLoadDGO.cmd_id == 0) {
     // something went wrong.
     cmd->result = DGO_RPC_RESULT_ERROR;
   } else {
@@ -414,6 +423,13 @@ void LoadNextDGO(RPC_Dgo_Cmd* cmd) {
  * Abort an in progress load.
  */
 void CancelDGO(RPC_Dgo_Cmd* cmd) {
+  if (fast_dgo_active()) {
+    fast_dgo_cancel();
+    if (cmd) {
+      cmd->result = DGO_RPC_RESULT_ABORTED;
+    }
+  }
+
   if (sLoadDGO.cmd_id) {
     sLoadDGO.want_abort = 1;
     // wake up DGO state machine with abort
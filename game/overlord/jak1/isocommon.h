@@ -5,6 +5,7 @@
  * Common ISO utilities.
  */
 
+#include <span>
 #include <string>
 
 #include "common/common_types.h"
@@ -42,6 +43,7 @@ struct LoadStackEntry {
   FileRecord* fr;
   uint32_t location;  // sectors.
   FILE* fp;
+  std::span<const u8> iso_data;  // used instead of fp for files read out of a mounted ISO
 };
 
 /*!
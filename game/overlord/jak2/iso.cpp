@@ -7,6 +7,8 @@
 
 #include "game/common/dgo_rpc_types.h"
 #include "game/overlord/common/dma.h"
+#include "game/overlord/common/fake_iso.h"
+#include "game/overlord/common/fast_dgo.h"
 #include "game/overlord/common/iso.h"
 #include "game/overlord/common/srpc.h"
 #include "game/overlord/jak2/iso_api.h"
@@ -954,6 +956,11 @@ void LoadDGO(RPC_Dgo_Cmd* param_1) {
     param_1->result = 1;
   } else {
     CancelDGO(0);
+    if (fast_dgo_should_load(get_file_path(iVar1))) {
+      param_1->result = fast_dgo_begin(get_file_path(iVar1), param_1->buffer1, param_1->buffer2,
+                                       param_1->buffer_heap_top, &param_1->buffer1);
+      return;
+    }
     sLoadDgo.header.cmd_kind = 0x200;
     sLoadDgo.header.thread_id = 0;
     sLoadDgo.header.mbx_to_reply = dgo_mbx;
@@ -1123,7 +1130,10 @@ void* RPC_DGO(unsigned int param_1, void* param_2, int) {
 }
 
 void LoadNextDGO(RPC_Dgo_Cmd* param_1) {
-  if (sLoadDgo.header.cmd_kind == 0) {
+  if (fast_dgo_active()) {
+    param_1->result = fast_dgo_next(param_1->buffer1, param_1->buffer2, param_1->buffer_heap_top,
+                                    &param_1->buffer1);
+  } else if (sLoadDgo.header.cmd_kind == 0) {
     param_1->result = 1;
   } else {
     sLoadDgo.buffer_heaptop = (uint8_t*)(u64)param_1->buffer_heap_top;
@@ -1148,6 +1158,12 @@ void LoadNextDGO(RPC_Dgo_Cmd* param_1) {
 }
 
 void CancelDGO(RPC_Dgo_Cmd* param_1) {
+  if (fast_dgo_active()) {
+    fast_dgo_cancel();
+    if (param_1 != (RPC_Dgo_Cmd*)nullptr) {
+      param_1->result = 3;
+    }
+  }
   if (sLoadDgo.header.cmd_kind != 0) {
     sLoadDgo.want_abort = 1;
     SendMbx(sync_mbx, nullptr);  // was some stack addr...
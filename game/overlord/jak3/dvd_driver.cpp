@@ -7,6 +7,7 @@
 #include "common/util/Assert.h"
 #include "common/util/FileUtil.h"
 
+#include "game/overlord/jak3/dvd_reader.h"
 #include "game/overlord/jak3/isocommon.h"
 #include "game/overlord/jak3/overlord.h"
 #include "game/sce/iop.h"
@@ -92,7 +93,7 @@ CDvdDriver::CDvdDriver() {
 
 void CDvdDriver::Initialize() {
   if (!initialized) {
-    *this = {};
+    // the original resets the driver here, which the constructor has already done.
     ThreadParam thread_param;
     thread_param.attr = 0x2000000;
     // mbox_param.option = gDvdDriverThreadOptions; // ???
@@ -130,6 +131,8 @@ void CDvdDriver::Initialize() {
     param.init_pattern = 0;
     event_flag = CreateEventFlag(&param);
     ASSERT(event_flag >= 0);
+    m_reader = std::make_unique<DvdReader>(kNumReadThreads);
+    m_slot_reads = std::make_unique<SlotRead[]>(16);
     StartThread(g_nDvdDriverThread, 0);  // this...
   }
   initialized = 1;
@@ -269,6 +272,10 @@ void CDvdDriver::CancelRead(jak3::CDescriptor* desc) {
     Block* iter = desc->m_pHead;
     Block* tail = desc->m_pTail;
     while (iter) {
+      // PC port: reads can't be stopped, so wait for them before the memory is reused.
+      if (iter >= ring && iter < ring + 16) {
+        wait_for_read(iter - ring);
+      }
       if (iter->descriptor) {
         CompletionHandler(iter, 6);
       }
@@ -370,84 +377,40 @@ int CDvdDriver::ReleaseFIFOSema(bool from_dvd_thread) {
 }
 
 /*!
- * PC port added function to actually do a read of a block.
+ * PC port added function to start the reads for count ring slots, starting at first_slot. Slots
+ * that have already been started are skipped.
  */
-void CDvdDriver::read_from_file(const jak3::Block* block) {
-  const auto* fd = block->params.file_def;
-  ASSERT(fd);
-  FileCacheEntry* selected_entry = nullptr;
-
-  // get a cache entry
-  for (auto& entry : m_file_cache) {
-    // if we already opened this file, use that
-    if (entry.def == fd) {
-      selected_entry = &entry;
-      break;
+void CDvdDriver::start_reads(s32 first_slot, s32 count) {
+  for (s32 i = 0; i < count; i++) {
+    s32 slot = (first_slot + i) % 16;
+    auto& read = m_slot_reads[slot];
+    if (read.started) {
+      continue;
     }
-
-    // otherwise pick the least recently used
-    if (!selected_entry) {
-      selected_entry = &entry;
+    read.started = true;
+    const Block* block = ring + slot;
+    if (block->descriptor) {
+      m_reader->submit(block->params, &read.done);
     } else {
-      if (selected_entry->last_use_count > entry.last_use_count) {
-        selected_entry = &entry;
-      }
+      // cancelled, don't bother reading.
+      read.done = true;
     }
   }
+}
 
-  // open a new file if needed
-  if (selected_entry->def != fd) {
-    lg::debug("CDvdDriver swapping files {} - > {}",
-              selected_entry->def ? selected_entry->def->name.data : "NONE", fd->name.data);
-    if (selected_entry->def) {
-      fclose(selected_entry->fp);
-      selected_entry->size = 0;
-    }
-
-    selected_entry->def = fd;
-    selected_entry->fp = file_util::open_file(fd->full_path, "rb");
-    if (!selected_entry->fp) {
-      lg::die("Failed to open {} {}", fd->full_path, strerror(errno));
-    }
-    // get the size of the file we actually opened, rather than caching the size at startup to
-    // support changing the file length after the game has started.
-    fseek(selected_entry->fp, 0, SEEK_END);
-    selected_entry->size = ftell(selected_entry->fp);
-    fseek(selected_entry->fp, 0, SEEK_SET);
-    selected_entry->offset_in_file = 0;
-  }
-
-  // increment use counter
-  selected_entry->last_use_count = m_file_cache_counter++;
-
-  const u64 desired_offset = block->params.sector_num * 0x800;
-
-  // see if we're reading entirely past the end of the file
-  if (desired_offset >= selected_entry->size) {
+/*!
+ * PC port added function to wait for the read of a ring slot to finish, if one was started.
+ * Replacement for sceCdSync.
+ */
+void CDvdDriver::wait_for_read(s32 slot) {
+  auto& read = m_slot_reads[slot];
+  if (!read.started) {
     return;
   }
-
-  if (selected_entry->offset_in_file != desired_offset) {
-    lg::debug("CDvdDriver jumping in file {}: {} -> {}", fd->name.data,
-              selected_entry->offset_in_file, desired_offset);
-    if (fseek(selected_entry->fp, desired_offset, SEEK_SET)) {
-      ASSERT_NOT_REACHED_MSG("Failed to fseek");
-    }
-    selected_entry->offset_in_file = desired_offset;
-  }
-
-  // read
-  s64 read_length = block->params.num_sectors * 0x800;
-  s64 extra_length = read_length + desired_offset - selected_entry->size;
-  if (extra_length > 0) {
-    read_length -= extra_length;
-  }
-  auto ret = fread(block->params.destination, read_length, 1, selected_entry->fp);
-  if (ret != 1) {
-    lg::die("Failed to read {} {}, size {} of {} (ret {})", fd->full_path, strerror(errno),
-            read_length, selected_entry->size, ret);
+  while (!read.done) {
+    DelayThread(100);
   }
-  selected_entry->offset_in_file += read_length;
+  read.started = false;
 }
 
 u32 DvdThread() {
@@ -471,8 +434,8 @@ u32 DvdThread() {
 
     // if a read is in progress, wait for it to finish.
     if (driver->read_in_progress) {
-      // TODO: if we switch to async reads, this is where we'd want to sync.
       // sceCdSync(0);
+      driver->wait_for_read(driver->ring_head);
       completed = true;
       // error checking
     }
@@ -494,10 +457,10 @@ u32 DvdThread() {
     s32 fifo_entries = driver->m_nNumFifoEntries - fifo_slots_freed;
 
     if (fifo_entries) {
-      // start a new read.
+      // start a new read. On PC, we also start the reads for the rest of the ring.
       driver->read_in_progress = 1;
       ovrld_log(LogCategory::DRIVER, "[driver thread] Reading for slot {}", block - driver->ring);
-      driver->read_from_file(block);
+      driver->start_reads(ring_entry, fifo_entries);
 
     } else {
       driver->read_in_progress = 0;
@@ -578,12 +541,6 @@ void CDvdDriver::CompletionHandler(jak3::Block* block, int code) {
   // PopPri(this, local_20[0]);
 }
 
-CDvdDriver::~CDvdDriver() {
-  for (auto& entry : m_file_cache) {
-    if (entry.fp) {
-      fclose(entry.fp);
-    }
-  }
-}
+CDvdDriver::~CDvdDriver() = default;
 
 }  // namespace jak3
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
 
 #include "common/common_types.h"
 
@@ -19,8 +21,9 @@ void jak3_overlord_init_globals_dvd_driver();
  * It's not clear if sceCdSync would allow other threads to run while waiting on the read to finish.
  * but if it did, this is a bit of a difference in the blocking behavior.
  *
- * This is something that could be revisited, as freads will now essentially block the entire
- * overlord, including refilling sound RAM.
+ * In the PC port, reads are done by a DvdReader on background threads. The DVD thread starts reads
+ * for everything in its ring at once, and waits for them with DelayThread, so other threads, like
+ * the ones refilling sound RAM, can run in the meantime.
  */
 
 struct CDescriptor;
@@ -66,6 +69,7 @@ struct CMsgCancelRead : public CMsg {
 };
 
 struct CISOCDFile;
+class DvdReader;
 
 /*!
  * Reference to an ongoing or requested read at the driver level, possibly made up of multiple
@@ -102,7 +106,8 @@ class CDvdDriver {
   s32 ValidateBlockParams(BlockParams* params, int num_params);
   int ReleaseFIFOSema(bool from_dvd_thread);
   int AcquireFIFOSema(bool from_dvd_thread);
-  void read_from_file(const Block* block);
+  void start_reads(s32 first_slot, s32 count);
+  void wait_for_read(s32 slot);
   void CompletionHandler(Block* block, int code);
 
   u8 initialized = 0;
@@ -127,16 +132,15 @@ class CDvdDriver {
   s32 m_nDvdThreadAccessSemaCount = 0;
 
  private:
-  struct FileCacheEntry {
-    const ISOFileDef* def = nullptr;
-    FILE* fp = nullptr;
-    size_t size = 0;
-    u32 last_use_count = 0;
-    u64 offset_in_file = 0;
+  // PC port: the read for each ring slot.
+  struct SlotRead {
+    std::atomic<bool> done = false;
+    bool started = false;
   };
-  u32 m_file_cache_counter = 0;
-  static constexpr int kNumFileCacheEntries = 6;
-  FileCacheEntry m_file_cache[kNumFileCacheEntries];
+  static constexpr int kNumReadThreads = 4;
+  // declared first, so it outlives the reader threads that set done.
+  std::unique_ptr<SlotRead[]> m_slot_reads;
+  std::unique_ptr<DvdReader> m_reader;
 };
 
 // replacement for g_DvdDriver
@@ -0,0 +1,170 @@
+#include "dvd_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#include "common/log/log.h"
+#include "common/util/Assert.h"
+#include "common/util/FileUtil.h"
+
+namespace jak3 {
+
+namespace {
+constexpr u64 kSectorSize = 0x800;
+// reads in a row, each starting where the last one ended, before we start reading ahead.
+constexpr int kSequentialReadsForReadAhead = 2;
+// how much to read past the requested block when reading ahead.
+constexpr size_t kReadAheadSize = 512 * 1024;
+}  // namespace
+
+DvdReader::DvdReader(int num_threads) {
+  ASSERT(num_threads > 0);
+  for (int i = 0; i < num_threads; i++) {
+    auto& worker = m_workers.emplace_back(std::make_unique<Worker>());
+    worker->thread = std::thread(&DvdReader::worker_loop, this, worker.get());
+  }
+}
+
+DvdReader::~DvdReader() {
+  m_want_exit = true;
+  for (auto& worker : m_workers) {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+    }
+    worker->cv.notify_one();
+    worker->thread.join();
+    for (auto& file : worker->files) {
+      if (file.fp) {
+        fclose(file.fp);
+      }
+    }
+  }
+}
+
+void DvdReader::submit(const BlockParams& params, std::atomic<bool>* done) {
+  ASSERT(params.file_def);
+  *done = false;
+  auto& worker = *m_workers[worker_for(params.file_def)];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.jobs.push_back({params, done});
+  }
+  worker.cv.notify_one();
+}
+
+/*!
+ * Pick the thread by the file's path. The ISOFileDefs are all aligned the same way, so their
+ * addresses would put every file on the same thread.
+ */
+int DvdReader::worker_for(const ISOFileDef* def) const {
+  return std::hash<std::string>()(def->full_path) % m_workers.size();
+}
+
+void DvdReader::worker_loop(Worker* worker) {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(worker->mutex);
+      worker->cv.wait(lock, [&] { return m_want_exit || !worker->jobs.empty(); });
+      // on shutdown, drop pending jobs: the driver waiting on them is going away.
+      if (m_want_exit) {
+        return;
+      }
+      job = worker->jobs.front();
+      worker->jobs.pop_front();
+    }
+    read_block(*worker, job.params);
+    *job.done = true;
+  }
+}
+
+/*!
+ * Get an open file, opening it in place of the least recently used one if needed.
+ */
+DvdReader::OpenFile& DvdReader::get_file(Worker& worker, const ISOFileDef* def) {
+  OpenFile* selected = nullptr;
+  for (auto& file : worker.files) {
+    // if we already opened this file, use that
+    if (file.def == def) {
+      selected = &file;
+      break;
+    }
+    // otherwise pick the least recently used
+    if (!selected || selected->last_use_count > file.last_use_count) {
+      selected = &file;
+    }
+  }
+
+  if (selected->def != def) {
+    lg::debug("DvdReader swapping files {} - > {}",
+              selected->def ? selected->def->name.data : "NONE", def->name.data);
+    if (selected->fp) {
+      fclose(selected->fp);
+    }
+    *selected = {};
+    selected->def = def;
+    selected->fp = file_util::open_file(def->full_path, "rb");
+    if (!selected->fp) {
+      lg::die("Failed to open {} {}", def->full_path, strerror(errno));
+    }
+    // get the size of the file we actually opened, rather than caching the size at startup to
+    // support changing the file length after the game has started.
+    fseek(selected->fp, 0, SEEK_END);
+    selected->size = ftell(selected->fp);
+    fseek(selected->fp, 0, SEEK_SET);
+  }
+
+  selected->last_use_count = worker.use_counter++;
+  return *selected;
+}
+
+void DvdReader::read_at(OpenFile& file, u64 offset, void* dest, size_t size) {
+  if (file.offset_in_file != offset) {
+    lg::debug("DvdReader jumping in file {}: {} -> {}", file.def->name.data, file.offset_in_file,
+              offset);
+    if (fseek(file.fp, offset, SEEK_SET)) {
+      ASSERT_NOT_REACHED_MSG("Failed to fseek");
+    }
+    file.offset_in_file = offset;
+  }
+  auto ret = fread(dest, size, 1, file.fp);
+  if (ret != 1) {
+    lg::die("Failed to read {} {}, size {} of {} (ret {})", file.def->full_path, strerror(errno),
+            size, file.size, ret);
+  }
+  file.offset_in_file += size;
+}
+
+void DvdReader::read_block(Worker& worker, const BlockParams& params) {
+  auto& file = get_file(worker, params.file_def);
+  const u64 offset = params.sector_num * kSectorSize;
+
+  // see if we're reading entirely past the end of the file
+  if (offset >= file.size) {
+    return;
+  }
+  const size_t size = std::min<u64>(params.num_sectors * kSectorSize, file.size - offset);
+
+  if (offset == file.last_read_end) {
+    file.sequential_reads++;
+  } else {
+    file.sequential_reads = 0;
+  }
+  file.last_read_end = offset + size;
+
+  if (offset >= file.ahead_offset && offset + size <= file.ahead_offset + file.ahead.size()) {
+    memcpy(params.destination, file.ahead.data() + (offset - file.ahead_offset), size);
+    m_read_ahead_hits++;
+  } else if (file.sequential_reads >= kSequentialReadsForReadAhead) {
+    file.ahead.resize(std::min<u64>(size + kReadAheadSize, file.size - offset));
+    file.ahead_offset = offset;
+    read_at(file, offset, file.ahead.data(), file.ahead.size());
+    memcpy(params.destination, file.ahead.data(), size);
+  } else {
+    read_at(file, offset, params.destination, size);
+  }
+}
+
+}  // namespace jak3
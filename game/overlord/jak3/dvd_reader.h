@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+
+#include "game/overlord/jak3/isocommon.h"
+
+namespace jak3 {
+
+/*!
+ * PC port added reader for the CDvdDriver. Blocks are read on background threads, so the DVD thread
+ * can queue up every read in its ring at once and let the rest of the IOP run while they finish,
+ * like the Sony CD library's own async reads.
+ *
+ * Each file is always read by the same thread, so reads of a file happen in order, from one open
+ * handle. Different files are read in parallel. Each thread keeps several files open, and once a
+ * file has been read sequentially for a few blocks (music, VAG and movie streams), it reads ahead
+ * in large chunks. This keeps interleaved streams from seeking back and forth for every block.
+ */
+class DvdReader {
+ public:
+  explicit DvdReader(int num_threads);
+  ~DvdReader();
+  DvdReader(const DvdReader&) = delete;
+  DvdReader& operator=(const DvdReader&) = delete;
+
+  // Start reading a block. done is set once the data is in the block's destination.
+  void submit(const BlockParams& params, std::atomic<bool>* done);
+
+  // The thread that reads this file.
+  int worker_for(const ISOFileDef* def) const;
+  // Number of blocks that were copied from data that was already read ahead.
+  u64 read_ahead_hits() const { return m_read_ahead_hits; }
+
+ private:
+  static constexpr int kNumFilesPerThread = 8;
+
+  struct OpenFile {
+    const ISOFileDef* def = nullptr;
+    FILE* fp = nullptr;
+    size_t size = 0;
+    u32 last_use_count = 0;
+    u64 offset_in_file = 0;
+    // for read-ahead
+    u64 last_read_end = 0;
+    int sequential_reads = 0;
+    u64 ahead_offset = 0;
+    std::vector<u8> ahead;
+  };
+
+  struct Job {
+    BlockParams params;
+    std::atomic<bool>* done;
+  };
+
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    OpenFile files[kNumFilesPerThread];
+    u32 use_counter = 0;
+  };
+
+  void worker_loop(Worker* worker);
+  void read_block(Worker& worker, const BlockParams& params);
+  OpenFile& get_file(Worker& worker, const ISOFileDef* def);
+  void read_at(OpenFile& file, u64 offset, void* dest, size_t size);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<bool> m_want_exit = false;
+  std::atomic<u64> m_read_ahead_hits = 0;
+};
+
+}  // namespace jak3
@@ -4,6 +4,8 @@
 
 #include "common/util/Assert.h"
 
+#include "game/common/dgo_rpc_types.h"
+#include "game/overlord/common/fast_dgo.h"
 #include "game/overlord/jak3/dma.h"
 #include "game/overlord/jak3/iso_api.h"
 #include "game/overlord/jak3/iso_cd.h"
@@ -1551,6 +1553,19 @@ void LoadDGO(RPC_Dgo_Cmd* cmd) {
   if (sLoadDGO.last_id < cmd->cgo_id) {
     ovrld_log(LogCategory::RPC, "DGO RPC: new command ID, starting a load for {}\n", cmd->name);
     CancelDGO(nullptr);
+    if (fast_dgo_should_load(file->full_path.c_str())) {
+      if (0 < cmd->cgo_id - sLoadDGO.last_id) {
+        sLoadDGO.last_id = cmd->cgo_id;
+      }
+      sLoadDGO.selected_id = cmd->cgo_id;
+      sLoadDGO.nosync_cancel_ack = 0;
+      cmd->status = fast_dgo_begin(file->full_path.c_str(), cmd->buffer1, cmd->buffer2,
+                                   cmd->buffer_heap_top, &cmd->buffer1);
+      if (cmd->status != DGO_RPC_RESULT_MORE) {
+        sLoadDGO.selected_id = -1;
+      }
+      return;
+    }
     sLoadDGO.msg_type = ISO_Hdr::MsgType::DGO_LOAD;
     sLoadDGO.selected_id = cmd->cgo_id;
     sLoadDGO.mbox_reply = g_nDGOMbx;
@@ -1594,6 +1609,23 @@ void LoadDGO(RPC_Dgo_Cmd* cmd) {
 }
 
 void LoadNextDGO(RPC_Dgo_Cmd* cmd) {
+  if (fast_dgo_active()) {
+    if (sLoadDGO.nosync_cancel_pending_flag && sLoadDGO.selected_id == sLoadDGO.request_cancel_id) {
+      // cancelled by CancelDGONoSync, ack it like the state machine would.
+      fast_dgo_cancel();
+      sLoadDGO.nosync_cancel_ack = 1;
+      sLoadDGO.nosync_cancel_pending_flag = 0;
+      sLoadDGO.acked_cancel_id = sLoadDGO.request_cancel_id;
+      cmd->status = DGO_RPC_RESULT_ABORTED;
+    } else {
+      cmd->status = fast_dgo_next(cmd->buffer1, cmd->buffer2, cmd->buffer_heap_top, &cmd->buffer1);
+    }
+    if (cmd->status != DGO_RPC_RESULT_MORE) {
+      sLoadDGO.selected_id = -1;
+    }
+    return;
+  }
+
   if (sLoadDGO.msg_type == ISO_Hdr::MsgType::MSG_0) {
     ovrld_log(LogCategory::WARN, "DGO RPC: LoadNextDGO {} load not running! Ignoring\n", cmd->name);
     cmd->status = 1;
@@ -1631,6 +1663,13 @@ void LoadNextDGO(RPC_Dgo_Cmd* cmd) {
 
 void CancelDGO(RPC_Dgo_Cmd* param_1) {
   ovrld_log(LogCategory::WARN, "DGO RPC: CancelDGO {}\n", param_1 ? param_1->name : "NO CMD");
+  if (fast_dgo_active()) {
+    fast_dgo_cancel();
+    if (param_1) {
+      param_1->status = DGO_RPC_RESULT_ABORTED;
+    }
+    sLoadDGO.selected_id = -1;
+  }
   if (sLoadDGO.msg_type != ISO_Hdr::MsgType::MSG_0) {
     sLoadDGO.want_abort = 1;
     if (NotifyDGO()) {
@@ -24,17 +24,22 @@
 #include "runtime.h"
 
 #include "common/cross_os_debug/xdbg.h"
+#include "common/global_profiler/FrameTimings.h"
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/goal_constants.h"
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+#include "common/util/iso_vfs.h"
 #include "common/versions/versions.h"
 
 #include "game/external/discord.h"
 #include "game/graphics/gfx.h"
 #include "game/kernel/common/fileio.h"
+#include "game/kernel/common/kboot_image.h"
 #include "game/kernel/common/kdgo.h"
 #include "game/kernel/common/kdsnetm.h"
+#include "game/kernel/common/kinput_replay.h"
 #include "game/kernel/common/klink.h"
 #include "game/kernel/common/klisten.h"
 #include "game/kernel/common/kmachine.h"
@@ -55,6 +60,7 @@
 #include "game/kernel/jak3/klisten.h"
 #include "game/kernel/jak3/kscheme.h"
 #include "game/overlord/common/fake_iso.h"
+#include "game/overlord/common/fast_dgo.h"
 #include "game/overlord/common/iso.h"
 #include "game/overlord/common/sbank.h"
 #include "game/overlord/common/srpc.h"
@@ -218,6 +224,8 @@ void ee_runner(SystemThreadInterface& iface) {
 
   kmemcard_init_globals();
   kprint_init_globals_common();
+  boot_image::init_globals();
+  input_replay::init_globals();
 
   // Added for OpenGOAL's debugger
   xdbg::allow_debugging();
@@ -271,6 +279,7 @@ void iop_runner(SystemThreadInterface& iface, GameVersion version) {
   iop::LIBRARY_register(&iop);
   Gfx::register_vsync_callback([&iop]() { iop.kernel.signal_vblank(); });
 
+  fast_dgo_init_globals();
   if (version != GameVersion::Jak3) {
     jak1::dma_init_globals();
     jak2::dma_init_globals();
@@ -349,16 +358,20 @@ void iop_runner(SystemThreadInterface& iface, GameVersion version) {
   iop.signal_overlord_init_finish();
 
   // IOP Kernel loop
+  const int dispatch_timing_channel = frame_timings().channel("iop-dispatch");
   while (!iface.get_want_exit() && !iop.want_exit) {
     // prof().root_event();
     // The IOP scheduler informs us of how many microseconds are left until it has something to do.
     // So we can wait for that long or until something else needs it to wake up.
+    Timer dispatch_timer;
     auto wait_duration = iop.kernel.dispatch();
+    frame_timings().record(dispatch_timing_channel, dispatch_timer.getMs());
     if (wait_duration) {
       iop.wait_run_iop(*wait_duration);
     }
   }
 
+  iop.kernel.log_thread_stats();
   Gfx::clear_vsync_callback();
 }
 }  // namespace
@@ -383,6 +396,33 @@ RuntimeExitStatus exec_runtime(GameLaunchOptions game_options, int argc, const c
   bool enable_display = !game_options.disable_display;
   g_game_version = game_options.game_version;
   g_server_port = game_options.server_port;
+  if (!game_options.boot_image_path.empty() && g_game_version != GameVersion::Jak1) {
+    lg::warn("Boot images are only supported in jak1, ignoring --boot-image");
+    game_options.boot_image_path.clear();
+  }
+  boot_image::set_path(game_options.boot_image_path);
+  fast_dgo_set_enabled(game_options.fast_dgo);
+  if (!game_options.record_input_path.empty() && !game_options.replay_input_path.empty()) {
+    lg::warn("Can't record inputs while replaying them, ignoring --record-input");
+    game_options.record_input_path.clear();
+  }
+  input_replay::set_paths(game_options.record_input_path, game_options.replay_input_path,
+                          game_options.exit_after_replay);
+  if (!game_options.iso_path.empty()) {
+    if (g_game_version != GameVersion::Jak1) {
+      lg::warn("Reading from an ISO is only supported in jak1, ignoring --iso");
+    } else {
+      try {
+        auto iso = std::make_shared<IsoVfs>(game_options.iso_path);
+        file_util::mount_iso(file_util::get_jak_project_dir() / "out" /
+                                 game_version_names[g_game_version] / "iso",
+                             iso);
+        fake_iso_set_image(iso);
+      } catch (const std::exception& e) {
+        lg::error("Failed to open ISO {}: {}", game_options.iso_path, e.what());
+      }
+    }
+  }
 
   gStartTime = time(nullptr);
   prof().instant_event("ROOT");
@@ -458,6 +498,7 @@ RuntimeExitStatus exec_runtime(GameLaunchOptions game_options, int argc, const c
 
   // fully shut down EE first before stopping the other threads
   ee_thread.join();
+  input_replay::stop();
 
   // to be extra sure
   tm.shutdown();
@@ -465,6 +506,10 @@ RuntimeExitStatus exec_runtime(GameLaunchOptions game_options, int argc, const c
   // join and exit
   tm.join();
 
+  if (!game_options.frame_timings_path.empty()) {
+    frame_timings().dump(game_options.frame_timings_path);
+  }
+
   // kill renderer after all threads are stopped.
   // this makes sure the std::shared_ptr<Display> is destroyed in the main thread.
   if (enable_display) {
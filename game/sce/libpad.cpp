@@ -5,6 +5,7 @@
 #include "game/graphics/display.h"
 #include "game/graphics/gfx.h"
 #include "game/kernel/common/kernel_types.h"
+#include "game/kernel/common/kinput_replay.h"
 #include "game/system/hid/input_bindings.h"
 
 /*!
@@ -94,6 +95,7 @@ int scePadRead(int port, int /*slot*/, u8* rdata) {
     }
   }
 
+  input_replay::pad(port, rdata);
   return 32;
 }
 
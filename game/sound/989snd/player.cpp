@@ -13,10 +13,17 @@
 #include <combaseapi.h>
 #include <windows.h>
 #endif
+#include "common/global_profiler/FrameTimings.h"
 #include "common/log/log.h"
+#include "common/util/Timer.h"
 
 namespace snd {
 
+namespace {
+// each callback fills a few ms of audio, so one that takes longer than this risks an underrun.
+constexpr float CALLBACK_HITCH_MS = 2.f;
+}  // namespace
+
 u8 g_global_excite = 0;
 
 Player::Player() : mVmanager(mSynth) {
@@ -86,7 +93,10 @@ long Player::sound_callback([[maybe_unused]] cubeb_stream* stream,
                             [[maybe_unused]] const void* input,
                             void* output_buffer,
                             long nframes) {
+  static const int timing_channel = frame_timings().channel("audio-callback", CALLBACK_HITCH_MS);
+  Timer timer;
   ((Player*)user)->Tick((s16Output*)output_buffer, nframes);
+  frame_timings().record(timing_channel, timer.getMs());
   return nframes;
 }
 
@@ -2,6 +2,7 @@
 
 #include <cstring>
 
+#include "common/global_profiler/FrameTimings.h"
 #include "common/global_profiler/GlobalProfiler.h"
 #include "common/log/log.h"
 #include "common/util/Assert.h"
@@ -9,8 +10,17 @@
 
 #include "game/sce/iop.h"
 
+#include "fmt/core.h"
+
 using namespace std::chrono;
 
+namespace {
+// no other IOP thread can run while one is running, so long runs can starve audio streaming.
+constexpr float RUN_HITCH_MS = 1.f;
+// dispatch may sleep for up to 1 ms before noticing a delay has expired.
+constexpr float LATENCY_HITCH_MS = 2.f;
+}  // namespace
+
 /*
 ** wrap thread entry points to ensure they don't return into libco
 */
@@ -57,7 +67,11 @@ s32 IOP_Kernel::CreateThread(std::string name, void (*func)(), u32 priority) {
   ASSERT(ID == threads.size());
 
   // add entry
-  threads.emplace_back(name, func, ID, priority);
+  auto& thread = threads.emplace_back(name, func, ID, priority);
+  thread.run_timing_channel =
+      frame_timings().channel(fmt::format("iop/{}/run", name), RUN_HITCH_MS);
+  thread.latency_timing_channel =
+      frame_timings().channel(fmt::format("iop/{}/latency", name), LATENCY_HITCH_MS);
 
   // enter the function wrapper so it can put the actual thread enry on its stack
   // to call it when the thread is eventually started
@@ -72,7 +86,7 @@ s32 IOP_Kernel::CreateThread(std::string name, void (*func)(), u32 priority) {
  * Start a thread. Marking it to run on each dispatch of the IOP kernel.
  */
 void IOP_Kernel::StartThread(s32 id) {
-  threads.at(id).state = IopThread::State::Ready;
+  setReady(&threads.at(id));
 }
 
 s32 IOP_Kernel::ExitThread() {
@@ -88,10 +102,10 @@ s32 IOP_Kernel::ExitThread() {
 void IOP_Kernel::DelayThread(u32 usec) {
   ASSERT(_currentThread);
 
-  _currentThread->state = IopThread::State::Wait;
-  _currentThread->waitType = IopThread::Wait::Delay;
   _currentThread->resumeTime =
       time_point_cast<microseconds>(steady_clock::now()) + microseconds(usec);
+  delay_queue.emplace(_currentThread->resumeTime, _currentThread->thID);
+  waitCurrent(IopThread::State::Wait, IopThread::Wait::Delay);
   leaveThread();
 }
 
@@ -101,13 +115,16 @@ void IOP_Kernel::DelayThread(u32 usec) {
 void IOP_Kernel::SleepThread() {
   ASSERT(_currentThread);
 
+  // the wait type is left alone, so a thread that was delayed can still be woken by its delay.
   _currentThread->state = IopThread::State::Suspend;
+  _currentThread->stats_wait = IopThread::Wait::None;
+  _currentThread->wait_start = steady_clock::now();
   leaveThread();
 }
 
 void IOP_Kernel::YieldThread() {
   ASSERT(_currentThread);
-  _currentThread->state = IopThread::State::Ready;
+  setReady(_currentThread);
   leaveThread();
 }
 
@@ -116,7 +133,7 @@ void IOP_Kernel::YieldThread() {
  */
 void IOP_Kernel::WakeupThread(s32 id) {
   ASSERT(id > 0);
-  threads.at(id).state = IopThread::State::Ready;
+  setReady(&threads.at(id));
 }
 
 void IOP_Kernel::iWakeupThread(s32 id) {
@@ -133,8 +150,7 @@ s32 IOP_Kernel::WaitSema(s32 id) {
   }
 
   sema.wait_list.push_back(_currentThread);
-  _currentThread->state = IopThread::State::Wait;
-  _currentThread->waitType = IopThread::Wait::Semaphore;
+  waitCurrent(IopThread::State::Wait, IopThread::Wait::Semaphore);
   leaveThread();
 
   return KE_OK;
@@ -177,8 +193,7 @@ s32 IOP_Kernel::WaitEventFlag(s32 flag, u32 pattern, u32 mode) {
     wait_entry.mode = mode;
     wait_entry.thread = _currentThread;
 
-    _currentThread->state = IopThread::State::Wait;
-    _currentThread->waitType = IopThread::Wait::EventFlag;
+    waitCurrent(IopThread::State::Wait, IopThread::Wait::EventFlag);
     leaveThread();
 
     return KE_OK;
@@ -195,7 +210,7 @@ s32 IOP_Kernel::SetEventFlag(s32 flag, u32 pattern) {
         ef.value = 0;
       }
       it->thread->waitType = IopThread::Wait::None;
-      it->thread->state = IopThread::State::Ready;
+      setReady(it->thread);
       it = ef.wait_list.erase(it);
     } else {
       ++it;
@@ -216,8 +231,7 @@ s32 IOP_Kernel::ReceiveMbx(void** msg, s32 id) {
   ASSERT(!box.wait_thread);  // don't know how to deal with this, hopefully doesn't come up.
 
   box.wait_thread = _currentThread;
-  _currentThread->state = IopThread::State::Wait;
-  _currentThread->waitType = IopThread::Wait::Messagebox;
+  waitCurrent(IopThread::State::Wait, IopThread::Wait::Messagebox);
   leaveThread();
 
   auto ret = PollMbx(msg, id);
@@ -234,7 +248,7 @@ s32 IOP_Kernel::SendMbx(s32 mbx, void* value) {
   if (to_run) {
     box.wait_thread = nullptr;
     to_run->waitType = IopThread::Wait::None;
-    to_run->state = IopThread::State::Ready;
+    setReady(to_run);
   }
   return 0;
 }
@@ -265,7 +279,7 @@ s32 IOP_Kernel::SignalSema(s32 id) {
   }
 
   to_run->waitType = IopThread::Wait::None;
-  to_run->state = IopThread::State::Ready;
+  setReady(to_run);
   return KE_OK;
 }
 
@@ -291,6 +305,46 @@ void IOP_Kernel::leaveThread() {
   ASSERT(_currentThread == oldThread);
 }
 
+/*!
+ * Put the current thread in a waiting state. The caller should leave the thread after this.
+ */
+void IOP_Kernel::waitCurrent(IopThread::State state, IopThread::Wait wait) {
+  ASSERT(_currentThread);
+  _currentThread->state = state;
+  _currentThread->waitType = wait;
+  _currentThread->stats_wait = wait;
+  _currentThread->wait_start = steady_clock::now();
+}
+
+void IOP_Kernel::setReady(IopThread* thread) {
+  setReady(thread, steady_clock::now());
+}
+
+/*!
+ * Mark a thread as Ready, to be run by the kernel. The latency of the thread is measured from
+ * since, the time it could have run.
+ */
+void IOP_Kernel::setReady(IopThread* thread, steady_clock::time_point since) {
+  if (thread->state == IopThread::State::Ready) {
+    return;
+  }
+  if (thread->state == IopThread::State::Wait || thread->state == IopThread::State::Suspend) {
+    auto& wait = thread->stats.waits.at((int)thread->stats_wait);
+    u64 wait_ns = duration_cast<nanoseconds>(steady_clock::now() - thread->wait_start).count();
+    wait.count++;
+    wait.total_ns += wait_ns;
+    wait.max_ns = std::max(wait.max_ns, wait_ns);
+    thread->stats.wakeups++;
+    prof().instant_event(thread->wake_event_name.c_str());
+  }
+  thread->state = IopThread::State::Ready;
+  thread->ready_time = since;
+  if (!thread->in_ready_queue) {
+    thread->in_ready_queue = true;
+    ready_queue.emplace(thread->priority, thread->thID);
+  }
+}
+
 /*
 ** -----------------------------------------------------------------------------
 ** Kernel functions.
@@ -302,47 +356,68 @@ void IOP_Kernel::leaveThread() {
  */
 void IOP_Kernel::runThread(IopThread* thread) {
   ASSERT(_currentThread == nullptr);  // should run in the kernel thread
+  auto& stats = thread->stats;
+  auto start = steady_clock::now();
+  u64 latency_ns = duration_cast<nanoseconds>(start - thread->ready_time).count();
+  stats.latency_ns += latency_ns;
+  stats.max_latency_ns = std::max(stats.max_latency_ns, latency_ns);
+  frame_timings().record(thread->latency_timing_channel, latency_ns / 1e6f);
+
   _currentThread = thread;
   thread->state = IopThread::State::Run;
   co_switch(thread->thread);
   _currentThread = nullptr;
+
+  u64 run_ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  stats.runs++;
+  stats.run_ns += run_ns;
+  stats.max_run_ns = std::max(stats.max_run_ns, run_ns);
+  frame_timings().record(thread->run_timing_channel, run_ns / 1e6f);
 }
 
 /*!
 ** Update wait states for delayed threads
 */
 void IOP_Kernel::updateDelay() {
-  for (auto& t : threads) {
-    if (t.waitType == IopThread::Wait::Delay) {
-      if (steady_clock::now() > t.resumeTime) {
-        t.waitType = IopThread::Wait::None;
-        t.state = IopThread::State::Ready;
-      }
+  auto now = steady_clock::now();
+  while (!delay_queue.empty() && now > delay_queue.top().first) {
+    auto [resume_time, id] = delay_queue.top();
+    delay_queue.pop();
+    auto& t = threads.at(id);
+    // skip threads that were delayed again, or woken and are now waiting on something else.
+    if (t.waitType == IopThread::Wait::Delay && t.resumeTime == resume_time) {
+      t.waitType = IopThread::Wait::None;
+      setReady(&t, resume_time);
     }
   }
 }
 
 std::optional<time_stamp> IOP_Kernel::nextWakeup() {
-  bool found_ready = false;
-  time_stamp lowest = time_point_cast<microseconds>(steady_clock::now()) + microseconds(1000);
+  if (peekReady()) {
+    return {};
+  }
 
-  for (auto& t : threads) {
-    if (t.waitType == IopThread::Wait::Delay) {
-      if (t.resumeTime < lowest) {
-        lowest = t.resumeTime;
-      }
-    }
+  time_stamp lowest = time_point_cast<microseconds>(steady_clock::now()) + microseconds(1000);
+  // this may be a skipped entry, which just wakes us up early.
+  if (!delay_queue.empty() && delay_queue.top().first < lowest) {
+    lowest = delay_queue.top().first;
+  }
+  return lowest;
+}
 
+/*!
+** Get the Ready thread with the highest priority, without removing it from the queue.
+*/
+IopThread* IOP_Kernel::peekReady() {
+  while (!ready_queue.empty()) {
+    auto& t = threads.at(ready_queue.top().second);
     if (t.state == IopThread::State::Ready) {
-      found_ready = true;
+      return &t;
     }
+    ready_queue.pop();
+    t.in_ready_queue = false;
   }
-
-  if (found_ready) {
-    return {};
-  } else {
-    return lowest;
-  }
+  return nullptr;
 }
 
 /*!
@@ -350,22 +425,12 @@ std::optional<time_stamp> IOP_Kernel::nextWakeup() {
 ** i.e. Highest prio in ready state.
 */
 IopThread* IOP_Kernel::schedNext() {
-  IopThread* highest_prio = nullptr;
-
-  for (auto& t : threads) {
-    if (t.state == IopThread::State::Ready) {
-      if (highest_prio == nullptr) {
-        highest_prio = &t;
-      }
-
-      // Lower number = higher priority
-      if (t.priority < highest_prio->priority) {
-        highest_prio = &t;
-      }
-    }
+  IopThread* next = peekReady();
+  if (next) {
+    ready_queue.pop();
+    next->in_ready_queue = false;
   }
-
-  return highest_prio;
+  return next;
 };
 
 void IOP_Kernel::processWakeups() {
@@ -408,6 +473,31 @@ std::optional<time_stamp> IOP_Kernel::dispatch() {
   return nextWakeup();
 }
 
+/*!
+ * Print the scheduler stats of each thread that has run.
+ */
+void IOP_Kernel::log_thread_stats() {
+  auto ms = [](u64 ns) { return ns / 1e6; };
+  lg::info("[IOP Kernel] thread stats (ms):");
+  for (auto& t : threads) {
+    auto& s = t.stats;
+    if (!s.runs) {
+      continue;
+    }
+    lg::info("  {:20s} runs {:8d} run {:10.3f} (max {:7.3f}) latency {:10.3f} (max {:7.3f})",
+             t.name, s.runs, ms(s.run_ns), ms(s.max_run_ns), ms(s.latency_ns),
+             ms(s.max_latency_ns));
+    static constexpr const char* wait_names[] = {"sleep", "sema", "delay", "mbx", "event-flag"};
+    for (size_t i = 0; i < s.waits.size(); i++) {
+      auto& w = s.waits[i];
+      if (w.count) {
+        lg::info("  {:20s}   {:10s} waits {:8d} total {:10.3f} (max {:7.3f})", "", wait_names[i],
+                 w.count, ms(w.total_ns), ms(w.max_ns));
+      }
+    }
+  }
+}
+
 void IOP_Kernel::set_rpc_queue(iop::sceSifQueueData* qd, u32 thread) {
   sif_mtx.lock();
   for (const auto& r : sif_records) {
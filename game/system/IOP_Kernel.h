@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <optional>
@@ -55,9 +58,28 @@ struct IopThread {
 
   enum class Wait { None, Semaphore, Delay, Messagebox, EventFlag };
 
+  struct WaitStats {
+    u64 count = 0;
+    u64 total_ns = 0;
+    u64 max_ns = 0;
+  };
+
+  struct Stats {
+    u64 runs = 0;  // number of times the kernel switched to this thread
+    u64 run_ns = 0;
+    u64 max_run_ns = 0;
+    // time from when the thread could have run (it was woken, or its delay expired) until it ran.
+    u64 latency_ns = 0;
+    u64 max_latency_ns = 0;
+    u64 wakeups = 0;
+    // time spent waiting, indexed by Wait. Wait::None is time spent in SleepThread.
+    std::array<WaitStats, 5> waits;
+  };
+
   IopThread(std::string n, void (*f)(), s32 ID, u32 pri)
       : name(std::move(n)), function(f), priority(pri), thID(ID) {
     thread = co_create(0x300000, functionWrapper);
+    wake_event_name = "wake " + name;
   }
 
   ~IopThread() { co_delete(thread); }
@@ -71,6 +93,17 @@ struct IopThread {
   time_stamp resumeTime = {};
   u32 priority = 0;
   s32 thID = -1;
+
+  // scheduler bookkeeping
+  bool in_ready_queue = false;
+  std::chrono::steady_clock::time_point ready_time = {};
+  std::chrono::steady_clock::time_point wait_start = {};
+  Wait stats_wait = Wait::None;  // what wait_start is for
+
+  Stats stats;
+  std::string wake_event_name;
+  int run_timing_channel = -1;
+  int latency_timing_channel = -1;
 };
 
 struct Semaphore {
@@ -123,6 +156,8 @@ class IOP_Kernel {
   void set_rpc_queue(iop::sceSifQueueData* qd, u32 thread);
   void rpc_loop(iop::sceSifQueueData* qd);
   void shutdown();
+  void log_thread_stats();
+  const IopThread::Stats& thread_stats(s32 id) const { return threads.at(id).stats; }
 
   /*!
    * Get current thread ID.
@@ -217,9 +252,13 @@ class IOP_Kernel {
  private:
   void runThread(IopThread* thread);
   void leaveThread();
+  void waitCurrent(IopThread::State state, IopThread::Wait wait);
+  void setReady(IopThread* thread);
+  void setReady(IopThread* thread, std::chrono::steady_clock::time_point since);
   void updateDelay();
   void processWakeups();
 
+  IopThread* peekReady();
   IopThread* schedNext();
   std::optional<time_stamp> nextWakeup();
 
@@ -234,6 +273,16 @@ class IOP_Kernel {
   std::vector<SifRecord> sif_records;
   std::vector<Semaphore> semas;
   std::vector<EventFlag> event_flags;
+
+  // Ready threads by (priority, thID), so ties go to the thread created first. Threads stay in here
+  // when they leave the Ready state without running, those entries are skipped by peekReady.
+  using ReadyEntry = std::pair<u32, s32>;
+  std::priority_queue<ReadyEntry, std::vector<ReadyEntry>, std::greater<ReadyEntry>> ready_queue;
+  // Delayed threads by resume time. Entries for threads that are no longer waiting on that delay
+  // are skipped by updateDelay.
+  using DelayEntry = std::pair<time_stamp, s32>;
+  std::priority_queue<DelayEntry, std::vector<DelayEntry>, std::greater<DelayEntry>> delay_queue;
+
   std::queue<int> wakeup_queue;
   bool mainThreadSleep = false;
   std::mutex sif_mtx, wakeup_mtx;
@@ -30,6 +30,9 @@ bool BackgroundWorker::process_queues() {
       case JobType::WEB_REQUEST:
         job_web_request(std::get<WebRequestJobPayload>(job.payload));
         break;
+      case JobType::FUNCTION:
+        std::get<FunctionJobPayload>(job.payload).func();
+        break;
       default:
         lg::error("[Job] Unsupported job type!");
         break;
@@ -45,6 +48,11 @@ void BackgroundWorker::enqueue_webrequest(WebRequestJobPayload payload) {
   inbox_queue.push({JobType::WEB_REQUEST, payload});
 }
 
+void BackgroundWorker::enqueue_function(std::function<void()> func) {
+  std::lock_guard<std::mutex> inbox_lock(inbox_queue_lock);
+  inbox_queue.push({JobType::FUNCTION, FunctionJobPayload{JobType::FUNCTION, std::move(func)}});
+}
+
 static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
   ((std::string*)userp)->append((char*)contents, size * nmemb);
   return size * nmemb;
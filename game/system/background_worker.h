@@ -12,7 +12,7 @@
 // but since you cannot spawn new threads directly in the EE without causing problems
 // you can delegate to this worker, managed by a separate worker thread `ee_worker_thread`.
 
-enum class JobType { WEB_REQUEST };
+enum class JobType { WEB_REQUEST, FUNCTION };
 
 struct WebRequestJobPayload {
   JobType type = JobType::WEB_REQUEST;
@@ -21,9 +21,14 @@ struct WebRequestJobPayload {
   std::function<void(bool, std::string cache_id, std::optional<std::string>)> callback;
 };
 
+struct FunctionJobPayload {
+  JobType type = JobType::FUNCTION;
+  std::function<void()> func;
+};
+
 struct BackgroundJob {
   JobType type;
-  std::variant<WebRequestJobPayload> payload;
+  std::variant<WebRequestJobPayload, FunctionJobPayload> payload;
 };
 
 // TODO - consider adding some sort of job tracking / polling if required
@@ -43,6 +48,7 @@ class BackgroundWorker {
   bool process_queues();
 
   void enqueue_webrequest(WebRequestJobPayload payload);
+  void enqueue_function(std::function<void()> func);
 
  private:
   void job_web_request(WebRequestJobPayload payload);
@@ -158,6 +158,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "custom_assets/jak1/models/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -169,6 +170,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "custom_assets/jak1/levels/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -180,6 +182,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "goal_src/jak1/dgos/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -88,6 +88,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "custom_assets/jak2/levels/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -99,6 +100,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "goal_src/jak2/dgos/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -88,6 +88,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "goal_src/jak3/dgos/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -241,6 +242,7 @@
   (let ((out-name (string-append "$OUT/iso/" output-name)))
     (defstep :in (string-append "custom_assets/jak3/levels/" desc-file-name)
       :tool 'dgo
+      :arg (if *compress-dgos* 'zstd #f)
       :out `(,out-name)
       )
     (set! *all-cgos* (cons out-name *all-cgos*))
@@ -1,34 +1,48 @@
 #include "collide_bvh.h"
 
 #include <algorithm>
+#include <limits>
 #include <map>
-#include <unordered_set>
+#include <unordered_map>
 
 #include "common/log/log.h"
 #include "common/util/Assert.h"
+#include "common/util/JobSystem.h"
 #include "common/util/Timer.h"
 
 // Collision BVH algorithm
 // We start with all the points in a single node, then recursively split nodes in 8 until no nodes
 // have too many faces.
-// The splitting is done by doing median cuts along the x, y, or z axis.
+// The splitting is done with a binned surface area heuristic on the face centers, falling back to
+// a median cut along the longest axis if the SAH split is too unbalanced.
+// Faces are never copied during the build: every node refers to a range of a single array of face
+// indices, which is partitioned in place as nodes are split. The range of a node covers the faces
+// of all of its children.
 
-// The bspheres are built at the end.
+// The bspheres are computed as nodes are created.
 
 namespace collide {
 
 namespace {
 constexpr int MAX_UNIQUE_VERTS_IN_FRAG = 128;
+constexpr int SAH_BIN_COUNT = 16;
+// subtrees at the top of the tree with at least this many faces are built in parallel.
+constexpr u32 MIN_FACES_FOR_PARALLEL = 4096;
 
 /*!
  * The Collide node.
- * If it's a leaf, it has faces
+ * If it's a leaf, it has no children and owns the faces in its range.
  * Otherwise it has 2, 4, or 8 children nodes.
  */
 struct CNode {
   std::vector<CNode> child_nodes;
-  std::vector<jak1::CollideFace> faces;
+  // range in BuildContext::face_order
+  u32 begin = 0;
+  u32 end = 0;
   math::Vector4f bsphere;
+
+  bool is_leaf() const { return child_nodes.empty(); }
+  u32 face_count() const { return end - begin; }
 };
 
 struct VectorHash {
@@ -38,43 +52,99 @@ struct VectorHash {
 };
 
 /*!
- * Recursively get a list of vertices.
+ * Shared state for building a tree. The face_order array is modified by splits, but splits of
+ * different nodes only touch disjoint ranges, so separate subtrees can be built in parallel.
+ */
+struct BuildContext {
+  const std::vector<jak1::CollideFace>& faces;
+  std::vector<u32> face_order;
+  // the id of each face's vertices, where equal vertices get the same id.
+  std::vector<u32> vertex_ids;
+  u32 unique_vertex_total = 0;
+
+  explicit BuildContext(const std::vector<jak1::CollideFace>& tris) : faces(tris) {
+    face_order.resize(faces.size());
+    for (u32 i = 0; i < face_order.size(); i++) {
+      face_order[i] = i;
+    }
+
+    std::unordered_map<math::Vector3f, u32, VectorHash> ids;
+    ids.reserve(faces.size() * 3);
+    vertex_ids.reserve(faces.size() * 3);
+    for (auto& face : faces) {
+      for (auto& v : face.v) {
+        auto [it, inserted] = ids.try_emplace(v, unique_vertex_total);
+        if (inserted) {
+          unique_vertex_total++;
+        }
+        vertex_ids.push_back(it->second);
+      }
+    }
+  }
+
+  const jak1::CollideFace& face(u32 idx) const { return faces[face_order[idx]]; }
+};
+
+/*!
+ * Count the unique vertices in a node, stopping early once limit is reached.
  */
-void collect_vertices(const CNode& node, std::vector<math::Vector3f>& verts) {
-  for (auto& child : node.child_nodes) {
-    collect_vertices(child, verts);
+int count_unique_vertices(const BuildContext& ctx, const CNode& node, int limit) {
+  // per-thread "seen" stamps, so we don't need to clear a set for each query.
+  thread_local std::vector<u32> seen_stamp;
+  thread_local u32 current_stamp = 0;
+  if (seen_stamp.size() < ctx.unique_vertex_total) {
+    seen_stamp.assign(ctx.unique_vertex_total, 0);
+    current_stamp = 0;
   }
-  for (auto& face : node.faces) {
-    verts.push_back(face.v[0]);
-    verts.push_back(face.v[1]);
-    verts.push_back(face.v[2]);
+  current_stamp++;
+  if (current_stamp == 0) {
+    std::fill(seen_stamp.begin(), seen_stamp.end(), 0);
+    current_stamp = 1;
   }
+
+  int count = 0;
+  for (u32 i = node.begin; i < node.end; i++) {
+    for (int j = 0; j < 3; j++) {
+      u32 id = ctx.vertex_ids[ctx.face_order[i] * 3 + j];
+      if (seen_stamp[id] != current_stamp) {
+        seen_stamp[id] = current_stamp;
+        if (++count >= limit) {
+          return count;
+        }
+      }
+    }
+  }
+  return count;
 }
 
 /*!
- * Find the vertex in verts that is most distant from pt.
+ * Find the vertex in the node that is most distant from pt.
  */
-size_t find_most_distant(math::Vector3f pt, const std::vector<math::Vector3f>& verts) {
+math::Vector3f find_most_distant(const BuildContext& ctx,
+                                 const CNode& node,
+                                 const math::Vector3f& pt) {
   float max_dist_squared = 0;
-  size_t idx_of_best = 0;
-  for (size_t i = 0; i < verts.size(); i++) {
-    float dist = (pt - verts[i]).squared_length();
-    if (dist > max_dist_squared) {
-      max_dist_squared = dist;
-      idx_of_best = i;
+  math::Vector3f best = pt;
+  for (u32 i = node.begin; i < node.end; i++) {
+    for (auto& v : ctx.face(i).v) {
+      float dist = (pt - v).squared_length();
+      if (dist > max_dist_squared) {
+        max_dist_squared = dist;
+        best = v;
+      }
     }
   }
-  return idx_of_best;
+  return best;
 }
 
 /*!
  * Compute a bounding sphere for a node and its children.
  */
-void compute_my_bsphere_ritters(CNode& node, const std::vector<math::Vector3f>& verts) {
-  ASSERT(verts.size() > 0);
-  auto px = verts[0];
-  auto py = verts[find_most_distant(px, verts)];
-  auto pz = verts[find_most_distant(py, verts)];
+void compute_my_bsphere_ritters(const BuildContext& ctx, CNode& node) {
+  ASSERT(node.face_count() > 0);
+  auto px = ctx.face(node.begin).v[0];
+  auto py = find_most_distant(ctx, node, px);
+  auto pz = find_most_distant(ctx, node, py);
 
   auto origin = (pz + py) / 2.f;
   node.bsphere.x() = origin.x();
@@ -82,75 +152,166 @@ void compute_my_bsphere_ritters(CNode& node, const std::vector<math::Vector3f>&
   node.bsphere.z() = origin.z();
 
   float max_squared = 0;
-  for (auto& pt : verts) {
-    max_squared = std::max(max_squared, (pt - origin).squared_length());
+  for (u32 i = node.begin; i < node.end; i++) {
+    for (auto& pt : ctx.face(i).v) {
+      max_squared = std::max(max_squared, (pt - origin).squared_length());
+    }
   }
   node.bsphere.w() = std::sqrt(max_squared);
 }
 
-/*!
- * Compute a bounding sphere for a node and its children.
- */
-void compute_my_bsphere_ritters(CNode& node) {
-  std::vector<math::Vector3f> verts;
-  collect_vertices(node, verts);
-  compute_my_bsphere_ritters(node, verts);
-}
+struct Bounds {
+  static constexpr float kInf = std::numeric_limits<float>::max();
+  math::Vector3f min = math::Vector3f(kInf, kInf, kInf);
+  math::Vector3f max = math::Vector3f(-kInf, -kInf, -kInf);
+
+  void add(const math::Vector3f& pt) {
+    for (int i = 0; i < 3; i++) {
+      min[i] = std::min(min[i], pt[i]);
+      max[i] = std::max(max[i], pt[i]);
+    }
+  }
+
+  void add(const Bounds& other) {
+    if (other.empty()) {
+      return;
+    }
+    add(other.min);
+    add(other.max);
+  }
+
+  bool empty() const { return min.x() > max.x(); }
+
+  float half_area() const {
+    auto size = max - min;
+    return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+  }
+};
 
 /*!
- * Split faces in two along a coordinate plane.
- * Will clear the input faces
+ * Pick a place to split the faces of a node, using a binned surface area heuristic on the face
+ * bsphere centers. Returns the number of faces that go in the first child, after partitioning the
+ * node's range in place. Returns 0 if there is no acceptable SAH split.
  */
-void split_along_dim(std::vector<jak1::CollideFace>& faces,
-                     int dim,
-                     std::vector<jak1::CollideFace>* out0,
-                     std::vector<jak1::CollideFace>* out1) {
-  std::sort(faces.begin(), faces.end(),
-            [=](const jak1::CollideFace& a, const jak1::CollideFace& b) {
-              return a.bsphere[dim] < b.bsphere[dim];
-            });
-  // lg::print("splitting with size: {}\n", faces.size());
-  size_t split_idx = faces.size() / 2;
-  out0->insert(out0->end(), faces.begin(), faces.begin() + split_idx);
-  out1->insert(out1->end(), faces.begin() + split_idx, faces.end());
+u32 partition_sah(BuildContext& ctx, const CNode& node, const Bounds& centers) {
+  const u32 n = node.face_count();
+  // don't allow very unbalanced splits, the tree depth is limited.
+  const u32 min_side = std::max(1u, n / 8);
+
+  float best_cost = std::numeric_limits<float>::max();
+  int best_dim = -1;
+  int best_bin = 0;
+
+  auto bin_of = [&](int dim, const jak1::CollideFace& face) {
+    float extent = centers.max[dim] - centers.min[dim];
+    int bin = (int)(SAH_BIN_COUNT * (face.bsphere[dim] - centers.min[dim]) / extent);
+    return std::clamp(bin, 0, SAH_BIN_COUNT - 1);
+  };
+
+  for (int dim = 0; dim < 3; dim++) {
+    if (centers.max[dim] <= centers.min[dim]) {
+      continue;
+    }
+
+    Bounds bin_bounds[SAH_BIN_COUNT];
+    u32 bin_counts[SAH_BIN_COUNT] = {0};
+    for (u32 i = node.begin; i < node.end; i++) {
+      const auto& face = ctx.face(i);
+      int bin = bin_of(dim, face);
+      bin_counts[bin]++;
+      for (auto& v : face.v) {
+        bin_bounds[bin].add(v);
+      }
+    }
+
+    // sweep from the right to get the cost of everything after each split plane
+    float right_cost[SAH_BIN_COUNT];
+    u32 right_count[SAH_BIN_COUNT];
+    Bounds right;
+    u32 count = 0;
+    for (int bin = SAH_BIN_COUNT - 1; bin > 0; bin--) {
+      right.add(bin_bounds[bin]);
+      count += bin_counts[bin];
+      right_cost[bin] = count ? right.half_area() * count : 0;
+      right_count[bin] = count;
+    }
+
+    // then from the left, splitting between bin - 1 and bin.
+    Bounds left;
+    count = 0;
+    for (int bin = 1; bin < SAH_BIN_COUNT; bin++) {
+      left.add(bin_bounds[bin - 1]);
+      count += bin_counts[bin - 1];
+      if (count < min_side || right_count[bin] < min_side) {
+        continue;
+      }
+      float cost = left.half_area() * count + right_cost[bin];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_dim = dim;
+        best_bin = bin;
+      }
+    }
+  }
+
+  if (best_dim < 0) {
+    return 0;
+  }
+
+  auto mid = std::partition(
+      ctx.face_order.begin() + node.begin, ctx.face_order.begin() + node.end,
+      [&](u32 idx) { return bin_of(best_dim, ctx.faces[idx]) < best_bin; });
+  return (u32)(mid - (ctx.face_order.begin() + node.begin));
 }
 
 /*!
- * Split a node into two nodes. The outputs should be uninitialized nodes
+ * Split a node's faces in half with a median cut along the longest axis.
  */
-void split_node_once(CNode& node, CNode* out0, CNode* out1) {
-  compute_my_bsphere_ritters(node);
-  CNode temps[6];
-  split_along_dim(node.faces, 0, &temps[0].faces, &temps[1].faces);
-  split_along_dim(node.faces, 1, &temps[2].faces, &temps[3].faces);
-  split_along_dim(node.faces, 2, &temps[4].faces, &temps[5].faces);
-  node.faces.clear();
-  for (auto& t : temps) {
-    compute_my_bsphere_ritters(t);
+u32 partition_median(BuildContext& ctx, const CNode& node, const Bounds& centers) {
+  auto size = centers.max - centers.min;
+  int dim = 0;
+  for (int i = 1; i < 3; i++) {
+    if (size[i] > size[dim]) {
+      dim = i;
+    }
   }
 
-  float max_bspheres[3] = {0, 0, 0};
+  u32 split_idx = node.face_count() / 2;
+  std::nth_element(ctx.face_order.begin() + node.begin,
+                   ctx.face_order.begin() + node.begin + split_idx,
+                   ctx.face_order.begin() + node.end, [&](u32 a, u32 b) {
+                     return ctx.faces[a].bsphere[dim] < ctx.faces[b].bsphere[dim];
+                   });
+  return split_idx;
+}
 
-  for (int i = 0; i < 3; i++) {
-    max_bspheres[i] = std::max(temps[i * 2].bsphere.w(), temps[i * 2 + 1].bsphere.w());
+/*!
+ * Split a node into two nodes. The outputs should be uninitialized nodes.
+ * The bspheres of the outputs are computed.
+ */
+void split_node_once(BuildContext& ctx, const CNode& node, CNode* out0, CNode* out1) {
+  ASSERT(node.face_count() >= 2);
+  Bounds centers;
+  for (u32 i = node.begin; i < node.end; i++) {
+    centers.add(ctx.face(i).bsphere.xyz());
   }
 
-  int best_dim = 0;
-  float best_w = max_bspheres[0];
-  for (int i = 0; i < 3; i++) {
-    if (max_bspheres[i] < best_w) {
-      best_dim = i;
-      best_w = max_bspheres[i];
-    }
+  u32 split_idx = partition_sah(ctx, node, centers);
+  if (split_idx == 0 || split_idx == node.face_count()) {
+    split_idx = partition_median(ctx, node, centers);
   }
 
-  *out0 = temps[best_dim * 2];
-  *out1 = temps[best_dim * 2 + 1];
+  out0->begin = node.begin;
+  out0->end = node.begin + split_idx;
+  out1->begin = out0->end;
+  out1->end = node.end;
+  compute_my_bsphere_ritters(ctx, *out0);
+  compute_my_bsphere_ritters(ctx, *out1);
 }
 
-bool needs_split(const CNode& node) {
+bool needs_split(const BuildContext& ctx, const CNode& node) {
   // quick reject.
-  if (node.faces.size() > 100) {
+  if (node.face_count() > 100) {
     return true;
   }
 
@@ -158,38 +319,33 @@ bool needs_split(const CNode& node) {
     return true;
   }
 
-  ASSERT(node.child_nodes.empty());
-  std::unordered_set<math::Vector3f, VectorHash> unique_verts;
-  for (auto& f : node.faces) {
-    for (auto& v : f.v) {
-      unique_verts.insert(v);
-    }
-  }
-
-  return unique_verts.size() >= MAX_UNIQUE_VERTS_IN_FRAG;
+  ASSERT(node.is_leaf());
+  return count_unique_vertices(ctx, node, MAX_UNIQUE_VERTS_IN_FRAG) >= MAX_UNIQUE_VERTS_IN_FRAG;
 }
 
-void split_recursive(CNode& to_split) {
-  ASSERT(to_split.child_nodes.empty());
-  ASSERT(!to_split.faces.empty());
+void split_recursive(BuildContext& ctx, CNode& to_split, int depth) {
+  ASSERT(to_split.is_leaf());
+  ASSERT(to_split.face_count() > 0);
+
+  // children that need to be split further. These are only recursed into after all the children
+  // are created, so the child_nodes array doesn't move while we are working on them.
+  std::vector<size_t> to_recurse;
 
   CNode level0[2];
-  split_node_once(to_split, &level0[0], &level0[1]);
+  split_node_once(ctx, to_split, &level0[0], &level0[1]);
   for (int i = 0; i < 2; i++) {
-    if (needs_split(level0[i])) {
+    if (needs_split(ctx, level0[i])) {
       CNode level1[2];
-      split_node_once(level0[i], &level1[0], &level1[1]);
+      split_node_once(ctx, level0[i], &level1[0], &level1[1]);
       for (int j = 0; j < 2; j++) {
-        if (needs_split(level1[j])) {
+        if (needs_split(ctx, level1[j])) {
           CNode level2[2];
-          split_node_once(level1[j], &level2[0], &level2[1]);
+          split_node_once(ctx, level1[j], &level2[0], &level2[1]);
           for (int k = 0; k < 2; k++) {
-            if (needs_split(level2[k])) {
-              to_split.child_nodes.push_back(std::move(level2[k]));
-              split_recursive(to_split.child_nodes.back());
-            } else {
-              to_split.child_nodes.push_back(std::move(level2[k]));
+            if (needs_split(ctx, level2[k])) {
+              to_recurse.push_back(to_split.child_nodes.size());
             }
+            to_split.child_nodes.push_back(std::move(level2[k]));
           }
         } else {
           to_split.child_nodes.push_back(std::move(level1[j]));
@@ -202,68 +358,78 @@ void split_recursive(CNode& to_split) {
 
   ASSERT(to_split.child_nodes.size() <= 8);
 
+  if (depth == 0 && to_split.face_count() >= MIN_FACES_FOR_PARALLEL && to_recurse.size() > 1) {
+    JobSystem::global().parallel_for("split-collide-bvh", to_recurse.size(), [&](size_t i) {
+      split_recursive(ctx, to_split.child_nodes.at(to_recurse.at(i)), depth + 1);
+    });
+  } else {
+    for (auto idx : to_recurse) {
+      split_recursive(ctx, to_split.child_nodes.at(idx), depth + 1);
+    }
+  }
+
   bool has_leaves = false;
   bool has_not_leaves = false;
   for (auto& child : to_split.child_nodes) {
-    if (!child.faces.empty()) {
+    if (child.is_leaf()) {
       has_leaves = true;
-    }
-    if (!child.child_nodes.empty()) {
+    } else {
       has_not_leaves = true;
     }
   }
 
+  // a draw node's children are either all frags or all draw nodes, so move each leaf down a level.
   if (has_leaves && has_not_leaves) {
-    std::vector<CNode> temp_children = std::move(to_split.child_nodes);
-    to_split.child_nodes = {};
-    for (auto& c : temp_children) {
-      if (!c.faces.empty()) {
-        to_split.child_nodes.emplace_back();
-        to_split.child_nodes.emplace_back();
-        split_node_once(c, &to_split.child_nodes[to_split.child_nodes.size() - 1],
-                        &to_split.child_nodes[to_split.child_nodes.size() - 2]);
+    for (auto& c : to_split.child_nodes) {
+      if (!c.is_leaf()) {
+        continue;
+      }
+      CNode leaf = std::move(c);
+      c = {};
+      c.begin = leaf.begin;
+      c.end = leaf.end;
+      c.bsphere = leaf.bsphere;
+      if (leaf.face_count() >= 2) {
+        c.child_nodes.resize(2);
+        split_node_once(ctx, leaf, &c.child_nodes[0], &c.child_nodes[1]);
       } else {
-        to_split.child_nodes.push_back(std::move(c));
+        c.child_nodes.push_back(std::move(leaf));
       }
     }
   }
-}
 
-/*!
- * Recursively compute bspheres of all children
- * (note that we don't do bspheres of bspheres... I think this is better?)
- */
-void bsphere_recursive(CNode& node) {
-  compute_my_bsphere_ritters(node);
-  for (auto& child : node.child_nodes) {
-    bsphere_recursive(child);
+  for (auto& child : to_split.child_nodes) {
+    ASSERT(child.is_leaf() == to_split.child_nodes.front().is_leaf());
   }
 }
 
-void drawable_layout_helper(const CNode& node_in,
+void drawable_layout_helper(const BuildContext& ctx,
+                            const CNode& node_in,
                             CollideTree& tree_out,
                             DrawNode& parent_to_add_to) {
-  if (node_in.faces.empty()) {
-    ASSERT(!node_in.child_nodes.empty());
+  if (!node_in.is_leaf()) {
     auto& next = parent_to_add_to.draw_node_children.emplace_back();
     next.bsphere = node_in.bsphere;
     for (auto& c : node_in.child_nodes) {
-      drawable_layout_helper(c, tree_out, next);
+      drawable_layout_helper(ctx, c, tree_out, next);
     }
 
   } else {
-    ASSERT(node_in.child_nodes.empty());
+    ASSERT(node_in.face_count() > 0);
     size_t frag_idx = tree_out.frags.frags.size();
     auto& frag_out = tree_out.frags.frags.emplace_back();
-    frag_out.faces = node_in.faces;
+    frag_out.faces.reserve(node_in.face_count());
+    for (u32 i = node_in.begin; i < node_in.end; i++) {
+      frag_out.faces.push_back(ctx.face(i));
+    }
     frag_out.bsphere = node_in.bsphere;
     parent_to_add_to.frag_children.push_back((int)frag_idx);
   }
 }
 
-CollideTree build_collide_tree(CNode& root) {
+CollideTree build_collide_tree(const BuildContext& ctx, CNode& root) {
   CollideTree tree;
-  drawable_layout_helper(root, tree, tree.fake_root_node);
+  drawable_layout_helper(ctx, root, tree, tree.fake_root_node);
   return tree;
 }
 
@@ -283,19 +449,23 @@ CollideTree construct_collide_bvh(const std::vector<jak1::CollideFace>& tris) {
   // part 1: build the tree
   Timer bvh_timer;
   lg::info("Building collide bvh from {} triangles", tris.size());
+  BuildContext ctx(tris);
   CNode root;
-  root.faces = tris;
-  split_recursive(root);
+  root.begin = 0;
+  root.end = ctx.face_order.size();
+  if (root.face_count() >= 2) {
+    split_recursive(ctx, root, 0);
+  }
   lg::info("BVH tree constructed in {:.2f} ms", bvh_timer.getMs());
 
-  // part 2: compute bspheres
+  // part 2: compute bspheres. Only the root is missing, the others were found during the split.
   bvh_timer.start();
-  bsphere_recursive(root);
+  compute_my_bsphere_ritters(ctx, root);
   lg::info("Found bspheres in {:.2f} ms", bvh_timer.getMs());
 
   // part 3: layout tree
   bvh_timer.start();
-  auto tree = build_collide_tree(root);
+  auto tree = build_collide_tree(ctx, root);
   debug_stats(tree);
 
   lg::info("Tree layout done in {:.2f} ms", bvh_timer.getMs());
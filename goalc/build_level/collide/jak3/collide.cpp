@@ -220,7 +220,6 @@ struct Frag {
 struct FragStats {
   BoundingBox bbox;
   math::Vector3f average_vertex_position;
-  math::Vector3f median_vertex_position;
 };
 
 /*!
@@ -244,18 +243,6 @@ FragStats compute_frag_stats(const std::vector<jak3::CollideFace>& tris,
     }
   }
 
-  for (int i = 0; i < 3; i++) {
-    std::vector<float> vx;
-    vx.reserve(tris.size() * 3);
-    for (auto idx : indices) {
-      for (const auto& vtx : tris[idx].v) {
-        vx.push_back(vtx[i]);
-      }
-    }
-    std::sort(vx.begin(), vx.end());
-    ret.median_vertex_position[i] = vx[vx.size() / 2];
-  }
-
   ret.bbox = bbox.box;
   return ret;
 }
@@ -273,14 +260,18 @@ struct CVertexHash {
 };
 
 /*!
- * How many unique vertices are there in this frag?
+ * How many unique vertices are there in this frag? Stops counting once limit is reached.
  * (currently using float equality, however, a smarter version could look at quantized vertices)
  */
-int unique_vertex_count(const Frag& frag, const std::vector<jak3::CollideFace>& tris) {
+int unique_vertex_count(const Frag& frag, const std::vector<jak3::CollideFace>& tris, int limit) {
   std::unordered_set<math::Vector3f, VectorHash> vmap;
+  vmap.reserve(std::min(frag.tri_indices.size() * 3, (size_t)limit));
   for (auto i : frag.tri_indices) {
     for (const auto& v : tris[i].v) {
       vmap.insert(v);
+      if ((int)vmap.size() >= limit) {
+        return limit;
+      }
     }
   }
   return (int)vmap.size();
@@ -310,7 +301,7 @@ bool frag_is_valid_for_packing(const Frag& frag,
   }
 
   // there is a limit to the number of unique vertices
-  if (unique_vertex_count(frag, tris) >= UINT8_MAX) {
+  if (unique_vertex_count(frag, tris, UINT8_MAX) >= UINT8_MAX) {
     return false;
   }
 
@@ -168,6 +168,11 @@ void CodeGenerator::do_goal_function(FunctionEnv* env, int f_idx) {
   }
   debug->stack_usage = stack_offset;
 
+  if (env->trace_name) {
+    emit_trace_event(f_rec, env->trace_name, FunctionTraceEvent::ENTER,
+                     InstructionInfo::Kind::PROLOGUE);
+  }
+
   // emit each IR into x86 instructions.
   for (int ir_idx = 0; ir_idx < int(env->code().size()); ir_idx++) {
     auto& ir = env->code().at(ir_idx);
@@ -228,6 +233,12 @@ void CodeGenerator::do_goal_function(FunctionEnv* env, int f_idx) {
   }  // end IR loop
 
   // EPILOGUE
+  // every return jumps to the IR_Null at the end of the function, so this catches all of them.
+  if (env->trace_name) {
+    emit_trace_event(f_rec, env->trace_name, FunctionTraceEvent::EXIT,
+                     InstructionInfo::Kind::EPILOGUE);
+  }
+
   if (manually_added_stack_offset || allocs.needs_aligned_stack_for_spills ||
       env->needs_aligned_stack()) {
     if (manually_added_stack_offset) {
@@ -280,6 +291,65 @@ void CodeGenerator::do_goal_function(FunctionEnv* env, int f_idx) {
   m_gen.add_instr_no_ir(f_rec, IGen::ret(), InstructionInfo::Kind::EPILOGUE);
 }
 
+/*!
+ * Append a FunctionTraceEntry to the runtime's trace buffer. This has to preserve all argument
+ * registers and the return value, so the three registers it uses are saved on the stack.
+ * The runtime always sets up a valid buffer (possibly just one entry), so there are no branches.
+ */
+void CodeGenerator::emit_trace_event(const FunctionRecord& f_rec,
+                                     const StaticObject* name,
+                                     FunctionTraceEvent event,
+                                     InstructionInfo::Kind kind) {
+  static_assert(sizeof(FunctionTraceEntry) == 16);
+  const auto off = emitter::gRegInfo.get_offset_reg();
+  const auto add = [&](const Instruction& instr) {
+    return m_gen.add_instr_no_ir(f_rec, instr, kind);
+  };
+
+  add(IGen::push_gpr64(RAX));
+  add(IGen::push_gpr64(RDX));
+  add(IGen::push_gpr64(RCX));
+
+  // rax = info->next++, rcx = info
+  add(IGen::mov_gpr64_u32(RCX, FUNCTION_TRACE_INFO_ADDR));
+  add(IGen::load32u_gpr64_gpr64_plus_gpr64_plus_s32(RAX, RCX, off,
+                                                    offsetof(FunctionTraceInfo, next)));
+  add(IGen::mov_gpr64_gpr64(RDX, RAX));
+  add(IGen::add_gpr64_imm8s(RDX, 1));
+  add(IGen::store32_gpr64_gpr64_plus_gpr64_plus_s32(RCX, off, RDX,
+                                                     offsetof(FunctionTraceInfo, next)));
+
+  // rcx = info->buffer + (idx & info->mask) * 16
+  add(IGen::load32u_gpr64_gpr64_plus_gpr64_plus_s32(RDX, RCX, off,
+                                                    offsetof(FunctionTraceInfo, mask)));
+  add(IGen::and_gpr64_gpr64(RAX, RDX));
+  add(IGen::shl_gpr64_u8(RAX, 4));
+  add(IGen::load32u_gpr64_gpr64_plus_gpr64_plus_s32(RDX, RCX, off,
+                                                    offsetof(FunctionTraceInfo, buffer)));
+  add(IGen::add_gpr64_gpr64(RAX, RDX));
+  add(IGen::mov_gpr64_gpr64(RCX, RAX));
+
+  add(IGen::rdtsc());
+  add(IGen::shl_gpr64_u8(RDX, 32));
+  add(IGen::or_gpr64_gpr64(RAX, RDX));
+  add(IGen::store64_gpr64_gpr64_plus_gpr64_plus_s32(RCX, off, RAX,
+                                                     offsetof(FunctionTraceEntry, tsc)));
+
+  // the name is a static string, convert its address to a GOAL pointer.
+  auto lea = add(IGen::static_addr(RAX, 0));
+  m_gen.link_instruction_static(lea, name->rec, name->get_addr_offset());
+  add(IGen::sub_gpr64_gpr64(RAX, off));
+  add(IGen::store32_gpr64_gpr64_plus_gpr64_plus_s32(RCX, off, RAX,
+                                                     offsetof(FunctionTraceEntry, name)));
+  add(IGen::mov_gpr64_u32(RAX, (u32)event));
+  add(IGen::store32_gpr64_gpr64_plus_gpr64_plus_s32(RCX, off, RAX,
+                                                     offsetof(FunctionTraceEntry, kind)));
+
+  add(IGen::pop_gpr64(RCX));
+  add(IGen::pop_gpr64(RDX));
+  add(IGen::pop_gpr64(RAX));
+}
+
 void CodeGenerator::do_asm_function(FunctionEnv* env, int f_idx, bool allow_saved_regs) {
   auto f_rec = m_gen.get_existing_function_record(f_idx);
   const auto& allocs = env->alloc_result();
@@ -9,6 +9,7 @@
 
 #include "Env.h"
 
+#include "common/goal_constants.h"
 #include "common/versions/versions.h"
 
 #include "goalc/emitter/ObjectGenerator.h"
@@ -21,11 +22,16 @@ class CodeGenerator {
   CodeGenerator(FileEnv* env, DebugInfo* debug_info, GameVersion version);
   std::vector<u8> run(const TypeSystem* ts);
   emitter::ObjectGeneratorStats get_obj_stats() const { return m_gen.get_stats(); }
+  void set_peephole_enabled(bool enabled) { m_gen.set_peephole_enabled(enabled); }
 
  private:
   void do_function(FunctionEnv* env, int f_idx);
   void do_goal_function(FunctionEnv* env, int f_idx);
   void do_asm_function(FunctionEnv* env, int f_idx, bool allow_saved_regs);
+  void emit_trace_event(const emitter::FunctionRecord& f_rec,
+                        const StaticObject* name,
+                        FunctionTraceEvent event,
+                        InstructionInfo::Kind kind);
   emitter::ObjectGenerator m_gen;
   FileEnv* m_fe = nullptr;
   DebugInfo* m_debug_info = nullptr;
@@ -5,6 +5,7 @@
 
 #include "CompilerException.h"
 #include "IR.h"
+#include "IROptimizer.h"
 
 #include "common/goos/PrettyPrinter.h"
 #include "common/link_types.h"
@@ -250,7 +251,19 @@ Val* Compiler::compile_error_guard(const goos::Object& code, Env* env) {
 
 void Compiler::color_object_file(FileEnv* env) {
   int num_spills_in_file = 0;
+  bool optimize = env->optimize_ir().value_or(m_settings.optimize_ir);
   for (auto& f : env->functions()) {
+    if (optimize) {
+      auto opt_stats = optimize_ir(f.get());
+      m_debug_stats.ir_optimized_funcs++;
+      m_debug_stats.ir_instructions_before += opt_stats.instructions_before;
+      m_debug_stats.ir_instructions_after += opt_stats.instructions_after;
+      m_debug_stats.ir_loads_reused += opt_stats.loads_reused;
+      m_debug_stats.ir_copies_propagated += opt_stats.copies_propagated;
+      m_debug_stats.ir_constants_folded += opt_stats.constants_folded;
+      m_debug_stats.ir_dead_removed += opt_stats.dead_removed;
+    }
+
     AllocationInput input;
     input.is_asm_function = f->is_asm_func;
     for (auto& i : f->code()) {
@@ -308,6 +321,7 @@ std::vector<u8> Compiler::codegen_object_file(FileEnv* env) {
     auto debug_info = &m_debugger.get_debug_info_for_object(env->name());
     debug_info->clear();
     CodeGenerator gen(env, debug_info, m_version);
+    gen.set_peephole_enabled(!m_settings.disable_peephole);
     bool ok = true;
     auto result = gen.run(&m_ts);
     for (auto& f : env->functions()) {
@@ -317,6 +331,7 @@ std::vector<u8> Compiler::codegen_object_file(FileEnv* env) {
     }
     auto stats = gen.get_obj_stats();
     m_debug_stats.num_moves_eliminated += stats.moves_eliminated;
+    m_debug_stats.peephole.add(stats.peephole);
     env->cleanup_after_codegen();
     return result;
   } catch (std::exception& e) {
@@ -332,6 +347,7 @@ bool Compiler::codegen_and_disassemble_object_file(FileEnv* env,
   auto debug_info = &m_debugger.get_debug_info_for_object(env->name());
   debug_info->clear();
   CodeGenerator gen(env, debug_info, m_version);
+  gen.set_peephole_enabled(!m_settings.disable_peephole);
   *data_out = gen.run(&m_ts);
   bool ok = true;
   *asm_out = debug_info->disassemble_all_functions(&ok, &m_goos.reader, omit_ir);
@@ -16,6 +16,7 @@
 #include "goalc/compiler/symbol_info.h"
 #include "goalc/data_compiler/game_text_common.h"
 #include "goalc/debugger/Debugger.h"
+#include "goalc/emitter/Peephole.h"
 #include "goalc/emitter/Register.h"
 #include "goalc/listener/Listener.h"
 #include "goalc/make/MakeSystem.h"
@@ -147,6 +148,14 @@ class Compiler {
     int num_moves_eliminated = 0;
     int total_funcs = 0;
     int funcs_requiring_v1_allocator = 0;
+    int ir_optimized_funcs = 0;
+    int ir_instructions_before = 0;
+    int ir_instructions_after = 0;
+    int ir_loads_reused = 0;
+    int ir_copies_propagated = 0;
+    int ir_constants_folded = 0;
+    int ir_dead_removed = 0;
+    emitter::PeepholeStats peephole;
   } m_debug_stats;
 
   void setup_goos_forms();
@@ -225,6 +234,7 @@ class Compiler {
 
   SymbolVal* compile_get_sym_obj(const std::string& name, Env* env);
   void color_object_file(FileEnv* env);
+  void setup_function_trace(FunctionEnv* func);
   std::vector<u8> codegen_object_file(FileEnv* env);
   bool codegen_and_disassemble_object_file(FileEnv* env,
                                            std::vector<u8>* data_out,
@@ -673,6 +683,7 @@ class Compiler {
   Val* compile_bp(const goos::Object& form, const goos::Object& rest, Env* env);
   Val* compile_ubp(const goos::Object& form, const goos::Object& rest, Env* env);
   Val* compile_d_sym_name(const goos::Object& form, const goos::Object& rest, Env* env);
+  Val* compile_profile(const goos::Object& form, const goos::Object& rest, Env* env);
   u32 parse_address_spec(const goos::Object& form);
 
   // Macro
@@ -9,6 +9,15 @@ CompilerSettings::CompilerSettings() {
 
   m_settings["disable-math-const-prop"].kind = SettingKind::BOOL;
   m_settings["disable-math-const-prop"].boolp = &disable_math_const_prop;
+
+  m_settings["disable-peephole"].kind = SettingKind::BOOL;
+  m_settings["disable-peephole"].boolp = &disable_peephole;
+
+  m_settings["optimize-ir"].kind = SettingKind::BOOL;
+  m_settings["optimize-ir"].boolp = &optimize_ir;
+
+  m_settings["profile-functions"].kind = SettingKind::BOOL;
+  m_settings["profile-functions"].boolp = &profile_functions;
 }
 
 void CompilerSettings::set(const std::string& name, const goos::Object& value) {
@@ -11,6 +11,9 @@ class CompilerSettings {
   bool debug_print_ir = false;
   bool debug_print_regalloc = false;
   bool disable_math_const_prop = false;
+  bool disable_peephole = false;
+  bool optimize_ir = false;  // run IROptimizer passes before register allocation
+  bool profile_functions = false;  // add enter/exit trace events to every function
   bool emit_move_after_return = true;
   bool check_for_requires = false;  // check for missing 'require' statements (TODO - does not work
                                     // for virtual state usages or macro usages)
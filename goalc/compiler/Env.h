@@ -7,6 +7,7 @@
  */
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -128,6 +129,12 @@ class FileEnv : public Env {
   void set_nondebug_file() { m_default_segment = MAIN_SEGMENT; }
   void set_debug_file() { m_default_segment = DEBUG_SEGMENT; }
   bool is_debug_file() const { return default_segment() == DEBUG_SEGMENT; }
+  // set by (declare-file (optimize-ir ...)), overrides the optimize-ir compiler setting.
+  std::optional<bool> optimize_ir() const { return m_optimize_ir; }
+  void set_optimize_ir(bool enable) { m_optimize_ir = enable; }
+  // set by (declare-file (profile ...)), overrides the profile-functions compiler setting.
+  std::optional<bool> profile_functions() const { return m_profile_functions; }
+  void set_profile_functions(bool enable) { m_profile_functions = enable; }
 
   void cleanup_after_codegen();
 
@@ -142,6 +149,8 @@ class FileEnv : public Env {
   int m_anon_func_counter = 0;
   std::vector<std::unique_ptr<Val>> m_vals;
   int m_default_segment = MAIN_SEGMENT;
+  std::optional<bool> m_optimize_ir;
+  std::optional<bool> m_profile_functions;
 
   // statics
   FunctionEnv* m_top_level_func = nullptr;
@@ -189,6 +198,7 @@ class FunctionEnv : public DeclareEnv {
   void finish();
   RegVal* make_ireg(const TypeSpec& ts, RegClass reg_class) override;
   const std::vector<std::unique_ptr<IR>>& code() const { return m_code; }
+  void replace_ir(int idx, std::unique_ptr<IR> ir) { m_code.at(idx) = std::move(ir); }
   const std::vector<goos::Object>& code_source() const { return m_code_debug_source; }
   int max_vars() const { return m_iregs.size(); }
   const std::vector<IRegConstraint>& constraints() { return m_constraints; }
@@ -249,6 +259,9 @@ class FunctionEnv : public DeclareEnv {
   std::optional<int> method_id;
   bool is_asm_func = false;
   bool asm_func_saved_regs = false;
+  bool profile = false;  // set by (declare (profile))
+  // if set, the prologue and epilogue record trace events with this name.
+  StaticString* trace_name = nullptr;
   TypeSpec asm_func_return_type;
   std::vector<UnresolvedGoto> unresolved_gotos;
   std::vector<UnresolvedConditionalGoto> unresolved_cond_gotos;
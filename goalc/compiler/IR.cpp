@@ -277,6 +277,14 @@ RegAllocInstr IR_SetSymbolValue::to_rai() {
   return rai;
 }
 
+bool IR_SetSymbolValue::replace_read(int ireg_id, RegVal* replacement) {
+  if (m_src->ireg().id != ireg_id) {
+    return false;
+  }
+  m_src = replacement;
+  return true;
+}
+
 void IR_SetSymbolValue::do_codegen(emitter::ObjectGenerator* gen,
                                    const AllocationResult& allocs,
                                    emitter::IR_Record irec) {
@@ -340,6 +348,14 @@ RegAllocInstr IR_RegSet::to_rai() {
   return rai;
 }
 
+bool IR_RegSet::replace_read(int ireg_id, RegVal* replacement) {
+  if (m_src->ireg().id != ireg_id) {
+    return false;
+  }
+  m_src = replacement;
+  return true;
+}
+
 void IR_RegSet::do_codegen(emitter::ObjectGenerator* gen,
                            const AllocationResult& allocs,
                            emitter::IR_Record irec) {
@@ -608,6 +624,15 @@ RegAllocInstr IR_IntegerMath::to_rai() {
   return rai;
 }
 
+bool IR_IntegerMath::replace_read(int ireg_id, RegVal* replacement) {
+  // the destination is also an input, and can't be changed.
+  if (m_dest->ireg().id == ireg_id || !m_arg || m_arg->ireg().id != ireg_id) {
+    return false;
+  }
+  m_arg = replacement;
+  return true;
+}
+
 void IR_IntegerMath::do_codegen(emitter::ObjectGenerator* gen,
                                 const AllocationResult& allocs,
                                 emitter::IR_Record irec) {
@@ -737,6 +762,14 @@ RegAllocInstr IR_FloatMath::to_rai() {
   return rai;
 }
 
+bool IR_FloatMath::replace_read(int ireg_id, RegVal* replacement) {
+  if (m_dest->ireg().id == ireg_id || m_arg->ireg().id != ireg_id) {
+    return false;
+  }
+  m_arg = replacement;
+  return true;
+}
+
 void IR_FloatMath::do_codegen(emitter::ObjectGenerator* gen,
                               const AllocationResult& allocs,
                               emitter::IR_Record irec) {
@@ -859,6 +892,19 @@ RegAllocInstr IR_ConditionalBranch::to_rai() {
   return rai;
 }
 
+bool IR_ConditionalBranch::replace_read(int ireg_id, RegVal* replacement) {
+  bool replaced = false;
+  if (condition.a->ireg().id == ireg_id) {
+    condition.a = replacement;
+    replaced = true;
+  }
+  if (condition.b->ireg().id == ireg_id) {
+    condition.b = replacement;
+    replaced = true;
+  }
+  return replaced;
+}
+
 void IR_ConditionalBranch::do_codegen(emitter::ObjectGenerator* gen,
                                       const AllocationResult& allocs,
                                       emitter::IR_Record irec) {
@@ -940,6 +986,14 @@ RegAllocInstr IR_LoadConstOffset::to_rai() {
   return rai;
 }
 
+bool IR_LoadConstOffset::replace_read(int ireg_id, RegVal* replacement) {
+  if (!m_use_coloring || m_base->ireg().id != ireg_id) {
+    return false;
+  }
+  m_base = replacement;
+  return true;
+}
+
 void IR_LoadConstOffset::do_codegen(emitter::ObjectGenerator* gen,
                                     const AllocationResult& allocs,
                                     emitter::IR_Record irec) {
@@ -988,6 +1042,22 @@ RegAllocInstr IR_StoreConstOffset::to_rai() {
   return rai;
 }
 
+bool IR_StoreConstOffset::replace_read(int ireg_id, RegVal* replacement) {
+  if (!m_use_coloring) {
+    return false;
+  }
+  bool replaced = false;
+  if (m_value->ireg().id == ireg_id) {
+    m_value = replacement;
+    replaced = true;
+  }
+  if (m_base->ireg().id == ireg_id) {
+    m_base = replacement;
+    replaced = true;
+  }
+  return replaced;
+}
+
 void IR_StoreConstOffset::do_codegen(emitter::ObjectGenerator* gen,
                                      const AllocationResult& allocs,
                                      emitter::IR_Record irec) {
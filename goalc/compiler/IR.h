@@ -20,6 +20,13 @@ class IR {
     (void)constraints;
     (void)my_id;
   }
+  // used by the IR optimizer to read a different register holding the same value. Returns false if
+  // the register can't be replaced, in which case nothing is modified.
+  virtual bool replace_read(int ireg_id, RegVal* replacement) {
+    (void)ireg_id;
+    (void)replacement;
+    return false;
+  }
   virtual ~IR() = default;
 };
 
@@ -48,6 +55,8 @@ class IR_LoadConstant64 : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  const RegVal* dest() const { return m_dest; }
+  u64 value() const { return m_value; }
 
  protected:
   const RegVal* m_dest = nullptr;
@@ -76,6 +85,8 @@ class IR_SetSymbolValue : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
+  const SymbolVal* dest() const { return m_dest; }
 
  protected:
   const SymbolVal* m_dest = nullptr;
@@ -90,6 +101,9 @@ class IR_GetSymbolValue : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  const RegVal* dest() const { return m_dest; }
+  const SymbolVal* src() const { return m_src; }
+  bool sext() const { return m_sext; }
 
  protected:
   const RegVal* m_dest = nullptr;
@@ -105,6 +119,9 @@ class IR_RegSet : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
+  const RegVal* dest() const { return m_dest; }
+  const RegVal* src() const { return m_src; }
 
  protected:
   const RegVal* m_dest = nullptr;
@@ -219,7 +236,11 @@ class IR_IntegerMath : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
   IntegerMathKind get_kind() const { return m_kind; }
+  const RegVal* dest() const { return m_dest; }
+  const RegVal* arg() const { return m_arg; }
+  u8 shift_amount() const { return m_shift_amount; }
 
  protected:
   IntegerMathKind m_kind;
@@ -238,6 +259,7 @@ class IR_FloatMath : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
   FloatMathKind get_kind() const { return m_kind; }
 
  protected:
@@ -282,6 +304,7 @@ class IR_ConditionalBranch : public IR {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
   void mark_as_resolved() { m_resolved = true; }
 
   Condition condition;
@@ -370,6 +393,7 @@ class IR_Asm : public IR {
  public:
   explicit IR_Asm(bool use_coloring);
   std::string get_color_suffix_string();
+  bool use_coloring() const { return m_use_coloring; }
 
  protected:
   bool m_use_coloring;
@@ -387,6 +411,11 @@ class IR_LoadConstOffset : public IR_Asm {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
+  const RegVal* dest() const { return m_dest; }
+  const RegVal* base() const { return m_base; }
+  int offset() const { return m_offset; }
+  const MemLoadInfo& info() const { return m_info; }
 
  private:
   const RegVal* m_dest = nullptr;
@@ -407,6 +436,7 @@ class IR_StoreConstOffset : public IR_Asm {
   void do_codegen(emitter::ObjectGenerator* gen,
                   const AllocationResult& allocs,
                   emitter::IR_Record irec) override;
+  bool replace_read(int ireg_id, RegVal* replacement) override;
 
  private:
   const RegVal* m_value = nullptr;
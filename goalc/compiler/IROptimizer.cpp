@@ -0,0 +1,463 @@
+/*!
+ * @file IROptimizer.cpp
+ * Optimization passes on a function's IR.
+ *
+ * Labels and register constraints refer to instructions by index, so instructions are never
+ * removed or moved. Instead, instructions are replaced in place, and deleted instructions become
+ * IR_Null, which generates no code.
+ *
+ * Most IR can't have its operands rewritten, so the value tracking is done within basic blocks,
+ * where the value in each register is known without building SSA form:
+ *  - reuse of symbol value and constant offset loads that are already in a register
+ *  - copy propagation, reading the original register instead of a copy of it
+ *  - constant folding of integer math on constants loaded with IR_LoadConstant64
+ * followed by dead code elimination using liveness over the whole function, which removes the
+ * copies and constants that are no longer used.
+ *
+ * Registers with a constraint or forced onto the stack are never changed or propagated.
+ */
+
+#include "IROptimizer.h"
+
+#include <optional>
+#include <unordered_map>
+
+#include "goalc/compiler/Env.h"
+#include "goalc/compiler/IR.h"
+
+namespace {
+
+/*!
+ * Basic facts about the function that all of the passes need.
+ */
+struct FunctionInfo {
+  std::vector<RegAllocInstr> rai;
+  std::vector<bool> block_start;
+  std::vector<bool> constrained_instr;
+  std::vector<bool> excluded_reg;
+  std::vector<RegVal*> reg_by_id;
+
+  bool reg_ok(int id) const {
+    return id >= 0 && id < (int)excluded_reg.size() && !excluded_reg[id];
+  }
+};
+
+FunctionInfo analyze(FunctionEnv* env) {
+  FunctionInfo info;
+  const auto& code = env->code();
+  for (const auto& ir : code) {
+    info.rai.push_back(ir->to_rai());
+  }
+
+  info.block_start.resize(code.size() + 1, false);
+  info.block_start.at(0) = true;
+  for (size_t i = 0; i < code.size(); i++) {
+    for (int target : info.rai[i].jumps) {
+      if (target >= 0 && target <= (int)code.size()) {
+        info.block_start.at(target) = true;
+      }
+    }
+    if (!info.rai[i].jumps.empty() || !info.rai[i].fallthrough) {
+      info.block_start.at(i + 1) = true;
+    }
+  }
+
+  info.constrained_instr.resize(code.size(), false);
+  info.excluded_reg.resize(env->max_vars(), false);
+  info.reg_by_id.resize(env->max_vars(), nullptr);
+  for (const auto& constraint : env->constraints()) {
+    info.excluded_reg.at(constraint.ireg.id) = true;
+    if (constraint.instr_idx >= 0 && constraint.instr_idx < (int)code.size()) {
+      info.constrained_instr.at(constraint.instr_idx) = true;
+    }
+  }
+  for (const auto& reg : env->reg_vals()) {
+    int id = reg->ireg().id;
+    if (reg->forced_on_stack()) {
+      info.excluded_reg.at(id) = true;
+    }
+    // rlet can create multiple RegVals for the same constrained register, but those are excluded
+    if (!info.reg_by_id.at(id)) {
+      info.reg_by_id.at(id) = reg.get();
+    }
+  }
+  return info;
+}
+
+/*!
+ * Functions with assembly that isn't register allocated or jumps we can't follow aren't optimized.
+ */
+bool can_optimize(const FunctionEnv& env) {
+  if (env.is_asm_func) {
+    return false;
+  }
+  for (const auto& ir : env.code()) {
+    if (dynamic_cast<const IR_JumpReg*>(ir.get()) || dynamic_cast<const IR_AsmRet*>(ir.get())) {
+      return false;
+    }
+    auto as_asm = dynamic_cast<const IR_Asm*>(ir.get());
+    if (as_asm && !as_asm->use_coloring()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * Does this instruction only write its destination registers, with no other effects?
+ * If so, it can be removed if its results aren't used, and doesn't invalidate loads.
+ */
+bool is_pure(const IR* ir) {
+  if (auto math = dynamic_cast<const IR_IntegerMath*>(ir)) {
+    // division can trap
+    switch (math->get_kind()) {
+      case IntegerMathKind::IDIV_32:
+      case IntegerMathKind::UDIV_32:
+      case IntegerMathKind::IMOD_32:
+      case IntegerMathKind::UMOD_32:
+        return false;
+      default:
+        return true;
+    }
+  }
+  return dynamic_cast<const IR_LoadConstant64*>(ir) || dynamic_cast<const IR_RegSet*>(ir) ||
+         dynamic_cast<const IR_GetSymbolValue*>(ir) ||
+         dynamic_cast<const IR_LoadSymbolPointer*>(ir) ||
+         dynamic_cast<const IR_LoadConstOffset*>(ir) || dynamic_cast<const IR_FloatMath*>(ir) ||
+         dynamic_cast<const IR_StaticVarAddr*>(ir) || dynamic_cast<const IR_StaticVarLoad*>(ir) ||
+         dynamic_cast<const IR_FunctionAddr*>(ir) || dynamic_cast<const IR_GetStackAddr*>(ir) ||
+         dynamic_cast<const IR_FloatToInt*>(ir) || dynamic_cast<const IR_IntToFloat*>(ir);
+}
+
+/*!
+ * Instructions that don't write any memory, so loads done before them are still valid after.
+ */
+bool preserves_memory(const IR* ir) {
+  return is_pure(ir) || dynamic_cast<const IR_Null*>(ir) ||
+         dynamic_cast<const IR_ConditionalBranch*>(ir) || dynamic_cast<const IR_GotoLabel*>(ir) ||
+         dynamic_cast<const IR_ValueReset*>(ir);
+}
+
+std::optional<u64> fold_integer_math(IntegerMathKind kind, u64 a, u64 b, u8 shift) {
+  switch (kind) {
+    case IntegerMathKind::ADD_64:
+      return a + b;
+    case IntegerMathKind::SUB_64:
+      return a - b;
+    case IntegerMathKind::IMUL_64:
+      return a * b;
+    case IntegerMathKind::IMUL_32:
+      // matches the sign extension done in codegen
+      return (u64)(s64)(s32)((u32)a * (u32)b);
+    case IntegerMathKind::AND_64:
+      return a & b;
+    case IntegerMathKind::OR_64:
+      return a | b;
+    case IntegerMathKind::XOR_64:
+      return a ^ b;
+    case IntegerMathKind::NOT_64:
+      return ~a;
+    case IntegerMathKind::SHL_64:
+      return a << (shift & 63);
+    case IntegerMathKind::SHR_64:
+      return a >> (shift & 63);
+    case IntegerMathKind::SAR_64:
+      return (u64)(((s64)a) >> (shift & 63));
+    default:
+      return std::nullopt;
+  }
+}
+
+bool uses_arg(IntegerMathKind kind) {
+  return kind != IntegerMathKind::NOT_64 && kind != IntegerMathKind::SHL_64 &&
+         kind != IntegerMathKind::SAR_64 && kind != IntegerMathKind::SHR_64;
+}
+
+bool same_load(const MemLoadInfo& a, const MemLoadInfo& b) {
+  return a.size == b.size && a.sign_extend == b.sign_extend && a.reg == b.reg;
+}
+
+/*!
+ * What is known about the registers at a point inside a basic block.
+ */
+struct BlockState {
+  struct SymbolLoad {
+    std::string name;
+    bool sext = false;
+    const RegVal* dest = nullptr;
+  };
+
+  struct ConstOffsetLoad {
+    int base = -1;
+    int offset = 0;
+    MemLoadInfo info;
+    const RegVal* dest = nullptr;
+  };
+
+  std::unordered_map<int, int> copy_of;  // register -> earlier register with the same value
+  std::unordered_map<int, u64> constant_of;
+  std::vector<SymbolLoad> symbol_loads;
+  std::vector<ConstOffsetLoad> const_offset_loads;
+
+  void clear() {
+    copy_of.clear();
+    constant_of.clear();
+    symbol_loads.clear();
+    const_offset_loads.clear();
+  }
+
+  void clear_memory() {
+    symbol_loads.clear();
+    const_offset_loads.clear();
+  }
+
+  void kill_reg(int id) {
+    copy_of.erase(id);
+    std::erase_if(copy_of, [&](const auto& kv) { return kv.second == id; });
+    constant_of.erase(id);
+    std::erase_if(symbol_loads, [&](const auto& l) { return l.dest->ireg().id == id; });
+    std::erase_if(const_offset_loads,
+                  [&](const auto& l) { return l.dest->ireg().id == id || l.base == id; });
+  }
+};
+
+/*!
+ * Load reuse, copy propagation and constant folding, within each basic block.
+ */
+void local_value_pass(FunctionEnv* env, FunctionInfo& info, IROptimizerStats* stats) {
+  BlockState state;
+  const auto& code = env->code();
+  for (int i = 0; i < (int)code.size(); i++) {
+    if (info.block_start[i]) {
+      state.clear();
+    }
+
+    if (!info.constrained_instr[i]) {
+      // copy propagation: read the original instead of the copy
+      for (const auto& read : info.rai[i].read) {
+        auto copy = state.copy_of.find(read.id);
+        if (copy != state.copy_of.end() &&
+            code[i]->replace_read(read.id, info.reg_by_id.at(copy->second))) {
+          stats->copies_propagated++;
+        }
+      }
+
+      IR* ir = code[i].get();
+      if (auto math = dynamic_cast<IR_IntegerMath*>(ir)) {
+        auto dst = state.constant_of.find(math->dest()->ireg().id);
+        std::optional<u64> arg;
+        if (uses_arg(math->get_kind())) {
+          auto arg_const = state.constant_of.find(math->arg()->ireg().id);
+          if (arg_const != state.constant_of.end()) {
+            arg = arg_const->second;
+          }
+        } else {
+          arg = 0;
+        }
+        if (dst != state.constant_of.end() && arg) {
+          auto folded = fold_integer_math(math->get_kind(), dst->second, *arg,
+                                          math->shift_amount());
+          if (folded) {
+            env->replace_ir(i, std::make_unique<IR_LoadConstant64>(math->dest(), *folded));
+            stats->constants_folded++;
+          }
+        }
+      } else if (auto sym_load = dynamic_cast<IR_GetSymbolValue*>(ir)) {
+        for (const auto& prev : state.symbol_loads) {
+          if (prev.name == sym_load->src()->name() && prev.sext == sym_load->sext() &&
+              info.reg_ok(sym_load->dest()->ireg().id)) {
+            env->replace_ir(i, std::make_unique<IR_RegSet>(sym_load->dest(), prev.dest));
+            stats->loads_reused++;
+            break;
+          }
+        }
+      } else if (auto mem_load = dynamic_cast<IR_LoadConstOffset*>(ir)) {
+        for (const auto& prev : state.const_offset_loads) {
+          if (prev.base == mem_load->base()->ireg().id && prev.offset == mem_load->offset() &&
+              same_load(prev.info, mem_load->info()) &&
+              prev.dest->ireg().reg_class == mem_load->dest()->ireg().reg_class &&
+              info.reg_ok(mem_load->dest()->ireg().id)) {
+            env->replace_ir(i, std::make_unique<IR_RegSet>(mem_load->dest(), prev.dest));
+            stats->loads_reused++;
+            break;
+          }
+        }
+      }
+      info.rai[i] = code[i]->to_rai();
+    }
+
+    IR* ir = code[i].get();
+    if (!preserves_memory(ir)) {
+      state.clear_memory();
+    }
+    for (const auto& write : info.rai[i].write) {
+      state.kill_reg(write.id);
+    }
+    if (info.constrained_instr[i]) {
+      continue;
+    }
+
+    // remember what this instruction computed.
+    if (auto set = dynamic_cast<IR_RegSet*>(ir)) {
+      int dst = set->dest()->ireg().id;
+      int src = set->src()->ireg().id;
+      if (dst != src && info.reg_ok(dst) && info.reg_ok(src) &&
+          set->dest()->ireg().reg_class == set->src()->ireg().reg_class) {
+        auto src_copy = state.copy_of.find(src);
+        state.copy_of[dst] = src_copy == state.copy_of.end() ? src : src_copy->second;
+        auto src_const = state.constant_of.find(src);
+        if (src_const != state.constant_of.end()) {
+          state.constant_of[dst] = src_const->second;
+        }
+      }
+    } else if (auto constant = dynamic_cast<IR_LoadConstant64*>(ir)) {
+      if (info.reg_ok(constant->dest()->ireg().id)) {
+        state.constant_of[constant->dest()->ireg().id] = constant->value();
+      }
+    } else if (auto sym_load = dynamic_cast<IR_GetSymbolValue*>(ir)) {
+      if (info.reg_ok(sym_load->dest()->ireg().id)) {
+        state.symbol_loads.push_back(
+            {sym_load->src()->name(), sym_load->sext(), sym_load->dest()});
+      }
+    } else if (auto mem_load = dynamic_cast<IR_LoadConstOffset*>(ir)) {
+      int dst = mem_load->dest()->ireg().id;
+      int base = mem_load->base()->ireg().id;
+      if (dst != base && info.reg_ok(dst) && info.reg_ok(base)) {
+        state.const_offset_loads.push_back(
+            {base, mem_load->offset(), mem_load->info(), mem_load->dest()});
+      }
+    }
+  }
+}
+
+/*!
+ * Replace pure instructions whose results are never read with IR_Null.
+ * Returns the number of instructions removed.
+ */
+int dead_code_pass(FunctionEnv* env, FunctionInfo& info) {
+  const auto& code = env->code();
+  const int n = code.size();
+  const int num_words = (info.excluded_reg.size() + 63) / 64;
+  using Bits = std::vector<u64>;
+  auto set_bit = [](Bits& b, int id) { b[id / 64] |= (1ull << (id % 64)); };
+  auto clear_bit = [](Bits& b, int id) { b[id / 64] &= ~(1ull << (id % 64)); };
+  auto get_bit = [](const Bits& b, int id) { return b[id / 64] & (1ull << (id % 64)); };
+
+  // basic blocks
+  std::vector<int> block_of(n);
+  std::vector<int> block_begin;
+  for (int i = 0; i < n; i++) {
+    if (info.block_start[i]) {
+      block_begin.push_back(i);
+    }
+    block_of[i] = block_begin.size() - 1;
+  }
+  const int num_blocks = block_begin.size();
+  auto block_end = [&](int b) { return b + 1 < num_blocks ? block_begin[b + 1] : n; };
+
+  std::vector<std::vector<int>> succs(num_blocks);
+  for (int b = 0; b < num_blocks; b++) {
+    int last = block_end(b) - 1;
+    for (int target : info.rai[last].jumps) {
+      if (target < n) {
+        succs[b].push_back(block_of.at(target));
+      }
+    }
+    if (info.rai[last].fallthrough && last + 1 < n) {
+      succs[b].push_back(block_of[last + 1]);
+    }
+  }
+
+  // per block use (read before written) and def
+  std::vector<Bits> use(num_blocks, Bits(num_words)), def(num_blocks, Bits(num_words));
+  for (int b = 0; b < num_blocks; b++) {
+    for (int i = block_begin[b]; i < block_end(b); i++) {
+      for (const auto& r : info.rai[i].read) {
+        if (!get_bit(def[b], r.id)) {
+          set_bit(use[b], r.id);
+        }
+      }
+      for (const auto& w : info.rai[i].write) {
+        set_bit(def[b], w.id);
+      }
+    }
+  }
+
+  std::vector<Bits> live_in(num_blocks, Bits(num_words)), live_out(num_blocks, Bits(num_words));
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int b = num_blocks - 1; b >= 0; b--) {
+      for (int s : succs[b]) {
+        for (int w = 0; w < num_words; w++) {
+          u64 merged = live_out[b][w] | live_in[s][w];
+          if (merged != live_out[b][w]) {
+            live_out[b][w] = merged;
+            changed = true;
+          }
+        }
+      }
+      for (int w = 0; w < num_words; w++) {
+        live_in[b][w] = use[b][w] | (live_out[b][w] & ~def[b][w]);
+      }
+    }
+  }
+
+  int removed = 0;
+  for (int b = 0; b < num_blocks; b++) {
+    Bits live = live_out[b];
+    for (int i = block_end(b) - 1; i >= block_begin[b]; i--) {
+      const auto& rai = info.rai[i];
+      bool dead = !info.constrained_instr[i] && !rai.write.empty() && is_pure(code[i].get());
+      for (const auto& w : rai.write) {
+        if (get_bit(live, w.id) || !info.reg_ok(w.id)) {
+          dead = false;
+        }
+      }
+      if (dead) {
+        env->replace_ir(i, std::make_unique<IR_Null>());
+        info.rai[i] = RegAllocInstr();
+        removed++;
+        continue;
+      }
+      for (const auto& w : rai.write) {
+        clear_bit(live, w.id);
+      }
+      for (const auto& r : rai.read) {
+        set_bit(live, r.id);
+      }
+    }
+  }
+  return removed;
+}
+
+int count_instructions(const FunctionEnv& env) {
+  int count = 0;
+  for (const auto& ir : env.code()) {
+    if (!dynamic_cast<const IR_Null*>(ir.get())) {
+      count++;
+    }
+  }
+  return count;
+}
+}  // namespace
+
+IROptimizerStats optimize_ir(FunctionEnv* env) {
+  IROptimizerStats stats;
+  stats.instructions_before = count_instructions(*env);
+  if (can_optimize(*env) && !env->code().empty()) {
+    auto info = analyze(env);
+    local_value_pass(env, info, &stats);
+    // removing an instruction can make the instructions that computed its inputs dead too.
+    constexpr int kMaxDeadCodePasses = 4;
+    for (int pass = 0; pass < kMaxDeadCodePasses; pass++) {
+      int removed = dead_code_pass(env, info);
+      stats.dead_removed += removed;
+      if (!removed) {
+        break;
+      }
+    }
+  }
+  stats.instructions_after = count_instructions(*env);
+  return stats;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/*!
+ * @file IROptimizer.h
+ * Optimization passes on a function's IR, run after the function is compiled and before register
+ * allocation.
+ */
+
+class FunctionEnv;
+
+struct IROptimizerStats {
+  int instructions_before = 0;
+  int instructions_after = 0;
+  int loads_reused = 0;
+  int copies_propagated = 0;
+  int constants_folded = 0;
+  int dead_removed = 0;
+};
+
+IROptimizerStats optimize_ir(FunctionEnv* env);
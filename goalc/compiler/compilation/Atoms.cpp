@@ -201,6 +201,7 @@ const std::unordered_map<std::string, GoalCompilerForm> g_goal_forms = {
     {":bp", {.form_function = &Compiler::compile_bp}},
     {":ubp", {.form_function = &Compiler::compile_ubp}},
     {":sym-name", {.form_function = &Compiler::compile_d_sym_name}},
+    {":prof", {.form_function = &Compiler::compile_profile}},
 
     // TYPE
     {"deftype", {.form_function = &Compiler::compile_deftype}},
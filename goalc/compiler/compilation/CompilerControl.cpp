@@ -856,6 +856,21 @@ Val* Compiler::compile_print_debug_compiler_stats(const goos::Object& form,
   lg::print("Eliminated moves: {}\n", m_debug_stats.num_moves_eliminated);
   lg::print("Total functions: {}\n", m_debug_stats.total_funcs);
   lg::print("Functions requiring v1: {}\n", m_debug_stats.funcs_requiring_v1_allocator);
+  if (m_debug_stats.ir_optimized_funcs) {
+    lg::print("IR optimized functions: {}\n", m_debug_stats.ir_optimized_funcs);
+    lg::print("  IR instructions: {} -> {}\n", m_debug_stats.ir_instructions_before,
+              m_debug_stats.ir_instructions_after);
+    lg::print("  Loads reused: {}\n", m_debug_stats.ir_loads_reused);
+    lg::print("  Copies propagated: {}\n", m_debug_stats.ir_copies_propagated);
+    lg::print("  Constants folded: {}\n", m_debug_stats.ir_constants_folded);
+    lg::print("  Dead instructions removed: {}\n", m_debug_stats.ir_dead_removed);
+  }
+  lg::print("Peephole rewrites: {} ({} bytes saved)\n", m_debug_stats.peephole.total_hits(),
+            m_debug_stats.peephole.bytes_saved);
+  for (int i = 0; i < (int)emitter::PeepholeRule::COUNT; i++) {
+    lg::print("  {}: {}\n", emitter::peephole_rule_name((emitter::PeepholeRule)i),
+              m_debug_stats.peephole.hits[i]);
+  }
   lg::print("Size of autocomplete prefix tree: {}\n", m_symbol_info.symbol_count());
 
   return get_none();
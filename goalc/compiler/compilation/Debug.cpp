@@ -439,3 +439,40 @@ Val* Compiler::compile_d_sym_name(const goos::Object& form, const goos::Object&
 
   return get_none();
 }
+
+Val* Compiler::compile_profile(const goos::Object& form, const goos::Object& rest, Env* env) {
+  (void)env;
+  auto args = get_va(form, rest);
+  va_check(form, args, {{}},
+           {{"rate", {false, goos::ObjectType::INTEGER}},
+            {"top", {false, goos::ObjectType::INTEGER}},
+            {"file", {false, goos::ObjectType::STRING}}});
+
+  const auto& duration = args.unnamed.at(0);
+  if (!duration.is_int() && !duration.is_float()) {
+    throw_compiler_error(form, ":prof duration must be a number of seconds.");
+  }
+  double seconds = duration.is_int() ? duration.as_int() : duration.as_float();
+  int rate = args.has_named("rate") ? args.get_named("rate").as_int() : 200;
+  int top = args.has_named("top") ? args.get_named("top").as_int() : 30;
+  if (rate <= 0 || rate > 10000) {
+    throw_compiler_error(form, ":prof rate must be between 1 and 10000 samples per second.");
+  }
+
+  if (!m_debugger.is_running()) {
+    throw_compiler_error(
+        form, "Cannot profile, the debugger must be connected and the target must be running.");
+  }
+
+  lg::print("Profiling for {:.2f}s at {} samples per second...\n", seconds, rate);
+  auto profile = m_debugger.profile(seconds, rate);
+  lg::print("{}", profile.print_summary(top));
+
+  if (args.has_named("file")) {
+    auto path = file_util::get_file_path({args.get_named("file").as_string()->data});
+    file_util::write_text_file(path, profile.to_collapsed_stacks());
+    lg::print("Wrote collapsed stacks to {}\n", path);
+  }
+
+  return get_none();
+}
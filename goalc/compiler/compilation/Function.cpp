@@ -294,6 +294,7 @@ Val* Compiler::compile_lambda(const goos::Object& form, const goos::Object& rest
     func_block_env->end_label.idx = new_func_env->code().size();
     new_func_env->emit_ir<IR_Null>(form);
     new_func_env->finish();
+    setup_function_trace(new_func_env.get());
 
     // save our code for possible inlining
     ASSERT(obj_env);
@@ -662,6 +663,27 @@ Val* Compiler::compile_real_function_call(const goos::Object& form,
   }
 }
 
+/*!
+ * If profiling is enabled for a function, give it a static string with its name so the prologue
+ * and epilogue can record trace events. This runs after the body is compiled, so any
+ * (declare (profile)) has been seen.
+ */
+void Compiler::setup_function_trace(FunctionEnv* func) {
+  auto* file = func->file_env();
+  bool enabled = func->profile || file->profile_functions().value_or(m_settings.profile_functions);
+  if (!enabled || func->is_asm_func) {
+    return;
+  }
+
+  std::string name = func->name();
+  if (str_util::starts_with(name, "anon-function-")) {
+    name = fmt::format("{} in {}", name, file->name());
+  }
+  auto obj = std::make_unique<StaticString>(name, func->segment_for_static_data());
+  func->trace_name = obj.get();
+  file->add_static(std::move(obj));
+}
+
 /*!
  * A (declare ...) form can be used to configure settings inside a function.
  * Currently there aren't many useful settings, but more may be added in the future.
@@ -726,6 +748,12 @@ Val* Compiler::compile_declare(const goos::Object& form, const goos::Object& res
       auto fe = env->function_env();
       fe->asm_func_saved_regs = true;
 
+    } else if (first.as_symbol() == "profile") {
+      if (!rrest->is_empty_list()) {
+        throw_compiler_error(first, "Invalid profile declare");
+      }
+      env->function_env()->profile = true;
+
     } else {
       throw_compiler_error(first, "Unrecognized declare option {}.", first.print());
     }
@@ -759,6 +787,28 @@ Val* Compiler::compile_declare_file(const goos::Object& /*form*/,
         throw DebugFileDeclareException();
       }
 
+    } else if (first.as_symbol() == "optimize-ir") {
+      // (optimize-ir) or (optimize-ir #t) / (optimize-ir #f)
+      bool enable = true;
+      if (!rrest->is_empty_list()) {
+        if (!rrest->is_pair() || !rrest->as_pair()->cdr.is_empty_list()) {
+          throw_compiler_error(first, "Invalid optimize-ir declare");
+        }
+        enable = get_true_or_false(o, rrest->as_pair()->car);
+      }
+      env->file_env()->set_optimize_ir(enable);
+
+    } else if (first.as_symbol() == "profile") {
+      // (profile) or (profile #t) / (profile #f)
+      bool enable = true;
+      if (!rrest->is_empty_list()) {
+        if (!rrest->is_pair() || !rrest->as_pair()->cdr.is_empty_list()) {
+          throw_compiler_error(first, "Invalid profile declare");
+        }
+        enable = get_true_or_false(o, rrest->as_pair()->car);
+      }
+      env->file_env()->set_profile_functions(enable);
+
     } else {
       throw_compiler_error(first, "Unrecognized declare-file option {}.", first.print());
     }
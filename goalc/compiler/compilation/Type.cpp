@@ -670,6 +670,7 @@ Val* Compiler::compile_defmethod(const goos::Object& form, const goos::Object& _
   func_block_env->end_label.idx = new_func_env->code().size();
   new_func_env->emit_ir<IR_Null>(form);
   new_func_env->finish();
+  setup_function_trace(new_func_env.get());
 
   auto obj_env = new_func_env->file_env();
   ASSERT(obj_env);
@@ -6,6 +6,8 @@
 
 #include "Debugger.h"
 
+#include <algorithm>
+
 #include "common/goal_constants.h"
 #include "common/log/log.h"
 #include "common/symbols.h"
@@ -361,6 +363,138 @@ std::vector<BacktraceFrame> Debugger::get_backtrace(u64 rip,
   return bt;
 }
 
+/*!
+ * Name for a frame in a profiler sample. Code that isn't in a known GOAL function is grouped by
+ * object, or by where it is.
+ */
+std::string Debugger::get_sample_frame_name(const InstructionPointerInfo& info) const {
+  if (info.knows_function) {
+    return info.function_name;
+  }
+  if (info.knows_object) {
+    return fmt::format("[{}]", info.object_name);
+  }
+  return info.in_goal_mem ? "[unknown]" : "[runtime]";
+}
+
+/*!
+ * Get the call stack for a profiler sample, leaf first. Like get_backtrace, frames of GOAL
+ * functions are unwound using their stack usage. When we don't know the current function (C++
+ * runtime code, or code without debug info), scan the stack for the first return address into a
+ * known GOAL function instead.
+ * This assumes we have an up-to-date memory map.
+ */
+std::vector<std::string> Debugger::get_sample_stack(u64 rip, u64 rsp) {
+  std::vector<std::string> frames;
+  while ((int)frames.size() < PROFILE_MAX_STACK_DEPTH) {
+    auto info = get_rip_info(rip);
+    frames.push_back(get_sample_frame_name(info));
+
+    if (info.knows_function && info.func_debug && info.func_debug->stack_usage) {
+      u64 rsp_at_call = rsp + *info.func_debug->stack_usage;
+      u64 next_rip = 0;
+      if (!read_memory_if_safe<u64>(&next_rip, rsp_at_call - m_debug_context.base)) {
+        break;
+      }
+      rip = next_rip;
+      rsp = rsp_at_call + 8;  // 8 for the call itself.
+      if (!get_rip_info(rip).knows_function) {
+        // returning to the runtime (or a bad unwind), either way we're done.
+        break;
+      }
+    } else {
+      u64 stack[PROFILE_STACK_SCAN_SIZE / 8];
+      if (!read_memory_if_safe((u8*)stack, sizeof(stack), rsp - m_debug_context.base)) {
+        break;
+      }
+      bool found = false;
+      for (int i = 0; i < PROFILE_STACK_SCAN_SIZE / 8; i++) {
+        if (get_rip_info(stack[i]).knows_function) {
+          rip = stack[i];
+          rsp += 8 * (i + 1);
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        break;
+      }
+    }
+  }
+  return frames;
+}
+
+/*!
+ * Sample the call stack of the running target by repeatedly stopping it. The target must be
+ * attached and running, and it is left running unless it stopped for some other reason (crash or
+ * breakpoint) while we were profiling.
+ */
+SampleProfile Debugger::profile(double seconds, int samples_per_second) {
+  ASSERT(is_valid() && is_attached() && is_running());
+  ASSERT(samples_per_second > 0);
+  SampleProfile result;
+  m_memory_map = m_listener->build_memory_map();
+  m_quiet_breaks = true;
+
+  const auto interval = std::chrono::nanoseconds(1000000000 / samples_per_second);
+  auto next_sample = std::chrono::steady_clock::now();
+  Timer timer;
+  while (timer.getSeconds() < seconds) {
+    // if stopping the target is slower than the sample rate, don't try to catch up.
+    next_sample = std::max(next_sample + interval, std::chrono::steady_clock::now());
+    std::this_thread::sleep_until(next_sample);
+
+    // the target may have stopped on its own since the last sample. Interrupting a stopped
+    // thread reports no new stop, so only interrupt it if it's still running.
+    bool stopped;
+    {
+      std::unique_lock<std::mutex> lock(m_watcher_mutex);
+      stopped = !m_running || !m_watcher_queue.empty();
+    }
+    m_continue_info.valid = false;
+    if (!stopped) {
+      if (!xdbg::break_now(m_debug_context.tid)) {
+        break;
+      }
+      stopped = pop_signal().kind != xdbg::SignalInfo::BREAK;
+    }
+    // a stop that arrived just before the interrupt is queued too. Anything but our own break
+    // means the target stopped.
+    SignalInfo info;
+    while (try_pop_signal(&info)) {
+      stopped = true;
+    }
+    m_running = false;
+    m_regs_valid = xdbg::get_regs_now(m_debug_context.tid, &m_regs_at_break);
+    if (stopped ||
+        (m_regs_valid && get_continue_info(m_regs_at_break.rip).is_addr_breakpiont)) {
+      // stopped for a real reason, leave it stopped.
+      lg::print("[Debugger] Target stopped while profiling, profile is incomplete.\n");
+      m_quiet_breaks = false;
+      update_break_info({});
+      result.seconds = timer.getSeconds();
+      return result;
+    }
+
+    if (m_regs_valid) {
+      result.add_sample(
+          get_sample_stack(m_regs_at_break.rip, m_regs_at_break.gprs[emitter::RSP]));
+    } else {
+      result.num_failed++;
+    }
+
+    m_regs_valid = false;
+    if (!xdbg::cont_now(m_debug_context.tid)) {
+      break;
+    }
+    m_running = true;
+  }
+
+  m_quiet_breaks = false;
+  result.seconds = timer.getSeconds();
+  return result;
+}
+
 /*!
  * This assumes we have an up-to-date memory map and symbol info.
  */
@@ -956,7 +1090,9 @@ void Debugger::watcher() {
           printf("Target has crashed with a SEGFAULT! Run (:di) to get more information.\n");
           break;
         case xdbg::SignalInfo::BREAK:
-          printf("Target has stopped. Run (:di) to get more information.\n");
+          if (!m_quiet_breaks) {
+            printf("Target has stopped. Run (:di) to get more information.\n");
+          }
           break;
         case xdbg::SignalInfo::MATH_EXCEPTION:
           printf("Target has crashed with a MATH_EXCEPTION! Run (:di) to get more information.\n");
@@ -995,8 +1131,9 @@ void Debugger::watcher() {
       m_watcher_cv.notify_one();
 
     } else {
-      // the target didn't stop.
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      // the target didn't stop. When profiling, we're waiting on the break we just sent.
+      std::this_thread::sleep_for(m_quiet_breaks ? std::chrono::microseconds(50)
+                                                 : std::chrono::microseconds(10000));
     }
   }
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <cstring>
 #include <mutex>
@@ -14,6 +15,7 @@
 #include <unordered_map>
 
 #include "DebugInfo.h"
+#include "SampleProfile.h"
 
 #include "common/common_types.h"
 #include "common/cross_os_debug/xdbg.h"
@@ -107,6 +109,7 @@ class Debugger {
   Disassembly disassemble_at_rip(const InstructionPointerInfo& info);
 
   std::vector<BacktraceFrame> get_backtrace(u64 rip, u64 rsp, std::optional<std::string> dump_path);
+  SampleProfile profile(double seconds, int samples_per_second);
 
   std::string disassemble_x86_with_symbols(int len, u64 base_addr) const;
 
@@ -156,6 +159,9 @@ class Debugger {
   // how many bytes of instructions to look at ahead of / behind rip when stopping
   static constexpr int INSTR_DUMP_SIZE_REV = 32;
   static constexpr int INSTR_DUMP_SIZE_FWD = 64;
+  // limits for unwinding the stack of a profiler sample
+  static constexpr int PROFILE_MAX_STACK_DEPTH = 64;
+  static constexpr int PROFILE_STACK_SCAN_SIZE = 512;
 
   // symbol table info (all s7-relative offsets)
   std::unordered_map<std::string, s32> m_symbol_name_to_offset_map;
@@ -180,6 +186,8 @@ class Debugger {
   void watcher();
   void update_continue_info();
   void handle_disappearance();
+  std::vector<std::string> get_sample_stack(u64 rip, u64 rsp);
+  std::string get_sample_frame_name(const InstructionPointerInfo& info) const;
 
   struct Breakpoint {
     u32 goal_addr = 0;  // address to break at
@@ -188,6 +196,8 @@ class Debugger {
   };
 
   bool m_expecting_immeidate_break = false;
+  // set while profiling, so the watcher doesn't print every time we stop to take a sample.
+  std::atomic<bool> m_quiet_breaks = false;
 
   std::unordered_map<u32, Breakpoint> m_addr_breakpoints;
 
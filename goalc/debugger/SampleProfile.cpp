@@ -0,0 +1,74 @@
+#include "SampleProfile.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "fmt/core.h"
+
+/*!
+ * Add a sampled call stack. The first frame is the function that was running.
+ */
+void SampleProfile::add_sample(const std::vector<std::string>& frames_leaf_first) {
+  num_samples++;
+  if (frames_leaf_first.empty()) {
+    stacks["[unknown]"]++;
+    self_samples["[unknown]"]++;
+    total_samples["[unknown]"]++;
+    return;
+  }
+
+  std::string stack;
+  for (auto it = frames_leaf_first.rbegin(); it != frames_leaf_first.rend(); it++) {
+    if (!stack.empty()) {
+      stack.push_back(';');
+    }
+    stack += *it;
+  }
+  stacks[stack]++;
+  self_samples[frames_leaf_first.front()]++;
+
+  // recursive functions only count once per sample.
+  std::unordered_set<std::string> seen;
+  for (auto& frame : frames_leaf_first) {
+    if (seen.insert(frame).second) {
+      total_samples[frame]++;
+    }
+  }
+}
+
+/*!
+ * One "stack count" line per unique stack, the input format for flamegraph.pl and speedscope.
+ */
+std::string SampleProfile::to_collapsed_stacks() const {
+  std::vector<std::pair<std::string, int>> sorted(stacks.begin(), stacks.end());
+  std::sort(sorted.begin(), sorted.end());
+  std::string result;
+  for (auto& [stack, count] : sorted) {
+    result += fmt::format("{} {}\n", stack, count);
+  }
+  return result;
+}
+
+/*!
+ * Table of the functions with the most samples at the top of the stack.
+ */
+std::string SampleProfile::print_summary(int max_functions) const {
+  std::string result =
+      fmt::format("{} samples in {:.2f}s ({} failed)\n", num_samples, seconds, num_failed);
+  if (num_samples == 0) {
+    return result;
+  }
+
+  std::vector<std::pair<std::string, int>> sorted(self_samples.begin(), self_samples.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+
+  result += fmt::format(" {:>7s} {:>7s}  function\n", "self", "total");
+  for (int i = 0; i < std::min(max_functions, (int)sorted.size()); i++) {
+    const auto& [name, self] = sorted[i];
+    result += fmt::format(" {:6.2f}% {:6.2f}%  {}\n", 100. * self / num_samples,
+                          100. * total_samples.at(name) / num_samples, name);
+  }
+  return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+/*!
+ * @file SampleProfile.h
+ * Results of sampling the call stack of a running target with the debugger.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SampleProfile {
+  int num_samples = 0;
+  // samples where we couldn't read registers, these aren't included in the stacks
+  int num_failed = 0;
+  double seconds = 0;
+
+  // call stack, written root first and separated with ;, to the number of times it was sampled.
+  std::unordered_map<std::string, int> stacks;
+  // number of samples where the function was at the top of the stack
+  std::unordered_map<std::string, int> self_samples;
+  // number of samples where the function was anywhere on the stack
+  std::unordered_map<std::string, int> total_samples;
+
+  void add_sample(const std::vector<std::string>& frames_leaf_first);
+  std::string to_collapsed_stacks() const;
+  std::string print_summary(int max_functions) const;
+};
@@ -1697,6 +1697,18 @@ class IGen {
     return instr;
   }
 
+  /*!
+   * Bitwise and of two gpr64's, only setting flags. "test a, a" sets the same flags as comparing
+   * a with zero.
+   */
+  static Instruction test_gpr64_gpr64(Register a, Register b) {
+    Instruction instr(0x85);
+    ASSERT(a.is_gpr());
+    ASSERT(b.is_gpr());
+    instr.set_modrm_and_rex(b.hw_id(), a.hw_id(), 3, true);
+    return instr;
+  }
+
   //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
   //   BIT STUFF
   //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -2069,6 +2081,15 @@ class IGen {
     return instr;
   }
 
+  /*!
+   * Read the time stamp counter into edx:eax.
+   */
+  static Instruction rdtsc() {
+    Instruction instr(0x0f);
+    instr.set_op2(0x31);
+    return instr;
+  }
+
   // TODO - rsqrt / abs / sqrt
 
   //;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
@@ -4,6 +4,7 @@
  *
  * There are 5 steps:
  * 1. The user adds static data / instructions and specifies links.
+ *    (1.5. The instructions of each function are peephole optimized)
  * 2. The functions and static data are laid out in memory
  * 3. The user specified links are updated according to the memory layout, and jumps are patched
  * 4. The link table is generated for each segment
@@ -33,6 +34,13 @@ ObjectGenerator::ObjectGenerator(GameVersion version) : m_version(version) {}
 ObjectFileData ObjectGenerator::generate_data_v3(const TypeSystem* ts) {
   ObjectFileData out;
 
+  // peephole optimize instructions (step 1.5), must happen before any instruction is laid out.
+  if (m_peephole_enabled) {
+    for (int seg = N_SEG; seg-- > 0;) {
+      run_peephole_on_functions(seg);
+    }
+  }
+
   // do functions (step 2, part 1)
   for (int seg = N_SEG; seg-- > 0;) {
     auto& data = m_data_by_seg.at(seg);
@@ -199,12 +207,17 @@ InstructionRecord ObjectGenerator::add_instr(Instruction inst, IR_Record ir) {
   return rec;
 }
 
-void ObjectGenerator::add_instr_no_ir(FunctionRecord func,
-                                      Instruction inst,
-                                      InstructionInfo::Kind kind) {
-  auto info = InstructionInfo(inst, kind);
-  m_function_data_by_seg.at(func.seg).at(func.func_id).instructions.emplace_back(inst);
-  func.debug->instructions.push_back(info);
+InstructionRecord ObjectGenerator::add_instr_no_ir(FunctionRecord func,
+                                                   Instruction inst,
+                                                   InstructionInfo::Kind kind) {
+  InstructionRecord rec;
+  rec.seg = func.seg;
+  rec.func_id = func.func_id;
+  auto& instructions = m_function_data_by_seg.at(func.seg).at(func.func_id).instructions;
+  rec.instr_id = int(instructions.size());
+  instructions.emplace_back(inst);
+  func.debug->instructions.push_back(InstructionInfo(inst, kind));
+  return rec;
 }
 
 /*!
@@ -321,6 +334,51 @@ void ObjectGenerator::link_instruction_to_function(const InstructionRecord& inst
   m_rip_func_temp_links_by_seg.at(instr.seg).push_back({instr, target_func});
 }
 
+/*!
+ * Run the peephole optimizer on each function in the segment. Instructions that will be patched by
+ * links are left alone, and instructions that can be jumped to are not combined with the
+ * instruction before them.
+ */
+void ObjectGenerator::run_peephole_on_functions(int seg) {
+  auto& functions = m_function_data_by_seg.at(seg);
+  std::vector<PeepholeInput> inputs(functions.size());
+  for (size_t i = 0; i < functions.size(); i++) {
+    inputs[i].pinned.resize(functions[i].instructions.size(), false);
+    // a jump to the end of the function targets one past the last instruction.
+    inputs[i].jump_target.resize(functions[i].instructions.size() + 1, false);
+  }
+
+  auto pin = [&](const InstructionRecord& rec) {
+    inputs.at(rec.func_id).pinned.at(rec.instr_id) = true;
+  };
+  for (const auto& link : m_jump_temp_links_by_seg.at(seg)) {
+    pin(link.jump_instr);
+    const auto& function = functions.at(link.dest.func_id);
+    inputs.at(link.dest.func_id).jump_target.at(function.ir_to_instruction.at(link.dest.ir_id)) =
+        true;
+  }
+  for (const auto& links : m_symbol_instr_temp_links_by_seg.at(seg)) {
+    for (const auto& link : links.second) {
+      pin(link.rec);
+    }
+  }
+  for (const auto& link : m_rip_func_temp_links_by_seg.at(seg)) {
+    pin(link.instr);
+  }
+  for (const auto& link : m_rip_data_temp_links_by_seg.at(seg)) {
+    pin(link.instr);
+  }
+
+  for (size_t i = 0; i < functions.size(); i++) {
+    auto& function = functions[i];
+    run_peephole(&function.instructions, inputs[i], &m_stats.peephole);
+    // keep the debug info in sync for disassembly.
+    for (size_t j = 0; j < function.instructions.size(); j++) {
+      function.debug->instructions.at(j).instruction = function.instructions[j];
+    }
+  }
+}
+
 /*!
  * Convert:
  * m_static_type_temp_links_by_seg -> m_type_ptr_links_by_seg
@@ -11,6 +11,7 @@
 
 #include "Instruction.h"
 #include "ObjectFileData.h"
+#include "Peephole.h"
 
 #include "common/versions/versions.h"
 
@@ -59,6 +60,7 @@ struct StaticRecord {
 
 struct ObjectGeneratorStats {
   int moves_eliminated = 0;
+  PeepholeStats peephole;
 };
 
 class ObjectGenerator {
@@ -73,7 +75,9 @@ class ObjectGenerator {
   IR_Record get_future_ir_record(const FunctionRecord& func, int ir_id);
   IR_Record get_future_ir_record_in_same_func(const IR_Record& irec, int ir_id);
   InstructionRecord add_instr(Instruction inst, IR_Record ir);
-  void add_instr_no_ir(FunctionRecord func, Instruction inst, InstructionInfo::Kind kind);
+  InstructionRecord add_instr_no_ir(FunctionRecord func,
+                                    Instruction inst,
+                                    InstructionInfo::Kind kind);
   StaticRecord add_static_to_seg(int seg, int min_align = 16);
   std::vector<u8>& get_static_data(const StaticRecord& rec);
   void link_instruction_jump(InstructionRecord jump_instr, IR_Record destination);
@@ -96,10 +100,12 @@ class ObjectGenerator {
                                     const FunctionRecord& target_func);
   ObjectGeneratorStats get_stats() const;
   void count_eliminated_move();
+  void set_peephole_enabled(bool enabled) { m_peephole_enabled = enabled; }
 
   GameVersion version() const { return m_version; }
 
  private:
+  void run_peephole_on_functions(int seg);
   void handle_temp_static_type_links(int seg);
   void handle_temp_jump_links(int seg);
   void handle_temp_instr_sym_links(int seg);
@@ -237,5 +243,6 @@ class ObjectGenerator {
   std::vector<FunctionRecord> m_all_function_records;
 
   ObjectGeneratorStats m_stats;
+  bool m_peephole_enabled = true;
 };
 }  // namespace emitter
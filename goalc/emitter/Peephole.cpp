@@ -0,0 +1,475 @@
+/*!
+ * @file Peephole.cpp
+ * Peephole optimization of x86-64 instructions.
+ *
+ * The rules look at one instruction, along with the instruction before it, ignoring nulls, and
+ * whether the flags it sets can be read later. The instructions are matched by their encoding,
+ * so the rules are written in terms of opcode bytes and ModRM fields. Only plain GPR forms with a
+ * single byte opcode are recognized, anything else is left alone.
+ */
+
+#include "Peephole.h"
+
+#include <optional>
+
+#include "IGen.h"
+
+namespace emitter {
+
+namespace {
+
+bool has(const Instruction& instr, int flag) {
+  return instr.m_flags & flag;
+}
+
+/*!
+ * A single byte opcode with an optional REX prefix and no other prefixes.
+ */
+bool is_plain(const Instruction& instr) {
+  if (has(instr, Instruction::kIsNull) || instr.n_vex ||
+      has(instr, Instruction::kOp2Set | Instruction::kOp3Set)) {
+    return false;
+  }
+  return !has(instr, Instruction::kSetRex) || (instr.m_rex & 0xf0) == 0x40;
+}
+
+bool rex_w(const Instruction& instr) {
+  return has(instr, Instruction::kSetRex) && (instr.m_rex & 0b1000);
+}
+
+int modrm_mod(const Instruction& instr) {
+  return instr.m_modrm >> 6;
+}
+
+// the reg field, including REX.R
+int modrm_reg(const Instruction& instr) {
+  int ext = (has(instr, Instruction::kSetRex) && (instr.m_rex & 0b0100)) ? 8 : 0;
+  return ((instr.m_modrm >> 3) & 7) + ext;
+}
+
+// the r/m field, including REX.B
+int modrm_rm(const Instruction& instr) {
+  int ext = (has(instr, Instruction::kSetRex) && (instr.m_rex & 0b0001)) ? 8 : 0;
+  return (instr.m_modrm & 7) + ext;
+}
+
+/*!
+ * Is this a 64-bit "op reg, reg" instruction with the given opcode?
+ */
+bool is_reg_reg64(const Instruction& instr, u8 opcode) {
+  return is_plain(instr) && instr.op == opcode && rex_w(instr) &&
+         has(instr, Instruction::kSetModrm) && modrm_mod(instr) == 3 &&
+         !has(instr, Instruction::kSetSib | Instruction::kSetDispImm | Instruction::kSetImm);
+}
+
+/*!
+ * Is this a 64-bit "op reg, imm" instruction with the given opcode and ModRM reg field?
+ */
+bool is_reg_imm64(const Instruction& instr, u8 opcode, int group) {
+  return is_plain(instr) && instr.op == opcode && rex_w(instr) &&
+         has(instr, Instruction::kSetModrm) && modrm_mod(instr) == 3 &&
+         ((instr.m_modrm >> 3) & 7) == group && has(instr, Instruction::kSetImm) &&
+         !has(instr, Instruction::kSetSib | Instruction::kSetDispImm);
+}
+
+bool imm_is_zero(const Instruction& instr) {
+  for (int i = 0; i < instr.imm.size; i++) {
+    if (instr.imm.v_arr[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * Decode a 64-bit mov between gprs.
+ */
+bool get_mov(const Instruction& instr, int* dst, int* src) {
+  if (is_reg_reg64(instr, 0x89)) {
+    *dst = modrm_rm(instr);
+    *src = modrm_reg(instr);
+    return true;
+  }
+  if (is_reg_reg64(instr, 0x8b)) {
+    *dst = modrm_reg(instr);
+    *src = modrm_rm(instr);
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * Is this "xor r, r", which sets r to zero?
+ */
+bool is_zero_reg(const Instruction& instr, int* reg) {
+  if ((is_reg_reg64(instr, 0x33) || is_reg_reg64(instr, 0x31)) &&
+      modrm_reg(instr) == modrm_rm(instr)) {
+    *reg = modrm_reg(instr);
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * Get the opcode of an instruction, skipping over prefixes. op2 is the byte after a 0x0f, or -1.
+ * Returns false if the opcode can't be found.
+ */
+bool get_opcode(const Instruction& instr, u8* op, int* op2) {
+  // opcode bytes in the order they are emitted.
+  u8 bytes[4];
+  int count = 0;
+  if (has(instr, Instruction::kSetRex)) {
+    // either a REX prefix, or a prefix swapped in front of the REX by swap_op0_rex.
+    bytes[count++] = instr.m_rex;
+  }
+  bytes[count++] = instr.op;
+  if (has(instr, Instruction::kOp2Set)) {
+    bytes[count++] = instr.op2;
+  }
+  if (has(instr, Instruction::kOp3Set)) {
+    bytes[count++] = instr.op3;
+  }
+
+  int idx = 0;
+  while (idx < count && (bytes[idx] == 0x66 || bytes[idx] == 0xf2 || bytes[idx] == 0xf3 ||
+                         (bytes[idx] & 0xf0) == 0x40)) {
+    idx++;
+  }
+  if (idx == count || (bytes[idx] == 0x0f && idx + 1 == count)) {
+    return false;
+  }
+  *op = bytes[idx];
+  *op2 = bytes[idx] == 0x0f ? bytes[idx + 1] : -1;
+  return true;
+}
+
+/*!
+ * Could this instruction read the flags? Conservative for plain instructions and two byte
+ * opcodes, VEX instructions never read flags.
+ */
+bool reads_flags(const Instruction& instr) {
+  if (has(instr, Instruction::kIsNull) || instr.n_vex) {
+    return false;
+  }
+  u8 op;
+  int op2;
+  if (!get_opcode(instr, &op, &op2)) {
+    return true;
+  }
+
+  int group = (instr.m_modrm >> 3) & 7;
+  if (op == 0x0f) {
+    return (op2 >= 0x40 && op2 <= 0x4f) ||  // cmovcc
+           (op2 >= 0x80 && op2 <= 0x9f);    // jcc, setcc
+  }
+  if (op >= 0x70 && op <= 0x7f) {
+    return true;  // short jcc
+  }
+  if (op >= 0x10 && op <= 0x1d) {
+    return true;  // adc, sbb
+  }
+  if (op == 0x9c || op == 0x9f) {
+    return true;  // pushf, lahf
+  }
+  if ((op == 0x80 || op == 0x81 || op == 0x83 || (op >= 0xc0 && op <= 0xc1) ||
+       (op >= 0xd0 && op <= 0xd3)) &&
+      has(instr, Instruction::kSetModrm)) {
+    return group == 2 || group == 3;  // adc/sbb/rcl/rcr
+  }
+  return false;
+}
+
+/*!
+ * Does this instruction set all of CF, PF, AF, ZF, SF and OF, without reading them?
+ */
+bool writes_all_flags(const Instruction& instr) {
+  if (has(instr, Instruction::kIsNull) || instr.n_vex || reads_flags(instr)) {
+    return false;
+  }
+  u8 op;
+  int op2;
+  if (!get_opcode(instr, &op, &op2)) {
+    return false;
+  }
+  if (op < 0x40 && (op & 7) <= 5) {
+    return true;  // add, or, and, sub, xor, cmp (adc and sbb read flags)
+  }
+  if (op == 0x80 || op == 0x81 || op == 0x83) {
+    return has(instr, Instruction::kSetModrm);  // the same, with an immediate
+  }
+  return op == 0x84 || op == 0x85 || op == 0xa8 || op == 0xa9;  // test
+}
+
+/*!
+ * Could this instruction go somewhere other than the next instruction?
+ */
+bool is_control_flow(const Instruction& instr) {
+  if (has(instr, Instruction::kIsNull) || instr.n_vex) {
+    return false;
+  }
+  u8 op;
+  int op2;
+  if (!get_opcode(instr, &op, &op2)) {
+    return true;
+  }
+  if (op == 0x0f) {
+    return (op2 >= 0x80 && op2 <= 0x8f) || op2 == 0x05 || op2 == 0x0b;  // jcc, syscall, ud2
+  }
+  if (op == 0xff && has(instr, Instruction::kSetModrm)) {
+    int group = (instr.m_modrm >> 3) & 7;
+    return group >= 2 && group <= 5;  // call, jmp
+  }
+  return (op >= 0x70 && op <= 0x7f) || (op >= 0xe0 && op <= 0xe3) || op == 0xe8 || op == 0xe9 ||
+         op == 0xeb || op == 0xc2 || op == 0xc3 || (op >= 0xca && op <= 0xcf);
+}
+
+/*!
+ * Will the flags set by instruction idx be overwritten before anything can read them? Jumps, jump
+ * targets, linked instructions, the end of the function and anything past the first few
+ * instructions are assumed to read them.
+ */
+bool flags_dead_after(const std::vector<Instruction>& instrs, const PeepholeInput& input, int idx) {
+  constexpr int kMaxInstructions = 16;
+  int checked = 0;
+  for (int i = idx + 1; i < (int)instrs.size() && checked < kMaxInstructions; i++) {
+    const auto& instr = instrs[i];
+    if (input.jump_target[i] || input.pinned[i]) {
+      return false;
+    }
+    if (has(instr, Instruction::kIsNull)) {
+      continue;
+    }
+    checked++;
+    if (reads_flags(instr) || is_control_flow(instr)) {
+      return false;
+    }
+    if (writes_all_flags(instr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct PeepholeWindow {
+  const Instruction* prev = nullptr;  // null if there's no previous instruction we can combine with
+  const Instruction* cur = nullptr;
+  // if the flags set by cur are overwritten before they can be read.
+  bool flags_dead = false;
+};
+
+using RuleFunc = std::optional<Instruction> (*)(const PeepholeWindow&);
+
+std::optional<Instruction> rule_mov_self(const PeepholeWindow& w) {
+  int dst, src;
+  if (get_mov(*w.cur, &dst, &src) && dst == src) {
+    return IGen::null();
+  }
+  return std::nullopt;
+}
+
+std::optional<Instruction> rule_mov_back(const PeepholeWindow& w) {
+  int dst, src, prev_dst, prev_src;
+  if (w.prev && get_mov(*w.cur, &dst, &src) && get_mov(*w.prev, &prev_dst, &prev_src)) {
+    // both registers already hold the same value.
+    if ((dst == prev_src && src == prev_dst) || (dst == prev_dst && src == prev_src)) {
+      return IGen::null();
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<Instruction> rule_add_sub_zero(const PeepholeWindow& w) {
+  bool add_or_sub = is_reg_imm64(*w.cur, 0x83, 0) || is_reg_imm64(*w.cur, 0x83, 5) ||
+                    is_reg_imm64(*w.cur, 0x81, 0) || is_reg_imm64(*w.cur, 0x81, 5);
+  if (add_or_sub && imm_is_zero(*w.cur) && w.flags_dead) {
+    return IGen::null();
+  }
+  return std::nullopt;
+}
+
+std::optional<Instruction> rule_cmp_zero_to_test(const PeepholeWindow& w) {
+  // cmp r, 0
+  if (is_reg_imm64(*w.cur, 0x83, 7) && imm_is_zero(*w.cur)) {
+    Register r(modrm_rm(*w.cur));
+    return IGen::test_gpr64_gpr64(r, r);
+  }
+
+  // cmp a, b where b was just zeroed.
+  int zero;
+  if (!w.prev || !is_zero_reg(*w.prev, &zero)) {
+    return std::nullopt;
+  }
+  if (is_reg_reg64(*w.cur, 0x3b) && modrm_rm(*w.cur) == zero) {
+    // cmp reg, r/m
+    Register r(modrm_reg(*w.cur));
+    return IGen::test_gpr64_gpr64(r, r);
+  }
+  if (is_reg_reg64(*w.cur, 0x39) && modrm_reg(*w.cur) == zero) {
+    // cmp r/m, reg
+    Register r(modrm_rm(*w.cur));
+    return IGen::test_gpr64_gpr64(r, r);
+  }
+  return std::nullopt;
+}
+
+/*!
+ * Is this a 64-bit "mov" between a gpr and memory, not rip relative?
+ */
+bool is_mem_mov64(const Instruction& instr, u8 opcode) {
+  return is_plain(instr) && instr.op == opcode && rex_w(instr) &&
+         has(instr, Instruction::kSetModrm) && modrm_mod(instr) != 3 &&
+         !(modrm_mod(instr) == 0 && (instr.m_modrm & 7) == 5) && !has(instr, Instruction::kSetImm);
+}
+
+bool same_address(const Instruction& a, const Instruction& b) {
+  constexpr u8 kRexXB = 0b0011;
+  if (modrm_mod(a) != modrm_mod(b) || (a.m_modrm & 7) != (b.m_modrm & 7) ||
+      (a.m_rex & kRexXB) != (b.m_rex & kRexXB)) {
+    return false;
+  }
+  if (has(a, Instruction::kSetSib) != has(b, Instruction::kSetSib) ||
+      (has(a, Instruction::kSetSib) && a.m_sib != b.m_sib)) {
+    return false;
+  }
+  if (has(a, Instruction::kSetDispImm) != has(b, Instruction::kSetDispImm)) {
+    return false;
+  }
+  if (has(a, Instruction::kSetDispImm)) {
+    if (a.disp.size != b.disp.size) {
+      return false;
+    }
+    for (int i = 0; i < a.disp.size; i++) {
+      if (a.disp.v_arr[i] != b.disp.v_arr[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::optional<Instruction> rule_store_reload(const PeepholeWindow& w) {
+  if (w.prev && is_mem_mov64(*w.prev, 0x89) && is_mem_mov64(*w.cur, 0x8b) &&
+      same_address(*w.prev, *w.cur)) {
+    int stored = modrm_reg(*w.prev);
+    int loaded = modrm_reg(*w.cur);
+    if (stored == loaded) {
+      return IGen::null();
+    }
+    return IGen::mov_gpr64_gpr64(Register(loaded), Register(stored));
+  }
+  return std::nullopt;
+}
+
+std::optional<Instruction> rule_redundant_sign_ext(const PeepholeWindow& w) {
+  // movsxd r, r32
+  if (!w.prev || !is_reg_reg64(*w.cur, 0x63) || modrm_reg(*w.cur) != modrm_rm(*w.cur)) {
+    return std::nullopt;
+  }
+  int reg = modrm_reg(*w.cur);
+  const auto& prev = *w.prev;
+
+  // movsxd r, r32 / movsxd r, [mem]
+  bool prev_sext = is_plain(prev) && prev.op == 0x63 && rex_w(prev) && modrm_reg(prev) == reg;
+  // mov r, simm32
+  bool prev_imm = is_reg_imm64(prev, 0xc7, 0) && modrm_rm(prev) == reg;
+  // xor r, r
+  int zero;
+  bool prev_zero = is_zero_reg(prev, &zero) && zero == reg;
+
+  if (prev_sext || prev_imm || prev_zero) {
+    return IGen::null();
+  }
+  return std::nullopt;
+}
+
+struct RuleEntry {
+  PeepholeRule rule;
+  const char* name;
+  RuleFunc func;
+};
+
+// the first rule that matches is used.
+constexpr RuleEntry kRules[] = {
+    {PeepholeRule::MOV_SELF, "mov-self", rule_mov_self},
+    {PeepholeRule::MOV_BACK, "mov-back", rule_mov_back},
+    {PeepholeRule::ADD_SUB_ZERO, "add-sub-zero", rule_add_sub_zero},
+    {PeepholeRule::CMP_ZERO_TO_TEST, "cmp-zero-to-test", rule_cmp_zero_to_test},
+    {PeepholeRule::STORE_RELOAD, "store-reload", rule_store_reload},
+    {PeepholeRule::REDUNDANT_SIGN_EXT, "redundant-sign-ext", rule_redundant_sign_ext},
+};
+static_assert(std::size(kRules) == (size_t)PeepholeRule::COUNT);
+
+}  // namespace
+
+const char* peephole_rule_name(PeepholeRule rule) {
+  for (const auto& entry : kRules) {
+    if (entry.rule == rule) {
+      return entry.name;
+    }
+  }
+  return "invalid";
+}
+
+int PeepholeStats::total_hits() const {
+  int total = 0;
+  for (auto hit : hits) {
+    total += hit;
+  }
+  return total;
+}
+
+void PeepholeStats::add(const PeepholeStats& other) {
+  for (size_t i = 0; i < hits.size(); i++) {
+    hits[i] += other.hits[i];
+  }
+  bytes_saved += other.bytes_saved;
+}
+
+void run_peephole(std::vector<Instruction>* instructions,
+                  const PeepholeInput& input,
+                  PeepholeStats* stats) {
+  auto& instrs = *instructions;
+  const int n = instrs.size();
+  ASSERT((int)input.pinned.size() == n);
+  ASSERT((int)input.jump_target.size() >= n);
+
+  auto is_null = [&](int idx) { return has(instrs[idx], Instruction::kIsNull); };
+
+  int prev = -1;
+  for (int i = 0; i < n; i++) {
+    if (input.jump_target[i]) {
+      // another path can get here, so the previous instruction might not have run.
+      prev = -1;
+    }
+    if (is_null(i)) {
+      continue;
+    }
+    if (input.pinned[i]) {
+      // linked instructions will have their immediate/displacement changed, so they can't be
+      // compared to anything either.
+      prev = -1;
+      continue;
+    }
+
+    PeepholeWindow window;
+    window.prev = prev >= 0 ? &instrs[prev] : nullptr;
+    window.cur = &instrs[i];
+    window.flags_dead = flags_dead_after(instrs, input, i);
+
+    for (const auto& entry : kRules) {
+      auto replacement = entry.func(window);
+      if (replacement) {
+        stats->hits[(int)entry.rule]++;
+        stats->bytes_saved += instrs[i].length() - replacement->length();
+        instrs[i] = *replacement;
+        break;
+      }
+    }
+
+    if (!is_null(i)) {
+      prev = i;
+    }
+  }
+}
+
+}  // namespace emitter
@@ -0,0 +1,53 @@
+#pragma once
+
+/*!
+ * @file Peephole.h
+ * Peephole optimization of a function's x86-64 instructions, done by the ObjectGenerator before
+ * the function is laid out.
+ *
+ * Like the "eliminated moves" done in codegen, instructions are never removed from the list, only
+ * replaced with IGen::null(), so instruction indices used by links and debug info stay valid.
+ */
+
+#include <array>
+#include <vector>
+
+#include "Instruction.h"
+
+namespace emitter {
+
+enum class PeepholeRule {
+  MOV_SELF,             // mov r, r
+  MOV_BACK,             // mov a, b; mov b, a
+  ADD_SUB_ZERO,         // add r, 0 / sub r, 0 (when flags aren't read)
+  CMP_ZERO_TO_TEST,     // xor b, b; cmp a, b -> test a, a
+  STORE_RELOAD,         // mov [m], a; mov b, [m] -> mov b, a
+  REDUNDANT_SIGN_EXT,   // movsxd r, r when r is already sign extended from 32 bits
+  COUNT
+};
+
+const char* peephole_rule_name(PeepholeRule rule);
+
+struct PeepholeStats {
+  std::array<int, (int)PeepholeRule::COUNT> hits = {};
+  int bytes_saved = 0;
+
+  int total_hits() const;
+  void add(const PeepholeStats& other);
+};
+
+/*!
+ * Options to tell the peephole optimizer about instructions it can't see from the instruction list.
+ */
+struct PeepholeInput {
+  // instructions that are patched by a link (jumps, symbols, rip-relative), these are not modified.
+  std::vector<bool> pinned;
+  // instructions that may be reached by a jump, these can't be combined with the one before.
+  std::vector<bool> jump_target;
+};
+
+void run_peephole(std::vector<Instruction>* instructions,
+                  const PeepholeInput& input,
+                  PeepholeStats* stats);
+
+}  // namespace emitter
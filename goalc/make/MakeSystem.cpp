@@ -99,6 +99,7 @@ MakeSystem::MakeSystem(const std::optional<REPL::Config> repl_config, const std:
     set_constant("*iso-data*", file_util::get_file_path({"iso_data"}));
     set_constant("*use-iso-data-path*", false);
   }
+  set_constant("*compress-dgos*", m_repl_config && m_repl_config->compress_dgos);
 
   add_tool<DgoTool>();
   add_tool<TpageDirTool>();
@@ -89,7 +89,8 @@ bool DgoTool::run(const ToolInput& task, const PathMap& path_map) {
     throw std::runtime_error(fmt::format("Invalid amount of inputs to {} tool", name()));
   }
   auto desc = parse_desc_file(task.input.at(0), m_reader);
-  build_dgo(desc, path_map.output_prefix);
+  // :arg 'zstd to compress each object.
+  build_dgo(desc, path_map.output_prefix, task.arg.is_symbol("zstd"));
   return true;
 }
 
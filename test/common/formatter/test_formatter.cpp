@@ -163,3 +163,19 @@ bool find_and_run_tests() {
 TEST(Formatter, FormatterTests) {
   EXPECT_TRUE(find_and_run_tests());
 }
+
+TEST(Formatter, ParallelTopLevelForms) {
+  std::string source = ";; a comment\n";
+  for (int i = 0; i < 64; i++) {
+    source += fmt::format("(define   *value-{}*   (+ {} {}))\n", i, i, i * 2);
+  }
+  const auto serial = formatter::format_code(source, 1);
+  ASSERT_TRUE(serial);
+  EXPECT_EQ(formatter::format_code(source, 4), serial);
+
+  const auto forms = formatter::format_top_level_forms(source, 4);
+  ASSERT_TRUE(forms);
+  ASSERT_EQ(forms->size(), 65u);
+  EXPECT_EQ(forms->at(0), ";; a comment");
+  EXPECT_EQ(forms->at(3), "(define *value-2* (+ 2 4))");
+}
@@ -0,0 +1,112 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/global_profiler/FrameTimings.h"
+#include "common/util/FileUtil.h"
+
+#include "gtest/gtest.h"
+#include "third-party/json.hpp"
+
+TEST(FrameTimings, Stats) {
+  FrameTimings timings;
+  const int ch = timings.channel("test");
+  EXPECT_EQ(timings.channel("test"), ch);
+  for (int i = 1; i <= 100; i++) {
+    timings.record(ch, i);
+  }
+
+  auto stats = timings.stats();
+  ASSERT_EQ(stats.size(), 1u);
+  auto& s = stats.at(0);
+  EXPECT_EQ(s.name, "test");
+  EXPECT_EQ(s.count, 100u);
+  EXPECT_FLOAT_EQ(s.mean, 50.5f);
+  EXPECT_FLOAT_EQ(s.max, 100.f);
+  // nearest rank
+  EXPECT_FLOAT_EQ(s.p50, 50.f);
+  EXPECT_FLOAT_EQ(s.p95, 95.f);
+  EXPECT_FLOAT_EQ(s.p99, 99.f);
+  // over 1000 / 30 ms.
+  EXPECT_EQ(s.hitches, 67u);
+}
+
+TEST(FrameTimings, PercentilesUseRecentHistory) {
+  FrameTimings timings;
+  const int ch = timings.channel("test", 10.f);
+  for (int i = 0; i < FrameTimings::HISTORY_SIZE; i++) {
+    timings.record(ch, 100.f);
+  }
+  for (int i = 0; i < FrameTimings::HISTORY_SIZE; i++) {
+    timings.record(ch, 1.f);
+  }
+
+  auto s = timings.stats().at(0);
+  EXPECT_EQ(s.count, 2u * FrameTimings::HISTORY_SIZE);
+  EXPECT_FLOAT_EQ(s.p99, 1.f);
+  EXPECT_FLOAT_EQ(s.max, 100.f);
+  EXPECT_EQ(s.hitches, (u64)FrameTimings::HISTORY_SIZE);
+}
+
+TEST(FrameTimings, ResetAndDump) {
+  FrameTimings timings;
+  const int ch = timings.channel("test", 4.f);
+  for (int i = 0; i < 10; i++) {
+    timings.record(ch, 20.f);
+  }
+  timings.reset();
+
+  auto s = timings.stats().at(0);
+  EXPECT_EQ(s.count, 0u);
+  EXPECT_FLOAT_EQ(s.p50, 0.f);
+  EXPECT_FLOAT_EQ(s.max, 0.f);
+
+  timings.record(ch, 2.f);
+  timings.record(ch, 6.f);
+  s = timings.stats().at(0);
+  EXPECT_EQ(s.count, 2u);
+  EXPECT_FLOAT_EQ(s.mean, 4.f);
+  EXPECT_FLOAT_EQ(s.p50, 2.f);
+  EXPECT_FLOAT_EQ(s.p99, 6.f);
+  EXPECT_EQ(s.hitches, 1u);
+
+  const auto dir = fs::temp_directory_path() / "opengoal-test-frame-timings";
+  ASSERT_TRUE(timings.dump(dir / "timings.csv"));
+  EXPECT_EQ(file_util::read_text_file(dir / "timings.csv"),
+            "channel,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches,hitch_ms\n"
+            "test,2,4.000,2.000,6.000,6.000,6.000,1,4.000\n");
+
+  ASSERT_TRUE(timings.dump(dir / "timings.json"));
+  auto json = nlohmann::json::parse(file_util::read_text_file(dir / "timings.json"));
+  auto& dumped = json.at("channels").at("test");
+  EXPECT_EQ(dumped.at("count").get<u64>(), 2u);
+  EXPECT_EQ(dumped.at("history_ms").get<std::vector<float>>(), std::vector<float>({2.f, 6.f}));
+  fs::remove_all(dir);
+}
+
+TEST(FrameTimings, SingleSample) {
+  FrameTimings timings;
+  timings.record("test", 3.f);
+  auto s = timings.stats().at(0);
+  EXPECT_FLOAT_EQ(s.p50, 3.f);
+  EXPECT_FLOAT_EQ(s.p99, 3.f);
+}
+
+TEST(FrameTimings, RecordFromThreads) {
+  FrameTimings timings;
+  const int ch = timings.channel("test");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; i++) {
+        timings.record(ch, 1.f);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto s = timings.stats().at(0);
+  EXPECT_EQ(s.count, 4000u);
+  EXPECT_FLOAT_EQ(s.mean, 1.f);
+}
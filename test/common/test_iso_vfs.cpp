@@ -0,0 +1,129 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/util/FileUtil.h"
+#include "common/util/iso_vfs.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+constexpr u32 SECTOR_SIZE = 0x800;
+constexpr u32 PATH_TABLE_SECTOR = 0x12;
+constexpr u32 ROOT_SECTOR = 0x13;
+constexpr u32 SUBDIR_SECTOR = 0x14;
+constexpr u32 FIRST_DATA_SECTOR = 0x15;
+
+void put_u32(std::vector<u8>& image, size_t offset, u32 value) {
+  memcpy(image.data() + offset, &value, sizeof(u32));
+}
+
+// add a directory record. Files have a ";1" version suffix, like on the discs.
+void add_record(std::vector<u8>& image,
+                size_t* offset,
+                const std::string& name,
+                u32 extent,
+                u32 size) {
+  const u8 record_size = (33 + name.size() + 1) & ~1;
+  image.at(*offset) = record_size;
+  put_u32(image, *offset + 2, extent);
+  put_u32(image, *offset + 10, size);
+  image.at(*offset + 32) = name.size();
+  memcpy(image.data() + *offset + 33, name.data(), name.size());
+  *offset += record_size;
+}
+
+struct TestFile {
+  std::string record_name;
+  std::string data;
+};
+
+/*!
+ * Build a minimal ISO9660 image with some files in the root and one in SUBDIR.
+ */
+fs::path write_test_iso(const std::vector<TestFile>& root_files, const TestFile& subdir_file) {
+  std::vector<u8> image(FIRST_DATA_SECTOR * SECTOR_SIZE);
+  put_u32(image, 0x10 * SECTOR_SIZE + 0x8c, PATH_TABLE_SECTOR);
+  // the first path table entry is the root directory.
+  put_u32(image, PATH_TABLE_SECTOR * SECTOR_SIZE + 2, ROOT_SECTOR);
+
+  auto add_file_data = [&](const std::string& data) {
+    u32 sector = image.size() / SECTOR_SIZE;
+    image.resize(image.size() + ((data.size() + SECTOR_SIZE - 1) / SECTOR_SIZE) * SECTOR_SIZE);
+    memcpy(image.data() + sector * SECTOR_SIZE, data.data(), data.size());
+    return sector;
+  };
+
+  size_t offset = ROOT_SECTOR * SECTOR_SIZE;
+  add_record(image, &offset, std::string(1, '\0'), ROOT_SECTOR, SECTOR_SIZE);
+  add_record(image, &offset, std::string(1, '\1'), ROOT_SECTOR, SECTOR_SIZE);
+  for (const auto& file : root_files) {
+    add_record(image, &offset, file.record_name, add_file_data(file.data), file.data.size());
+  }
+  add_record(image, &offset, "SUBDIR", SUBDIR_SECTOR, SECTOR_SIZE);
+
+  offset = SUBDIR_SECTOR * SECTOR_SIZE;
+  add_record(image, &offset, std::string(1, '\0'), SUBDIR_SECTOR, SECTOR_SIZE);
+  add_record(image, &offset, std::string(1, '\1'), ROOT_SECTOR, SECTOR_SIZE);
+  add_record(image, &offset, subdir_file.record_name, add_file_data(subdir_file.data),
+             subdir_file.data.size());
+
+  auto path = fs::temp_directory_path() / "opengoal-test.iso";
+  file_util::write_binary_file(path, image.data(), image.size());
+  return path;
+}
+
+std::string to_string(std::span<const u8> data) {
+  return std::string((const char*)data.data(), data.size());
+}
+}  // namespace
+
+TEST(IsoVfs, FindsFilesInDirectories) {
+  auto path = write_test_iso({{"TWEAKVAL.MUS;1", "tweaks"}, {"EMPTY.TXT;1", ""}},
+                             {"GAME.CGO;1", std::string(5000, 'x')});
+  IsoVfs iso(path);
+  ASSERT_EQ(iso.entries().size(), 3u);
+
+  const auto* tweaks = iso.find("TWEAKVAL.MUS");
+  ASSERT_TRUE(tweaks);
+  EXPECT_EQ(to_string(iso.data(*tweaks)), "tweaks");
+
+  // not case sensitive, either slash, and files can span sectors.
+  const auto* cgo = iso.find("\\subdir\\game.cgo");
+  ASSERT_TRUE(cgo);
+  EXPECT_EQ(cgo->path, "SUBDIR/GAME.CGO");
+  EXPECT_EQ(to_string(iso.data(*cgo)), std::string(5000, 'x'));
+
+  const auto* empty = iso.find("EMPTY.TXT");
+  ASSERT_TRUE(empty);
+  EXPECT_EQ(empty->size, 0u);
+
+  EXPECT_FALSE(iso.find("GAME.CGO"));
+  EXPECT_FALSE(iso.find("SUBDIR"));
+}
+
+TEST(IsoVfs, ReadFromMountedIso) {
+  auto path = write_test_iso({{"TWEAKVAL.MUS;1", "tweaks"}}, {"FILE.BIN;1", "in a subdir"});
+  // mounts are never removed, so use a directory that nothing else reads.
+  auto mount_point = fs::temp_directory_path() / "opengoal-test-iso-mount";
+  fs::remove_all(mount_point);
+  fs::create_directories(mount_point);
+  file_util::mount_iso(mount_point, std::make_shared<const IsoVfs>(path));
+
+  auto tweaks = file_util::find_in_mounted_iso(mount_point / "TWEAKVAL.MUS");
+  ASSERT_TRUE(tweaks);
+  EXPECT_EQ(to_string(*tweaks), "tweaks");
+  EXPECT_EQ(to_string(*file_util::find_in_mounted_iso(mount_point / "subdir" / "file.bin")),
+            "in a subdir");
+  EXPECT_FALSE(file_util::find_in_mounted_iso(mount_point / "MISSING.BIN"));
+  EXPECT_FALSE(file_util::find_in_mounted_iso(mount_point / ".." / "TWEAKVAL.MUS"));
+
+  // read_binary_file falls back to the mount, but files on disk come first.
+  auto read = file_util::read_binary_file(mount_point / "TWEAKVAL.MUS");
+  EXPECT_EQ(std::string(read.begin(), read.end()), "tweaks");
+  file_util::write_text_file(mount_point / "TWEAKVAL.MUS", "on disk");
+  read = file_util::read_binary_file(mount_point / "TWEAKVAL.MUS");
+  EXPECT_EQ(std::string(read.begin(), read.end()), "on disk\n");
+  EXPECT_ANY_THROW(file_util::read_binary_file(mount_point / "MISSING.BIN"));
+}
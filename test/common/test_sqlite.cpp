@@ -0,0 +1,77 @@
+#include <string>
+
+#include "common/sqlite/sqlite.h"
+#include "common/util/FileUtil.h"
+
+#include "fmt/core.h"
+#include "gtest/gtest.h"
+
+namespace {
+fs::path test_db_path() {
+  auto path = fs::temp_directory_path() / "opengoal-test-sqlite.db";
+  fs::remove(path);
+  return path;
+}
+}  // namespace
+
+TEST(SQLite, CachedStatementRunsAgain) {
+  sqlite::SQLiteDatabase db;
+  ASSERT_TRUE(db.open_db(":memory:"));
+  EXPECT_EQ(db.run_statement("CREATE TABLE t (v INTEGER);").status,
+            sqlite::QueryResult::Status::MODIFY);
+
+  // the same text is prepared once, then reset and run again from the cache.
+  const std::string insert = "INSERT INTO t (v) VALUES ((SELECT COUNT(*) FROM t) + 10);";
+  EXPECT_EQ(db.run_statement(insert).status, sqlite::QueryResult::Status::MODIFY);
+  EXPECT_EQ(db.run_statement(insert).status, sqlite::QueryResult::Status::MODIFY);
+
+  const std::string select = "SELECT v, 'x' || v FROM t ORDER BY v;";
+  auto result = db.run_statement(select);
+  ASSERT_EQ(result.status, sqlite::QueryResult::Status::SELECT);
+  ASSERT_EQ(result.num_columns, 2);
+  ASSERT_EQ(result.num_rows(), 2u);
+  EXPECT_EQ(result.cells.at(0).type, SQLITE_INTEGER);
+  EXPECT_EQ(result.cells.at(0).integer, 10);
+  EXPECT_EQ(result.cells.at(2).integer, 11);
+  EXPECT_STREQ(result.cell_text(1), "x10");
+  EXPECT_STREQ(result.cell_text(3), "x11");
+
+  // the cached select sees rows added after it was prepared.
+  db.run_statement(insert);
+  EXPECT_EQ(db.run_statement(select).num_rows(), 3u);
+}
+
+TEST(SQLite, StatementError) {
+  sqlite::SQLiteDatabase db;
+  ASSERT_TRUE(db.open_db(":memory:"));
+  auto result = db.run_statement("SELECT * FROM missing_table;");
+  EXPECT_EQ(result.status, sqlite::QueryResult::Status::ERROR);
+  EXPECT_FALSE(result.error.empty());
+}
+
+TEST(SQLite, BatchedWrites) {
+  const auto path = test_db_path();
+  {
+    sqlite::SQLiteDatabase writer;
+    ASSERT_TRUE(writer.open_db(path.string()));
+    writer.run_statement("CREATE TABLE t (v INTEGER);");
+    writer.set_batch_writes(std::chrono::milliseconds(60 * 1000));
+    for (int i = 0; i < 5; i++) {
+      writer.run_statement(fmt::format("INSERT INTO t (v) VALUES ({});", i));
+    }
+    EXPECT_TRUE(writer.has_pending_writes());
+
+    // the writes are in an open transaction, so other connections don't see them yet.
+    sqlite::SQLiteDatabase reader;
+    ASSERT_TRUE(reader.open_db(path.string()));
+    EXPECT_EQ(reader.run_statement("SELECT COUNT(*) FROM t;").cells.at(0).integer, 0);
+
+    writer.commit_writes();
+    EXPECT_FALSE(writer.has_pending_writes());
+    auto result = reader.run_statement("SELECT SUM(v), COUNT(*) FROM t;");
+    ASSERT_EQ(result.num_rows(), 1u);
+    EXPECT_EQ(result.cells.at(0).integer, 0 + 1 + 2 + 3 + 4);
+    EXPECT_EQ(result.cells.at(1).integer, 5);
+  }
+  fs::remove(path);
+}
@@ -0,0 +1,88 @@
+#include "decompiler/ObjectFile/IR2Cache.h"
+#include "decompiler/ObjectFile/ObjectFileDB.h"
+#include "decompiler/config.h"
+#include "gtest/gtest.h"
+
+using namespace decompiler;
+
+namespace {
+class IR2CacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cache_dir = fs::temp_directory_path() / "opengoal-ir2-cache-test";
+    fs::remove_all(cache_dir);
+    obj.record.name = "test-obj";
+    obj.data = {1, 2, 3, 4};
+    dts.add_symbol("test-global", "int", {});
+  }
+
+  void TearDown() override { fs::remove_all(cache_dir); }
+
+  fs::path cache_dir;
+  Config config;
+  DecompilerTypeSystem dts{GameVersion::Jak1};
+  ObjectFileData obj{GameVersion::Jak1};
+  IR2Cache::Result result{"; test-obj ir2\n(set! test-global 1)",
+                          "(defun foo ()\n  (the-as test-type test-global))"};
+};
+}  // namespace
+
+TEST_F(IR2CacheTest, StoreAndReuse) {
+  {
+    IR2Cache cache(cache_dir, config, dts);
+    auto key = cache.compute_key(obj, config, {});
+    EXPECT_FALSE(cache.lookup(obj, key));
+    cache.store(obj, key, result);
+  }
+
+  IR2Cache cache(cache_dir, config, dts);
+  auto key = cache.compute_key(obj, config, {});
+  auto cached = cache.lookup(obj, key);
+  ASSERT_TRUE(cached);
+  EXPECT_EQ(cached->ir2_asm, result.ir2_asm);
+  EXPECT_EQ(cached->disasm, result.disasm);
+  EXPECT_EQ(cache.hit_count(), 1);
+}
+
+TEST_F(IR2CacheTest, KeyChanges) {
+  IR2Cache cache(cache_dir, config, dts);
+  auto key = cache.compute_key(obj, config, {});
+  EXPECT_EQ(key, cache.compute_key(obj, config, {}));
+  EXPECT_NE(key, cache.compute_key(obj, config, {"goal_src/jak1/import/foo-ag.gc"}));
+
+  auto config_with_labels = config;
+  config_with_labels.label_types["test-obj"]["L12"] = {false, "vector", {}};
+  EXPECT_NE(key, cache.compute_key(obj, config_with_labels, {}));
+
+  obj.data.push_back(5);
+  EXPECT_NE(key, cache.compute_key(obj, config, {}));
+}
+
+TEST_F(IR2CacheTest, SymbolTypeChange) {
+  {
+    IR2Cache cache(cache_dir, config, dts);
+    cache.store(obj, cache.compute_key(obj, config, {}), result);
+  }
+
+  // changing a symbol that isn't used doesn't matter
+  dts.add_symbol("unused-global", "float", {});
+  {
+    IR2Cache cache(cache_dir, config, dts);
+    EXPECT_TRUE(cache.lookup(obj, cache.compute_key(obj, config, {})));
+  }
+
+  dts.symbol_types["test-global"] = TypeSpec("float");
+  IR2Cache cache(cache_dir, config, dts);
+  EXPECT_FALSE(cache.lookup(obj, cache.compute_key(obj, config, {})));
+}
+
+TEST_F(IR2CacheTest, NewType) {
+  {
+    IR2Cache cache(cache_dir, config, dts);
+    cache.store(obj, cache.compute_key(obj, config, {}), result);
+  }
+
+  dts.ts.forward_declare_type_as("test-type", "basic");
+  IR2Cache cache(cache_dir, config, dts);
+  EXPECT_FALSE(cache.lookup(obj, cache.compute_key(obj, config, {})));
+}
@@ -0,0 +1,98 @@
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/FileUtil.h"
+
+#include "game/overlord/jak3/dvd_reader.h"
+#include "game/overlord/jak3/isocommon.h"
+
+#include "fmt/core.h"
+#include "gtest/gtest.h"
+
+namespace {
+constexpr int kSector = 0x800;
+constexpr int kSectorsPerFile = 64;
+
+void wait_for(const std::atomic<bool>& done) {
+  while (!done) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+struct TestFiles {
+  fs::path dir = fs::temp_directory_path() / "opengoal-test-dvd-reader";
+  std::vector<jak3::ISOFileDef> defs;
+
+  explicit TestFiles(int count) {
+    file_util::create_dir_if_needed(dir);
+    defs.resize(count);
+    for (int i = 0; i < count; i++) {
+      // each sector is filled with its file and sector index, so reads can be checked.
+      std::vector<u8> data(kSector * kSectorsPerFile);
+      for (size_t j = 0; j < data.size(); j++) {
+        data[j] = (j / kSector) + i * kSectorsPerFile;
+      }
+      defs[i].full_path = (dir / fmt::format("file-{}.bin", i)).string();
+      file_util::write_binary_file(fs::path(defs[i].full_path), data.data(), data.size());
+    }
+  }
+  ~TestFiles() { fs::remove_all(dir); }
+};
+
+jak3::BlockParams block(const jak3::ISOFileDef* def, int sector, void* dest) {
+  jak3::BlockParams params = {};
+  params.destination = dest;
+  params.num_sectors = 1;
+  params.sector_num = sector;
+  params.file_def = def;
+  return params;
+}
+}  // namespace
+
+TEST(DvdReader, FilesUseDifferentWorkers) {
+  TestFiles files(8);
+  jak3::DvdReader reader(4);
+  std::set<int> workers;
+  for (auto& def : files.defs) {
+    workers.insert(reader.worker_for(&def));
+    EXPECT_EQ(reader.worker_for(&def), reader.worker_for(&def));
+  }
+  EXPECT_GT(workers.size(), 1u);
+}
+
+TEST(DvdReader, ReadsInOrderWithReadAhead) {
+  TestFiles files(2);
+  jak3::DvdReader reader(4);
+  std::vector<std::vector<u8>> dest(kSectorsPerFile, std::vector<u8>(kSector));
+  std::vector<std::atomic<bool>> done(kSectorsPerFile);
+  const auto* def = &files.defs[1];
+  for (int i = 0; i < kSectorsPerFile; i++) {
+    reader.submit(block(def, i, dest[i].data()), &done[i]);
+  }
+
+  // reads of a file are done one at a time in order, so each is done before the next one.
+  for (int i = 0; i < kSectorsPerFile; i++) {
+    wait_for(done[i]);
+    for (int j = 0; j < i; j++) {
+      EXPECT_TRUE(done[j]);
+    }
+    EXPECT_EQ(dest[i].front(), kSectorsPerFile + i);
+    EXPECT_EQ(dest[i].back(), kSectorsPerFile + i);
+  }
+  // after the first few sequential reads, the rest come from the read-ahead.
+  EXPECT_GE(reader.read_ahead_hits(), (u64)kSectorsPerFile - 4);
+}
+
+TEST(DvdReader, ReadPastEnd) {
+  TestFiles files(1);
+  jak3::DvdReader reader(1);
+  std::vector<u8> dest(kSector, 0xaa);
+  std::atomic<bool> done;
+  reader.submit(block(&files.defs[0], kSectorsPerFile, dest.data()), &done);
+  wait_for(done);
+  EXPECT_EQ(dest[0], 0xaa);
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game/system/IOP_Kernel.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono;
+
+namespace {
+IOP_Kernel* g_kernel = nullptr;
+std::vector<std::string> g_log;
+s32 g_sema = -1;
+steady_clock::time_point g_delay_start, g_resumed;
+
+void sleep_forever() {
+  while (true) {
+    g_kernel->SleepThread();
+  }
+}
+
+// log each time the thread is woken.
+void log_a() {
+  while (true) {
+    g_log.push_back("a");
+    g_kernel->SleepThread();
+  }
+}
+
+void log_b() {
+  while (true) {
+    g_log.push_back("b");
+    g_kernel->SleepThread();
+  }
+}
+
+void log_c() {
+  while (true) {
+    g_log.push_back("c");
+    g_kernel->SleepThread();
+  }
+}
+
+void delay_once() {
+  g_delay_start = steady_clock::now();
+  g_kernel->DelayThread(5000);
+  g_resumed = steady_clock::now();
+  g_log.push_back("resumed");
+  sleep_forever();
+}
+
+void delay_short_then_long() {
+  g_log.push_back("start");
+  g_kernel->DelayThread(2000);
+  g_log.push_back("delay 1");
+  g_kernel->DelayThread(10 * 1000 * 1000);
+  g_log.push_back("delay 2");
+  sleep_forever();
+}
+
+void delay_then_wait_sema() {
+  g_log.push_back("start");
+  g_kernel->DelayThread(2000);
+  g_log.push_back("delay");
+  g_kernel->WaitSema(g_sema);
+  g_log.push_back("sema");
+  sleep_forever();
+}
+
+// dispatch until the time, like the IOP runtime loop does.
+void dispatch_until(steady_clock::time_point end) {
+  while (steady_clock::now() < end) {
+    g_kernel->dispatch();
+    std::this_thread::sleep_for(microseconds(100));
+  }
+}
+
+class IopKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    kernel = std::make_unique<IOP_Kernel>();
+    g_kernel = kernel.get();
+    g_log.clear();
+  }
+  void TearDown() override { g_kernel = nullptr; }
+  std::unique_ptr<IOP_Kernel> kernel;
+};
+}  // namespace
+
+TEST_F(IopKernelTest, PriorityTiesGoToLowerThreadId) {
+  s32 a = kernel->CreateThread("a", log_a, 10);
+  s32 b = kernel->CreateThread("b", log_b, 10);
+  s32 c = kernel->CreateThread("c", log_c, 5);
+  // started in a different order than they were created.
+  kernel->StartThread(b);
+  kernel->StartThread(a);
+  kernel->StartThread(c);
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"c", "a", "b"}));
+
+  // waking them again uses the same order, and each runs once.
+  g_log.clear();
+  kernel->WakeupThread(b);
+  kernel->WakeupThread(a);
+  kernel->WakeupThread(b);
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"a", "b"}));
+}
+
+TEST_F(IopKernelTest, DelayWakesAtResumeTime) {
+  s32 t = kernel->CreateThread("delay", delay_once, 10);
+  kernel->StartThread(t);
+  kernel->dispatch();
+  // the resume time is set just after this.
+  const auto resume_time = g_delay_start + microseconds(5000);
+
+  dispatch_until(resume_time - milliseconds(1));
+  EXPECT_TRUE(g_log.empty());
+
+  std::this_thread::sleep_until(resume_time + milliseconds(10));
+  const auto dispatch_time = steady_clock::now();
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"resumed"}));
+  EXPECT_GE(g_resumed, resume_time);
+  // it was ready at the resume time, not when the kernel noticed.
+  const u64 late_ns = duration_cast<nanoseconds>(dispatch_time - resume_time).count();
+  EXPECT_GE(kernel->thread_stats(t).max_latency_ns, late_ns - 1000 * 1000);
+}
+
+TEST_F(IopKernelTest, StaleDelayIsSkipped) {
+  s32 t = kernel->CreateThread("delay", delay_short_then_long, 10);
+  kernel->StartThread(t);
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"start"}));
+
+  // wake it before the first delay expires, so it delays again.
+  kernel->WakeupThread(t);
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"start", "delay 1"}));
+
+  // when the first delay expires, its entry is skipped instead of ending the second delay.
+  dispatch_until(steady_clock::now() + milliseconds(20));
+  EXPECT_EQ(g_log, std::vector<std::string>({"start", "delay 1"}));
+  EXPECT_EQ(kernel->thread_stats(t).runs, 2u);
+}
+
+TEST_F(IopKernelTest, StaleDelayAfterWaitingOnSomethingElse) {
+  g_sema = kernel->CreateSema(0, 0, 0, 1);
+  s32 t = kernel->CreateThread("delay", delay_then_wait_sema, 10);
+  kernel->StartThread(t);
+  kernel->dispatch();
+
+  // woken early, it waits on the semaphore, and the expired delay doesn't wake it.
+  kernel->WakeupThread(t);
+  kernel->dispatch();
+  dispatch_until(steady_clock::now() + milliseconds(20));
+  EXPECT_EQ(g_log, std::vector<std::string>({"start", "delay"}));
+
+  kernel->SignalSema(g_sema);
+  kernel->dispatch();
+  EXPECT_EQ(g_log, std::vector<std::string>({"start", "delay", "sema"}));
+}
+
+TEST_F(IopKernelTest, ThreadStats) {
+  s32 t = kernel->CreateThread("delay", delay_once, 10);
+  kernel->StartThread(t);
+  kernel->dispatch();
+  dispatch_until(g_delay_start + milliseconds(20));
+  ASSERT_EQ(g_log, std::vector<std::string>({"resumed"}));
+
+  const auto& stats = kernel->thread_stats(t);
+  EXPECT_EQ(stats.runs, 2u);
+  EXPECT_GT(stats.run_ns, 0u);
+  EXPECT_GE(stats.run_ns, stats.max_run_ns);
+  // latency is measured from when the delay expired.
+  EXPECT_GT(stats.latency_ns, 0u);
+  EXPECT_LT(stats.max_latency_ns, 15u * 1000 * 1000);
+  EXPECT_EQ(stats.wakeups, 1u);
+  const auto& delay = stats.waits.at((int)IopThread::Wait::Delay);
+  EXPECT_EQ(delay.count, 1u);
+  EXPECT_GE(delay.total_ns, 4u * 1000 * 1000);
+}
@@ -294,4 +294,8 @@ TEST_F(ArithmeticTests, DivideSigns) {
 
 TEST_F(ArithmeticTests, ModUnsigned) {
   runner->run_static_test(env, testCategory, "mod-unsigned.static.gc", {"ffffffffffffffff 5\n0\n"});
-}
\ No newline at end of file
+}
+
+TEST_F(ArithmeticTests, OptimizeIR) {
+  runner->run_static_test(env, testCategory, "optimize-ir.static.gc", {"177\n"});
+}
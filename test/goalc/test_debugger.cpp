@@ -1,6 +1,7 @@
 #include "common/log/log.h"
 
 #include "goalc/compiler/Compiler.h"
+#include "goalc/debugger/SampleProfile.h"
 #include "gtest/gtest.h"
 #include "test/goalc/framework/test_runner.h"
 
@@ -224,3 +225,22 @@ TEST(Jak1Debugger, SimpleBreakpoint) {
 }
 
 #endif
+
+TEST(Debugger, SampleProfileCollapsedStacks) {
+  SampleProfile profile;
+  profile.add_sample({"vector-length", "update-actor", "main-loop"});
+  profile.add_sample({"vector-length", "update-actor", "main-loop"});
+  profile.add_sample({"draw", "main-loop"});
+  profile.add_sample({"fib", "fib", "fib"});
+  profile.add_sample({});
+
+  EXPECT_EQ(profile.num_samples, 5);
+  EXPECT_EQ(profile.to_collapsed_stacks(),
+            "[unknown] 1\n"
+            "fib;fib;fib 1\n"
+            "main-loop;draw 1\n"
+            "main-loop;update-actor;vector-length 2\n");
+  EXPECT_EQ(profile.self_samples.at("vector-length"), 2);
+  EXPECT_EQ(profile.total_samples.at("main-loop"), 3);
+  EXPECT_EQ(profile.total_samples.at("fib"), 1);
+}
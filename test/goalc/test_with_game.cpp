@@ -888,3 +888,20 @@ TEST_F(WithGameTests, Mips2C_CallGoal) {
   shared_compiler->runner.run_static_test(testCategory, "test-mips2c-goal.gc",
                                           {"1 2 3 4 5 6 7 8\n12\n"});
 }
+
+TEST_F(WithGameTests, FunctionTraceProbe) {
+  // both calls record an enter and an exit event, including the early return.
+  shared_compiler->runner.run_static_test(
+      testCategory, "test-function-trace.gc",
+      {"42 0 4\n0 1 0 1\ntest-function-trace-probe #t\n#t\n#t\n0\n"});
+  // the dump after stopping has the four recorded events, and not the call after the stop.
+  const fs::path dump_path = "test-function-trace.json";
+  const std::string dump = file_util::read_text_file(dump_path);
+  fs::remove(dump_path);
+  size_t event_count = 0;
+  for (size_t pos = dump.find("\"name\""); pos != std::string::npos;
+       pos = dump.find("\"name\"", pos + 1)) {
+    event_count++;
+  }
+  EXPECT_EQ(event_count, 4u);
+}
@@ -1,4 +1,6 @@
+#include <atomic>
 #include <limits>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -7,6 +9,7 @@
 #include "common/util/BitUtils.h"
 #include "common/util/CopyOnWrite.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
 #include "common/util/Range.h"
 #include "common/util/SmallVector.h"
 #include "common/util/Trie.h"
@@ -423,5 +426,48 @@ TEST(CRC32, Reference) {
   }
 }
 
+TEST(JobSystem, ParallelFor) {
+  JobSystem jobs(4);
+  std::vector<std::atomic<int>> counts(1000);
+  jobs.parallel_for("test", counts.size(), [&](size_t i) { counts[i]++; });
+  for (auto& count : counts) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+TEST(JobSystem, NestedGroups) {
+  JobSystem jobs(2);
+  std::atomic<int> total = 0;
+  TaskGroup outer(nullptr, &jobs);
+  for (int i = 0; i < 8; i++) {
+    outer.run([&]() {
+      // waiting from a worker runs other tasks instead of blocking it.
+      TaskGroup inner(nullptr, &jobs);
+      for (int j = 0; j < 8; j++) {
+        inner.run([&]() { total++; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(total, 64);
+}
+
+TEST(JobSystem, Exception) {
+  JobSystem jobs(2);
+  std::atomic<int> finished = 0;
+  TaskGroup group(nullptr, &jobs);
+  for (int i = 0; i < 10; i++) {
+    group.run([&, i]() {
+      if (i == 3) {
+        throw std::runtime_error("task failed");
+      }
+      finished++;
+    });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_EQ(finished, 9);
+}
+
 }  // namespace test
 }  // namespace cu
@@ -0,0 +1,274 @@
+/*!
+ * @file test_peephole.cpp
+ * Tests for the x86-64 peephole optimizer. Each sequence is run with the CodeTester before and
+ * after optimization to check that the rewrite didn't change the result.
+ */
+
+#include "goalc/emitter/CodeTester.h"
+#include "goalc/emitter/IGen.h"
+#include "goalc/emitter/Peephole.h"
+#include "gtest/gtest.h"
+
+using namespace emitter;
+
+namespace {
+
+// the flags that are defined after cmp and test: CF, PF, ZF, SF, OF
+constexpr u64 kFlagMask = 0x8c5;
+
+PeepholeStats optimize(std::vector<Instruction>* instrs, PeepholeInput input = {}) {
+  input.pinned.resize(instrs->size(), false);
+  input.jump_target.resize(instrs->size() + 1, false);
+  PeepholeStats stats;
+  run_peephole(instrs, input, &stats);
+  return stats;
+}
+
+/*!
+ * Run instrs as a function taking 4 arguments. Returns rax, or the flags if return_flags is set.
+ */
+u64 run(CodeTester* tester,
+        const std::vector<Instruction>& instrs,
+        u64 a0,
+        u64 a1 = 0,
+        bool return_flags = false) {
+  tester->clear();
+  tester->emit_push_all_gprs(true);
+  for (const auto& instr : instrs) {
+    tester->emit(instr);
+  }
+  if (return_flags) {
+    tester->emit_data<u8>(0x9c);  // pushfq
+    tester->emit_data<u8>(0x58);  // pop rax
+  }
+  tester->emit_pop_all_gprs(true);
+  tester->emit_return();
+  return tester->execute(a0, a1, 0, 0);
+}
+
+std::string hex(CodeTester* tester, const Instruction& instr) {
+  tester->clear();
+  tester->emit(instr);
+  return tester->dump_to_hex_string();
+}
+
+int hits(const PeepholeStats& stats, PeepholeRule rule) {
+  return stats.hits[(int)rule];
+}
+
+// setz al
+Instruction setz_al() {
+  Instruction instr(0x0f);
+  instr.set_op2(0x94);
+  instr.set_modrm_and_rex(0, RAX, 3, false);
+  return instr;
+}
+
+}  // namespace
+
+TEST(Peephole, MovSelfAndAddZero) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  std::vector<Instruction> code = {
+      IGen::mov_gpr64_gpr64(RAX, tester.get_c_abi_arg_reg(0)),
+      IGen::mov_gpr64_gpr64(RAX, RAX),
+      IGen::add_gpr64_imm8s(RAX, 0),
+      IGen::sub_gpr64_imm32s(RAX, 0),
+      IGen::add_gpr64_imm8s(RAX, 3),
+  };
+  auto optimized = code;
+  auto stats = optimize(&optimized);
+  EXPECT_EQ(hits(stats, PeepholeRule::MOV_SELF), 1);
+  EXPECT_EQ(hits(stats, PeepholeRule::ADD_SUB_ZERO), 2);
+  EXPECT_EQ(stats.total_hits(), 3);
+  EXPECT_EQ(stats.bytes_saved, 3 + 4 + 7);
+
+  for (u64 x : {0ull, 12ull, 0xffffffffffffffffull}) {
+    EXPECT_EQ(run(&tester, code, x), x + 3);
+    EXPECT_EQ(run(&tester, optimized, x), x + 3);
+  }
+}
+
+TEST(Peephole, AddZeroKeptBeforeFlagUse) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  std::vector<Instruction> code = {
+      IGen::mov_gpr64_gpr64(RAX, tester.get_c_abi_arg_reg(0)),
+      IGen::add_gpr64_imm8s(RAX, 0),
+      IGen::je_32(),  // jumps to the next instruction
+  };
+  auto stats = optimize(&code);
+  EXPECT_EQ(stats.total_hits(), 0);
+  EXPECT_EQ(run(&tester, code, 7), 7);
+
+  // the flags are read after another instruction.
+  std::vector<Instruction> later = {
+      IGen::mov_gpr64_gpr64(RBX, tester.get_c_abi_arg_reg(0)),
+      IGen::xor_gpr64_gpr64(RAX, RAX),  // sets ZF
+      IGen::sub_gpr64_imm8s(RBX, 0),    // sets ZF if rbx is 0
+      IGen::mov_gpr64_gpr64(RCX, RBX),
+      setz_al(),
+  };
+  EXPECT_EQ(optimize(&later).total_hits(), 0);
+  EXPECT_EQ(run(&tester, later, 0), 1);
+  EXPECT_EQ(run(&tester, later, 5), 0);
+
+  // flags are assumed to be read after a jump, at a jump target and at the end.
+  std::vector<Instruction> jump = {
+      IGen::sub_gpr64_imm8s(RBX, 0),
+      IGen::mov_gpr64_gpr64(RCX, RBX),
+      IGen::jmp_32(),
+  };
+  EXPECT_EQ(optimize(&jump).total_hits(), 0);
+
+  std::vector<Instruction> target = {
+      IGen::sub_gpr64_imm8s(RBX, 0),
+      IGen::mov_gpr64_gpr64(RCX, RBX),
+      IGen::add_gpr64_imm8s(RBX, 1),
+  };
+  PeepholeInput input;
+  input.jump_target = {false, true, false, false};
+  EXPECT_EQ(optimize(&target, input).total_hits(), 0);
+
+  std::vector<Instruction> end = {
+      IGen::sub_gpr64_imm8s(RBX, 0),
+      IGen::mov_gpr64_gpr64(RCX, RBX),
+  };
+  EXPECT_EQ(optimize(&end).total_hits(), 0);
+
+  // but not when they are overwritten first.
+  std::vector<Instruction> overwritten = {
+      IGen::sub_gpr64_imm8s(RBX, 0),
+      IGen::mov_gpr64_gpr64(RCX, RBX),
+      IGen::add_gpr64_imm8s(RBX, 1),
+      setz_al(),
+  };
+  EXPECT_EQ(hits(optimize(&overwritten), PeepholeRule::ADD_SUB_ZERO), 1);
+}
+
+TEST(Peephole, MovBack) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  std::vector<Instruction> code = {
+      IGen::mov_gpr64_gpr64(RBX, tester.get_c_abi_arg_reg(0)),
+      IGen::mov_gpr64_gpr64(RAX, RBX),
+      IGen::mov_gpr64_gpr64(RBX, RAX),  // rbx already has this value
+      IGen::mov_gpr64_gpr64(RAX, RBX),  // and so does rax
+      IGen::add_gpr64_gpr64(RAX, RBX),
+  };
+  auto optimized = code;
+  auto stats = optimize(&optimized);
+  EXPECT_EQ(hits(stats, PeepholeRule::MOV_BACK), 2);
+  EXPECT_EQ(stats.total_hits(), 2);
+
+  for (u64 x : {0ull, 3ull, 0x123456789ull}) {
+    EXPECT_EQ(run(&tester, code, x), 2 * x);
+    EXPECT_EQ(run(&tester, optimized, x), 2 * x);
+  }
+}
+
+TEST(Peephole, CmpZeroToTest) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  for (int reg = 0; reg < 16; reg++) {
+    if (reg == RSP || reg == R11) {
+      continue;
+    }
+    std::vector<Instruction> code = {
+        IGen::mov_gpr64_gpr64(reg, tester.get_c_abi_arg_reg(0)),
+        IGen::xor_gpr64_gpr64(R11, R11),
+        IGen::cmp_gpr64_gpr64(reg, R11),
+    };
+    auto optimized = code;
+    auto stats = optimize(&optimized);
+    EXPECT_EQ(hits(stats, PeepholeRule::CMP_ZERO_TO_TEST), 1);
+    EXPECT_EQ(hex(&tester, optimized.at(2)), hex(&tester, IGen::test_gpr64_gpr64(reg, reg)));
+
+    for (u64 x : {0ull, 1ull, 0xffffffffffffffffull, 0x8000000000000000ull, 0x7fffffffffffffffull,
+                  0x100000000ull}) {
+      EXPECT_EQ(run(&tester, code, x, 0, true) & kFlagMask,
+                run(&tester, optimized, x, 0, true) & kFlagMask);
+    }
+  }
+
+  // comparing zero against a register is not the same.
+  std::vector<Instruction> reversed = {
+      IGen::xor_gpr64_gpr64(R11, R11),
+      IGen::cmp_gpr64_gpr64(R11, RAX),
+  };
+  EXPECT_EQ(optimize(&reversed).total_hits(), 0);
+}
+
+TEST(Peephole, TestEncoding) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  EXPECT_EQ(hex(&tester, IGen::test_gpr64_gpr64(RAX, RAX)), "48 85 c0");
+  EXPECT_EQ(hex(&tester, IGen::test_gpr64_gpr64(R12, R12)), "4d 85 e4");
+  EXPECT_EQ(hex(&tester, IGen::test_gpr64_gpr64(RCX, R9)), "4c 85 c9");
+}
+
+TEST(Peephole, StoreReload) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  std::vector<Instruction> code = {
+      IGen::sub_gpr64_imm8s(RSP, 16),
+      IGen::mov_gpr64_gpr64(RBX, tester.get_c_abi_arg_reg(0)),
+      IGen::store64_gpr64_plus_s32(RSP, 8, RBX),
+      IGen::load64_gpr64_plus_s32(RAX, 8, RSP),  // becomes mov rax, rbx
+      IGen::store64_gpr64_plus_s32(RSP, 8, RAX),
+      IGen::load64_gpr64_plus_s32(RAX, 8, RSP),  // removed
+      IGen::add_gpr64_gpr64(RAX, RBX),
+      IGen::add_gpr64_imm8s(RSP, 16),
+  };
+  auto optimized = code;
+  auto stats = optimize(&optimized);
+  EXPECT_EQ(hits(stats, PeepholeRule::STORE_RELOAD), 2);
+  EXPECT_EQ(stats.total_hits(), 2);
+  EXPECT_EQ(hex(&tester, optimized.at(3)), hex(&tester, IGen::mov_gpr64_gpr64(RAX, RBX)));
+
+  for (u64 x : {0ull, 5ull, 0xfedcba9876543210ull}) {
+    EXPECT_EQ(run(&tester, code, x), 2 * x);
+    EXPECT_EQ(run(&tester, optimized, x), 2 * x);
+  }
+
+  // different offset, or reached by a jump, or linked: no change.
+  std::vector<Instruction> other_slot = {
+      IGen::store64_gpr64_plus_s32(RSP, 8, RBX),
+      IGen::load64_gpr64_plus_s32(RAX, 16, RSP),
+  };
+  EXPECT_EQ(optimize(&other_slot).total_hits(), 0);
+
+  std::vector<Instruction> jumped_to = {
+      IGen::store64_gpr64_plus_s32(RSP, 8, RBX),
+      IGen::load64_gpr64_plus_s32(RAX, 8, RSP),
+  };
+  PeepholeInput input;
+  input.jump_target = {false, true, false};
+  EXPECT_EQ(optimize(&jumped_to, input).total_hits(), 0);
+
+  std::vector<Instruction> linked = jumped_to;
+  input.jump_target = {};
+  input.pinned = {true, false};
+  EXPECT_EQ(optimize(&linked, input).total_hits(), 0);
+}
+
+TEST(Peephole, RedundantSignExtend) {
+  CodeTester tester;
+  tester.init_code_buffer(256);
+  std::vector<Instruction> code = {
+      IGen::mov_gpr64_gpr64(RAX, tester.get_c_abi_arg_reg(0)),
+      IGen::imul_gpr32_gpr32(RAX, tester.get_c_abi_arg_reg(1)),
+      IGen::movsx_r64_r32(RAX, RAX),
+      IGen::movsx_r64_r32(RAX, RAX),
+  };
+  auto optimized = code;
+  auto stats = optimize(&optimized);
+  EXPECT_EQ(hits(stats, PeepholeRule::REDUNDANT_SIGN_EXT), 1);
+  EXPECT_EQ(stats.total_hits(), 1);
+
+  for (s64 x : {0ll, 3ll, -7ll, 0x12345ll, 0x7fffffffll}) {
+    u64 expected = (s64)(s32)((u32)x * 3u);
+    EXPECT_EQ(run(&tester, code, x, 3), expected);
+    EXPECT_EQ(run(&tester, optimized, x, 3), expected);
+  }
+}
@@ -1,10 +1,19 @@
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "common/common_types.h"
+#include "common/link_types.h"
+#include "common/util/BitUtils.h"
+#include "common/util/DgoWriter.h"
+#include "common/util/FileUtil.h"
 #include "common/util/compress.h"
 
+#include "game/overlord/common/fast_dgo.h"
+
+#include "fmt/core.h"
 #include "gtest/gtest.h"
 #include "test/all_jak1_symbols.h"
 
@@ -56,4 +65,44 @@ TEST(ZSTD, CommonLibrary) {
   }
 
   EXPECT_TRUE(compressed.size() < 0.5 * all.size());
-}
\ No newline at end of file
+}
+
+TEST(ZSTD, CompressedDgo) {
+  // build the same DGO with and without compressed objects, from object files in out/.
+  const std::string prefix = "test-zstd-dgo";
+  const auto out_dir = file_util::get_jak_project_dir() / "out" / prefix;
+  std::vector<std::vector<u8>> objects = {std::vector<u8>(1000, 7), std::vector<u8>(37, 3), {}};
+  file_util::create_dir_if_needed(out_dir / "obj");
+  DgoDescription desc;
+  desc.dgo_name = "TEST.CGO";
+  for (size_t i = 0; i < objects.size(); i++) {
+    const auto name = fmt::format("test-obj-{}", i);
+    file_util::write_binary_file(out_dir / "obj" / (name + ".go"), objects[i].data(),
+                                 objects[i].size());
+    desc.entries.push_back({name + ".go", name});
+  }
+  build_dgo(desc, prefix, false);
+  const auto plain = file_util::read_binary_file(out_dir / "iso" / desc.dgo_name);
+  build_dgo(desc, prefix, true);
+  const auto compressed = file_util::read_binary_file(out_dir / "iso" / desc.dgo_name);
+  fs::remove_all(out_dir);
+
+  EXPECT_TRUE(file_util::dgo_is_zstd_compressed(compressed));
+  EXPECT_FALSE(file_util::dgo_is_zstd_compressed(plain));
+  EXPECT_EQ(file_util::decompress_zstd_dgo(compressed), plain);
+
+  // load each object the way the runtime's fast DGO loader does.
+  size_t plain_offset = sizeof(DgoHeader);
+  size_t compressed_offset = sizeof(DgoHeader);
+  for (auto& obj : objects) {
+    const size_t len = sizeof(ObjectHeader) + align16(obj.size());
+    std::vector<u8> loaded(len, 0xff);
+    fast_dgo_decompress_object(compressed.data() + compressed_offset, loaded.data());
+    ASSERT_LE(plain_offset + len, plain.size());
+    EXPECT_TRUE(std::equal(loaded.begin(), loaded.end(), plain.begin() + plain_offset));
+    plain_offset += len;
+    compressed_offset += fast_dgo_zstd_object_size(compressed.data() + compressed_offset);
+  }
+  EXPECT_EQ(plain_offset, plain.size());
+  EXPECT_EQ(compressed_offset, compressed.size());
+}
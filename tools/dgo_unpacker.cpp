@@ -30,6 +30,12 @@ int run(int argc, char** argv) {
       data = file_util::decompress_dgo(data);
       printf(" Decompressed from %d to %d bytes (%.2f%% compression)\n", int(original_size),
              int(data.size()), 100.f * original_size / data.size());
+    } else if (file_util::dgo_is_zstd_compressed(data)) {
+      printf(" Detected zstd compressed dgo, decompressing...\n");
+      auto original_size = data.size();
+      data = file_util::decompress_zstd_dgo(data);
+      printf(" Decompressed from %d to %d bytes (%.2f%% compression)\n", int(original_size),
+             int(data.size()), 100.f * original_size / data.size());
     }
     // read as a DGO
     auto dgo = DgoReader(base, data);
@@ -4,15 +4,21 @@
 // - parent-types
 // - ...
 
+#include <mutex>
 #include <queue>
+#include <regex>
+#include <thread>
 
 #include "common/formatter/formatter.h"
 #include "common/log/log.h"
 #include "common/util/FileUtil.h"
+#include "common/util/JobSystem.h"
+#include "common/util/Timer.h"
 #include "common/util/json_util.h"
 #include "common/util/string_util.h"
 #include "common/util/term_util.h"
 #include "common/util/unicode_util.h"
+#include "common/versions/versions.h"
 
 #include "decompiler/util/DecompilerTypeSystem.h"
 #include "tree_sitter/api.h"
@@ -20,6 +26,103 @@
 #include "fmt/core.h"
 #include "third-party/CLI11.hpp"
 #include "third-party/json.hpp"
+#include "third-party/zstd/lib/common/xxhash.h"
+
+namespace {
+
+enum class FileResult { FORMATTED, UNCHANGED, CACHED, FAILED };
+
+/*!
+ * Convert a simple file name glob (only * and ?) into a regex.
+ */
+std::regex glob_to_regex(const std::string& glob) {
+  std::string pattern;
+  for (char c : glob) {
+    switch (c) {
+      case '*':
+        pattern += ".*";
+        break;
+      case '?':
+        pattern += ".";
+        break;
+      case '.':
+      case '+':
+      case '(':
+      case ')':
+      case '[':
+      case ']':
+      case '{':
+      case '}':
+      case '^':
+      case '$':
+      case '|':
+      case '\\':
+        pattern += '\\';
+        pattern += c;
+        break;
+      default:
+        pattern += c;
+    }
+  }
+  return std::regex(pattern);
+}
+
+std::string hash_text(const std::string& text) {
+  return fmt::format("{:016x}", XXH64(text.data(), text.size(), 0));
+}
+
+/*!
+ * The cache maps a file path to the hash of its contents the last time it was known to be
+ * formatted. It's thrown out if the formatter was built from a different revision, since the
+ * output may have changed.
+ */
+class FormatCache {
+ public:
+  void load(const fs::path& path) {
+    m_path = path;
+    if (m_path.empty() || !fs::exists(m_path)) {
+      return;
+    }
+    try {
+      auto data = parse_commented_json(file_util::read_text_file(m_path), m_path.string());
+      if (data.value("version", "") != build_revision()) {
+        lg::info("Format cache is from a different version, ignoring it");
+        return;
+      }
+      m_files = data.at("files").get<std::unordered_map<std::string, std::string>>();
+    } catch (const std::exception& e) {
+      lg::warn("Unable to read format cache {}: {}", m_path.string(), e.what());
+    }
+  }
+
+  bool is_formatted(const std::string& file, const std::string& hash) const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    const auto it = m_files.find(file);
+    return it != m_files.end() && it->second == hash;
+  }
+
+  void set_formatted(const std::string& file, const std::string& hash) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_files[file] = hash;
+  }
+
+  void save() const {
+    if (m_path.empty()) {
+      return;
+    }
+    nlohmann::json data;
+    data["version"] = build_revision();
+    data["files"] = m_files;
+    file_util::write_text_file(m_path, data.dump(2));
+  }
+
+ private:
+  fs::path m_path;
+  std::unordered_map<std::string, std::string> m_files;
+  mutable std::mutex m_lock;
+};
+
+}  // namespace
 
 int main(int argc, char** argv) {
   ArgumentGuard u8_guard(argc, argv);
@@ -28,7 +131,11 @@ int main(int argc, char** argv) {
   bool write_inplace = false;
   bool write_newfile = false;
   std::string file_path = "";
+  std::string dir_path = "";
+  std::string glob = "*.gc";
+  std::string cache_path = "";
   std::string config_path = "";
+  int num_jobs = 0;
 
   lg::initialize();
 
@@ -41,6 +148,13 @@ int main(int argc, char** argv) {
                "Whether to write the formatted results into a new file in the same directory, "
                "useful for testing");
   app.add_option("-f,--file", file_path, "Input file path");
+  app.add_option("-d,--dir", dir_path, "Format every file in this directory, recursively");
+  app.add_option("-g,--glob", glob, "File names to format when using --dir, defaults to *.gc");
+  app.add_option("-j,--jobs", num_jobs,
+                 "Number of files to format at once, defaults to the number of hardware threads");
+  app.add_option("--cache", cache_path,
+                 "Skip files whose contents haven't changed since they were last formatted, "
+                 "tracked in this file");
   app.add_option("--config", config_path, "Config file path");
   app.validate_positionals();
   define_common_cli_arguments(app);
@@ -50,23 +164,105 @@ int main(int argc, char** argv) {
     lg::disable_ansi_colors();
   }
 
-  // TODO - support recursing directories
-  // Read in source code
-  const auto source_code = file_util::read_text_file(file_path);
-  const auto result = formatter::format_code(source_code);
+  std::vector<fs::path> files;
+  if (!dir_path.empty()) {
+    files = file_util::find_files_recursively(dir_path, glob_to_regex(glob));
+    std::sort(files.begin(), files.end());
+  }
+  if (!file_path.empty()) {
+    files.push_back(file_path);
+  }
+  if (files.empty()) {
+    lg::error("No files to format, provide a --file or a --dir");
+    return 1;
+  }
+
+  const int hw_threads = std::max(1u, std::thread::hardware_concurrency());
+  if (num_jobs <= 0) {
+    num_jobs = hw_threads;
+  }
+  num_jobs = std::min(num_jobs, (int)files.size());
+  // a single file can still be split up by top level form.
+  const int threads_per_file = files.size() == 1 ? hw_threads : 1;
+
+  FormatCache cache;
+  cache.load(cache_path);
+
+  Timer timer;
+  std::vector<FileResult> results(files.size(), FileResult::FAILED);
+
+  const auto format_file = [&](size_t idx) {
+    auto path = files.at(idx);
+    const auto path_str = path.string();
+    const auto source_code = file_util::read_text_file(path);
+    const auto source_hash = hash_text(source_code);
+    if (cache.is_formatted(path_str, source_hash)) {
+      return FileResult::CACHED;
+    }
 
-  if (result) {
-    // TODO - i don't like this implementation, return a new string instead
-    if (write_inplace) {
-      file_util::write_text_file(file_path, result.value());
+    const auto result = formatter::format_code(source_code, threads_per_file);
+    if (!result) {
+      lg::error("Could not format file {}", path_str);
+      return FileResult::FAILED;
+    }
+    // write_text_file adds a trailing newline
+    if (result.value() + "\n" == source_code) {
+      cache.set_formatted(path_str, source_hash);
+      return FileResult::UNCHANGED;
+    }
+
+    if (check) {
+      lg::warn("{} is not formatted", path_str);
+    } else if (write_inplace) {
+      file_util::write_text_file(path, result.value());
+      cache.set_formatted(path_str, hash_text(result.value() + "\n"));
     } else if (write_newfile) {
-      if (str_util::replace(file_path, ".gc", ".new.gc")) {
-        file_util::write_text_file(file_path, result.value());
+      auto new_path = path_str;
+      if (str_util::replace(new_path, ".gc", ".new.gc")) {
+        file_util::write_text_file(new_path, result.value());
       }
     }
-    return 0;
-  } else {
-    lg::error("Could not format file");
+    return FileResult::FORMATTED;
+  };
+
+  JobSystem::global().parallel_for(
+      "format-file", files.size(),
+      [&](size_t idx) {
+        try {
+          results.at(idx) = format_file(idx);
+        } catch (const std::exception& e) {
+          lg::error("Could not format file {}: {}", files.at(idx).string(), e.what());
+        }
+      },
+      num_jobs);
+  cache.save();
+
+  int num_formatted = 0, num_unchanged = 0, num_cached = 0, num_failed = 0;
+  for (auto result : results) {
+    switch (result) {
+      case FileResult::FORMATTED:
+        num_formatted++;
+        break;
+      case FileResult::UNCHANGED:
+        num_unchanged++;
+        break;
+      case FileResult::CACHED:
+        num_cached++;
+        break;
+      case FileResult::FAILED:
+        num_failed++;
+        break;
+    }
+  }
+
+  if (files.size() > 1) {
+    lg::info("{} {}, {} already formatted, {} cached, {} failed in {:.2f}s", num_formatted,
+             check ? "need formatting" : "formatted", num_unchanged, num_cached, num_failed,
+             timer.getSeconds());
+  }
+
+  if (num_failed > 0 || (check && num_formatted > 0)) {
     return 1;
   }
+  return 0;
 }
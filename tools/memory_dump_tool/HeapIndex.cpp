@@ -0,0 +1,362 @@
+#include "HeapIndex.h"
+
+#include <algorithm>
+
+#include "common/log/log.h"
+#include "common/type_system/TypeSystem.h"
+#include "common/util/JobSystem.h"
+#include "common/util/Timer.h"
+
+namespace {
+// objects are found by looking for type tags on 16-byte boundaries above this address.
+constexpr u32 kFirstObjectAddr = 1 << 20;
+// limit for the size of dynamic objects, which extend to the start of the next object.
+constexpr u32 kMaxDynamicSize = 1 << 20;
+// the runtime's type structure has the allocated size here, the same in all games.
+constexpr u32 kTypeAllocatedSizeOffset = 8;
+
+/*!
+ * Run func(chunk, start, end) over [0, count), split into num_chunks pieces. Chunk results can be
+ * merged in order afterward to get a deterministic result.
+ */
+template <typename Func>
+void for_each_chunk(size_t count, size_t num_chunks, int num_threads, Func&& func) {
+  JobSystem::global().parallel_for(
+      "heap-index-chunk", num_chunks,
+      [&](size_t chunk) {
+        func(chunk, count * chunk / num_chunks, count * (chunk + 1) / num_chunks);
+      },
+      num_threads);
+}
+}  // namespace
+
+/*!
+ * Get the index of the object containing this address, or -1 if there isn't one.
+ */
+int HeapIndex::find_object(u32 addr) const {
+  auto it = std::upper_bound(objects.begin(), objects.end(), addr,
+                             [](u32 a, const HeapObject& obj) { return a < obj.addr; });
+  if (it == objects.begin()) {
+    return -1;
+  }
+  it--;
+  if (addr < it->addr + it->size) {
+    return it - objects.begin();
+  }
+  return -1;
+}
+
+/*!
+ * The objects of each type, as basic pointers. This is the input for the older per-type reports.
+ */
+std::unordered_map<std::string, std::vector<u32>> HeapIndex::basics_by_type(
+    const std::vector<std::string>& ignored_types) const {
+  std::unordered_map<std::string, std::vector<u32>> result;
+  for (const auto& obj : objects) {
+    const auto& name = type_names.at(obj.type);
+    if (std::find(ignored_types.begin(), ignored_types.end(), name) == ignored_types.end()) {
+      result[name].push_back(obj.addr);
+    }
+  }
+  return result;
+}
+
+/*!
+ * Find every object with a valid type tag and everything they point to.
+ *
+ * Object sizes come from the type in memory. Dynamic types (and types we don't know about) take
+ * up to the next object, which is right for objects packed in a heap, but may include free memory
+ * after the last object in a heap.
+ *
+ * Pointers are found conservatively: any word inside an object that points into another object
+ * counts, so the graph may have a few extra edges from integers that look like addresses.
+ */
+HeapIndex build_heap_index(const Ram& ram,
+                           const std::unordered_map<u32, std::string>& types,
+                           const std::vector<u32>& symbol_values,
+                           const TypeSystem& type_system,
+                           int num_threads) {
+  Timer timer;
+  HeapIndex index;
+
+  // give each type a small id, and figure out which ones have a fixed size.
+  std::unordered_map<u32, u32> type_ids;
+  std::vector<u32> type_sizes;
+  std::vector<bool> type_dynamic;
+  for (const auto& [tag, name] : types) {
+    if (name == "symbol" || name == "object" || name == "integer") {
+      continue;  // not real objects, the tag is just a common value.
+    }
+    type_ids[tag] = index.type_names.size();
+    index.type_names.push_back(name);
+    type_sizes.push_back(ram.read<u16>(tag + kTypeAllocatedSizeOffset));
+    bool dynamic = true;
+    if (type_system.fully_defined_type_exists(name)) {
+      auto as_structure = dynamic_cast<StructureType*>(type_system.lookup_type(name));
+      dynamic = !as_structure || as_structure->is_dynamic();
+    }
+    type_dynamic.push_back(dynamic);
+  }
+
+  // scan for type tags. Each chunk of memory is done separately, and the chunks are in address
+  // order, so concatenating them keeps the objects sorted.
+  const u32 num_slots = (ram.size - kFirstObjectAddr) / 16;
+  const size_t num_chunks = num_threads * 16;
+  std::vector<std::vector<HeapObject>> found(num_chunks);
+  for_each_chunk(num_slots, num_chunks, num_threads, [&](size_t chunk, size_t start, size_t end) {
+    for (size_t slot = start; slot < end; slot++) {
+      u32 addr = kFirstObjectAddr + 16 * slot;
+      auto it = type_ids.find(ram.word(addr));
+      if (it != type_ids.end()) {
+        found[chunk].push_back({addr, type_sizes[it->second], it->second});
+      }
+    }
+  });
+  for (auto& chunk : found) {
+    index.objects.insert(index.objects.end(), chunk.begin(), chunk.end());
+  }
+
+  for (size_t i = 0; i < index.objects.size(); i++) {
+    auto& obj = index.objects[i];
+    u32 next = i + 1 < index.objects.size() ? index.objects[i + 1].addr : ram.size;
+    if (type_dynamic[obj.type]) {
+      obj.size = std::min(next - obj.addr, kMaxDynamicSize);
+    } else {
+      // a bad tag match can claim a size that runs into the next object.
+      obj.size = std::clamp<u32>(obj.size, 4, next - obj.addr);
+    }
+  }
+
+  // find pointers out of each object.
+  const size_t num_edge_chunks = std::max<size_t>(1, std::min(index.objects.size(), num_chunks));
+  std::vector<std::vector<u32>> chunk_targets(num_edge_chunks);
+  std::vector<u32> edge_counts(index.objects.size());
+  for_each_chunk(index.objects.size(), num_edge_chunks, num_threads,
+                 [&](size_t chunk, size_t start, size_t end) {
+                   std::vector<u32> targets;
+                   for (size_t i = start; i < end; i++) {
+                     const auto& obj = index.objects[i];
+                     targets.clear();
+                     for (u32 addr = obj.addr + 4; addr + 4 <= obj.addr + obj.size; addr += 4) {
+                       u32 value = ram.word(addr);
+                       if ((value & 3) || !ram.word_in_memory(value)) {
+                         continue;
+                       }
+                       int target = index.find_object(value);
+                       if (target >= 0 && target != (int)i) {
+                         targets.push_back(target);
+                       }
+                     }
+                     std::sort(targets.begin(), targets.end());
+                     targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+                     edge_counts[i] = targets.size();
+                     chunk_targets[chunk].insert(chunk_targets[chunk].end(), targets.begin(),
+                                                 targets.end());
+                   }
+                 });
+
+  index.edge_start.resize(index.objects.size() + 1);
+  for (size_t i = 0; i < index.objects.size(); i++) {
+    index.edge_start[i + 1] = index.edge_start[i] + edge_counts[i];
+  }
+  index.edge_targets.reserve(index.edge_start.back());
+  for (auto& chunk : chunk_targets) {
+    index.edge_targets.insert(index.edge_targets.end(), chunk.begin(), chunk.end());
+  }
+  ASSERT(index.edge_targets.size() == index.edge_start.back());
+
+  for (u32 value : symbol_values) {
+    int obj = index.find_object(value);
+    if (obj >= 0) {
+      index.roots.push_back(obj);
+    }
+  }
+  std::sort(index.roots.begin(), index.roots.end());
+  index.roots.erase(std::unique(index.roots.begin(), index.roots.end()), index.roots.end());
+
+  lg::info("Indexed {} objects of {} types with {} pointers in {:.2f}s ({} threads)",
+           index.objects.size(), index.type_names.size(), index.edge_targets.size(),
+           timer.getSeconds(), num_threads);
+  return index;
+}
+
+/*!
+ * Count and total size of each type, biggest first.
+ */
+std::vector<TypeCensus> take_census(const HeapIndex& index) {
+  std::vector<TypeCensus> result(index.type_names.size());
+  for (size_t i = 0; i < result.size(); i++) {
+    result[i].name = index.type_names[i];
+  }
+  for (const auto& obj : index.objects) {
+    result[obj.type].count++;
+    result[obj.type].bytes += obj.size;
+  }
+  result.erase(std::remove_if(result.begin(), result.end(),
+                              [](const TypeCensus& c) { return c.count == 0; }),
+               result.end());
+  std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+    return a.bytes != b.bytes ? a.bytes > b.bytes : a.name < b.name;
+  });
+  return result;
+}
+
+/*!
+ * Compute the dominator tree of the pointer graph, rooted at the symbol table, and use it to find
+ * the retained size of each object. Objects that can't be reached from a symbol are treated as
+ * roots. This uses the iterative algorithm from "A Simple, Fast Dominance Algorithm" by Cooper,
+ * Harvey and Kennedy.
+ */
+RetainedSizes compute_retained_sizes(const HeapIndex& index) {
+  const u32 n = index.objects.size();
+  const u32 root = n;
+
+  // the successors of the root, added to as we find unreachable objects.
+  std::vector<u32> root_edges = index.roots;
+  auto successors = [&](u32 v, u32 i) -> const u32* {
+    if (v == root) {
+      return i < root_edges.size() ? &root_edges[i] : nullptr;
+    }
+    u32 e = index.edge_start[v] + i;
+    return e < index.edge_start[v + 1] ? &index.edge_targets[e] : nullptr;
+  };
+
+  // depth first search for a post order.
+  std::vector<u32> post_order;
+  std::vector<s32> post_number(n + 1, -1);
+  std::vector<bool> visited(n + 1, false);
+  std::vector<std::pair<u32, u32>> stack;  // node, next successor
+  auto search_from = [&](u32 start) {
+    visited[start] = true;
+    stack.push_back({start, 0});
+    while (!stack.empty()) {
+      auto& [v, next] = stack.back();
+      const u32* succ = successors(v, next);
+      if (succ) {
+        next++;
+        if (!visited[*succ]) {
+          visited[*succ] = true;
+          stack.push_back({*succ, 0});
+        }
+      } else {
+        post_number[v] = post_order.size();
+        post_order.push_back(v);
+        stack.pop_back();
+      }
+    }
+  };
+
+  visited[root] = true;
+  for (u32 r : index.roots) {
+    if (!visited[r]) {
+      search_from(r);
+    }
+  }
+  for (u32 v = 0; v < n; v++) {
+    if (!visited[v]) {
+      root_edges.push_back(v);
+      search_from(v);
+    }
+  }
+  post_number[root] = post_order.size();
+  post_order.push_back(root);
+
+  // predecessors
+  std::vector<u32> pred_start(n + 2, 0);
+  for (u32 t : index.edge_targets) {
+    pred_start[t + 1]++;
+  }
+  for (u32 t : root_edges) {
+    pred_start[t + 1]++;
+  }
+  for (u32 i = 0; i < n + 1; i++) {
+    pred_start[i + 1] += pred_start[i];
+  }
+  std::vector<u32> preds(pred_start.back());
+  {
+    std::vector<u32> fill(pred_start.begin(), pred_start.end() - 1);
+    for (u32 v = 0; v < n; v++) {
+      for (u32 e = index.edge_start[v]; e < index.edge_start[v + 1]; e++) {
+        preds[fill[index.edge_targets[e]]++] = v;
+      }
+    }
+    for (u32 t : root_edges) {
+      preds[fill[t]++] = root;
+    }
+  }
+
+  std::vector<s32> idom(n + 1, -1);
+  idom[root] = root;
+  auto intersect = [&](s32 a, s32 b) {
+    while (a != b) {
+      while (post_number[a] < post_number[b]) {
+        a = idom[a];
+      }
+      while (post_number[b] < post_number[a]) {
+        b = idom[b];
+      }
+    }
+    return a;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    // reverse post order, skipping the root.
+    for (size_t i = post_order.size() - 1; i-- > 0;) {
+      u32 v = post_order[i];
+      s32 new_idom = -1;
+      for (u32 p = pred_start[v]; p < pred_start[v + 1]; p++) {
+        s32 pred = preds[p];
+        if (idom[pred] != -1) {
+          new_idom = new_idom == -1 ? pred : intersect(pred, new_idom);
+        }
+      }
+      if (idom[v] != new_idom) {
+        idom[v] = new_idom;
+        changed = true;
+      }
+    }
+  }
+
+  RetainedSizes result;
+  result.retained.resize(n + 1, 0);
+  for (u32 v = 0; v < n; v++) {
+    result.retained[v] = index.objects[v].size;
+  }
+  // children come before their dominator in post order.
+  for (u32 v : post_order) {
+    if (v != root) {
+      result.retained[idom[v]] += result.retained[v];
+    }
+  }
+  result.retained.pop_back();
+  result.idom.resize(n);
+  for (u32 v = 0; v < n; v++) {
+    result.idom[v] = idom[v] == (s32)root ? -1 : idom[v];
+  }
+  return result;
+}
+
+/*!
+ * Objects that point to obj, as (object index, offset of the pointer in that object).
+ */
+std::vector<std::pair<u32, u32>> find_referrers(const Ram& ram, const HeapIndex& index, u32 obj) {
+  std::vector<std::pair<u32, u32>> result;
+  const auto& target = index.objects.at(obj);
+  for (u32 v = 0; v < index.objects.size(); v++) {
+    auto begin = index.edge_targets.begin() + index.edge_start[v];
+    auto end = index.edge_targets.begin() + index.edge_start[v + 1];
+    if (!std::binary_search(begin, end, obj)) {
+      continue;
+    }
+    const auto& src = index.objects[v];
+    for (u32 addr = src.addr + 4; addr + 4 <= src.addr + src.size; addr += 4) {
+      u32 value = ram.word(addr);
+      if (value >= target.addr && value < target.addr + target.size) {
+        result.push_back({v, addr - src.addr});
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+/*!
+ * @file HeapIndex.h
+ * An index of the GOAL objects in a memory dump and the pointers between them. It's built once,
+ * in parallel, and the census, retained size and "who points to" reports all read from it.
+ */
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/util/Assert.h"
+
+class TypeSystem;
+
+struct Ram {
+  const u8* data = nullptr;
+  u32 size = 0;
+
+  Ram(const u8* _data, u32 _size) : data(_data), size(_size) {}
+
+  template <typename T>
+  T read(u32 addr) const {
+    ASSERT(in_memory<T>(addr));
+    T result;
+    memcpy(&result, data + addr, sizeof(T));
+    return result;
+  }
+
+  template <typename T>
+  bool in_memory(u32 addr) const {
+    return addr > (1 << 19) && addr <= (size - sizeof(T));
+  }
+
+  u32 word(u32 addr) const { return read<u32>(addr); }
+
+  u8 byte(int addr) const { return read<u8>(addr); }
+
+  std::string string(u32 addr) const {
+    std::string result;
+    while (true) {
+      ASSERT(in_memory<u8>(addr));
+      auto next = read<u8>(addr++);
+      if (next) {
+        result.push_back(next);
+      } else {
+        return result;
+      }
+    }
+  }
+
+  std::optional<std::string> try_string(u32 addr, int max_len = 128) const {
+    std::string result;
+    for (int i = 0; i < max_len; i++) {
+      if (!in_memory<u8>(addr)) {
+        return {};
+      }
+      auto next = read<u8>(addr++);
+      if (next) {
+        result.push_back(next);
+      } else {
+        return result;
+      }
+    }
+    return {};
+  }
+
+  /*!
+   * addr, including basic offset.
+   */
+  std::string goal_string(u32 addr) { return string(addr + 4); }
+
+  bool word_in_memory(u32 addr) const { return in_memory<u32>(addr); }
+};
+
+struct HeapObject {
+  u32 addr = 0;  // address of the type tag, the basic starts 4 bytes later.
+  u32 size = 0;  // estimated, see build_heap_index
+  u32 type = 0;  // index into HeapIndex::type_names
+};
+
+struct HeapIndex {
+  std::vector<std::string> type_names;
+  // sorted by address, and don't overlap.
+  std::vector<HeapObject> objects;
+  // the objects pointed to by objects[i] are edge_targets[edge_start[i]] to
+  // edge_targets[edge_start[i + 1]], as indices into objects.
+  std::vector<u32> edge_start;
+  std::vector<u32> edge_targets;
+  // objects that are the value of a symbol.
+  std::vector<u32> roots;
+
+  int find_object(u32 addr) const;
+  std::unordered_map<std::string, std::vector<u32>> basics_by_type(
+      const std::vector<std::string>& ignored_types) const;
+};
+
+struct TypeCensus {
+  std::string name;
+  u64 count = 0;
+  u64 bytes = 0;
+};
+
+struct RetainedSizes {
+  // size of everything that's only reachable through this object, including itself.
+  std::vector<u64> retained;
+  // immediate dominator of each object, or -1 if it's only dominated by the symbol table.
+  std::vector<s32> idom;
+};
+
+HeapIndex build_heap_index(const Ram& ram,
+                           const std::unordered_map<u32, std::string>& types,
+                           const std::vector<u32>& symbol_values,
+                           const TypeSystem& type_system,
+                           int num_threads);
+std::vector<TypeCensus> take_census(const HeapIndex& index);
+RetainedSizes compute_retained_sizes(const HeapIndex& index);
+std::vector<std::pair<u32, u32>> find_referrers(const Ram& ram, const HeapIndex& index, u32 obj);
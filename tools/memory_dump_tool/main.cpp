@@ -1,7 +1,9 @@
 #include <fstream>
 #include <iomanip>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "common/goal_constants.h"
 #include "common/log/log.h"
@@ -11,72 +13,14 @@
 #include "common/util/FileUtil.h"
 #include "common/util/unicode_util.h"
 
+#include "HeapIndex.h"
+
 #include "decompiler/util/DecompilerTypeSystem.h"
 
 #include "fmt/core.h"
 #include "third-party/CLI11.hpp"
 #include "third-party/json.hpp"
 
-struct Ram {
-  const u8* data = nullptr;
-  u32 size = 0;
-
-  Ram(const u8* _data, u32 _size) : data(_data), size(_size) {}
-
-  template <typename T>
-  T read(u32 addr) const {
-    ASSERT(in_memory<T>(addr));
-    T result;
-    memcpy(&result, data + addr, sizeof(T));
-    return result;
-  }
-
-  template <typename T>
-  bool in_memory(u32 addr) const {
-    return addr > (1 << 19) && addr <= (size - sizeof(T));
-  }
-
-  u32 word(u32 addr) const { return read<u32>(addr); }
-
-  u8 byte(int addr) const { return read<u8>(addr); }
-
-  std::string string(u32 addr) const {
-    std::string result;
-    while (true) {
-      ASSERT(in_memory<u8>(addr));
-      auto next = read<u8>(addr++);
-      if (next) {
-        result.push_back(next);
-      } else {
-        return result;
-      }
-    }
-  }
-
-  std::optional<std::string> try_string(u32 addr, int max_len = 128) const {
-    std::string result;
-    for (int i = 0; i < max_len; i++) {
-      if (!in_memory<u8>(addr)) {
-        return {};
-      }
-      auto next = read<u8>(addr++);
-      if (next) {
-        result.push_back(next);
-      } else {
-        return result;
-      }
-    }
-    return {};
-  }
-
-  /*!
-   * addr, including basic offset.
-   */
-  std::string goal_string(u32 addr) { return string(addr + 4); }
-
-  bool word_in_memory(u32 addr) const { return in_memory<u32>(addr); }
-};
-
 u32 scan_for_symbol_table(const Ram& ram,
                           const GameVersion& game_version,
                           u32 start_addr,
@@ -230,29 +174,6 @@ std::unordered_map<u32, std::string> build_type_map(const Ram& ram,
 const std::vector<std::string> ignored_types = {"symbol", "string", "function", "object",
                                                 "integer"};
 
-std::unordered_map<std::string, std::vector<u32>> find_basics(
-    const Ram& ram,
-    const std::unordered_map<u32, std::string>& type_map) {
-  lg::info("Scanning memory for objects. This may take a while...");
-
-  std::unordered_map<std::string, std::vector<u32>> result;
-  int total_objects = 0;
-
-  for (u32 addr = (1 << 20); addr < ram.size; addr += 16) {
-    u32 tag = ram.word(addr);
-    auto iter = type_map.find(tag);
-    // ignore the stupid types.
-    if (iter != type_map.end() && std::find(ignored_types.begin(), ignored_types.end(),
-                                            iter->second) == ignored_types.end()) {
-      result[iter->second].push_back(addr);
-      total_objects++;
-    }
-  }
-
-  lg::info("Got {} objects of {} unique types\n", total_objects, result.size());
-  return result;
-}
-
 void inspect_process_self(const Ram& ram,
                           const std::unordered_map<std::string, std::vector<u32>>& basics,
                           const std::unordered_map<u32, std::string>& types,
@@ -606,12 +527,179 @@ void inspect_symbols(const Ram& ram,
   }
 }
 
+void print_census(const HeapIndex& index, int top) {
+  auto census = take_census(index);
+  u64 total_count = 0, total_bytes = 0;
+  for (const auto& entry : census) {
+    total_count += entry.count;
+    total_bytes += entry.bytes;
+  }
+  fmt::print("Census: {} objects, {} KB\n", total_count, total_bytes / 1024);
+  fmt::print("  {:>10s} {:>10s} {:>6s}  type\n", "count", "KB", "%");
+  for (int i = 0; i < std::min(top, (int)census.size()); i++) {
+    const auto& entry = census[i];
+    fmt::print("  {:10d} {:10d} {:5.1f}%  {}\n", entry.count, entry.bytes / 1024,
+               100. * entry.bytes / total_bytes, entry.name);
+  }
+}
+
+void print_retained(const HeapIndex& index, const RetainedSizes& sizes, int top) {
+  std::vector<u32> order(index.objects.size());
+  for (u32 i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+    return sizes.retained[a] != sizes.retained[b] ? sizes.retained[a] > sizes.retained[b] : a < b;
+  });
+  fmt::print("Largest retained sizes:\n");
+  fmt::print("  {:>8s} {:>10s} {:>12s}  type\n", "object", "self", "retained");
+  for (int i = 0; i < std::min(top, (int)order.size()); i++) {
+    const auto& obj = index.objects[order[i]];
+    fmt::print("  {:08x} {:10d} {:12d}  {}\n", obj.addr + 4, obj.size, sizes.retained[order[i]],
+               index.type_names[obj.type]);
+  }
+}
+
+void print_referrers(const Ram& ram,
+                     const HeapIndex& index,
+                     const RetainedSizes& sizes,
+                     const SymbolMap& symbols,
+                     u32 addr) {
+  int obj_idx = index.find_object(addr);
+  if (obj_idx < 0) {
+    lg::error("No object found at #x{:x}", addr);
+    return;
+  }
+  auto print_object = [&](u32 idx) {
+    const auto& obj = index.objects[idx];
+    return fmt::format("{:08x} {} ({} bytes, {} retained)", obj.addr + 4,
+                       index.type_names[obj.type], obj.size, sizes.retained[idx]);
+  };
+  const auto& obj = index.objects[obj_idx];
+  fmt::print("Object {}\n", print_object(obj_idx));
+
+  for (const auto& [name, value] : symbols.name_to_value) {
+    if (value >= obj.addr && value < obj.addr + obj.size) {
+      fmt::print("  value of symbol {}\n", name);
+    }
+  }
+  auto referrers = find_referrers(ram, index, obj_idx);
+  fmt::print("  {} pointers from other objects:\n", referrers.size());
+  for (const auto& [from, offset] : referrers) {
+    fmt::print("    {} + {}\n", print_object(from), offset - 4);
+  }
+  fmt::print("  dominated by:\n");
+  for (s32 dom = sizes.idom[obj_idx]; dom >= 0; dom = sizes.idom[dom]) {
+    fmt::print("    {}\n", print_object(dom));
+  }
+  fmt::print("    symbol table\n");
+}
+
+void print_census_diff(const HeapIndex& before, const HeapIndex& after, int top) {
+  struct Delta {
+    std::string name;
+    s64 count = 0;
+    s64 bytes = 0;
+  };
+  std::unordered_map<std::string, Delta> deltas;
+  for (const auto& entry : take_census(before)) {
+    auto& delta = deltas[entry.name];
+    delta.name = entry.name;
+    delta.count -= entry.count;
+    delta.bytes -= entry.bytes;
+  }
+  for (const auto& entry : take_census(after)) {
+    auto& delta = deltas[entry.name];
+    delta.name = entry.name;
+    delta.count += entry.count;
+    delta.bytes += entry.bytes;
+  }
+  std::vector<Delta> sorted;
+  for (const auto& [name, delta] : deltas) {
+    if (delta.count || delta.bytes) {
+      sorted.push_back(delta);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const Delta& a, const Delta& b) {
+    return std::abs(a.bytes) != std::abs(b.bytes) ? std::abs(a.bytes) > std::abs(b.bytes)
+                                                  : a.name < b.name;
+  });
+  fmt::print("Changes by type ({} types changed):\n", sorted.size());
+  fmt::print("  {:>10s} {:>12s}  type\n", "count", "bytes");
+  for (int i = 0; i < std::min(top, (int)sorted.size()); i++) {
+    fmt::print("  {:+10d} {:+12d}  {}\n", sorted[i].count, sorted[i].bytes, sorted[i].name);
+  }
+}
+
+struct MemoryDump {
+  std::vector<u8> data;
+  u32 s7 = 0;
+  SymbolMap symbols;
+  std::unordered_map<u32, std::string> types;
+
+  Ram ram() const { return Ram(data.data(), data.size()); }
+
+  std::vector<u32> symbol_values() const {
+    std::vector<u32> result;
+    for (const auto& [name, value] : symbols.name_to_value) {
+      result.push_back(value);
+    }
+    return result;
+  }
+};
+
+std::optional<MemoryDump> load_dump(const fs::path& dump_path, GameVersion game_version) {
+  if (dump_path.extension() == "p2s") {
+    lg::error("PCSX2 savestates are not directly supported. Please extract contents beforehand");
+    return {};
+  }
+
+  lg::info("Loading memory from '{}'", dump_path.string());
+  MemoryDump dump;
+  dump.data = file_util::read_binary_file(dump_path);
+
+  u32 one_mb = (1 << 20);
+
+  if (dump.data.size() == 32 * one_mb) {
+    lg::info("Got 32MB file");
+  } else if (dump.data.size() == 128 * one_mb) {
+    lg::info("Got 128MB file");
+  } else if (dump.data.size() == 127 * one_mb) {
+    lg::warn("Got a 127MB file. Assuming this is a dump with the first 1 MB missing.\n");
+    dump.data.insert(dump.data.begin(), one_mb, 0);
+    if (dump.data.size() != 128 * one_mb) {
+      lg::error("it was not!");
+      return {};
+    }
+  } else {
+    lg::error("Invalid size: {} bytes", dump.data.size());
+    return {};
+  }
+
+  auto ram = dump.ram();
+  dump.s7 = scan_for_symbol_table(ram, game_version, one_mb, 2 * one_mb);
+  if (!dump.s7) {
+    lg::error("Failed to find symbol table");
+    return {};
+  }
+
+  dump.symbols = build_symbol_map(game_version, ram, dump.s7);
+  dump.types = build_type_map(ram, dump.symbols, game_version, dump.s7);
+  return dump;
+}
+
 int main(int argc, char** argv) {
   ArgumentGuard u8_guard(argc, argv);
 
   fs::path dump_path;
   fs::path output_path;
+  fs::path diff_path;
   std::string game_name = "jak1";
+  std::string who_points_to;
+  int num_jobs = 0;
+  int top = 30;
+  bool census = false;
+  bool retained = false;
 
   lg::initialize();
 
@@ -620,9 +708,36 @@ int main(int argc, char** argv) {
   app.add_option("--output-path", output_path,
                  "Where the output files should be sent, defaults to current directory otherwise");
   app.add_option("-g,--game", game_name, "Specify the game name, defaults to 'jak1'");
+  app.add_option("-j,--jobs", num_jobs,
+                 "Number of threads for scanning memory, defaults to the number of hardware "
+                 "threads");
+  app.add_flag("--census", census, "Print the number and total size of objects of each type");
+  app.add_flag("--retained", retained,
+               "Print the objects that keep the most memory alive, by their dominator tree");
+  app.add_option("--who-points-to", who_points_to,
+                 "Print the objects pointing to the object at this address, and its dominators");
+  app.add_option("--diff", diff_path,
+                 "Print how the census changed from this earlier dump of the same game");
+  app.add_option("--top", top, "Number of entries in the --census, --retained and --diff reports");
   app.validate_positionals();
   CLI11_PARSE(app, argc, argv);
 
+  u32 who_points_to_addr = 0;
+  if (!who_points_to.empty()) {
+    size_t end = 0;
+    unsigned long addr = 0;
+    try {
+      addr = std::stoul(who_points_to, &end, 0);
+    } catch (const std::logic_error&) {
+      end = 0;
+    }
+    if (end != who_points_to.size() || addr > UINT32_MAX) {
+      lg::error("--who-points-to takes an address, like 0x1b2c30, but got '{}'", who_points_to);
+      return 1;
+    }
+    who_points_to_addr = addr;
+  }
+
   auto ok = file_util::setup_project_path({});
   if (!ok) {
     lg::error("couldn't setup project path, exiting");
@@ -651,38 +766,44 @@ int main(int argc, char** argv) {
     output_folder = "./";
   }
 
-  if (dump_path.extension() == "p2s") {
-    lg::error("PCSX2 savestates are not directly supported. Please extract contents beforehand");
-    return 1;
+  if (num_jobs <= 0) {
+    num_jobs = std::max(1u, std::thread::hardware_concurrency());
   }
 
-  lg::info("Loading memory from '{}'", dump_path.string());
-  auto data = file_util::read_binary_file(dump_path);
-
-  u32 one_mb = (1 << 20);
-
-  if (data.size() == 32 * one_mb) {
-    lg::info("Got 32MB file");
-  } else if (data.size() == 128 * one_mb) {
-    lg::info("Got 128MB file");
-  } else if (data.size() == 127 * one_mb) {
-    lg::warn("Got a 127MB file. Assuming this is a dump with the first 1 MB missing.\n");
-    data.insert(data.begin(), one_mb, 0);
-    if (data.size() != 128 * one_mb) {
-      lg::error("it was not!");
-      return 1;
-    }
-  } else {
-    lg::error("Invalid size: {} bytes", data.size());
+  auto dump = load_dump(dump_path, game_version);
+  if (!dump) {
     return 1;
   }
-
-  Ram ram(data.data(), data.size());
-
-  u32 s7 = scan_for_symbol_table(ram, game_version, one_mb, 2 * one_mb);
-  if (!s7) {
-    lg::error("Failed to find symbol table");
-    return 1;
+  Ram ram = dump->ram();
+  u32 s7 = dump->s7;
+  const auto& symbol_map = dump->symbols;
+  const auto& types = dump->types;
+  auto index = build_heap_index(ram, types, dump->symbol_values(), dts.ts, num_jobs);
+
+  // the queries are quick, so skip the full reports if any were asked for.
+  if (census || retained || !who_points_to.empty() || !diff_path.empty()) {
+    if (census) {
+      print_census(index, top);
+    }
+    if (retained || !who_points_to.empty()) {
+      auto sizes = compute_retained_sizes(index);
+      if (retained) {
+        print_retained(index, sizes, top);
+      }
+      if (!who_points_to.empty()) {
+        print_referrers(ram, index, sizes, symbol_map, who_points_to_addr);
+      }
+    }
+    if (!diff_path.empty()) {
+      auto other = load_dump(diff_path, game_version);
+      if (!other) {
+        return 1;
+      }
+      auto other_index = build_heap_index(other->ram(), other->types, other->symbol_values(),
+                                          dts.ts, num_jobs);
+      print_census_diff(other_index, index, top);
+    }
+    return 0;
   }
 
   nlohmann::json results;
@@ -693,9 +814,7 @@ int main(int argc, char** argv) {
     i >> results;
   }
 
-  auto symbol_map = build_symbol_map(game_version, ram, s7);
-  auto types = build_type_map(ram, symbol_map, game_version, s7);
-  auto basics = find_basics(ram, types);
+  auto basics = index.basics_by_type(ignored_types);
 
   follow_references_to_find_pointers(ram, dts.ts, basics, s7 + 0x100);
 
@@ -0,0 +1,265 @@
+/*!
+ * @file main.cpp
+ * Replay frames captured from the game (Tools > Frame Capture in the debug menu) through the OpenGL
+ * renderer, and report how long each bucket took, and how many draws and triangles it had.
+ *
+ * This runs without the game, so it can be used to bisect renderer performance. It needs the .fr3
+ * files for the captured levels in out/<game>/fr3. To run without a display, use --offscreen, and
+ * set LIBGL_ALWAYS_SOFTWARE=1 to use Mesa's software renderer.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/global_profiler/FrameTimings.h"
+#include "common/goal_constants.h"
+#include "common/log/log.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+#include "common/util/unicode_util.h"
+#include "common/versions/versions.h"
+
+#include "game/graphics/opengl_renderer/FrameCapture.h"
+#include "game/graphics/opengl_renderer/OpenGLRenderer.h"
+#include "game/graphics/opengl_renderer/loader/Loader.h"
+#include "game/graphics/texture/TexturePool.h"
+
+#include "fmt/core.h"
+#include "third-party/CLI11.hpp"
+#include "third-party/SDL/include/SDL3/SDL.h"
+#include "third-party/SDL/include/SDL3/SDL_hints.h"
+#include "third-party/glad/include/glad/glad.h"
+
+namespace {
+
+constexpr PerGameVersion<int> fr3_level_count(jak1::LEVEL_TOTAL,
+                                              jak2::LEVEL_TOTAL,
+                                              jak3::LEVEL_TOTAL);
+
+struct BucketTotals {
+  std::string name;
+  u64 draw_calls = 0;
+  u64 triangles = 0;
+};
+
+SDL_Window* create_window(int width, int height) {
+  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+  SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
+  SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+
+  SDL_Window* window = SDL_CreateWindow("OpenGOAL Render Replay", width, height,
+                                        SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!window) {
+    lg::error("Could not create window: {}", SDL_GetError());
+    return nullptr;
+  }
+  SDL_GLContext gl_context = SDL_GL_CreateContext(window);
+  if (!gl_context || !SDL_GL_MakeCurrent(window, gl_context)) {
+    lg::error("Could not create OpenGL 4.3 context: {}", SDL_GetError());
+    return nullptr;
+  }
+  gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
+  if (!gladLoadGL()) {
+    lg::error("GL init fail");
+    return nullptr;
+  }
+  lg::info("OpenGL: {} ({})", (const char*)glGetString(GL_RENDERER),
+           (const char*)glGetString(GL_VERSION));
+  // don't wait for vsync, we want to know how fast we can go.
+  SDL_GL_SetSwapInterval(0);
+  return window;
+}
+
+/*!
+ * Add the draws and triangles of each bucket in the last frame to the totals.
+ */
+void add_bucket_totals(const Profiler& profiler, std::vector<BucketTotals>& totals) {
+  for (const auto& node : profiler.root().children()) {
+    if (node.name() != "buckets") {
+      continue;
+    }
+    for (const auto& bucket : node.children()) {
+      auto it = std::find_if(totals.begin(), totals.end(),
+                             [&](const BucketTotals& t) { return t.name == bucket.name(); });
+      if (it == totals.end()) {
+        it = totals.insert(totals.end(), BucketTotals{bucket.name()});
+      }
+      it->draw_calls += bucket.stats().draw_calls;
+      it->triangles += bucket.stats().triangles;
+    }
+  }
+}
+
+void print_report(const std::vector<BucketTotals>& totals, u64 frames) {
+  const auto all_stats = frame_timings().stats();
+  std::unordered_map<std::string, FrameTimings::ChannelStats> timings;
+  for (auto& stats : all_stats) {
+    timings[stats.name] = stats;
+  }
+
+  struct Row {
+    const BucketTotals* totals;
+    FrameTimings::ChannelStats timing;
+  };
+  std::vector<Row> rows;
+  for (auto& bucket : totals) {
+    auto it = timings.find("bucket/" + bucket.name);
+    Row row{&bucket, it == timings.end() ? FrameTimings::ChannelStats() : it->second};
+    if (bucket.draw_calls || row.timing.max > 0.01f) {
+      rows.push_back(row);
+    }
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const Row& a, const Row& b) { return a.timing.mean > b.timing.mean; });
+
+  fmt::print("{:<40} {:>9} {:>9} {:>9} {:>9} {:>12} {:>12}\n", "bucket", "mean ms", "p95 ms",
+             "p99 ms", "max ms", "draws/frame", "tris/frame");
+  for (auto& row : rows) {
+    fmt::print("{:<40} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>12.1f} {:>12.1f}\n",
+               row.totals->name, row.timing.mean, row.timing.p95, row.timing.p99, row.timing.max,
+               (double)row.totals->draw_calls / frames, (double)row.totals->triangles / frames);
+  }
+
+  fmt::print("\n");
+  for (auto& stats : all_stats) {
+    if (stats.name == "render" || stats.name.rfind("category/", 0) == 0) {
+      fmt::print("{:<40} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f}\n", stats.name, stats.mean,
+                 stats.p95, stats.p99, stats.max);
+    }
+  }
+}
+
+int run(FrameCapture& capture,
+        int iterations,
+        int width,
+        int height,
+        int msaa,
+        bool gpu_sync,
+        SDL_Window* window) {
+  const auto version = capture.version;
+  auto texture_pool = std::make_shared<TexturePool>(version);
+  auto loader = std::make_shared<Loader>(
+      file_util::get_jak_project_dir() / "out" / game_version_names[version] / "fr3",
+      fr3_level_count[version]);
+  OpenGLRenderer renderer(texture_pool, loader, version);
+
+  RenderOptions options;
+  options.msaa_samples = msaa;
+  options.game_res_w = width;
+  options.game_res_h = height;
+  options.window_framebuffer_width = width;
+  options.window_framebuffer_height = height;
+  options.draw_region_width = width;
+  options.draw_region_height = height;
+  options.gpu_sync = gpu_sync;
+  options.ee_main_memory = capture.ee_memory.data();
+  options.offset_of_s7 = capture.offset_of_s7;
+
+  auto render_frame = [&](const FrameCaptureFrame& frame) {
+    loader->set_want_levels(frame.levels);
+    loader->set_active_levels(frame.active_levels);
+    options.pmode_alp_register = frame.pmode_alp;
+    renderer.render(DmaFollower(frame.dma.data.data(), frame.dma.start_offset), options);
+    SDL_GL_SwapWindow(window);
+  };
+
+  // load all the levels and render each frame once, so loading and shader compiles aren't timed.
+  Timer warmup_timer;
+  for (auto& frame : capture.frames) {
+    loader->set_want_levels(frame.levels);
+    loader->update_blocking(*texture_pool);
+    render_frame(frame);
+  }
+  glFinish();
+  lg::info("Warmup took {:.3f} s", warmup_timer.getSeconds());
+
+  frame_timings().reset();
+  std::vector<BucketTotals> totals;
+  u64 frames = 0;
+  Timer replay_timer;
+  for (int i = 0; i < iterations; i++) {
+    for (auto& frame : capture.frames) {
+      render_frame(frame);
+      add_bucket_totals(renderer.profiler(), totals);
+      frames++;
+    }
+  }
+  glFinish();
+  const double seconds = replay_timer.getSeconds();
+  lg::info("Replayed {} frames in {:.3f} s ({:.3f} ms/frame)", frames, seconds,
+           1000. * seconds / frames);
+  print_report(totals, frames);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ArgumentGuard u8_guard(argc, argv);
+
+  fs::path capture_path;
+  fs::path output_path;
+  int iterations = 100;
+  int width = 640;
+  int height = 480;
+  int msaa = 2;
+  bool no_gpu_sync = false;
+  bool offscreen = false;
+
+  lg::initialize();
+
+  CLI::App app{"OpenGOAL Render Replay"};
+  app.add_option("capture", capture_path, "Frame capture (.fcap) to replay")->required();
+  app.add_option("-n,--iterations", iterations, "How many times to replay the capture")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--width", width, "Render width");
+  app.add_option("--height", height, "Render height");
+  app.add_option("--msaa", msaa, "MSAA samples");
+  app.add_flag("--no-gpu-sync", no_gpu_sync,
+               "Don't glFinish after each bucket. Bucket times will only include CPU time");
+  app.add_flag("--offscreen", offscreen, "Use SDL's offscreen video driver, for headless machines");
+  app.add_option("-o,--output", output_path,
+                 "Also write frame timings for every bucket to a .csv or .json file");
+  app.validate_positionals();
+  CLI11_PARSE(app, argc, argv);
+
+  if (!file_util::setup_project_path({})) {
+    lg::error("couldn't setup project path, exiting");
+    return 1;
+  }
+
+  auto capture = load_frame_capture(capture_path);
+  if (!capture) {
+    return 1;
+  }
+  lg::info("Loaded {} frames of {}", capture->frames.size(),
+           game_version_names[capture->version]);
+
+  if (offscreen) {
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+  }
+  if (!SDL_Init(SDL_INIT_VIDEO)) {
+    lg::error("Could not initialize SDL: {}", SDL_GetError());
+    return 1;
+  }
+  SDL_Window* window = create_window(width, height);
+  if (!window) {
+    return 1;
+  }
+
+  int result = run(*capture, iterations, width, height, msaa, !no_gpu_sync, window);
+  if (result == 0 && !output_path.empty()) {
+    frame_timings().dump(output_path);
+  }
+
+  SDL_DestroyWindow(window);
+  SDL_Quit();
+  return result;
+}